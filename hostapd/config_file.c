@@ -1176,6 +1176,197 @@ static int parse_roaming_consortium(struct hostapd_bss_config *bss, char *pos,
 #endif /* CONFIG_INTERWORKING */
 
 
+/*
+ * Simple integer configuration items are dispatched through a hash table
+ * built from hostapd_config_fields[] instead of the string comparison chain
+ * in hostapd_config_read().
+ */
+
+struct hostapd_config_field {
+	const char *name;
+	int iface; /* 1 = struct hostapd_config, 0 = struct hostapd_bss_config */
+	void *offset;
+	size_t size;
+};
+
+#define BSS_FIELD(n, f) \
+	{ n, 0, (void *) &((struct hostapd_bss_config *) 0)->f, \
+	  sizeof(((struct hostapd_bss_config *) 0)->f) }
+#define IFACE_FIELD(n, f) \
+	{ n, 1, (void *) &((struct hostapd_config *) 0)->f, \
+	  sizeof(((struct hostapd_config *) 0)->f) }
+
+static const struct hostapd_config_field hostapd_config_fields[] = {
+	BSS_FIELD("logger_syslog_level", logger_syslog_level),
+	BSS_FIELD("logger_stdout_level", logger_stdout_level),
+	BSS_FIELD("logger_syslog", logger_syslog),
+	BSS_FIELD("logger_stdout", logger_stdout),
+	BSS_FIELD("wds_sta", wds_sta),
+	BSS_FIELD("ap_isolate", isolate),
+	BSS_FIELD("ap_max_inactivity", ap_max_inactivity),
+	IFACE_FIELD("ieee80211d", ieee80211d),
+	BSS_FIELD("ieee8021x", ieee802_1x),
+#ifdef EAP_SERVER
+	BSS_FIELD("eap_server", eap_server),
+	BSS_FIELD("check_crl", check_crl),
+	BSS_FIELD("fragment_size", fragment_size),
+#ifdef EAP_SERVER_FAST
+	BSS_FIELD("eap_fast_prov", eap_fast_prov),
+	BSS_FIELD("pac_key_lifetime", pac_key_lifetime),
+	BSS_FIELD("pac_key_refresh_time", pac_key_refresh_time),
+#endif /* EAP_SERVER_FAST */
+#ifdef EAP_SERVER_SIM
+	BSS_FIELD("eap_sim_aka_result_ind", eap_sim_aka_result_ind),
+#endif /* EAP_SERVER_SIM */
+#ifdef EAP_SERVER_TNC
+	BSS_FIELD("tnc", tnc),
+#endif /* EAP_SERVER_TNC */
+#ifdef EAP_SERVER_PWD
+	BSS_FIELD("pwd_group", pwd_group),
+#endif /* EAP_SERVER_PWD */
+#endif /* EAP_SERVER */
+	BSS_FIELD("eapol_key_index_workaround", eapol_key_index_workaround),
+	BSS_FIELD("wpa", wpa),
+	BSS_FIELD("wpa_group_rekey", wpa_group_rekey),
+	BSS_FIELD("wpa_strict_rekey", wpa_strict_rekey),
+	BSS_FIELD("wpa_gmk_rekey", wpa_gmk_rekey),
+	BSS_FIELD("wpa_ptk_rekey", wpa_ptk_rekey),
+#ifdef CONFIG_RSN_PREAUTH
+	BSS_FIELD("rsn_preauth", rsn_preauth),
+#endif /* CONFIG_RSN_PREAUTH */
+#ifdef CONFIG_PEERKEY
+	BSS_FIELD("peerkey", peerkey),
+#endif /* CONFIG_PEERKEY */
+#ifdef CONFIG_IEEE80211R
+	BSS_FIELD("r0_key_lifetime", r0_key_lifetime),
+	BSS_FIELD("reassociation_deadline", reassociation_deadline),
+	BSS_FIELD("pmk_r1_push", pmk_r1_push),
+	BSS_FIELD("ft_over_ds", ft_over_ds),
+#endif /* CONFIG_IEEE80211R */
+#ifdef RADIUS_SERVER
+	BSS_FIELD("radius_server_auth_port", radius_server_auth_port),
+	BSS_FIELD("radius_server_ipv6", radius_server_ipv6),
+#endif /* RADIUS_SERVER */
+#ifndef CONFIG_NO_RADIUS
+	BSS_FIELD("acct_spool_max_size", acct_spool_max_size),
+	BSS_FIELD("acct_spool_replay_rate", acct_spool_replay_rate),
+#endif /* CONFIG_NO_RADIUS */
+	BSS_FIELD("use_pae_group_addr", use_pae_group_addr),
+	IFACE_FIELD("channel", channel),
+	BSS_FIELD("ignore_broadcast_ssid", ignore_broadcast_ssid),
+#ifndef CONFIG_NO_VLAN
+	BSS_FIELD("dynamic_vlan", ssid.dynamic_vlan),
+#endif /* CONFIG_NO_VLAN */
+	IFACE_FIELD("ap_table_max_size", ap_table_max_size),
+	IFACE_FIELD("ap_table_expiration_time", ap_table_expiration_time),
+	BSS_FIELD("uapsd_advertisement_enabled", wmm_uapsd),
+#ifdef CONFIG_IEEE80211W
+	BSS_FIELD("ieee80211w", ieee80211w),
+#endif /* CONFIG_IEEE80211W */
+#ifdef CONFIG_IEEE80211N
+	IFACE_FIELD("ieee80211n", ieee80211n),
+	IFACE_FIELD("require_ht", require_ht),
+#endif /* CONFIG_IEEE80211N */
+	BSS_FIELD("max_listen_interval", max_listen_interval),
+	BSS_FIELD("disable_pmksa_caching", disable_pmksa_caching),
+	BSS_FIELD("okc", okc),
+#ifdef CONFIG_WPS
+	BSS_FIELD("ap_setup_locked", ap_setup_locked),
+	BSS_FIELD("skip_cred_build", skip_cred_build),
+	BSS_FIELD("wps_cred_processing", wps_cred_processing),
+	BSS_FIELD("pbc_in_m1", pbc_in_m1),
+#endif /* CONFIG_WPS */
+	BSS_FIELD("disassoc_low_ack", disassoc_low_ack),
+	BSS_FIELD("time_advertisement", time_advertisement),
+#ifdef CONFIG_INTERWORKING
+	BSS_FIELD("interworking", interworking),
+	BSS_FIELD("internet", internet),
+	BSS_FIELD("asra", asra),
+	BSS_FIELD("esr", esr),
+	BSS_FIELD("uesa", uesa),
+#endif /* CONFIG_INTERWORKING */
+};
+
+#undef BSS_FIELD
+#undef IFACE_FIELD
+
+#define NUM_CONFIG_FIELDS \
+	(sizeof(hostapd_config_fields) / sizeof(hostapd_config_fields[0]))
+#define CONFIG_FIELD_HASH_SIZE 256
+
+static const struct hostapd_config_field *
+hostapd_config_field_hash[CONFIG_FIELD_HASH_SIZE];
+static int hostapd_config_field_hash_ready = 0;
+
+
+static unsigned int hostapd_config_field_hash_key(const char *name)
+{
+	unsigned int hash = 5381;
+
+	while (*name)
+		hash = hash * 33 + (unsigned char) *name++;
+	return hash & (CONFIG_FIELD_HASH_SIZE - 1);
+}
+
+
+static void hostapd_config_field_hash_init(void)
+{
+	const struct hostapd_config_field *field;
+	unsigned int i, h;
+
+	for (i = 0; i < NUM_CONFIG_FIELDS; i++) {
+		field = &hostapd_config_fields[i];
+		h = hostapd_config_field_hash_key(field->name);
+		while (hostapd_config_field_hash[h])
+			h = (h + 1) & (CONFIG_FIELD_HASH_SIZE - 1);
+		hostapd_config_field_hash[h] = field;
+	}
+	hostapd_config_field_hash_ready = 1;
+}
+
+
+static const struct hostapd_config_field *
+hostapd_config_get_field(const char *name)
+{
+	const struct hostapd_config_field *field;
+	unsigned int h;
+
+	if (!hostapd_config_field_hash_ready)
+		hostapd_config_field_hash_init();
+
+	h = hostapd_config_field_hash_key(name);
+	while ((field = hostapd_config_field_hash[h]) != NULL) {
+		if (os_strcmp(field->name, name) == 0)
+			return field;
+		h = (h + 1) & (CONFIG_FIELD_HASH_SIZE - 1);
+	}
+	return NULL;
+}
+
+
+static void hostapd_config_set_field(struct hostapd_config *conf,
+				     struct hostapd_bss_config *bss,
+				     const struct hostapd_config_field *field,
+				     const char *value)
+{
+	u8 *base = field->iface ? (u8 *) conf : (u8 *) bss;
+	int val = atoi(value);
+
+	base += (long) field->offset;
+	switch (field->size) {
+	case 1:
+		*base = val;
+		break;
+	case 2:
+		*(u16 *) base = val;
+		break;
+	default:
+		*(int *) base = val;
+		break;
+	}
+}
+
+
 /**
  * hostapd_config_read - Read and parse a configuration file
  * @fname: Configuration file name (including path, if needed)
@@ -1186,6 +1377,7 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 	struct hostapd_config *conf;
 	struct hostapd_bss_config *bss;
 	FILE *f;
+	const struct hostapd_config_field *field;
 	char buf[256], *pos;
 	int line = 0;
 	int errors = 0;
@@ -1243,6 +1435,12 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		*pos = '\0';
 		pos++;
 
+		field = hostapd_config_get_field(buf);
+		if (field) {
+			hostapd_config_set_field(conf, bss, field, pos);
+			continue;
+		}
+
 		if (os_strcmp(buf, "interface") == 0) {
 			os_strlcpy(conf->bss[0].iface, pos,
 				   sizeof(conf->bss[0].iface));
@@ -1271,14 +1469,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 			wpa_printf(MSG_DEBUG, "Line %d: DEPRECATED: 'debug' "
 				   "configuration variable is not used "
 				   "anymore", line);
-		} else if (os_strcmp(buf, "logger_syslog_level") == 0) {
-			bss->logger_syslog_level = atoi(pos);
-		} else if (os_strcmp(buf, "logger_stdout_level") == 0) {
-			bss->logger_stdout_level = atoi(pos);
-		} else if (os_strcmp(buf, "logger_syslog") == 0) {
-			bss->logger_syslog = atoi(pos);
-		} else if (os_strcmp(buf, "logger_stdout") == 0) {
-			bss->logger_stdout = atoi(pos);
 		} else if (os_strcmp(buf, "dump_file") == 0) {
 			bss->dump_log_name = os_strdup(pos);
 		} else if (os_strcmp(buf, "ssid") == 0) {
@@ -1320,20 +1510,10 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 					   line, pos);
 				errors++;
 			}
-		} else if (os_strcmp(buf, "wds_sta") == 0) {
-			bss->wds_sta = atoi(pos);
-		} else if (os_strcmp(buf, "ap_isolate") == 0) {
-			bss->isolate = atoi(pos);
-		} else if (os_strcmp(buf, "ap_max_inactivity") == 0) {
-			bss->ap_max_inactivity = atoi(pos);
 		} else if (os_strcmp(buf, "country_code") == 0) {
 			os_memcpy(conf->country, pos, 2);
 			/* FIX: make this configurable */
 			conf->country[2] = ' ';
-		} else if (os_strcmp(buf, "ieee80211d") == 0) {
-			conf->ieee80211d = atoi(pos);
-		} else if (os_strcmp(buf, "ieee8021x") == 0) {
-			bss->ieee802_1x = atoi(pos);
 		} else if (os_strcmp(buf, "eapol_version") == 0) {
 			bss->eapol_version = atoi(pos);
 			if (bss->eapol_version < 1 ||
@@ -1351,8 +1531,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 			wpa_printf(MSG_ERROR, "Line %d: obsolete "
 				   "eap_authenticator used; this has been "
 				   "renamed to eap_server", line);
-		} else if (os_strcmp(buf, "eap_server") == 0) {
-			bss->eap_server = atoi(pos);
 		} else if (os_strcmp(buf, "eap_user_file") == 0) {
 			if (hostapd_config_read_eap_user(pos, bss))
 				errors++;
@@ -1368,13 +1546,9 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		} else if (os_strcmp(buf, "private_key_passwd") == 0) {
 			os_free(bss->private_key_passwd);
 			bss->private_key_passwd = os_strdup(pos);
-		} else if (os_strcmp(buf, "check_crl") == 0) {
-			bss->check_crl = atoi(pos);
 		} else if (os_strcmp(buf, "dh_file") == 0) {
 			os_free(bss->dh_file);
 			bss->dh_file = os_strdup(pos);
-		} else if (os_strcmp(buf, "fragment_size") == 0) {
-			bss->fragment_size = atoi(pos);
 #ifdef EAP_SERVER_FAST
 		} else if (os_strcmp(buf, "pac_opaque_encr_key") == 0) {
 			os_free(bss->pac_opaque_encr_key);
@@ -1411,28 +1585,12 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		} else if (os_strcmp(buf, "eap_fast_a_id_info") == 0) {
 			os_free(bss->eap_fast_a_id_info);
 			bss->eap_fast_a_id_info = os_strdup(pos);
-		} else if (os_strcmp(buf, "eap_fast_prov") == 0) {
-			bss->eap_fast_prov = atoi(pos);
-		} else if (os_strcmp(buf, "pac_key_lifetime") == 0) {
-			bss->pac_key_lifetime = atoi(pos);
-		} else if (os_strcmp(buf, "pac_key_refresh_time") == 0) {
-			bss->pac_key_refresh_time = atoi(pos);
 #endif /* EAP_SERVER_FAST */
 #ifdef EAP_SERVER_SIM
 		} else if (os_strcmp(buf, "eap_sim_db") == 0) {
 			os_free(bss->eap_sim_db);
 			bss->eap_sim_db = os_strdup(pos);
-		} else if (os_strcmp(buf, "eap_sim_aka_result_ind") == 0) {
-			bss->eap_sim_aka_result_ind = atoi(pos);
 #endif /* EAP_SERVER_SIM */
-#ifdef EAP_SERVER_TNC
-		} else if (os_strcmp(buf, "tnc") == 0) {
-			bss->tnc = atoi(pos);
-#endif /* EAP_SERVER_TNC */
-#ifdef EAP_SERVER_PWD
-		} else if (os_strcmp(buf, "pwd_group") == 0) {
-			bss->pwd_group = atoi(pos);
-#endif /* EAP_SERVER_PWD */
 #endif /* EAP_SERVER */
 		} else if (os_strcmp(buf, "eap_message") == 0) {
 			char *term;
@@ -1491,8 +1649,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 					   line, bss->eap_reauth_period);
 				errors++;
 			}
-		} else if (os_strcmp(buf, "eapol_key_index_workaround") == 0) {
-			bss->eapol_key_index_workaround = atoi(pos);
 #ifdef CONFIG_IAPP
 		} else if (os_strcmp(buf, "iapp_interface") == 0) {
 			bss->ieee802_11f = 1;
@@ -1559,9 +1715,26 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		} else if (os_strcmp(buf, "radius_retry_primary_interval") ==
 			   0) {
 			bss->radius->retry_primary_interval = atoi(pos);
+		} else if (os_strcmp(buf, "radius_client_ports") == 0) {
+			bss->radius->num_client_ports = atoi(pos);
+			if (bss->radius->num_client_ports < 1 ||
+			    bss->radius->num_client_ports > 16) {
+				wpa_printf(MSG_ERROR, "Line %d: invalid "
+					   "radius_client_ports %d (1..16)",
+					   line,
+					   bss->radius->num_client_ports);
+				errors++;
+			}
+		} else if (os_strcmp(buf, "radius_max_pending") == 0) {
+			bss->radius->max_pending = atoi(pos);
+		} else if (os_strcmp(buf, "radius_max_in_flight") == 0) {
+			bss->radius->max_in_flight = atoi(pos);
 		} else if (os_strcmp(buf, "radius_acct_interim_interval") == 0)
 		{
 			bss->acct_interim_interval = atoi(pos);
+		} else if (os_strcmp(buf, "acct_spool_file") == 0) {
+			os_free(bss->acct_spool_file);
+			bss->acct_spool_file = os_strdup(pos);
 #endif /* CONFIG_NO_RADIUS */
 		} else if (os_strcmp(buf, "auth_algs") == 0) {
 			bss->auth_algs = atoi(pos);
@@ -1581,16 +1754,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 					   MAX_STA_COUNT);
 				errors++;
 			}
-		} else if (os_strcmp(buf, "wpa") == 0) {
-			bss->wpa = atoi(pos);
-		} else if (os_strcmp(buf, "wpa_group_rekey") == 0) {
-			bss->wpa_group_rekey = atoi(pos);
-		} else if (os_strcmp(buf, "wpa_strict_rekey") == 0) {
-			bss->wpa_strict_rekey = atoi(pos);
-		} else if (os_strcmp(buf, "wpa_gmk_rekey") == 0) {
-			bss->wpa_gmk_rekey = atoi(pos);
-		} else if (os_strcmp(buf, "wpa_ptk_rekey") == 0) {
-			bss->wpa_ptk_rekey = atoi(pos);
 		} else if (os_strcmp(buf, "wpa_passphrase") == 0) {
 			int len = os_strlen(pos);
 			if (len < 8 || len > 63) {
@@ -1659,15 +1822,9 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 				errors++;
 			}
 #ifdef CONFIG_RSN_PREAUTH
-		} else if (os_strcmp(buf, "rsn_preauth") == 0) {
-			bss->rsn_preauth = atoi(pos);
 		} else if (os_strcmp(buf, "rsn_preauth_interfaces") == 0) {
 			bss->rsn_preauth_interfaces = os_strdup(pos);
 #endif /* CONFIG_RSN_PREAUTH */
-#ifdef CONFIG_PEERKEY
-		} else if (os_strcmp(buf, "peerkey") == 0) {
-			bss->peerkey = atoi(pos);
-#endif /* CONFIG_PEERKEY */
 #ifdef CONFIG_IEEE80211R
 		} else if (os_strcmp(buf, "mobility_domain") == 0) {
 			if (os_strlen(pos) != 2 * MOBILITY_DOMAIN_ID_LEN ||
@@ -1687,10 +1844,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 				errors++;
 				continue;
 			}
-		} else if (os_strcmp(buf, "r0_key_lifetime") == 0) {
-			bss->r0_key_lifetime = atoi(pos);
-		} else if (os_strcmp(buf, "reassociation_deadline") == 0) {
-			bss->reassociation_deadline = atoi(pos);
 		} else if (os_strcmp(buf, "r0kh") == 0) {
 			if (add_r0kh(bss, pos) < 0) {
 				wpa_printf(MSG_DEBUG, "Line %d: Invalid "
@@ -1705,10 +1858,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 				errors++;
 				continue;
 			}
-		} else if (os_strcmp(buf, "pmk_r1_push") == 0) {
-			bss->pmk_r1_push = atoi(pos);
-		} else if (os_strcmp(buf, "ft_over_ds") == 0) {
-			bss->ft_over_ds = atoi(pos);
 #endif /* CONFIG_IEEE80211R */
 #ifndef CONFIG_NO_CTRL_IFACE
 		} else if (os_strcmp(buf, "ctrl_interface") == 0) {
@@ -1747,16 +1896,10 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		} else if (os_strcmp(buf, "radius_server_clients") == 0) {
 			os_free(bss->radius_server_clients);
 			bss->radius_server_clients = os_strdup(pos);
-		} else if (os_strcmp(buf, "radius_server_auth_port") == 0) {
-			bss->radius_server_auth_port = atoi(pos);
-		} else if (os_strcmp(buf, "radius_server_ipv6") == 0) {
-			bss->radius_server_ipv6 = atoi(pos);
 #endif /* RADIUS_SERVER */
 		} else if (os_strcmp(buf, "test_socket") == 0) {
 			os_free(bss->test_socket);
 			bss->test_socket = os_strdup(pos);
-		} else if (os_strcmp(buf, "use_pae_group_addr") == 0) {
-			bss->use_pae_group_addr = atoi(pos);
 		} else if (os_strcmp(buf, "hw_mode") == 0) {
 			if (os_strcmp(pos, "a") == 0)
 				conf->hw_mode = HOSTAPD_MODE_IEEE80211A;
@@ -1769,8 +1912,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 					   "hw_mode '%s'", line, pos);
 				errors++;
 			}
-		} else if (os_strcmp(buf, "channel") == 0) {
-			conf->channel = atoi(pos);
 		} else if (os_strcmp(buf, "beacon_int") == 0) {
 			int val = atoi(pos);
 			/* MIB defines range as 1..65535, but very small values
@@ -1836,8 +1977,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 				conf->preamble = SHORT_PREAMBLE;
 			else
 				conf->preamble = LONG_PREAMBLE;
-		} else if (os_strcmp(buf, "ignore_broadcast_ssid") == 0) {
-			bss->ignore_broadcast_ssid = atoi(pos);
 		} else if (os_strcmp(buf, "wep_default_key") == 0) {
 			bss->ssid.wep.idx = atoi(pos);
 			if (bss->ssid.wep.idx > 3) {
@@ -1857,8 +1996,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 				errors++;
 			}
 #ifndef CONFIG_NO_VLAN
-		} else if (os_strcmp(buf, "dynamic_vlan") == 0) {
-			bss->ssid.dynamic_vlan = atoi(pos);
 		} else if (os_strcmp(buf, "vlan_file") == 0) {
 			if (hostapd_config_read_vlan_file(bss, pos)) {
 				wpa_printf(MSG_ERROR, "Line %d: failed to "
@@ -1870,10 +2007,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 			bss->ssid.vlan_tagged_interface = os_strdup(pos);
 #endif /* CONFIG_FULL_DYNAMIC_VLAN */
 #endif /* CONFIG_NO_VLAN */
-		} else if (os_strcmp(buf, "ap_table_max_size") == 0) {
-			conf->ap_table_max_size = atoi(pos);
-		} else if (os_strcmp(buf, "ap_table_expiration_time") == 0) {
-			conf->ap_table_expiration_time = atoi(pos);
 		} else if (os_strncmp(buf, "tx_queue_", 9) == 0) {
 			if (hostapd_config_tx_queue(conf, buf, pos)) {
 				wpa_printf(MSG_ERROR, "Line %d: invalid TX "
@@ -1883,8 +2016,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		} else if (os_strcmp(buf, "wme_enabled") == 0 ||
 			   os_strcmp(buf, "wmm_enabled") == 0) {
 			bss->wmm_enabled = atoi(pos);
-		} else if (os_strcmp(buf, "uapsd_advertisement_enabled") == 0) {
-			bss->wmm_uapsd = atoi(pos);
 		} else if (os_strncmp(buf, "wme_ac_", 7) == 0 ||
 			   os_strncmp(buf, "wmm_ac_", 7) == 0) {
 			if (hostapd_config_wmm_ac(conf, buf, pos)) {
@@ -1905,8 +2036,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 				errors++;
 			}
 #ifdef CONFIG_IEEE80211W
-		} else if (os_strcmp(buf, "ieee80211w") == 0) {
-			bss->ieee80211w = atoi(pos);
 		} else if (os_strcmp(buf, "assoc_sa_query_max_timeout") == 0) {
 			bss->assoc_sa_query_max_timeout = atoi(pos);
 			if (bss->assoc_sa_query_max_timeout == 0) {
@@ -1925,23 +2054,13 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 			}
 #endif /* CONFIG_IEEE80211W */
 #ifdef CONFIG_IEEE80211N
-		} else if (os_strcmp(buf, "ieee80211n") == 0) {
-			conf->ieee80211n = atoi(pos);
 		} else if (os_strcmp(buf, "ht_capab") == 0) {
 			if (hostapd_config_ht_capab(conf, pos) < 0) {
 				wpa_printf(MSG_ERROR, "Line %d: invalid "
 					   "ht_capab", line);
 				errors++;
 			}
-		} else if (os_strcmp(buf, "require_ht") == 0) {
-			conf->require_ht = atoi(pos);
 #endif /* CONFIG_IEEE80211N */
-		} else if (os_strcmp(buf, "max_listen_interval") == 0) {
-			bss->max_listen_interval = atoi(pos);
-		} else if (os_strcmp(buf, "disable_pmksa_caching") == 0) {
-			bss->disable_pmksa_caching = atoi(pos);
-		} else if (os_strcmp(buf, "okc") == 0) {
-			bss->okc = atoi(pos);
 #ifdef CONFIG_WPS
 		} else if (os_strcmp(buf, "wps_state") == 0) {
 			bss->wps_state = atoi(pos);
@@ -1950,8 +2069,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 					   "wps_state", line);
 				errors++;
 			}
-		} else if (os_strcmp(buf, "ap_setup_locked") == 0) {
-			bss->ap_setup_locked = atoi(pos);
 		} else if (os_strcmp(buf, "uuid") == 0) {
 			if (uuid_str2bin(pos, bss->uuid)) {
 				wpa_printf(MSG_ERROR, "Line %d: invalid UUID",
@@ -2016,8 +2133,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		} else if (os_strcmp(buf, "ap_pin") == 0) {
 			os_free(bss->ap_pin);
 			bss->ap_pin = os_strdup(pos);
-		} else if (os_strcmp(buf, "skip_cred_build") == 0) {
-			bss->skip_cred_build = atoi(pos);
 		} else if (os_strcmp(buf, "extra_cred") == 0) {
 			os_free(bss->extra_cred);
 			bss->extra_cred =
@@ -2028,8 +2143,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 					   line, pos);
 				errors++;
 			}
-		} else if (os_strcmp(buf, "wps_cred_processing") == 0) {
-			bss->wps_cred_processing = atoi(pos);
 		} else if (os_strcmp(buf, "ap_settings") == 0) {
 			os_free(bss->ap_settings);
 			bss->ap_settings =
@@ -2057,8 +2170,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		} else if (os_strcmp(buf, "upc") == 0) {
 			os_free(bss->upc);
 			bss->upc = os_strdup(pos);
-		} else if (os_strcmp(buf, "pbc_in_m1") == 0) {
-			bss->pbc_in_m1 = atoi(pos);
 #endif /* CONFIG_WPS */
 #ifdef CONFIG_P2P_MANAGER
 		} else if (os_strcmp(buf, "manage_p2p") == 0) {
@@ -2073,8 +2184,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 			else
 				bss->p2p &= ~P2P_ALLOW_CROSS_CONNECTION;
 #endif /* CONFIG_P2P_MANAGER */
-		} else if (os_strcmp(buf, "disassoc_low_ack") == 0) {
-			bss->disassoc_low_ack = atoi(pos);
 		} else if (os_strcmp(buf, "tdls_prohibit") == 0) {
 			int val = atoi(pos);
 			if (val)
@@ -2092,8 +2201,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 			extern int rsn_testing;
 			rsn_testing = atoi(pos);
 #endif /* CONFIG_RSN_TESTING */
-		} else if (os_strcmp(buf, "time_advertisement") == 0) {
-			bss->time_advertisement = atoi(pos);
 		} else if (os_strcmp(buf, "time_zone") == 0) {
 			size_t tz_len = os_strlen(pos);
 			if (tz_len < 4 || tz_len > 255) {
@@ -2107,8 +2214,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 			if (bss->time_zone == NULL)
 				errors++;
 #ifdef CONFIG_INTERWORKING
-		} else if (os_strcmp(buf, "interworking") == 0) {
-			bss->interworking = atoi(pos);
 		} else if (os_strcmp(buf, "access_network_type") == 0) {
 			bss->access_network_type = atoi(pos);
 			if (bss->access_network_type < 0 ||
@@ -2117,14 +2222,6 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 					   "access_network_type", line);
 				errors++;
 			}
-		} else if (os_strcmp(buf, "internet") == 0) {
-			bss->internet = atoi(pos);
-		} else if (os_strcmp(buf, "asra") == 0) {
-			bss->asra = atoi(pos);
-		} else if (os_strcmp(buf, "esr") == 0) {
-			bss->esr = atoi(pos);
-		} else if (os_strcmp(buf, "uesa") == 0) {
-			bss->uesa = atoi(pos);
 		} else if (os_strcmp(buf, "venue_group") == 0) {
 			bss->venue_group = atoi(pos);
 			bss->venue_info_set = 1;
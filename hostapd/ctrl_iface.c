@@ -844,6 +844,17 @@ static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+	} else if (os_strcmp(buf, "LOG-DUMP") == 0) {
+		reply_len = wpa_debug_ringbuf_dump(0, reply, reply_size);
+	} else if (os_strncmp(buf, "LOG-DUMP ", 9) == 0) {
+		reply_len = wpa_debug_ringbuf_dump(atoi(buf + 9), reply,
+						   reply_size);
+#if defined(CONFIG_WPABUF_POOL) || defined(CONFIG_OS_MALLOC_POOL)
+	} else if (os_strcmp(buf, "POOL-STATS") == 0) {
+		reply_len = os_pool_stats(reply, reply_size);
+#endif /* CONFIG_WPABUF_POOL || CONFIG_OS_MALLOC_POOL */
+	} else if (os_strcmp(buf, "DRIVER-STATS") == 0) {
+		reply_len = hostapd_drv_driver_stats(hapd, reply, reply_size);
 	} else if (os_strcmp(buf, "MIB") == 0) {
 		reply_len = ieee802_11_get_mib(hapd, reply, reply_size);
 		if (reply_len >= 0) {
@@ -41,6 +41,13 @@
  * strings. This is used to simulate an HLR/AuC. As such, it is not very useful
  * for real life authentication, but it is useful both as an example
  * implementation and for EAP-SIM testing.
+ *
+ * With a vector pool size (-p), authentication vectors for Milenage
+ * subscribers are generated ahead of time whenever there are no requests to
+ * process, so that a burst of requests (e.g., during load testing) is served
+ * from the pools without running the algorithms. AKA vectors in the pool use
+ * consecutive SQN values and are always handed out in SQN order; the pool is
+ * discarded on re-synchronization.
  */
 
 #include "includes.h"
@@ -54,30 +61,76 @@ static const char *default_socket_path = "/tmp/hlr_auc_gw.sock";
 static const char *socket_path;
 static int serv_sock = -1;
 
+static int quiet = 0;
+static int pool_size = 0;
+
 /* GSM triplets */
 struct gsm_triplet {
 	struct gsm_triplet *next;
+	struct gsm_triplet *imsi_next; /* next triplet for the same IMSI */
 	char imsi[20];
 	u8 kc[8];
 	u8 sres[4];
 	u8 _rand[16];
 };
 
-static struct gsm_triplet *gsm_db = NULL, *gsm_db_pos = NULL;
+static struct gsm_triplet *gsm_db = NULL;
+
+/* GSM triplets of an IMSI in the order they are used */
+struct gsm_subscriber {
+	struct gsm_subscriber *hnext;
+	char imsi[20];
+	struct gsm_triplet *first, *pos;
+};
+
+static struct gsm_subscriber **gsm_hash = NULL;
+static size_t gsm_hash_size = 0;
+
+/* Pre-generated authentication vectors */
+struct gsm_vector {
+	u8 kc[8];
+	u8 sres[4];
+	u8 _rand[16];
+};
+
+struct aka_vector {
+	u8 _rand[16];
+	u8 autn[16];
+	u8 ik[16];
+	u8 ck[16];
+	u8 res[16];
+	size_t res_len;
+	u8 sqn[6];
+};
 
 /* OPc and AMF parameters for Milenage (Example algorithms for AKA). */
 struct milenage_parameters {
 	struct milenage_parameters *next;
+	struct milenage_parameters *hnext;
+	struct milenage_parameters *refill_next;
+	int refill_queued;
 	char imsi[20];
 	u8 ki[16];
 	u8 opc[16];
 	u8 amf[2];
-	u8 sqn[6];
+	u8 sqn[6]; /* last SQN used in a generated vector */
+
+	/* Ring buffers of pool_size vectors, allocated on first use */
+	struct gsm_vector *gsm_pool;
+	int gsm_first, gsm_count;
+	struct aka_vector *aka_pool;
+	int aka_first, aka_count;
 };
 
 static struct milenage_parameters *milenage_db = NULL;
+static struct milenage_parameters **milenage_hash = NULL;
+static size_t milenage_hash_size = 0;
+
+/* Subscribers whose vector pools need to be refilled */
+static struct milenage_parameters *refill_head = NULL, *refill_tail = NULL;
 
 #define EAP_SIM_MAX_CHAL 3
+#define MAX_TRIPLETS 12
 
 #define EAP_AKA_RAND_LEN 16
 #define EAP_AKA_AUTN_LEN 16
@@ -224,28 +277,100 @@ static int read_gsm_triplets(const char *fname)
 }
 
 
-static struct gsm_triplet * get_gsm_triplet(const char *imsi)
+static u32 hash_imsi(const char *imsi)
 {
-	struct gsm_triplet *g = gsm_db_pos;
+	u32 hash = 2166136261U;
 
-	while (g) {
-		if (strcmp(g->imsi, imsi) == 0) {
-			gsm_db_pos = g->next;
-			return g;
-		}
-		g = g->next;
+	while (*imsi) {
+		hash ^= (u8) *imsi++;
+		hash *= 16777619U;
 	}
 
-	g = gsm_db;
-	while (g && g != gsm_db_pos) {
-		if (strcmp(g->imsi, imsi) == 0) {
-			gsm_db_pos = g->next;
-			return g;
+	return hash;
+}
+
+
+static size_t hash_size(size_t count)
+{
+	size_t size = 16;
+
+	while (size < count)
+		size *= 2;
+	return size;
+}
+
+
+static int build_gsm_hash(void)
+{
+	struct gsm_triplet *g, *prev = NULL;
+	struct gsm_subscriber *s;
+	size_t count = 0, idx;
+
+	for (g = gsm_db; g; g = g->next)
+		count++;
+	gsm_hash_size = hash_size(count);
+	gsm_hash = os_zalloc(gsm_hash_size * sizeof(*gsm_hash));
+	if (gsm_hash == NULL)
+		return -1;
+
+	/*
+	 * gsm_db is in reverse file order; reverse it first so that each
+	 * IMSI uses its triplets in the order they are listed in the file.
+	 */
+	while (gsm_db) {
+		g = gsm_db;
+		gsm_db = g->next;
+		g->next = prev;
+		prev = g;
+	}
+	gsm_db = prev;
+
+	for (g = gsm_db; g; g = g->next) {
+		idx = hash_imsi(g->imsi) & (gsm_hash_size - 1);
+		for (s = gsm_hash[idx]; s; s = s->hnext) {
+			if (strcmp(s->imsi, g->imsi) == 0)
+				break;
+		}
+		if (s == NULL) {
+			s = os_zalloc(sizeof(*s));
+			if (s == NULL)
+				return -1;
+			os_strlcpy(s->imsi, g->imsi, sizeof(s->imsi));
+			s->hnext = gsm_hash[idx];
+			gsm_hash[idx] = s;
+			s->first = s->pos = g;
+		} else {
+			struct gsm_triplet *last = s->first;
+			while (last->imsi_next)
+				last = last->imsi_next;
+			last->imsi_next = g;
 		}
-		g = g->next;
 	}
 
-	return NULL;
+	return 0;
+}
+
+
+static struct gsm_triplet * get_gsm_triplet(const char *imsi)
+{
+	struct gsm_subscriber *s;
+	struct gsm_triplet *g;
+
+	if (gsm_hash == NULL)
+		return NULL;
+
+	for (s = gsm_hash[hash_imsi(imsi) & (gsm_hash_size - 1)]; s;
+	     s = s->hnext) {
+		if (strcmp(s->imsi, imsi) == 0)
+			break;
+	}
+	if (s == NULL)
+		return NULL;
+
+	/* Rotate through the triplets of this IMSI */
+	g = s->pos;
+	s->pos = g->imsi_next ? g->imsi_next : s->first;
+	return g;
 }
 
 
@@ -374,20 +499,147 @@ static int read_milenage(const char *fname)
 }
 
 
+static int build_milenage_hash(void)
+{
+	struct milenage_parameters *m;
+	size_t count = 0, idx;
+
+	for (m = milenage_db; m; m = m->next)
+		count++;
+	milenage_hash_size = hash_size(count);
+	milenage_hash = os_zalloc(milenage_hash_size *
+				  sizeof(*milenage_hash));
+	if (milenage_hash == NULL)
+		return -1;
+
+	for (m = milenage_db; m; m = m->next) {
+		idx = hash_imsi(m->imsi) & (milenage_hash_size - 1);
+		m->hnext = milenage_hash[idx];
+		milenage_hash[idx] = m;
+	}
+
+	return 0;
+}
+
+
 static struct milenage_parameters * get_milenage(const char *imsi)
 {
-	struct milenage_parameters *m = milenage_db;
+	struct milenage_parameters *m;
 
+	if (milenage_hash == NULL)
+		return NULL;
+
+	m = milenage_hash[hash_imsi(imsi) & (milenage_hash_size - 1)];
 	while (m) {
 		if (strcmp(m->imsi, imsi) == 0)
 			break;
-		m = m->next;
+		m = m->hnext;
 	}
 
 	return m;
 }
 
 
+static int gen_gsm_vector(struct milenage_parameters *m,
+			  struct gsm_vector *v)
+{
+	if (random_get_bytes(v->_rand, 16) < 0)
+		return -1;
+	return gsm_milenage(m->opc, m->ki, v->_rand, v->sres, v->kc);
+}
+
+
+static int gen_aka_vector(struct milenage_parameters *m,
+			  struct aka_vector *v)
+{
+	if (random_get_bytes(v->_rand, EAP_AKA_RAND_LEN) < 0)
+		return -1;
+	v->res_len = EAP_AKA_RES_MAX_LEN;
+	inc_byte_array(m->sqn, 6);
+	os_memcpy(v->sqn, m->sqn, 6);
+	milenage_generate(m->opc, m->amf, m->ki, m->sqn, v->_rand,
+			  v->autn, v->ik, v->ck, v->res, &v->res_len);
+	return 0;
+}
+
+
+static void queue_refill(struct milenage_parameters *m)
+{
+	if (pool_size <= 0 || m->refill_queued)
+		return;
+	m->refill_queued = 1;
+	m->refill_next = NULL;
+	if (refill_tail)
+		refill_tail->refill_next = m;
+	else
+		refill_head = m;
+	refill_tail = m;
+}
+
+
+/* Generate one vector for the first subscriber in the refill queue */
+static void refill_pool(void)
+{
+	struct milenage_parameters *m = refill_head;
+	int idx;
+
+	if (m == NULL)
+		return;
+
+	if (m->gsm_pool == NULL)
+		m->gsm_pool = os_zalloc(pool_size * sizeof(*m->gsm_pool));
+	if (m->aka_pool == NULL)
+		m->aka_pool = os_zalloc(pool_size * sizeof(*m->aka_pool));
+
+	if (m->gsm_pool && m->gsm_count < pool_size) {
+		idx = (m->gsm_first + m->gsm_count) % pool_size;
+		if (gen_gsm_vector(m, &m->gsm_pool[idx]) == 0)
+			m->gsm_count++;
+	} else if (m->aka_pool && m->aka_count < pool_size) {
+		idx = (m->aka_first + m->aka_count) % pool_size;
+		if (gen_aka_vector(m, &m->aka_pool[idx]) == 0)
+			m->aka_count++;
+	}
+
+	if ((m->gsm_pool == NULL || m->gsm_count == pool_size) &&
+	    (m->aka_pool == NULL || m->aka_count == pool_size)) {
+		refill_head = m->refill_next;
+		if (refill_head == NULL)
+			refill_tail = NULL;
+		m->refill_queued = 0;
+	}
+}
+
+
+static int get_gsm_vector(struct milenage_parameters *m,
+			  struct gsm_vector *v)
+{
+	queue_refill(m);
+	if (m->gsm_count > 0) {
+		os_memcpy(v, &m->gsm_pool[m->gsm_first], sizeof(*v));
+		m->gsm_first = (m->gsm_first + 1) % pool_size;
+		m->gsm_count--;
+		return 0;
+	}
+	return gen_gsm_vector(m, v);
+}
+
+
+static int get_aka_vector(struct milenage_parameters *m,
+			  struct aka_vector *v)
+{
+	queue_refill(m);
+	if (m->aka_count > 0) {
+		/* Pooled vectors have lower SQN than any new one */
+		os_memcpy(v, &m->aka_pool[m->aka_first], sizeof(*v));
+		m->aka_first = (m->aka_first + 1) % pool_size;
+		m->aka_count--;
+		return 0;
+	}
+	return gen_aka_vector(m, v);
+}
+
+
 static void sim_req_auth(int s, struct sockaddr_un *from, socklen_t fromlen,
 			 char *imsi)
 {
@@ -405,6 +657,8 @@ static void sim_req_auth(int s, struct sockaddr_un *from, socklen_t fromlen,
 		max_chal = atoi(pos);
 		if (max_chal < 1 || max_chal < EAP_SIM_MAX_CHAL)
 			max_chal = EAP_SIM_MAX_CHAL;
+		if (max_chal > MAX_TRIPLETS)
+			max_chal = MAX_TRIPLETS;
 	} else
 		max_chal = EAP_SIM_MAX_CHAL;
 
@@ -417,17 +671,17 @@ static void sim_req_auth(int s, struct sockaddr_un *from, socklen_t fromlen,
 
 	m = get_milenage(imsi);
 	if (m) {
-		u8 _rand[16], sres[4], kc[8];
+		struct gsm_vector v;
 		for (count = 0; count < max_chal; count++) {
-			if (random_get_bytes(_rand, 16) < 0)
+			if (get_gsm_vector(m, &v) < 0)
 				return;
-			gsm_milenage(m->opc, m->ki, _rand, sres, kc);
 			*rpos++ = ' ';
-			rpos += wpa_snprintf_hex(rpos, rend - rpos, kc, 8);
+			rpos += wpa_snprintf_hex(rpos, rend - rpos, v.kc, 8);
 			*rpos++ = ':';
-			rpos += wpa_snprintf_hex(rpos, rend - rpos, sres, 4);
+			rpos += wpa_snprintf_hex(rpos, rend - rpos, v.sres, 4);
 			*rpos++ = ':';
-			rpos += wpa_snprintf_hex(rpos, rend - rpos, _rand, 16);
+			rpos += wpa_snprintf_hex(rpos, rend - rpos, v._rand,
+						 16);
 		}
 		*rpos = '\0';
 		goto send;
@@ -459,7 +713,8 @@ static void sim_req_auth(int s, struct sockaddr_un *from, socklen_t fromlen,
 	}
 
 send:
-	printf("Send: %s\n", reply);
+	if (!quiet)
+		printf("Send: %s\n", reply);
 	if (sendto(s, reply, rpos - reply, 0,
 		   (struct sockaddr *) from, fromlen) < 0)
 		perror("send");
@@ -471,26 +726,21 @@ static void aka_req_auth(int s, struct sockaddr_un *from, socklen_t fromlen,
 {
 	/* AKA-RESP-AUTH <IMSI> <RAND> <AUTN> <IK> <CK> <RES> */
 	char reply[1000], *pos, *end;
-	u8 _rand[EAP_AKA_RAND_LEN];
-	u8 autn[EAP_AKA_AUTN_LEN];
-	u8 ik[EAP_AKA_IK_LEN];
-	u8 ck[EAP_AKA_CK_LEN];
-	u8 res[EAP_AKA_RES_MAX_LEN];
-	size_t res_len;
+	struct aka_vector v;
+	u8 *_rand = v._rand, *autn = v.autn, *ik = v.ik, *ck = v.ck;
+	u8 *res = v.res;
 	int ret;
 	struct milenage_parameters *m;
 
 	m = get_milenage(imsi);
 	if (m) {
-		if (random_get_bytes(_rand, EAP_AKA_RAND_LEN) < 0)
+		if (get_aka_vector(m, &v) < 0)
 			return;
-		res_len = EAP_AKA_RES_MAX_LEN;
-		inc_byte_array(m->sqn, 6);
-		printf("AKA: Milenage with SQN=%02x%02x%02x%02x%02x%02x\n",
-		       m->sqn[0], m->sqn[1], m->sqn[2],
-		       m->sqn[3], m->sqn[4], m->sqn[5]);
-		milenage_generate(m->opc, m->amf, m->ki, m->sqn, _rand,
-				  autn, ik, ck, res, &res_len);
+		if (!quiet)
+			printf("AKA: Milenage with "
+			       "SQN=%02x%02x%02x%02x%02x%02x\n",
+			       v.sqn[0], v.sqn[1], v.sqn[2],
+			       v.sqn[3], v.sqn[4], v.sqn[5]);
 	} else {
 		printf("Unknown IMSI: %s\n", imsi);
 #ifdef AKA_USE_FIXED_TEST_VALUES
@@ -500,7 +750,7 @@ static void aka_req_auth(int s, struct sockaddr_un *from, socklen_t fromlen,
 		memset(ik, '3', EAP_AKA_IK_LEN);
 		memset(ck, '4', EAP_AKA_CK_LEN);
 		memset(res, '2', EAP_AKA_RES_MAX_LEN);
-		res_len = EAP_AKA_RES_MAX_LEN;
+		v.res_len = EAP_AKA_RES_MAX_LEN;
 #else /* AKA_USE_FIXED_TEST_VALUES */
 		return;
 #endif /* AKA_USE_FIXED_TEST_VALUES */
@@ -520,9 +770,10 @@ static void aka_req_auth(int s, struct sockaddr_un *from, socklen_t fromlen,
 	*pos++ = ' ';
 	pos += wpa_snprintf_hex(pos, end - pos, ck, EAP_AKA_CK_LEN);
 	*pos++ = ' ';
-	pos += wpa_snprintf_hex(pos, end - pos, res, res_len);
+	pos += wpa_snprintf_hex(pos, end - pos, res, v.res_len);
 
-	printf("Send: %s\n", reply);
+	if (!quiet)
+		printf("Send: %s\n", reply);
 
 	if (sendto(s, reply, pos - reply, 0, (struct sockaddr *) from,
 		   fromlen) < 0)
@@ -566,6 +817,9 @@ static void aka_auts(int s, struct sockaddr_un *from, socklen_t fromlen,
 		printf("AKA-AUTS: Incorrect MAC-S\n");
 	} else {
 		memcpy(m->sqn, sqn, 6);
+		/* Pooled vectors were generated with the old SQN */
+		m->aka_first = m->aka_count = 0;
+		queue_refill(m);
 		printf("AKA-AUTS: Re-synchronized: "
 		       "SQN=%02x%02x%02x%02x%02x%02x\n",
 		       sqn[0], sqn[1], sqn[2], sqn[3], sqn[4], sqn[5]);
@@ -595,7 +849,8 @@ static int process(int s)
 		res = sizeof(buf) - 1;
 	buf[res] = '\0';
 
-	printf("Received: %s\n", buf);
+	if (!quiet)
+		printf("Received: %s\n", buf);
 
 	if (strncmp(buf, "SIM-REQ-AUTH ", 13) == 0)
 		sim_req_auth(s, &from, fromlen, buf + 13);
@@ -613,7 +868,19 @@ static int process(int s)
 static void cleanup(void)
 {
 	struct gsm_triplet *g, *gprev;
+	struct gsm_subscriber *s, *sprev;
 	struct milenage_parameters *m, *prev;
+	size_t i;
+
+	for (i = 0; i < gsm_hash_size; i++) {
+		s = gsm_hash[i];
+		while (s) {
+			sprev = s;
+			s = s->hnext;
+			free(sprev);
+		}
+	}
+	free(gsm_hash);
 
 	g = gsm_db;
 	while (g) {
@@ -626,8 +893,11 @@ static void cleanup(void)
 	while (m) {
 		prev = m;
 		m = m->next;
+		free(prev->gsm_pool);
+		free(prev->aka_pool);
 		free(prev);
 	}
+	free(milenage_hash);
 
 	close(serv_sock);
 	unlink(socket_path);
@@ -648,15 +918,18 @@ static void usage(void)
 	       "Copyright (c) 2005-2007, Jouni Malinen <j@w1.fi>\n"
 	       "\n"
 	       "usage:\n"
-	       "hlr_auc_gw [-h] [-s<socket path>] [-g<triplet file>] "
-	       "[-m<milenage file>]\n"
+	       "hlr_auc_gw [-hq] [-s<socket path>] [-g<triplet file>] "
+	       "[-m<milenage file>] [-p<pool size>]\n"
 	       "\n"
 	       "options:\n"
 	       "  -h = show this usage help\n"
+	       "  -q = do not print requests and responses\n"
 	       "  -s<socket path> = path for UNIX domain socket\n"
 	       "                    (default: %s)\n"
 	       "  -g<triplet file> = path for GSM authentication triplets\n"
-	       "  -m<milenage file> = path for Milenage keys\n",
+	       "  -m<milenage file> = path for Milenage keys\n"
+	       "  -p<pool size> = number of pre-generated vectors per Milenage\n"
+	       "                  subscriber (default: 0 = no pools)\n",
 	       default_socket_path);
 }
 
@@ -670,7 +943,7 @@ int main(int argc, char *argv[])
 	socket_path = default_socket_path;
 
 	for (;;) {
-		c = getopt(argc, argv, "g:hm:s:");
+		c = getopt(argc, argv, "g:hm:p:qs:");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -683,6 +956,12 @@ int main(int argc, char *argv[])
 		case 'm':
 			milenage_file = optarg;
 			break;
+		case 'p':
+			pool_size = atoi(optarg);
+			break;
+		case 'q':
+			quiet = 1;
+			break;
 		case 's':
 			socket_path = optarg;
 			break;
@@ -692,10 +971,12 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (gsm_triplet_file && read_gsm_triplets(gsm_triplet_file) < 0)
+	if (gsm_triplet_file &&
+	    (read_gsm_triplets(gsm_triplet_file) < 0 || build_gsm_hash() < 0))
 		return -1;
 
-	if (milenage_file && read_milenage(milenage_file) < 0)
+	if (milenage_file &&
+	    (read_milenage(milenage_file) < 0 || build_milenage_hash() < 0))
 		return -1;
 
 	serv_sock = open_socket(socket_path);
@@ -708,8 +989,23 @@ int main(int argc, char *argv[])
 	signal(SIGTERM, handle_term);
 	signal(SIGINT, handle_term);
 
-	for (;;)
+	for (;;) {
+		if (refill_head) {
+			/* Refill vector pools while there are no requests */
+			fd_set rfds;
+			struct timeval tv;
+
+			FD_ZERO(&rfds);
+			FD_SET(serv_sock, &rfds);
+			tv.tv_sec = 0;
+			tv.tv_usec = 0;
+			if (select(serv_sock + 1, &rfds, NULL, NULL, &tv) <= 0) {
+				refill_pool();
+				continue;
+			}
+		}
 		process(serv_sock);
+	}
 
 	return 0;
 }
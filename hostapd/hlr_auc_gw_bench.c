@@ -0,0 +1,249 @@
+/*
+ * Request generator for measuring HLR/AuC gateway performance
+ * Copyright (c) 2026, The hostap project contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Alternatively, this software may be distributed under the terms of BSD
+ * license.
+ *
+ * See README and COPYING for more details.
+ *
+ * This program sends SIM-REQ-AUTH or AKA-REQ-AUTH requests to an HLR/AuC
+ * gateway (e.g., hlr_auc_gw) over the same UNIX domain socket interface that
+ * hostapd uses and reports the rate at which authentication vectors are
+ * received. A number of requests are kept outstanding at a time to simulate
+ * multiple concurrent authentications.
+ */
+
+#include "includes.h"
+#include <sys/un.h>
+
+#include "common.h"
+
+static const char *default_socket_path = "/tmp/hlr_auc_gw.sock";
+
+
+static int open_socket(const char *local, const char *path)
+{
+	struct sockaddr_un addr;
+	int s;
+
+	s = socket(PF_UNIX, SOCK_DGRAM, 0);
+	if (s < 0) {
+		perror("socket(PF_UNIX)");
+		return -1;
+	}
+
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	os_strlcpy(addr.sun_path, local, sizeof(addr.sun_path));
+	if (bind(s, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		perror("bind(PF_UNIX)");
+		close(s);
+		return -1;
+	}
+
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	os_strlcpy(addr.sun_path, path, sizeof(addr.sun_path));
+	if (connect(s, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		perror("connect(PF_UNIX)");
+		close(s);
+		unlink(local);
+		return -1;
+	}
+
+	return s;
+}
+
+
+static int send_request(int s, int aka, const char *imsi, int max_chal)
+{
+	char buf[100];
+	int len;
+
+	if (aka)
+		len = os_snprintf(buf, sizeof(buf), "AKA-REQ-AUTH %s", imsi);
+	else
+		len = os_snprintf(buf, sizeof(buf), "SIM-REQ-AUTH %s %d",
+				  imsi, max_chal);
+	if (len < 0 || (size_t) len >= sizeof(buf))
+		return -1;
+
+	if (send(s, buf, len, 0) < 0) {
+		perror("send");
+		return -1;
+	}
+
+	return 0;
+}
+
+
+/* Returns number of authentication vectors in the response or -1 */
+static int receive_response(int s)
+{
+	char buf[1000], *pos;
+	ssize_t res;
+	int vectors = 0;
+
+	res = recv(s, buf, sizeof(buf) - 1, 0);
+	if (res < 0) {
+		perror("recv");
+		return -1;
+	}
+	buf[res] = '\0';
+
+	if (os_strstr(buf, "FAILURE"))
+		return -1;
+
+	if (os_strncmp(buf, "AKA-RESP-AUTH ", 14) == 0)
+		return 1;
+
+	/* SIM-RESP-AUTH <IMSI> Kc(i):SRES(i):RAND(i) ... */
+	pos = buf;
+	while ((pos = os_strchr(pos, ':')) != NULL) {
+		vectors++;
+		pos++;
+	}
+
+	return vectors / 2;
+}
+
+
+static void usage(void)
+{
+	printf("HLR/AuC gateway request generator\n"
+	       "\n"
+	       "usage:\n"
+	       "hlr_auc_gw_bench [-ah] [-s<socket path>] [-n<requests>] "
+	       "[-w<window>]\n"
+	       "                 [-c<max_chal>] <IMSI> [IMSI..]\n"
+	       "\n"
+	       "options:\n"
+	       "  -a = request AKA authentication vectors instead of GSM "
+	       "triplets\n"
+	       "  -h = show this usage help\n"
+	       "  -s<socket path> = path for the gateway UNIX domain socket\n"
+	       "                    (default: %s)\n"
+	       "  -n<requests> = total number of requests (default: 10000)\n"
+	       "  -w<window> = number of outstanding requests (default: 16)\n"
+	       "  -c<max_chal> = number of triplets per SIM request "
+	       "(default: 3)\n",
+	       default_socket_path);
+}
+
+
+int main(int argc, char *argv[])
+{
+	const char *socket_path = default_socket_path;
+	char local[108];
+	int c, s, aka = 0, max_chal = 3;
+	int requests = 10000, window = 16;
+	int sent = 0, received = 0, failed = 0, lost = 0, outstanding = 0;
+	unsigned int vectors = 0;
+	int num_imsi;
+	char **imsi;
+	struct os_time start, end;
+	double elapsed;
+
+	for (;;) {
+		c = getopt(argc, argv, "ac:hn:s:w:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'a':
+			aka = 1;
+			break;
+		case 'c':
+			max_chal = atoi(optarg);
+			break;
+		case 'h':
+			usage();
+			return 0;
+		case 'n':
+			requests = atoi(optarg);
+			break;
+		case 's':
+			socket_path = optarg;
+			break;
+		case 'w':
+			window = atoi(optarg);
+			break;
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (optind >= argc || requests < 1 || window < 1 || max_chal < 1) {
+		usage();
+		return -1;
+	}
+	imsi = &argv[optind];
+	num_imsi = argc - optind;
+
+	os_snprintf(local, sizeof(local), "/tmp/hlr_auc_gw_bench.%d",
+		    (int) getpid());
+	s = open_socket(local, socket_path);
+	if (s < 0)
+		return -1;
+
+	os_get_time(&start);
+	while (received + failed + lost < requests) {
+		fd_set rfds;
+		struct timeval tv;
+		int res;
+
+		while (outstanding < window && sent < requests) {
+			if (send_request(s, aka, imsi[sent % num_imsi],
+					 max_chal) < 0)
+				goto out;
+			sent++;
+			outstanding++;
+		}
+
+		FD_ZERO(&rfds);
+		FD_SET(s, &rfds);
+		tv.tv_sec = 1;
+		tv.tv_usec = 0;
+		res = select(s + 1, &rfds, NULL, NULL, &tv);
+		if (res < 0) {
+			perror("select");
+			break;
+		}
+		if (res == 0) {
+			/* Consider the outstanding requests lost */
+			lost += outstanding;
+			outstanding = 0;
+			continue;
+		}
+
+		res = receive_response(s);
+		if (res < 0)
+			failed++;
+		else {
+			received++;
+			vectors += res;
+		}
+		if (outstanding > 0)
+			outstanding--;
+	}
+out:
+	os_get_time(&end);
+
+	close(s);
+	unlink(local);
+
+	elapsed = (end.sec - start.sec) + (end.usec - start.usec) / 1000000.0;
+	if (elapsed <= 0)
+		elapsed = 0.000001;
+	printf("%d requests sent, %d responses, %d failures, %d lost\n",
+	       sent, received, failed, lost);
+	printf("%.3f seconds: %.1f requests/s, %.1f vectors/s\n",
+	       elapsed, received / elapsed, vectors / elapsed);
+
+	return 0;
+}
@@ -101,6 +101,9 @@ static const char *commands_help =
 "   wps_config <SSID> <auth> <encr> <key>  configure AP\n"
 #endif /* CONFIG_WPS */
 "   get_config           show current configuration\n"
+"   log_dump [skip]      show messages from the debug ring buffer\n"
+"   pool_stats           show memory pool statistics\n"
+"   driver_stats         show driver interface statistics\n"
 "   help                 show this usage help\n"
 "   interface [ifname]   show interfaces/select interface\n"
 "   level <debug level>  change debug level\n"
@@ -230,6 +233,32 @@ static int hostapd_cli_cmd_relog(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int hostapd_cli_cmd_log_dump(struct wpa_ctrl *ctrl, int argc,
+				    char *argv[])
+{
+	char buf[64];
+
+	if (argc < 1)
+		return wpa_ctrl_command(ctrl, "LOG-DUMP");
+	os_snprintf(buf, sizeof(buf), "LOG-DUMP %s", argv[0]);
+	return wpa_ctrl_command(ctrl, buf);
+}
+
+
+static int hostapd_cli_cmd_pool_stats(struct wpa_ctrl *ctrl, int argc,
+				      char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "POOL-STATS");
+}
+
+
+static int hostapd_cli_cmd_driver_stats(struct wpa_ctrl *ctrl, int argc,
+					char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "DRIVER-STATS");
+}
+
+
 static int hostapd_cli_cmd_mib(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	return wpa_ctrl_command(ctrl, "MIB");
@@ -730,6 +759,9 @@ static struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	{ "ping", hostapd_cli_cmd_ping },
 	{ "mib", hostapd_cli_cmd_mib },
 	{ "relog", hostapd_cli_cmd_relog },
+	{ "log_dump", hostapd_cli_cmd_log_dump },
+	{ "pool_stats", hostapd_cli_cmd_pool_stats },
+	{ "driver_stats", hostapd_cli_cmd_driver_stats },
 	{ "sta", hostapd_cli_cmd_sta },
 	{ "all_sta", hostapd_cli_cmd_all_sta },
 	{ "new_sta", hostapd_cli_cmd_new_sta },
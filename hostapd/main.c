@@ -522,6 +522,9 @@ static void usage(void)
 	fprintf(stderr,
 		"\n"
 		"usage: hostapd [-hdBKtv] [-P <PID file>] [-e <entropy file>] "
+#ifdef CONFIG_DEBUG_RINGBUF
+		"[-r <records>] "
+#endif /* CONFIG_DEBUG_RINGBUF */
 		"<configuration file(s)>\n"
 		"\n"
 		"options:\n"
@@ -534,6 +537,10 @@ static void usage(void)
 #ifdef CONFIG_DEBUG_FILE
 		"   -f   log output to debug file instead of stdout\n"
 #endif /* CONFIG_DEBUG_FILE */
+#ifdef CONFIG_DEBUG_RINGBUF
+		"   -r   keep debug messages in a memory ring buffer of "
+		"<records> entries\n"
+#endif /* CONFIG_DEBUG_RINGBUF */
 		"   -t   include timestamps in some debug messages\n"
 		"   -v   show hostapd version\n");
 
@@ -559,12 +566,13 @@ int main(int argc, char *argv[])
 	char *pid_file = NULL;
 	const char *log_file = NULL;
 	const char *entropy_file = NULL;
+	int ringbuf_records = 0;
 
 	if (os_program_init())
 		return -1;
 
 	for (;;) {
-		c = getopt(argc, argv, "Bde:f:hKP:tv");
+		c = getopt(argc, argv, "Bde:f:hKP:r:tv");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -592,6 +600,11 @@ int main(int argc, char *argv[])
 			os_free(pid_file);
 			pid_file = os_rel2abs_path(optarg);
 			break;
+#ifdef CONFIG_DEBUG_RINGBUF
+		case 'r':
+			ringbuf_records = atoi(optarg);
+			break;
+#endif /* CONFIG_DEBUG_RINGBUF */
 		case 't':
 			wpa_debug_timestamp++;
 			break;
@@ -613,6 +626,11 @@ int main(int argc, char *argv[])
 
 	if (log_file)
 		wpa_debug_open_file(log_file);
+	if (ringbuf_records &&
+	    wpa_debug_ringbuf_init(ringbuf_records,
+				   wpa_debug_level < MSG_DEBUG ?
+				   wpa_debug_level : MSG_DEBUG) < 0)
+		wpa_printf(MSG_ERROR, "Failed to initialize debug ring buffer");
 
 	interfaces.count = argc - optind;
 	interfaces.iface = os_zalloc(interfaces.count *
@@ -650,6 +668,7 @@ int main(int argc, char *argv[])
 
 	if (log_file)
 		wpa_debug_close_file();
+	wpa_debug_ringbuf_deinit();
 
 	os_program_deinit();
 
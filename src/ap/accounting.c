@@ -16,6 +16,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/list.h"
 #include "drivers/driver.h"
 #include "radius/radius.h"
 #include "radius/radius_client.h"
@@ -32,6 +33,62 @@
  * input/output octets and updates Acct-{Input,Output}-Gigawords. */
 #define ACCT_DEFAULT_UPDATE_INTERVAL 300
 
+/* Interim update timers are aligned to multiples of this many seconds so that
+ * stations whose updates are due at about the same time share a single bulk
+ * statistics fetch from the driver. */
+#define ACCT_INTERIM_BUCKET 5
+
+/* The first interim update of a session is sent up to 1/ACCT_INTERIM_JITTER of
+ * the interval early to spread out stations that associated at the same
+ * time, e.g., after an AP restart. */
+#define ACCT_INTERIM_JITTER 10
+
+/* Spool record header: event time (u32) and message length (u16) */
+#define ACCT_SPOOL_HDR_LEN 6
+
+struct accounting_spool_entry {
+	struct dl_list list;
+	os_time_t event_time;
+	struct wpabuf *buf;
+	struct radius_msg *msg; /* replayed request waiting for a response */
+};
+
+/*
+ * Accounting requests that the RADIUS client gave up on are appended to the
+ * spool file (hostapd_bss_config::acct_spool_file). Once the accounting
+ * server responds again, the spooled records are read back into the replay
+ * list and sent at most acct_spool_replay_rate messages per second.
+ *
+ * This includes requests that were transmitted, but not acknowledged, e.g.,
+ * Accounting-Stop messages sent just before hostapd is stopped. The server
+ * may have received such a request, so a replay can be a duplicate. Replayed
+ * requests are therefore marked as resends the way RFC 2866 expects: they
+ * keep the original Acct-Session-Id and attributes, get a new Identifier,
+ * and Acct-Delay-Time is always increased from the value in the spooled
+ * request. This allows the server to detect duplicates while a request that
+ * was lost is not dropped.
+ *
+ * The spool file is not modified while its records are being replayed other
+ * than by appending new records. A record is removed only after an
+ * Accounting-Response to its replay has been received; the remaining records
+ * are then written to a temporary file that is renamed over the spool file.
+ * Records that are not acknowledged stay in the file, so a crash or restart
+ * during the replay does not lose them.
+ */
+struct accounting_spool {
+	size_t size; /* current size of the spool file in octets */
+	size_t replay_size; /* octets at the beginning of the spool file that
+			     * were read into the replay lists */
+	unsigned int spooled;
+	unsigned int replayed;
+	unsigned int dropped;
+	unsigned int pending; /* replayed requests waiting for a response */
+	int removed; /* records removed from the replay lists since the file
+		      * was last written */
+	struct dl_list replay; /* struct accounting_spool_entry; not yet sent */
+	struct dl_list sent; /* struct accounting_spool_entry; sent */
+};
+
 static void accounting_sta_get_id(struct hostapd_data *hapd,
 				  struct sta_info *sta);
 
@@ -185,9 +242,10 @@ static struct radius_msg * accounting_msg(struct hostapd_data *hapd,
 
 static int accounting_sta_update_stats(struct hostapd_data *hapd,
 				       struct sta_info *sta,
-				       struct hostap_sta_driver_data *data)
+				       struct hostap_sta_driver_data *data,
+				       int fresh)
 {
-	if (hostapd_drv_read_sta_data(hapd, data, sta->addr))
+	if (ap_sta_read_data(hapd, sta, data, fresh))
 		return -1;
 
 	if (sta->last_rx_bytes > data->rx_bytes)
@@ -208,6 +266,30 @@ static int accounting_sta_update_stats(struct hostapd_data *hapd,
 }
 
 
+static void accounting_interim_update(void *eloop_ctx, void *timeout_ctx);
+
+
+static void accounting_interim_register(struct hostapd_data *hapd,
+					struct sta_info *sta, int interval)
+{
+	struct os_time now;
+	os_time_t due;
+	unsigned int sec, usec;
+
+	os_get_time(&now);
+	due = now.sec + interval;
+	due += ACCT_INTERIM_BUCKET - due % ACCT_INTERIM_BUCKET;
+	sec = due - now.sec;
+	usec = 0;
+	if (now.usec) {
+		sec--;
+		usec = 1000000 - now.usec;
+	}
+
+	eloop_register_timeout(sec, usec, accounting_interim_update, hapd, sta);
+}
+
+
 static void accounting_interim_update(void *eloop_ctx, void *timeout_ctx)
 {
 	struct hostapd_data *hapd = eloop_ctx;
@@ -219,12 +301,11 @@ static void accounting_interim_update(void *eloop_ctx, void *timeout_ctx)
 		interval = sta->acct_interim_interval;
 	} else {
 		struct hostap_sta_driver_data data;
-		accounting_sta_update_stats(hapd, sta, &data);
+		accounting_sta_update_stats(hapd, sta, &data, 0);
 		interval = ACCT_DEFAULT_UPDATE_INTERVAL;
 	}
 
-	eloop_register_timeout(interval, 0, accounting_interim_update,
-			       hapd, sta);
+	accounting_interim_register(hapd, sta, interval);
 }
 
 
@@ -261,8 +342,8 @@ void accounting_sta_start(struct hostapd_data *hapd, struct sta_info *sta)
 		interval = sta->acct_interim_interval;
 	else
 		interval = ACCT_DEFAULT_UPDATE_INTERVAL;
-	eloop_register_timeout(interval, 0, accounting_interim_update,
-			       hapd, sta);
+	interval -= os_random() % (interval / ACCT_INTERIM_JITTER + 1);
+	accounting_interim_register(hapd, sta, interval);
 
 	msg = accounting_msg(hapd, sta, RADIUS_ACCT_STATUS_TYPE_START);
 	if (msg)
@@ -299,7 +380,8 @@ static void accounting_sta_report(struct hostapd_data *hapd,
 		goto fail;
 	}
 
-	if (accounting_sta_update_stats(hapd, sta, &data) == 0) {
+	/* Use up-to-date counters for the final report of the session */
+	if (accounting_sta_update_stats(hapd, sta, &data, stop) == 0) {
 		if (!radius_msg_add_attr_int32(msg,
 					       RADIUS_ATTR_ACCT_INPUT_PACKETS,
 					       data.rx_packets)) {
@@ -417,6 +499,424 @@ static void accounting_sta_get_id(struct hostapd_data *hapd,
 }
 
 
+static int accounting_spool_write(struct hostapd_data *hapd,
+				  os_time_t event_time, const u8 *data,
+				  size_t len)
+{
+	struct accounting_spool *spool = hapd->acct_spool;
+	const char *fname = hapd->conf->acct_spool_file;
+	u8 hdr[ACCT_SPOOL_HDR_LEN];
+	FILE *f;
+	int ret = 0;
+
+	if (len > 0xffff ||
+	    spool->size + ACCT_SPOOL_HDR_LEN + len >
+	    (size_t) hapd->conf->acct_spool_max_size) {
+		wpa_printf(MSG_INFO, "Accounting spool %s full - dropping "
+			   "record", fname);
+		spool->dropped++;
+		return -1;
+	}
+
+	f = fopen(fname, "ab");
+	if (f == NULL) {
+		wpa_printf(MSG_ERROR, "Could not open accounting spool %s: %s",
+			   fname, strerror(errno));
+		spool->dropped++;
+		return -1;
+	}
+
+	WPA_PUT_BE32(hdr, event_time);
+	WPA_PUT_BE16(hdr + 4, len);
+	if (fwrite(hdr, ACCT_SPOOL_HDR_LEN, 1, f) != 1 ||
+	    fwrite(data, len, 1, f) != 1) {
+		wpa_printf(MSG_ERROR, "Could not write to accounting spool "
+			   "%s", fname);
+		spool->dropped++;
+		ret = -1;
+	}
+	if (fclose(f) != 0)
+		ret = -1;
+	if (ret == 0) {
+		spool->size += ACCT_SPOOL_HDR_LEN + len;
+		spool->spooled++;
+	}
+
+	return ret;
+}
+
+
+static void accounting_spool_entry_free(struct accounting_spool_entry *entry)
+{
+	dl_list_del(&entry->list);
+	wpabuf_free(entry->buf);
+	os_free(entry);
+}
+
+
+static struct accounting_spool_entry *
+accounting_spool_find(struct accounting_spool *spool, struct radius_msg *msg)
+{
+	struct accounting_spool_entry *entry;
+
+	if (spool == NULL)
+		return NULL;
+
+	dl_list_for_each(entry, &spool->sent, struct accounting_spool_entry,
+			 list) {
+		if (entry->msg == msg)
+			return entry;
+	}
+
+	return NULL;
+}
+
+
+static int accounting_spool_write_entries(FILE *f, struct dl_list *list,
+					  size_t *len)
+{
+	struct accounting_spool_entry *entry;
+	u8 hdr[ACCT_SPOOL_HDR_LEN];
+
+	dl_list_for_each(entry, list, struct accounting_spool_entry, list) {
+		WPA_PUT_BE32(hdr, entry->event_time);
+		WPA_PUT_BE16(hdr + 4, wpabuf_len(entry->buf));
+		if (fwrite(hdr, ACCT_SPOOL_HDR_LEN, 1, f) != 1 ||
+		    fwrite(wpabuf_head(entry->buf), wpabuf_len(entry->buf), 1,
+			   f) != 1)
+			return -1;
+		*len += ACCT_SPOOL_HDR_LEN + wpabuf_len(entry->buf);
+	}
+
+	return 0;
+}
+
+
+/*
+ * Replace the records that were read for replay with the ones that have not
+ * been acknowledged. Records appended to the spool file after it was read are
+ * copied as-is.
+ */
+static void accounting_spool_rewrite(struct hostapd_data *hapd)
+{
+	struct accounting_spool *spool = hapd->acct_spool;
+	const char *fname = hapd->conf->acct_spool_file;
+	char *tmp;
+	size_t tmp_len, len = 0, tail = 0, res;
+	FILE *f, *in;
+	u8 buf[1024];
+	int ret = 0;
+
+	tmp_len = os_strlen(fname) + 5;
+	tmp = os_malloc(tmp_len);
+	if (tmp == NULL)
+		return;
+	os_snprintf(tmp, tmp_len, "%s.tmp", fname);
+
+	f = fopen(tmp, "wb");
+	if (f == NULL) {
+		wpa_printf(MSG_ERROR, "Could not open accounting spool %s: %s",
+			   tmp, strerror(errno));
+		os_free(tmp);
+		return;
+	}
+
+	if (accounting_spool_write_entries(f, &spool->sent, &len) ||
+	    accounting_spool_write_entries(f, &spool->replay, &len))
+		ret = -1;
+
+	in = fopen(fname, "rb");
+	if (ret == 0 && in) {
+		if (fseek(in, spool->replay_size, SEEK_SET) != 0)
+			ret = -1;
+		while (ret == 0 && (res = fread(buf, 1, sizeof(buf), in)) > 0) {
+			if (fwrite(buf, res, 1, f) != 1)
+				ret = -1;
+			tail += res;
+		}
+	}
+	if (in)
+		fclose(in);
+	if (fclose(f) != 0)
+		ret = -1;
+
+	if (ret == 0 && rename(tmp, fname) == 0) {
+		spool->size = len + tail;
+		spool->replay_size = len;
+		spool->removed = 0;
+	} else {
+		wpa_printf(MSG_ERROR, "Could not update accounting spool %s",
+			   fname);
+		unlink(tmp);
+	}
+	os_free(tmp);
+}
+
+
+/* Complete the replay round once all records have been sent and resolved */
+static void accounting_spool_replay_check(struct hostapd_data *hapd)
+{
+	struct accounting_spool *spool = hapd->acct_spool;
+	struct accounting_spool_entry *entry, *n;
+
+	if (!dl_list_empty(&spool->replay) || spool->pending ||
+	    (dl_list_empty(&spool->sent) && !spool->removed))
+		return;
+
+	if (spool->removed)
+		accounting_spool_rewrite(hapd);
+
+	/* Records without a response stay in the file for the next round */
+	dl_list_for_each_safe(entry, n, &spool->sent,
+			      struct accounting_spool_entry, list)
+		accounting_spool_entry_free(entry);
+	spool->replay_size = 0;
+
+	wpa_printf(MSG_DEBUG, "Accounting: spool replay completed");
+}
+
+
+static void accounting_spool_drop(void *ctx, struct radius_msg *msg,
+				  RadiusType msg_type, os_time_t first_try)
+{
+	struct hostapd_data *hapd = ctx;
+	struct accounting_spool_entry *entry;
+	struct wpabuf *buf;
+	u32 status_type, delay;
+
+	if (msg_type != RADIUS_ACCT && msg_type != RADIUS_ACCT_INTERIM)
+		return;
+
+	entry = accounting_spool_find(hapd->acct_spool, msg);
+	if (entry) {
+		/* The record is still in the spool file */
+		entry->msg = NULL;
+		hapd->acct_spool->pending--;
+		accounting_spool_replay_check(hapd);
+		return;
+	}
+
+	/* Accounting-On/Off are only meaningful when they are sent */
+	if (radius_msg_get_attr_int32(msg, RADIUS_ATTR_ACCT_STATUS_TYPE,
+				      &status_type) ||
+	    (status_type != RADIUS_ACCT_STATUS_TYPE_START &&
+	     status_type != RADIUS_ACCT_STATUS_TYPE_STOP &&
+	     status_type != RADIUS_ACCT_STATUS_TYPE_INTERIM_UPDATE))
+		return;
+
+	/* A replayed record already tells how old the event is */
+	if (radius_msg_get_attr_int32(msg, RADIUS_ATTR_ACCT_DELAY_TIME,
+				      &delay) == 0)
+		first_try -= delay;
+
+	buf = radius_msg_get_buf(msg);
+	if (accounting_spool_write(hapd, first_try, wpabuf_head(buf),
+				   wpabuf_len(buf)) == 0)
+		wpa_printf(MSG_DEBUG, "Accounting: spooled unacknowledged "
+			   "request (Acct-Status-Type %u)", status_type);
+}
+
+
+static void accounting_spool_replay_timer(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+	struct accounting_spool *spool = hapd->acct_spool;
+	struct accounting_spool_entry *entry;
+	struct radius_msg *msg;
+	struct os_time now;
+	u8 *pos;
+	size_t len;
+	u32 delay, prev_delay;
+	int count;
+
+	/* Drop acknowledged records from the file at most once per second */
+	if (spool->removed)
+		accounting_spool_rewrite(hapd);
+
+	os_get_time(&now);
+	for (count = 0; count < hapd->conf->acct_spool_replay_rate; count++) {
+		entry = dl_list_first(&spool->replay,
+				      struct accounting_spool_entry, list);
+		if (entry == NULL)
+			break;
+
+		msg = radius_msg_parse(wpabuf_head(entry->buf),
+				       wpabuf_len(entry->buf));
+		if (msg == NULL) {
+			wpa_printf(MSG_INFO, "Accounting: invalid record in "
+				   "spool - dropped");
+			spool->dropped++;
+			accounting_spool_entry_free(entry);
+			spool->removed++;
+			continue;
+		}
+
+		delay = now.sec > entry->event_time ?
+			now.sec - entry->event_time : 0;
+		if (radius_msg_get_attr_ptr(msg, RADIUS_ATTR_ACCT_DELAY_TIME,
+					    &pos, &len, NULL) == 0 &&
+		    len == 4) {
+			/* Make sure a resend differs from the original */
+			prev_delay = WPA_GET_BE32(pos);
+			if (delay <= prev_delay)
+				delay = prev_delay + 1;
+			WPA_PUT_BE32(pos, delay);
+		} else if (!radius_msg_add_attr_int32(
+				   msg, RADIUS_ATTR_ACCT_DELAY_TIME,
+				   delay ? delay : 1)) {
+			/* Keep the record for the next replay round */
+			radius_msg_free(msg);
+			dl_list_del(&entry->list);
+			dl_list_add_tail(&spool->sent, &entry->list);
+			continue;
+		}
+		radius_msg_get_hdr(msg)->identifier =
+			radius_client_get_id(hapd->radius);
+
+		dl_list_del(&entry->list);
+		dl_list_add_tail(&spool->sent, &entry->list);
+		entry->msg = msg;
+		spool->pending++;
+		spool->replayed++;
+		radius_client_send(hapd->radius, msg, RADIUS_ACCT, NULL);
+	}
+
+	if (!dl_list_empty(&spool->replay))
+		eloop_register_timeout(1, 0, accounting_spool_replay_timer,
+				       hapd, NULL);
+	else
+		accounting_spool_replay_check(hapd);
+}
+
+
+static void accounting_spool_replay_start(struct hostapd_data *hapd)
+{
+	struct accounting_spool *spool = hapd->acct_spool;
+	const char *fname;
+	struct accounting_spool_entry *entry;
+	u8 hdr[ACCT_SPOOL_HDR_LEN];
+	size_t len;
+	FILE *f;
+	unsigned int count = 0;
+
+	if (spool == NULL || spool->size == 0 ||
+	    !dl_list_empty(&spool->replay) || !dl_list_empty(&spool->sent))
+		return;
+
+	fname = hapd->conf->acct_spool_file;
+	f = fopen(fname, "rb");
+	if (f == NULL) {
+		spool->size = 0;
+		return;
+	}
+
+	while (fread(hdr, ACCT_SPOOL_HDR_LEN, 1, f) == 1) {
+		len = WPA_GET_BE16(hdr + 4);
+		entry = os_zalloc(sizeof(*entry));
+		if (entry == NULL)
+			break;
+		entry->event_time = WPA_GET_BE32(hdr);
+		entry->buf = wpabuf_alloc(len);
+		if (entry->buf == NULL ||
+		    fread(wpabuf_put(entry->buf, len), len, 1, f) != 1) {
+			wpa_printf(MSG_INFO, "Accounting: truncated record in "
+				   "spool %s", fname);
+			wpabuf_free(entry->buf);
+			os_free(entry);
+			break;
+		}
+		dl_list_add_tail(&spool->replay, &entry->list);
+		count++;
+	}
+	/* A truncated record at the end is dropped when the file is updated */
+	if (fseek(f, 0, SEEK_END) == 0 && ftell(f) > 0)
+		spool->replay_size = ftell(f);
+	else
+		spool->replay_size = spool->size;
+	fclose(f);
+
+	if (count == 0) {
+		accounting_spool_rewrite(hapd);
+		return;
+	}
+
+	wpa_printf(MSG_INFO, "Accounting: replaying %u spooled record(s) from "
+		   "%s", count, fname);
+	eloop_cancel_timeout(accounting_spool_replay_timer, hapd, NULL);
+	eloop_register_timeout(0, 0, accounting_spool_replay_timer, hapd,
+			       NULL);
+}
+
+
+static int accounting_spool_init(struct hostapd_data *hapd)
+{
+	struct accounting_spool *spool;
+	FILE *f;
+	long size;
+
+	if (hapd->conf->acct_spool_file == NULL)
+		return 0;
+
+	spool = os_zalloc(sizeof(*spool));
+	if (spool == NULL)
+		return -1;
+	dl_list_init(&spool->replay);
+	dl_list_init(&spool->sent);
+
+	f = fopen(hapd->conf->acct_spool_file, "rb");
+	if (f) {
+		if (fseek(f, 0, SEEK_END) == 0) {
+			size = ftell(f);
+			if (size > 0)
+				spool->size = size;
+		}
+		fclose(f);
+	}
+
+	hapd->acct_spool = spool;
+	radius_client_set_drop_cb(hapd->radius, accounting_spool_drop, hapd);
+	if (spool->size)
+		wpa_printf(MSG_INFO, "Accounting: %lu octets of spooled "
+			   "records in %s", (unsigned long) spool->size,
+			   hapd->conf->acct_spool_file);
+
+	return 0;
+}
+
+
+static void accounting_spool_deinit(struct hostapd_data *hapd)
+{
+	struct accounting_spool *spool = hapd->acct_spool;
+	struct accounting_spool_entry *entry, *n;
+
+	if (spool == NULL)
+		return;
+
+	eloop_cancel_timeout(accounting_spool_replay_timer, hapd, NULL);
+
+	/*
+	 * Spool requests that are still waiting for a response. Replayed
+	 * records are already in the spool file, so only the acknowledged ones
+	 * need to be removed from it.
+	 */
+	radius_client_flush_acct(hapd->radius);
+	radius_client_set_drop_cb(hapd->radius, NULL, NULL);
+	dl_list_for_each_safe(entry, n, &spool->replay,
+			      struct accounting_spool_entry, list) {
+		dl_list_del(&entry->list);
+		dl_list_add_tail(&spool->sent, &entry->list);
+	}
+	spool->pending = 0;
+	accounting_spool_replay_check(hapd);
+
+	wpa_printf(MSG_DEBUG, "Accounting: spool %s: %u spooled, %u replayed, "
+		   "%u dropped", hapd->conf->acct_spool_file, spool->spooled,
+		   spool->replayed, spool->dropped);
+	os_free(spool);
+	hapd->acct_spool = NULL;
+}
+
+
 /**
  * accounting_receive - Process the RADIUS frames from Accounting Server
  * @msg: RADIUS response message
@@ -431,6 +931,9 @@ accounting_receive(struct radius_msg *msg, struct radius_msg *req,
 		   const u8 *shared_secret, size_t shared_secret_len,
 		   void *data)
 {
+	struct hostapd_data *hapd = data;
+	struct accounting_spool_entry *entry;
+
 	if (radius_msg_get_hdr(msg)->code != RADIUS_CODE_ACCOUNTING_RESPONSE) {
 		printf("Unknown RADIUS message code\n");
 		return RADIUS_RX_UNKNOWN;
@@ -442,6 +945,17 @@ accounting_receive(struct radius_msg *msg, struct radius_msg *req,
 		return RADIUS_RX_INVALID_AUTHENTICATOR;
 	}
 
+	entry = accounting_spool_find(hapd->acct_spool, req);
+	if (entry) {
+		accounting_spool_entry_free(entry);
+		hapd->acct_spool->pending--;
+		hapd->acct_spool->removed++;
+		accounting_spool_replay_check(hapd);
+	} else {
+		/* Accounting server is reachable; send any spooled records */
+		accounting_spool_replay_start(hapd);
+	}
+
 	return RADIUS_RX_PROCESSED;
 }
 
@@ -491,6 +1005,9 @@ int accounting_init(struct hostapd_data *hapd)
 				   accounting_receive, hapd))
 		return -1;
 
+	if (accounting_spool_init(hapd))
+		return -1;
+
 	accounting_report_state(hapd, 1);
 
 	return 0;
@@ -504,4 +1021,5 @@ int accounting_init(struct hostapd_data *hapd)
 void accounting_deinit(struct hostapd_data *hapd)
 {
 	accounting_report_state(hapd, 0);
+	accounting_spool_deinit(hapd);
 }
@@ -69,6 +69,8 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 	bss->dtim_period = 2;
 
 	bss->radius_server_auth_port = 1812;
+	bss->acct_spool_max_size = 1024 * 1024;
+	bss->acct_spool_replay_rate = 10;
 	bss->ap_max_inactivity = AP_MAX_INACTIVITY;
 	bss->eapol_version = EAPOL_VERSION;
 
@@ -330,6 +332,218 @@ int hostapd_wep_key_cmp(struct hostapd_wep_keys *a, struct hostapd_wep_keys *b)
 }
 
 
+static int hostapd_str_cmp(const char *a, const char *b)
+{
+	if (a == NULL || b == NULL)
+		return a != b;
+	return os_strcmp(a, b) != 0;
+}
+
+
+static int hostapd_maclist_cmp(const struct mac_acl_entry *a, int num_a,
+			       const struct mac_acl_entry *b, int num_b)
+{
+	if (num_a != num_b)
+		return 1;
+	if (num_a == 0)
+		return 0;
+	return os_memcmp(a, b, num_a * sizeof(*a)) != 0;
+}
+
+
+static int hostapd_wpa_psk_cmp(const struct hostapd_wpa_psk *a,
+			       const struct hostapd_wpa_psk *b)
+{
+	while (a && b) {
+		if (a->group != b->group ||
+		    os_memcmp(a->psk, b->psk, PMK_LEN) != 0 ||
+		    os_memcmp(a->addr, b->addr, ETH_ALEN) != 0)
+			return 1;
+		a = a->next;
+		b = b->next;
+	}
+	return a != b;
+}
+
+
+static int hostapd_eap_user_cmp(const struct hostapd_eap_user *a,
+				const struct hostapd_eap_user *b)
+{
+	while (a && b) {
+		if (a->identity_len != b->identity_len ||
+		    (a->identity_len &&
+		     os_memcmp(a->identity, b->identity, a->identity_len)) ||
+		    a->password_len != b->password_len ||
+		    (a->password_len &&
+		     os_memcmp(a->password, b->password, a->password_len)) ||
+		    os_memcmp(a->methods, b->methods, sizeof(a->methods)) ||
+		    a->phase2 != b->phase2 ||
+		    a->force_version != b->force_version ||
+		    a->wildcard_prefix != b->wildcard_prefix ||
+		    a->password_hash != b->password_hash ||
+		    a->ttls_auth != b->ttls_auth)
+			return 1;
+		a = a->next;
+		b = b->next;
+	}
+	return a != b;
+}
+
+
+static int hostapd_radius_server_cmp(struct hostapd_radius_server *a,
+				     int num_a,
+				     struct hostapd_radius_server *b,
+				     int num_b)
+{
+	int i;
+
+	if (num_a != num_b)
+		return 1;
+	for (i = 0; i < num_a; i++) {
+		if (hostapd_ip_diff(&a[i].addr, &b[i].addr) ||
+		    a[i].port != b[i].port ||
+		    a[i].shared_secret_len != b[i].shared_secret_len ||
+		    os_memcmp(a[i].shared_secret, b[i].shared_secret,
+			      a[i].shared_secret_len) != 0)
+			return 1;
+	}
+	return 0;
+}
+
+
+#ifdef CONFIG_IEEE80211R
+static int hostapd_r0kh_cmp(struct ft_remote_r0kh *a, struct ft_remote_r0kh *b)
+{
+	while (a && b) {
+		if (os_memcmp(a->addr, b->addr, ETH_ALEN) != 0 ||
+		    a->id_len != b->id_len ||
+		    os_memcmp(a->id, b->id, a->id_len) != 0 ||
+		    os_memcmp(a->key, b->key, sizeof(a->key)) != 0)
+			return 1;
+		a = a->next;
+		b = b->next;
+	}
+	return a != b;
+}
+
+
+static int hostapd_r1kh_cmp(struct ft_remote_r1kh *a, struct ft_remote_r1kh *b)
+{
+	while (a && b) {
+		if (os_memcmp(a->addr, b->addr, ETH_ALEN) != 0 ||
+		    os_memcmp(a->id, b->id, FT_R1KH_ID_LEN) != 0 ||
+		    os_memcmp(a->key, b->key, sizeof(a->key)) != 0)
+			return 1;
+		a = a->next;
+		b = b->next;
+	}
+	return a != b;
+}
+#endif /* CONFIG_IEEE80211R */
+
+
+/**
+ * hostapd_bss_config_sta_cmp - Compare BSS configuration for associated STAs
+ * @a: Old BSS configuration
+ * @b: New BSS configuration (PSK list must already be set up with
+ *	hostapd_setup_wpa_psk())
+ * Returns: 0 if the configuration items that control which stations are
+ * allowed to use the BSS and how they are authenticated are identical, 1 if
+ * existing associations must be dropped
+ *
+ * This is used on configuration reload to keep the stations of BSSes whose
+ * security configuration did not change. Changes in the authentication
+ * servers and FT key holder configuration drop the associations since the
+ * keys of the existing stations came from the old servers or key holders.
+ * Accounting servers are not compared: accounting for the stations that are
+ * kept continues with the new servers.
+ */
+int hostapd_bss_config_sta_cmp(struct hostapd_bss_config *a,
+			       struct hostapd_bss_config *b)
+{
+	if (os_strcmp(a->iface, b->iface) != 0 ||
+	    os_strcmp(a->bridge, b->bridge) != 0 ||
+	    a->ssid.ssid_len != b->ssid.ssid_len ||
+	    os_memcmp(a->ssid.ssid, b->ssid.ssid, a->ssid.ssid_len) != 0 ||
+	    a->ssid.security_policy != b->ssid.security_policy ||
+	    a->ssid.dynamic_vlan != b->ssid.dynamic_vlan ||
+	    hostapd_str_cmp(a->ssid.wpa_passphrase, b->ssid.wpa_passphrase) ||
+	    hostapd_wpa_psk_cmp(a->ssid.wpa_psk, b->ssid.wpa_psk) ||
+	    hostapd_wep_key_cmp(&a->ssid.wep, &b->ssid.wep))
+		return 1;
+
+	if (a->ieee802_1x != b->ieee802_1x ||
+	    a->eapol_version != b->eapol_version ||
+	    a->eap_server != b->eap_server ||
+	    hostapd_eap_user_cmp(a->eap_user, b->eap_user) ||
+	    a->default_wep_key_len != b->default_wep_key_len ||
+	    a->individual_wep_key_len != b->individual_wep_key_len ||
+	    a->auth_algs != b->auth_algs ||
+	    a->wpa != b->wpa ||
+	    a->wpa_key_mgmt != b->wpa_key_mgmt ||
+	    a->wpa_pairwise != b->wpa_pairwise ||
+	    a->wpa_group != b->wpa_group ||
+	    a->rsn_pairwise != b->rsn_pairwise ||
+	    a->wps_state != b->wps_state)
+		return 1;
+
+#ifdef CONFIG_IEEE80211W
+	if (a->ieee80211w != b->ieee80211w)
+		return 1;
+#endif /* CONFIG_IEEE80211W */
+
+	if (a->macaddr_acl != b->macaddr_acl ||
+	    hostapd_maclist_cmp(a->accept_mac, a->num_accept_mac,
+				b->accept_mac, b->num_accept_mac) ||
+	    hostapd_maclist_cmp(a->deny_mac, a->num_deny_mac,
+				b->deny_mac, b->num_deny_mac))
+		return 1;
+
+	if (hostapd_radius_server_cmp(a->radius->auth_servers,
+				      a->radius->num_auth_servers,
+				      b->radius->auth_servers,
+				      b->radius->num_auth_servers))
+		return 1;
+
+#ifdef CONFIG_IEEE80211R
+	if (os_memcmp(a->mobility_domain, b->mobility_domain,
+		      MOBILITY_DOMAIN_ID_LEN) != 0 ||
+	    os_memcmp(a->r1_key_holder, b->r1_key_holder,
+		      FT_R1KH_ID_LEN) != 0 ||
+	    hostapd_str_cmp(a->nas_identifier, b->nas_identifier) ||
+	    a->r0_key_lifetime != b->r0_key_lifetime ||
+	    a->pmk_r1_push != b->pmk_r1_push ||
+	    a->ft_over_ds != b->ft_over_ds ||
+	    hostapd_r0kh_cmp(a->r0kh_list, b->r0kh_list) ||
+	    hostapd_r1kh_cmp(a->r1kh_list, b->r1kh_list))
+		return 1;
+#endif /* CONFIG_IEEE80211R */
+
+	return 0;
+}
+
+
+/**
+ * hostapd_iface_config_sta_cmp - Compare radio configuration for STAs
+ * @a: Old interface configuration
+ * @b: New interface configuration
+ * Returns: 0 if associated stations can be kept, 1 if the radio configuration
+ * or the set of BSSes changed in a way that requires all associations to be
+ * dropped
+ */
+int hostapd_iface_config_sta_cmp(struct hostapd_config *a,
+				 struct hostapd_config *b)
+{
+	return a->num_bss != b->num_bss ||
+		a->driver != b->driver ||
+		a->channel != b->channel ||
+		a->hw_mode != b->hw_mode ||
+		a->ieee80211n != b->ieee80211n ||
+		a->secondary_channel != b->secondary_channel ||
+		a->ht_capab != b->ht_capab ||
+		a->require_ht != b->require_ht;
+}
+
 static void hostapd_config_free_radius(struct hostapd_radius_server *servers,
 				       int num_servers)
 {
@@ -394,6 +608,7 @@ static void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	os_free(conf->accept_mac);
 	os_free(conf->deny_mac);
 	os_free(conf->nas_identifier);
+	os_free(conf->acct_spool_file);
 	hostapd_config_free_radius(conf->radius->auth_servers,
 				   conf->radius->num_auth_servers);
 	hostapd_config_free_radius(conf->radius->acct_servers,
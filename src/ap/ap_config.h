@@ -178,6 +178,9 @@ struct hostapd_bss_config {
 	char *nas_identifier;
 	struct hostapd_radius_servers *radius;
 	int acct_interim_interval;
+	char *acct_spool_file;
+	int acct_spool_max_size;
+	int acct_spool_replay_rate;
 
 	struct hostapd_ssid ssid;
 
@@ -428,6 +431,10 @@ int hostapd_maclist_found(struct mac_acl_entry *list, int num_entries,
 int hostapd_rate_found(int *list, int rate);
 int hostapd_wep_key_cmp(struct hostapd_wep_keys *a,
 			struct hostapd_wep_keys *b);
+int hostapd_bss_config_sta_cmp(struct hostapd_bss_config *a,
+			       struct hostapd_bss_config *b);
+int hostapd_iface_config_sta_cmp(struct hostapd_config *a,
+				 struct hostapd_config *b);
 const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 			   const u8 *addr, const u8 *prev_psk);
 int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf);
@@ -245,8 +245,9 @@ void handle_probe_req(struct hostapd_data *hapd,
 #endif /* CONFIG_P2P */
 
 	if (hapd->conf->ignore_broadcast_ssid && elems.ssid_len == 0) {
-		wpa_printf(MSG_MSGDUMP, "Probe Request from " MACSTR " for "
-			   "broadcast SSID ignored", MAC2STR(mgmt->sa));
+		wpa_printf_hot(MSG_MSGDUMP, "Probe Request from " MACSTR
+			       " for broadcast SSID ignored",
+			       MAC2STR(mgmt->sa));
 		return;
 	}
 
@@ -273,7 +274,7 @@ void handle_probe_req(struct hostapd_data *hapd,
 	}
 
 	if (!ssid) {
-		if (!(mgmt->da[0] & 0x01)) {
+		if (!(mgmt->da[0] & 0x01) && wpa_debug_enabled(MSG_MSGDUMP)) {
 			char ssid_txt[33];
 			ieee802_11_print_ssid(ssid_txt, elems.ssid,
 					      elems.ssid_len);
@@ -412,9 +413,9 @@ void handle_probe_req(struct hostapd_data *hapd,
 
 	os_free(resp);
 
-	wpa_printf(MSG_EXCESSIVE, "STA " MACSTR " sent probe request for %s "
-		   "SSID", MAC2STR(mgmt->sa),
-		   elems.ssid_len == 0 ? "broadcast" : "our");
+	wpa_printf_hot(MSG_EXCESSIVE, "STA " MACSTR " sent probe request for "
+		       "%s SSID", MAC2STR(mgmt->sa),
+		       elems.ssid_len == 0 ? "broadcast" : "our");
 }
 
 #endif /* NEED_AP_MLME */
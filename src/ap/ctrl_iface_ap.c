@@ -45,6 +45,16 @@ static int hostapd_ctrl_iface_sta_mib(struct hostapd_data *hapd,
 		return len;
 	len += ret;
 
+	ret = os_snprintf(buf + len, buflen - len,
+			  "arena_size=%u\narena_used=%u\narena_heap=%u\n"
+			  "arena_allocs=%u\narena_fallbacks=%u\n",
+			  STA_ARENA_SIZE, (unsigned int) sta->arena_used,
+			  (unsigned int) sta->arena_heap, sta->arena_allocs,
+			  sta->arena_fallbacks);
+	if (ret < 0 || (size_t) ret >= buflen - len)
+		return len;
+	len += ret;
+
 	res = ieee802_11_get_mib_sta(hapd, sta, buf + len, buflen - len);
 	if (res >= 0)
 		len += res;
@@ -45,17 +45,12 @@ static int hostapd_broadcast_wep_clear(struct hostapd_data *hapd);
 extern int wpa_debug_level;
 
 
-static void hostapd_reload_bss(struct hostapd_data *hapd)
+static void hostapd_reload_bss(struct hostapd_data *hapd, int sta_kept)
 {
 #ifndef CONFIG_NO_RADIUS
 	radius_client_reconfig(hapd->radius, hapd->conf->radius);
 #endif /* CONFIG_NO_RADIUS */
 
-	if (hostapd_setup_wpa_psk(hapd->conf)) {
-		wpa_printf(MSG_ERROR, "Failed to re-configure WPA PSK "
-			   "after reloading configuration");
-	}
-
 	if (hapd->conf->ieee802_1x || hapd->conf->wpa)
 		hostapd_set_drv_ieee8021x(hapd, hapd->conf->iface, 1);
 	else
@@ -68,7 +63,8 @@ static void hostapd_reload_bss(struct hostapd_data *hapd)
 	} else if (hapd->conf->wpa) {
 		const u8 *wpa_ie;
 		size_t wpa_ie_len;
-		hostapd_reconfig_wpa(hapd);
+		/* Stations that are kept still use the current GTK */
+		hostapd_reconfig_wpa(hapd, sta_kept);
 		wpa_ie = wpa_auth_get_wpa_ie(hapd->wpa_auth, &wpa_ie_len);
 		if (hostapd_set_generic_elem(hapd, wpa_ie, wpa_ie_len))
 			wpa_printf(MSG_ERROR, "Failed to configure WPA IE for "
@@ -94,10 +90,23 @@ static void hostapd_reload_bss(struct hostapd_data *hapd)
 }
 
 
+static int hostapd_sta_update_conf(struct hostapd_data *hapd,
+				   struct sta_info *sta, void *ctx)
+{
+	/* STA entries point to the SSID of the configuration that is about to
+	 * be freed */
+	sta->ssid = &hapd->conf->ssid;
+	if (sta->ssid_probe)
+		sta->ssid_probe = &hapd->conf->ssid;
+	return 0;
+}
+
+
 int hostapd_reload_config(struct hostapd_iface *iface)
 {
 	struct hostapd_data *hapd = iface->bss[0];
 	struct hostapd_config *newconf, *oldconf;
+	int flush_all, *flush;
 	size_t j;
 
 	if (iface->config_read_cb == NULL)
@@ -106,13 +115,38 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 	if (newconf == NULL)
 		return -1;
 
+	for (j = 0; j < newconf->num_bss; j++) {
+		if (hostapd_setup_wpa_psk(&newconf->bss[j])) {
+			wpa_printf(MSG_ERROR, "Failed to re-configure WPA PSK "
+				   "after reloading configuration");
+		}
+	}
+
+	flush = os_zalloc(iface->num_bss * sizeof(int));
+	if (flush == NULL) {
+		hostapd_config_free(newconf);
+		return -1;
+	}
+
 	/*
-	 * Deauthenticate all stations since the new configuration may not
-	 * allow them to use the BSS anymore.
+	 * Deauthenticate stations of the BSSes whose configuration changed in
+	 * a way that may not allow them to use the BSS anymore. Other stations
+	 * are kept associated.
 	 */
+	flush_all = hostapd_iface_config_sta_cmp(hapd->iconf, newconf);
 	for (j = 0; j < iface->num_bss; j++) {
-		hostapd_flush_old_stations(iface->bss[j]);
-		hostapd_broadcast_wep_clear(iface->bss[j]);
+		flush[j] = flush_all ||
+			hostapd_bss_config_sta_cmp(iface->bss[j]->conf,
+						   &newconf->bss[j]);
+		if (flush[j]) {
+			hostapd_flush_old_stations(iface->bss[j]);
+			hostapd_broadcast_wep_clear(iface->bss[j]);
+		} else {
+			wpa_printf(MSG_DEBUG, "%s: Security configuration not "
+				   "changed - keeping %d associated STA(s)",
+				   iface->bss[j]->conf->iface,
+				   iface->bss[j]->num_sta);
+		}
 
 #ifndef CONFIG_NO_RADIUS
 		/* TODO: update dynamic data based on changed configuration
@@ -128,9 +162,12 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 		hapd = iface->bss[j];
 		hapd->iconf = newconf;
 		hapd->conf = &newconf->bss[j];
-		hostapd_reload_bss(hapd);
+		if (!flush[j])
+			ap_for_each_sta(hapd, hostapd_sta_update_conf, NULL);
+		hostapd_reload_bss(hapd, !flush[j]);
 	}
 
+	os_free(flush);
 	hostapd_config_free(oldconf);
 
 
@@ -75,6 +75,10 @@ struct hostapd_data {
 #define AID_WORDS ((2008 + 31) / 32)
 	u32 sta_aid[AID_WORDS];
 
+	/* Bulk station data cache; see ap_sta_read_data() */
+	struct os_time sta_data_time;
+	unsigned int sta_data_gen;
+
 	const struct wpa_driver_ops *driver;
 	void *drv_priv;
 
@@ -85,10 +89,11 @@ struct hostapd_data {
 
 	struct radius_client_data *radius;
 	u32 acct_session_id_hi, acct_session_id_lo;
+	struct accounting_spool *acct_spool;
 
 	struct iapp_data *iapp;
 
-	struct hostapd_cached_radius_acl *acl_cache;
+	struct hostapd_acl_cache *acl_cache;
 	struct hostapd_acl_query_data *acl_queries;
 
 	struct wpa_authenticator *wpa_auth;
@@ -193,7 +193,8 @@ static u16 auth_shared_key(struct hostapd_data *hapd, struct sta_info *sta,
 			u8 key[8];
 			struct os_time now;
 			int r;
-			sta->challenge = os_zalloc(WLAN_AUTH_CHALLENGE_LEN);
+			sta->challenge = ap_sta_arena_alloc(
+				sta, WLAN_AUTH_CHALLENGE_LEN);
 			if (sta->challenge == NULL)
 				return WLAN_STATUS_UNSPECIFIED_FAILURE;
 
@@ -230,7 +231,7 @@ static u16 auth_shared_key(struct hostapd_data *hapd, struct sta_info *sta,
 	sta->flags |= WLAN_STA_AUTH;
 	wpa_auth_sm_event(sta->wpa_sm, WPA_AUTH);
 #endif
-	os_free(sta->challenge);
+	ap_sta_arena_free(sta, sta->challenge, WLAN_AUTH_CHALLENGE_LEN);
 	sta->challenge = NULL;
 
 	return 0;
@@ -1074,9 +1075,13 @@ static void handle_assoc(struct hostapd_data *hapd,
 			  ETH_ALEN);
 	}
 
-	if (sta->last_assoc_req)
-		os_free(sta->last_assoc_req);
+	/*
+	 * Not taken from the STA arena: the copy is replaced on every
+	 * (re)association and the arena only reclaims its newest allocation.
+	 */
+	os_free(sta->last_assoc_req);
 	sta->last_assoc_req = os_malloc(len);
+	sta->last_assoc_req_len = sta->last_assoc_req ? len : 0;
 	if (sta->last_assoc_req)
 		os_memcpy(sta->last_assoc_req, mgmt, len);
 
@@ -1591,6 +1596,7 @@ static void handle_assoc_cb(struct hostapd_data *hapd,
 	if (sta->last_assoc_req) {
 		os_free(sta->last_assoc_req);
 		sta->last_assoc_req = NULL;
+		sta->last_assoc_req_len = 0;
 	}
 }
 
@@ -21,6 +21,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/list.h"
 #include "radius/radius.h"
 #include "radius/radius_client.h"
 #include "hostapd.h"
@@ -30,72 +31,175 @@
 #include "ieee802_11_auth.h"
 
 #define RADIUS_ACL_TIMEOUT 30
+/* Number of seconds before expiration when a cached entry that is being used
+ * is refreshed with a new RADIUS query in the background */
+#define RADIUS_ACL_REFRESH_AHEAD 5
+/* Maximum number of entries in the ACL cache per BSS; least recently used
+ * entries are evicted when the limit is reached */
+#ifndef RADIUS_ACL_CACHE_MAX
+#define RADIUS_ACL_CACHE_MAX 1024
+#endif /* RADIUS_ACL_CACHE_MAX */
+
+#define ACL_HASH_SIZE 256
+#define ACL_HASH(addr) (addr[5])
 
 
 struct hostapd_cached_radius_acl {
 	os_time_t timestamp;
 	macaddr addr;
-	int accepted; /* HOSTAPD_ACL_* */
-	struct hostapd_cached_radius_acl *next;
+	int accepted; /* HOSTAPD_ACL_*; HOSTAPD_ACL_PENDING until the first
+		       * response from the RADIUS server has been received */
+	struct hostapd_cached_radius_acl *hnext; /* next entry in hash bucket */
+	struct dl_list list; /* LRU list; most recently used first */
+	int query_pending; /* RADIUS query for this address is in progress */
 	u32 session_timeout;
 	u32 acct_interim_interval;
 	int vlan_id;
 };
 
 
+struct hostapd_acl_cache {
+	struct hostapd_cached_radius_acl *hash[ACL_HASH_SIZE];
+	struct dl_list lru;
+	unsigned int num_entries;
+};
+
+
 struct hostapd_acl_query_data {
 	os_time_t timestamp;
-	u8 radius_id;
+	int radius_id;
 	macaddr addr;
-	u8 *auth_msg; /* IEEE 802.11 authentication frame from station */
+	u8 *auth_msg; /* IEEE 802.11 authentication frame from station or
+		       * %NULL for background refresh of a cached entry */
 	size_t auth_msg_len;
 	struct hostapd_acl_query_data *next;
 };
 
 
 #ifndef CONFIG_NO_RADIUS
-static void hostapd_acl_cache_free(struct hostapd_cached_radius_acl *acl_cache)
+static struct hostapd_cached_radius_acl *
+hostapd_acl_cache_find(struct hostapd_acl_cache *cache, const u8 *addr)
+{
+	struct hostapd_cached_radius_acl *entry;
+
+	entry = cache->hash[ACL_HASH(addr)];
+	while (entry && os_memcmp(entry->addr, addr, ETH_ALEN) != 0)
+		entry = entry->hnext;
+	return entry;
+}
+
+
+static void hostapd_acl_cache_remove(struct hostapd_data *hapd,
+				     struct hostapd_cached_radius_acl *entry)
 {
-	struct hostapd_cached_radius_acl *prev;
+	struct hostapd_acl_cache *cache = hapd->acl_cache;
+	struct hostapd_cached_radius_acl **pos;
+
+	pos = &cache->hash[ACL_HASH(entry->addr)];
+	while (*pos && *pos != entry)
+		pos = &(*pos)->hnext;
+	if (*pos)
+		*pos = entry->hnext;
+	dl_list_del(&entry->list);
+	cache->num_entries--;
+
+	if (entry->accepted != HOSTAPD_ACL_PENDING)
+		hostapd_drv_set_radius_acl_expire(hapd, entry->addr);
+	os_free(entry);
+}
+
 
-	while (acl_cache) {
-		prev = acl_cache;
-		acl_cache = acl_cache->next;
-		os_free(prev);
+static struct hostapd_cached_radius_acl *
+hostapd_acl_cache_add(struct hostapd_data *hapd, const u8 *addr)
+{
+	struct hostapd_acl_cache *cache = hapd->acl_cache;
+	struct hostapd_cached_radius_acl *entry;
+
+	entry = hostapd_acl_cache_find(cache, addr);
+	if (entry)
+		return entry;
+
+	if (cache->num_entries >= RADIUS_ACL_CACHE_MAX) {
+		entry = dl_list_last(&cache->lru,
+				     struct hostapd_cached_radius_acl, list);
+		wpa_printf(MSG_DEBUG, "ACL cache full - evicting entry for "
+			   MACSTR, MAC2STR(entry->addr));
+		hostapd_acl_cache_remove(hapd, entry);
 	}
+
+	entry = os_zalloc(sizeof(*entry));
+	if (entry == NULL)
+		return NULL;
+	os_memcpy(entry->addr, addr, ETH_ALEN);
+	entry->accepted = HOSTAPD_ACL_PENDING;
+	entry->hnext = cache->hash[ACL_HASH(addr)];
+	cache->hash[ACL_HASH(addr)] = entry;
+	dl_list_add(&cache->lru, &entry->list);
+	cache->num_entries++;
+
+	return entry;
+}
+
+
+static void hostapd_acl_cache_free(struct hostapd_acl_cache *cache)
+{
+	struct hostapd_cached_radius_acl *entry, *n;
+
+	if (cache == NULL)
+		return;
+	dl_list_for_each_safe(entry, n, &cache->lru,
+			      struct hostapd_cached_radius_acl, list)
+		os_free(entry);
+	os_free(cache);
 }
 
 
+static int hostapd_acl_query_start(struct hostapd_data *hapd, const u8 *addr,
+				   const u8 *msg, size_t len);
+
+
 static int hostapd_acl_cache_get(struct hostapd_data *hapd, const u8 *addr,
 				 u32 *session_timeout,
 				 u32 *acct_interim_interval, int *vlan_id)
 {
 	struct hostapd_cached_radius_acl *entry;
 	struct os_time now;
+	os_time_t age;
 
-	os_get_time(&now);
-	entry = hapd->acl_cache;
+	entry = hostapd_acl_cache_find(hapd->acl_cache, addr);
+	if (entry == NULL)
+		return -1;
 
-	while (entry) {
-		if (os_memcmp(entry->addr, addr, ETH_ALEN) == 0) {
-			if (now.sec - entry->timestamp > RADIUS_ACL_TIMEOUT)
-				return -1; /* entry has expired */
-			if (entry->accepted == HOSTAPD_ACL_ACCEPT_TIMEOUT)
-				if (session_timeout)
-					*session_timeout =
-						entry->session_timeout;
-			if (acct_interim_interval)
-				*acct_interim_interval =
-					entry->acct_interim_interval;
-			if (vlan_id)
-				*vlan_id = entry->vlan_id;
-			return entry->accepted;
-		}
+	if (entry->accepted == HOSTAPD_ACL_PENDING)
+		return entry->query_pending ? HOSTAPD_ACL_PENDING : -1;
 
-		entry = entry->next;
+	os_get_time(&now);
+	age = now.sec - entry->timestamp;
+	if (age > RADIUS_ACL_TIMEOUT)
+		return entry->query_pending ? HOSTAPD_ACL_PENDING : -1;
+
+	/* Move to the head of the LRU list */
+	dl_list_del(&entry->list);
+	dl_list_add(&hapd->acl_cache->lru, &entry->list);
+
+	if (age > RADIUS_ACL_TIMEOUT - RADIUS_ACL_REFRESH_AHEAD &&
+	    !entry->query_pending && hapd->conf->radius->auth_server) {
+		/* Refresh the entry in the background while the cached result
+		 * is still being used */
+		wpa_printf(MSG_DEBUG, "Refreshing cached ACL entry for "
+			   MACSTR, MAC2STR(addr));
+		if (hostapd_acl_query_start(hapd, addr, NULL, 0) == 0)
+			entry->query_pending = 1;
 	}
 
-	return -1;
+	if (entry->accepted == HOSTAPD_ACL_ACCEPT_TIMEOUT)
+		if (session_timeout)
+			*session_timeout = entry->session_timeout;
+	if (acct_interim_interval)
+		*acct_interim_interval = entry->acct_interim_interval;
+	if (vlan_id)
+		*vlan_id = entry->vlan_id;
+	return entry->accepted;
 }
 #endif /* CONFIG_NO_RADIUS */
 
@@ -198,6 +302,45 @@ static int hostapd_radius_acl_query(struct hostapd_data *hapd, const u8 *addr,
 	radius_msg_free(msg);
 	return -1;
 }
+
+
+static int hostapd_acl_query_start(struct hostapd_data *hapd, const u8 *addr,
+				   const u8 *msg, size_t len)
+{
+	struct hostapd_acl_query_data *query;
+	struct os_time t;
+
+	query = os_zalloc(sizeof(*query));
+	if (query == NULL) {
+		wpa_printf(MSG_ERROR, "malloc for query data failed");
+		return -1;
+	}
+	os_get_time(&t);
+	query->timestamp = t.sec;
+	os_memcpy(query->addr, addr, ETH_ALEN);
+	if (hostapd_radius_acl_query(hapd, addr, query)) {
+		wpa_printf(MSG_DEBUG, "Failed to send Access-Request "
+			   "for ACL query.");
+		hostapd_acl_query_free(query);
+		return -1;
+	}
+
+	if (msg) {
+		query->auth_msg = os_malloc(len);
+		if (query->auth_msg == NULL) {
+			wpa_printf(MSG_ERROR, "Failed to allocate memory for "
+				   "auth frame.");
+			hostapd_acl_query_free(query);
+			return -1;
+		}
+		os_memcpy(query->auth_msg, msg, len);
+		query->auth_msg_len = len;
+	}
+	query->next = hapd->acl_queries;
+	hapd->acl_queries = query;
+
+	return 0;
+}
 #endif /* CONFIG_NO_RADIUS */
 
 
@@ -240,59 +383,38 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 #ifdef CONFIG_NO_RADIUS
 		return HOSTAPD_ACL_REJECT;
 #else /* CONFIG_NO_RADIUS */
-		struct hostapd_acl_query_data *query;
-		struct os_time t;
+		struct hostapd_cached_radius_acl *entry;
+		int res;
+
+		if (hapd->acl_cache == NULL)
+			return HOSTAPD_ACL_REJECT;
 
 		/* Check whether ACL cache has an entry for this station */
-		int res = hostapd_acl_cache_get(hapd, addr, session_timeout,
-						acct_interim_interval,
-						vlan_id);
+		res = hostapd_acl_cache_get(hapd, addr, session_timeout,
+					    acct_interim_interval, vlan_id);
 		if (res == HOSTAPD_ACL_ACCEPT ||
 		    res == HOSTAPD_ACL_ACCEPT_TIMEOUT)
 			return res;
 		if (res == HOSTAPD_ACL_REJECT)
 			return HOSTAPD_ACL_REJECT;
-
-		query = hapd->acl_queries;
-		while (query) {
-			if (os_memcmp(query->addr, addr, ETH_ALEN) == 0) {
-				/* pending query in RADIUS retransmit queue;
-				 * do not generate a new one */
-				return HOSTAPD_ACL_PENDING;
-			}
-			query = query->next;
+		if (res == HOSTAPD_ACL_PENDING) {
+			/* pending query in RADIUS retransmit queue; do not
+			 * generate a new one */
+			return HOSTAPD_ACL_PENDING;
 		}
 
 		if (!hapd->conf->radius->auth_server)
 			return HOSTAPD_ACL_REJECT;
 
 		/* No entry in the cache - query external RADIUS server */
-		query = os_zalloc(sizeof(*query));
-		if (query == NULL) {
-			wpa_printf(MSG_ERROR, "malloc for query data failed");
+		entry = hostapd_acl_cache_add(hapd, addr);
+		if (entry == NULL) {
+			wpa_printf(MSG_DEBUG, "Failed to add ACL cache entry");
 			return HOSTAPD_ACL_REJECT;
 		}
-		os_get_time(&t);
-		query->timestamp = t.sec;
-		os_memcpy(query->addr, addr, ETH_ALEN);
-		if (hostapd_radius_acl_query(hapd, addr, query)) {
-			wpa_printf(MSG_DEBUG, "Failed to send Access-Request "
-				   "for ACL query.");
-			hostapd_acl_query_free(query);
+		if (hostapd_acl_query_start(hapd, addr, msg, len) < 0)
 			return HOSTAPD_ACL_REJECT;
-		}
-
-		query->auth_msg = os_malloc(len);
-		if (query->auth_msg == NULL) {
-			wpa_printf(MSG_ERROR, "Failed to allocate memory for "
-				   "auth frame.");
-			hostapd_acl_query_free(query);
-			return HOSTAPD_ACL_REJECT;
-		}
-		os_memcpy(query->auth_msg, msg, len);
-		query->auth_msg_len = len;
-		query->next = hapd->acl_queries;
-		hapd->acl_queries = query;
+		entry->query_pending = 1;
 
 		/* Queued data will be processed in hostapd_acl_recv_radius()
 		 * when RADIUS server replies to the sent Access-Request. */
@@ -307,28 +429,16 @@ int hostapd_allowed_address(struct hostapd_data *hapd, const u8 *addr,
 #ifndef CONFIG_NO_RADIUS
 static void hostapd_acl_expire_cache(struct hostapd_data *hapd, os_time_t now)
 {
-	struct hostapd_cached_radius_acl *prev, *entry, *tmp;
+	struct hostapd_cached_radius_acl *entry, *n;
 
-	prev = NULL;
-	entry = hapd->acl_cache;
-
-	while (entry) {
-		if (now - entry->timestamp > RADIUS_ACL_TIMEOUT) {
-			wpa_printf(MSG_DEBUG, "Cached ACL entry for " MACSTR
-				   " has expired.", MAC2STR(entry->addr));
-			if (prev)
-				prev->next = entry->next;
-			else
-				hapd->acl_cache = entry->next;
-			hostapd_drv_set_radius_acl_expire(hapd, entry->addr);
-			tmp = entry;
-			entry = entry->next;
-			os_free(tmp);
+	dl_list_for_each_safe(entry, n, &hapd->acl_cache->lru,
+			      struct hostapd_cached_radius_acl, list) {
+		if (entry->query_pending ||
+		    now - entry->timestamp <= RADIUS_ACL_TIMEOUT)
 			continue;
-		}
-
-		prev = entry;
-		entry = entry->next;
+		wpa_printf(MSG_DEBUG, "Cached ACL entry for " MACSTR
+			   " has expired.", MAC2STR(entry->addr));
+		hostapd_acl_cache_remove(hapd, entry);
 	}
 }
 
@@ -343,8 +453,13 @@ static void hostapd_acl_expire_queries(struct hostapd_data *hapd,
 
 	while (entry) {
 		if (now - entry->timestamp > RADIUS_ACL_TIMEOUT) {
+			struct hostapd_cached_radius_acl *acl;
 			wpa_printf(MSG_DEBUG, "ACL query for " MACSTR
 				   " has expired.", MAC2STR(entry->addr));
+			acl = hostapd_acl_cache_find(hapd->acl_cache,
+						     entry->addr);
+			if (acl)
+				acl->query_pending = 0;
 			if (prev)
 				prev->next = entry->next;
 			else
@@ -373,8 +488,8 @@ static void hostapd_acl_expire(void *eloop_ctx, void *timeout_ctx)
 	struct os_time now;
 
 	os_get_time(&now);
-	hostapd_acl_expire_cache(hapd, now.sec);
 	hostapd_acl_expire_queries(hapd, now.sec);
+	hostapd_acl_expire_cache(hapd, now.sec);
 
 	eloop_register_timeout(10, 0, hostapd_acl_expire, hapd, NULL);
 }
@@ -399,12 +514,13 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 	struct hostapd_acl_query_data *query, *prev;
 	struct hostapd_cached_radius_acl *cache;
 	struct radius_hdr *hdr = radius_msg_get_hdr(msg);
+	int req_id = radius_client_get_req_id(hapd->radius);
 	struct os_time t;
 
 	query = hapd->acl_queries;
 	prev = NULL;
 	while (query) {
-		if (query->radius_id == hdr->identifier)
+		if (query->radius_id == req_id)
 			break;
 		prev = query;
 		query = query->next;
@@ -413,7 +529,7 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 		return RADIUS_RX_UNKNOWN;
 
 	wpa_printf(MSG_DEBUG, "Found matching Access-Request for RADIUS "
-		   "message (id=%d)", query->radius_id);
+		   "message (id=%d)", query->radius_id & 0xff);
 
 	if (radius_msg_verify(msg, shared_secret, shared_secret_len, req, 0)) {
 		wpa_printf(MSG_INFO, "Incoming RADIUS packet did not have "
@@ -428,15 +544,19 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 		return RADIUS_RX_UNKNOWN;
 	}
 
-	/* Insert Accept/Reject info into ACL cache */
-	cache = os_zalloc(sizeof(*cache));
+	/* Insert Accept/Reject info into ACL cache (or update the existing
+	 * entry in case of a background refresh) */
+	cache = hostapd_acl_cache_add(hapd, query->addr);
 	if (cache == NULL) {
 		wpa_printf(MSG_DEBUG, "Failed to add ACL cache entry");
 		goto done;
 	}
 	os_get_time(&t);
 	cache->timestamp = t.sec;
-	os_memcpy(cache->addr, query->addr, sizeof(cache->addr));
+	cache->query_pending = 0;
+	cache->session_timeout = 0;
+	cache->acct_interim_interval = 0;
+	cache->vlan_id = 0;
 	if (hdr->code == RADIUS_CODE_ACCESS_ACCEPT) {
 		if (radius_msg_get_attr_int32(msg, RADIUS_ATTR_SESSION_TIMEOUT,
 					      &cache->session_timeout) == 0)
@@ -458,18 +578,20 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 		cache->vlan_id = radius_msg_get_vlanid(msg);
 	} else
 		cache->accepted = HOSTAPD_ACL_REJECT;
-	cache->next = hapd->acl_cache;
-	hapd->acl_cache = cache;
 
 #ifdef CONFIG_DRIVER_RADIUS_ACL
 	hostapd_drv_set_radius_acl_auth(hapd, query->addr, cache->accepted,
 					cache->session_timeout);
 #else /* CONFIG_DRIVER_RADIUS_ACL */
 #ifdef NEED_AP_MLME
-	/* Re-send original authentication frame for 802.11 processing */
-	wpa_printf(MSG_DEBUG, "Re-sending authentication frame after "
-		   "successful RADIUS ACL query");
-	ieee802_11_mgmt(hapd, query->auth_msg, query->auth_msg_len, NULL);
+	/* Re-send original authentication frame for 802.11 processing; there
+	 * is no frame to process for background refresh of a cached entry */
+	if (query->auth_msg) {
+		wpa_printf(MSG_DEBUG, "Re-sending authentication frame after "
+			   "successful RADIUS ACL query");
+		ieee802_11_mgmt(hapd, query->auth_msg, query->auth_msg_len,
+				NULL);
+	}
 #endif /* NEED_AP_MLME */
 #endif /* CONFIG_DRIVER_RADIUS_ACL */
 
@@ -494,6 +616,11 @@ hostapd_acl_recv_radius(struct radius_msg *msg, struct radius_msg *req,
 int hostapd_acl_init(struct hostapd_data *hapd)
 {
 #ifndef CONFIG_NO_RADIUS
+	hapd->acl_cache = os_zalloc(sizeof(*hapd->acl_cache));
+	if (hapd->acl_cache == NULL)
+		return -1;
+	dl_list_init(&hapd->acl_cache->lru);
+
 	if (radius_client_register(hapd->radius, RADIUS_AUTH,
 				   hostapd_acl_recv_radius, hapd))
 		return -1;
@@ -517,6 +644,7 @@ void hostapd_acl_deinit(struct hostapd_data *hapd)
 	eloop_cancel_timeout(hostapd_acl_expire, hapd, NULL);
 
 	hostapd_acl_cache_free(hapd->acl_cache);
+	hapd->acl_cache = NULL;
 #endif /* CONFIG_NO_RADIUS */
 
 	query = hapd->acl_queries;
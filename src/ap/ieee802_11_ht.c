@@ -163,14 +163,15 @@ u16 copy_sta_ht_capab(struct hostapd_data *hapd, struct sta_info *sta,
 	    ht_capab_len < sizeof(struct ieee80211_ht_capabilities) ||
 	    hapd->conf->disable_11n) {
 		sta->flags &= ~WLAN_STA_HT;
-		os_free(sta->ht_capabilities);
+		ap_sta_arena_free(sta, sta->ht_capabilities,
+				  sizeof(struct ieee80211_ht_capabilities));
 		sta->ht_capabilities = NULL;
 		return WLAN_STATUS_SUCCESS;
 	}
 
 	if (sta->ht_capabilities == NULL) {
-		sta->ht_capabilities =
-			os_zalloc(sizeof(struct ieee80211_ht_capabilities));
+		sta->ht_capabilities = ap_sta_arena_alloc(
+			sta, sizeof(struct ieee80211_ht_capabilities));
 		if (sta->ht_capabilities == NULL)
 			return WLAN_STATUS_UNSPECIFIED_FAILURE;
 	}
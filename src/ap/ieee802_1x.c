@@ -1215,7 +1215,7 @@ static void ieee802_1x_update_sta_identity(struct hostapd_data *hapd,
 
 
 struct sta_id_search {
-	u8 identifier;
+	int identifier;
 	struct eapol_state_machine *sm;
 };
 
@@ -1237,7 +1237,7 @@ static int ieee802_1x_select_radius_identifier(struct hostapd_data *hapd,
 
 
 static struct eapol_state_machine *
-ieee802_1x_search_radius_identifier(struct hostapd_data *hapd, u8 identifier)
+ieee802_1x_search_radius_identifier(struct hostapd_data *hapd, int identifier)
 {
 	struct sta_id_search id_search;
 	id_search.identifier = identifier;
@@ -1269,7 +1269,8 @@ ieee802_1x_receive_auth(struct radius_msg *msg, struct radius_msg *req,
 	int override_eapReq = 0;
 	struct radius_hdr *hdr = radius_msg_get_hdr(msg);
 
-	sm = ieee802_1x_search_radius_identifier(hapd, hdr->identifier);
+	sm = ieee802_1x_search_radius_identifier(
+		hapd, radius_client_get_req_id(hapd->radius));
 	if (sm == NULL) {
 		wpa_printf(MSG_DEBUG, "IEEE 802.1X: Could not find matching "
 			   "station for this RADIUS message");
@@ -212,11 +212,16 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	radius_client_flush_auth(hapd->radius, sta->addr);
 #endif /* CONFIG_NO_RADIUS */
 
+	/*
+	 * Objects allocated from the per-STA arena go away with the sta_info
+	 * allocation itself; these calls only release heap fallbacks.
+	 */
 	os_free(sta->last_assoc_req);
-	os_free(sta->challenge);
+	ap_sta_arena_free(sta, sta->challenge, WLAN_AUTH_CHALLENGE_LEN);
 
 #ifdef CONFIG_IEEE80211W
-	os_free(sta->sa_query_trans_id);
+	ap_sta_arena_free(sta, sta->sa_query_trans_id,
+			  sta->sa_query_count * WLAN_SA_QUERY_TR_ID_LEN);
 	eloop_cancel_timeout(ap_sa_query_timer, hapd, sta);
 #endif /* CONFIG_IEEE80211W */
 
@@ -227,7 +232,9 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	wpabuf_free(sta->wps_ie);
 	wpabuf_free(sta->p2p_ie);
 
-	os_free(sta->ht_capabilities);
+	ap_sta_arena_free(sta, sta->ht_capabilities,
+			  sizeof(struct ieee80211_ht_capabilities));
+	ap_sta_arena_free(sta, sta->drv_data, sizeof(*sta->drv_data));
 
 	os_free(sta);
 }
@@ -253,6 +260,28 @@ void hostapd_free_stas(struct hostapd_data *hapd)
 }
 
 
+static void ap_sta_inact_timer_register(struct hostapd_data *hapd,
+					struct sta_info *sta,
+					unsigned long interval)
+{
+	struct os_time now;
+	os_time_t due;
+	unsigned int sec, usec;
+
+	os_get_time(&now);
+	due = now.sec + interval;
+	due += AP_STA_INACT_BUCKET - due % AP_STA_INACT_BUCKET;
+	sec = due - now.sec;
+	usec = 0;
+	if (now.usec) {
+		sec--;
+		usec = 1000000 - now.usec;
+	}
+
+	eloop_register_timeout(sec, usec, ap_handle_timer, hapd, sta);
+}
+
+
 /**
  * ap_handle_timer - Per STA timer handler
  * @eloop_ctx: struct hostapd_data *
@@ -279,7 +308,7 @@ void ap_handle_timer(void *eloop_ctx, void *timeout_ctx)
 	    (sta->timeout_next == STA_NULLFUNC ||
 	     sta->timeout_next == STA_DISASSOC)) {
 		int inactive_sec;
-		inactive_sec = hostapd_drv_get_inact_sec(hapd, sta->addr);
+		inactive_sec = ap_sta_get_inact_sec(hapd, sta);
 		if (inactive_sec == -1) {
 			wpa_msg(hapd, MSG_DEBUG, "Check inactivity: Could not "
 				"get station info rom kernel driver for "
@@ -313,8 +342,7 @@ void ap_handle_timer(void *eloop_ctx, void *timeout_ctx)
 	}
 
 	if (next_time) {
-		eloop_register_timeout(next_time, 0, ap_handle_timer, hapd,
-				       sta);
+		ap_sta_inact_timer_register(hapd, sta, next_time);
 		return;
 	}
 
@@ -441,16 +469,16 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 		return NULL;
 	}
 
-	sta = os_zalloc(sizeof(struct sta_info));
+	sta = os_zalloc(sizeof(struct sta_info) + STA_ARENA_SIZE);
 	if (sta == NULL) {
 		wpa_printf(MSG_ERROR, "malloc failed");
 		return NULL;
 	}
+	sta->arena = (u8 *) (sta + 1);
 	sta->acct_interim_interval = hapd->conf->acct_interim_interval;
 
 	/* initialize STA info data */
-	eloop_register_timeout(hapd->conf->ap_max_inactivity, 0,
-			       ap_handle_timer, hapd, sta);
+	ap_sta_inact_timer_register(hapd, sta, hapd->conf->ap_max_inactivity);
 	os_memcpy(sta->addr, addr, ETH_ALEN);
 	sta->next = hapd->sta_list;
 	hapd->sta_list = sta;
@@ -463,6 +491,111 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 }
 
 
+#define STA_ARENA_ALIGN(len) \
+	(((len) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+static int ap_sta_arena_owns(struct sta_info *sta, const void *ptr)
+{
+	const u8 *pos = ptr;
+	return pos >= sta->arena && pos < sta->arena + STA_ARENA_SIZE;
+}
+
+
+/**
+ * ap_sta_arena_alloc - Allocate zeroed memory for the lifetime of a STA entry
+ * @sta: Station data
+ * @len: Number of octets to allocate
+ * Returns: Pointer to the allocated buffer or %NULL on failure
+ *
+ * The memory is taken from the per-STA arena that was allocated together with
+ * struct sta_info, so it is released without any extra allocator work when the
+ * STA entry is freed. If the arena is full, the buffer is allocated from heap.
+ * In both cases, the buffer must be released with ap_sta_arena_free().
+ */
+void * ap_sta_arena_alloc(struct sta_info *sta, size_t len)
+{
+	size_t alen = STA_ARENA_ALIGN(len);
+	void *ptr;
+
+	if (len > 0 && alen <= STA_ARENA_SIZE - sta->arena_used) {
+		ptr = sta->arena + sta->arena_used;
+		sta->arena_last = sta->arena_used;
+		sta->arena_used += alen;
+		sta->arena_allocs++;
+		os_memset(ptr, 0, len);
+		return ptr;
+	}
+
+	ptr = os_zalloc(len);
+	if (ptr == NULL)
+		return NULL;
+	sta->arena_heap += len;
+	sta->arena_fallbacks++;
+	return ptr;
+}
+
+
+/**
+ * ap_sta_arena_realloc - Resize a buffer from ap_sta_arena_alloc()
+ * @sta: Station data
+ * @ptr: Old buffer or %NULL
+ * @old_len: Length of the old buffer in octets
+ * @len: New length in octets
+ * Returns: Pointer to the resized buffer or %NULL on failure (in which case
+ * the old buffer is not freed)
+ *
+ * The most recent arena allocation is grown in place when there is room for
+ * it; otherwise, a new buffer is allocated and the old contents copied to it.
+ */
+void * ap_sta_arena_realloc(struct sta_info *sta, void *ptr, size_t old_len,
+			    size_t len)
+{
+	void *nbuf;
+
+	if (ptr && ap_sta_arena_owns(sta, ptr) &&
+	    (u8 *) ptr == sta->arena + sta->arena_last &&
+	    STA_ARENA_ALIGN(len) <= STA_ARENA_SIZE - sta->arena_last) {
+		sta->arena_used = sta->arena_last + STA_ARENA_ALIGN(len);
+		return ptr;
+	}
+
+	nbuf = ap_sta_arena_alloc(sta, len);
+	if (nbuf == NULL)
+		return NULL;
+	if (ptr) {
+		os_memcpy(nbuf, ptr, old_len < len ? old_len : len);
+		ap_sta_arena_free(sta, ptr, old_len);
+	}
+	return nbuf;
+}
+
+
+/**
+ * ap_sta_arena_free - Free a buffer from ap_sta_arena_alloc()
+ * @sta: Station data
+ * @ptr: Buffer to free or %NULL
+ * @len: Length of the buffer in octets
+ *
+ * Heap fallbacks are freed immediately. Arena memory is returned to the arena
+ * only if it was the most recent arena allocation; other arena buffers are
+ * released when the STA entry is freed.
+ */
+void ap_sta_arena_free(struct sta_info *sta, void *ptr, size_t len)
+{
+	if (ptr == NULL)
+		return;
+
+	if (!ap_sta_arena_owns(sta, ptr)) {
+		os_free(ptr);
+		sta->arena_heap -= len;
+		return;
+	}
+
+	if ((u8 *) ptr == sta->arena + sta->arena_last)
+		sta->arena_used = sta->arena_last;
+}
+
+
 static int ap_sta_remove(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	ieee802_1x_notify_port_enabled(sta->eapol_sm, 0);
@@ -514,6 +647,98 @@ static void ap_sta_disassoc_cb_timeout(void *eloop_ctx, void *timeout_ctx)
 }
 
 
+static void ap_sta_data_cb(void *ctx, const u8 *addr,
+			   const struct hostap_sta_driver_data *data)
+{
+	struct hostapd_data *hapd = ctx;
+	struct sta_info *sta;
+
+	sta = ap_get_sta(hapd, addr);
+	if (sta == NULL)
+		return;
+	if (sta->drv_data == NULL) {
+		sta->drv_data = ap_sta_arena_alloc(sta, sizeof(*data));
+		if (sta->drv_data == NULL)
+			return;
+	}
+	os_memcpy(sta->drv_data, data, sizeof(*data));
+	sta->drv_data_gen = hapd->sta_data_gen;
+}
+
+
+static int ap_sta_data_update(struct hostapd_data *hapd)
+{
+	struct os_time now;
+	long age;
+
+	os_get_time(&now);
+	age = (now.sec - hapd->sta_data_time.sec) * 1000 +
+		(now.usec - hapd->sta_data_time.usec) / 1000;
+	if (hapd->sta_data_time.sec && age >= 0 &&
+	    age < AP_STA_DATA_CACHE_TTL_MS)
+		return 0;
+
+	hapd->sta_data_gen++;
+	if (hapd->sta_data_gen == 0)
+		hapd->sta_data_gen++;
+	hapd->sta_data_time.sec = 0;
+	if (hostapd_drv_read_all_sta_data(hapd, ap_sta_data_cb, hapd) < 0)
+		return -1;
+	hapd->sta_data_time = now;
+
+	return 0;
+}
+
+
+/**
+ * ap_sta_read_data - Fetch station data from the driver
+ * @hapd: Pointer to BSS data
+ * @sta: Pointer to the station
+ * @data: Buffer for returning station information
+ * @fresh: Whether to bypass cached data and query the station directly
+ * Returns: 0 on success, -1 on failure
+ *
+ * If the driver can report data for all stations with one request, the
+ * result is cached for AP_STA_DATA_CACHE_TTL_MS and shared between all
+ * stations of the BSS. This way timers that expire at about the same time
+ * (e.g., interim accounting and inactivity checks) do not each need a round
+ * trip to the driver. Both of these timers are aligned to shared time buckets
+ * (ACCT_INTERIM_BUCKET and AP_STA_INACT_BUCKET) for this reason.
+ */
+int ap_sta_read_data(struct hostapd_data *hapd, struct sta_info *sta,
+		     struct hostap_sta_driver_data *data, int fresh)
+{
+	if (!fresh && ap_sta_data_update(hapd) == 0 && sta->drv_data &&
+	    sta->drv_data_gen == hapd->sta_data_gen) {
+		os_memcpy(data, sta->drv_data, sizeof(*data));
+		return 0;
+	}
+
+	return hostapd_drv_read_sta_data(hapd, data, sta->addr);
+}
+
+
+/**
+ * ap_sta_get_inact_sec - Get station inactivity duration
+ * @hapd: Pointer to BSS data
+ * @sta: Pointer to the station
+ * Returns: Number of seconds station has been inactive, -1 on failure
+ */
+int ap_sta_get_inact_sec(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	struct hostap_sta_driver_data data;
+
+	if (hapd->driver == NULL || hapd->driver->read_all_sta_data == NULL)
+		return hostapd_drv_get_inact_sec(hapd, sta->addr);
+
+	data.inactive_msec = (unsigned long) -1;
+	if (ap_sta_read_data(hapd, sta, &data, 0) < 0 ||
+	    data.inactive_msec == (unsigned long) -1)
+		return -1;
+	return data.inactive_msec / 1000;
+}
+
+
 void ap_sta_disassociate(struct hostapd_data *hapd, struct sta_info *sta,
 			 u16 reason)
 {
@@ -700,7 +925,9 @@ int ap_check_sa_query_timeout(struct hostapd_data *hapd, struct sta_info *sta)
 			       HOSTAPD_LEVEL_DEBUG,
 			       "association SA Query timed out");
 		sta->sa_query_timed_out = 1;
-		os_free(sta->sa_query_trans_id);
+		ap_sta_arena_free(sta, sta->sa_query_trans_id,
+				  sta->sa_query_count *
+				  WLAN_SA_QUERY_TR_ID_LEN);
 		sta->sa_query_trans_id = NULL;
 		sta->sa_query_count = 0;
 		eloop_cancel_timeout(ap_sa_query_timer, hapd, sta);
@@ -722,8 +949,11 @@ static void ap_sa_query_timer(void *eloop_ctx, void *timeout_ctx)
 	    ap_check_sa_query_timeout(hapd, sta))
 		return;
 
-	nbuf = os_realloc(sta->sa_query_trans_id,
-			  (sta->sa_query_count + 1) * WLAN_SA_QUERY_TR_ID_LEN);
+	nbuf = ap_sta_arena_realloc(sta, sta->sa_query_trans_id,
+				    sta->sa_query_count *
+				    WLAN_SA_QUERY_TR_ID_LEN,
+				    (sta->sa_query_count + 1) *
+				    WLAN_SA_QUERY_TR_ID_LEN);
 	if (nbuf == NULL)
 		return;
 	if (sta->sa_query_count == 0) {
@@ -760,7 +990,8 @@ void ap_sta_start_sa_query(struct hostapd_data *hapd, struct sta_info *sta)
 void ap_sta_stop_sa_query(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	eloop_cancel_timeout(ap_sa_query_timer, hapd, sta);
-	os_free(sta->sa_query_trans_id);
+	ap_sta_arena_free(sta, sta->sa_query_trans_id,
+			  sta->sa_query_count * WLAN_SA_QUERY_TR_ID_LEN);
 	sta->sa_query_trans_id = NULL;
 	sta->sa_query_count = 0;
 }
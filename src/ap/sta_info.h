@@ -41,6 +41,12 @@
  * Supported Rates IEs). */
 #define WLAN_SUPP_RATES_MAX 32
 
+/* Size of the per-STA arena that is allocated together with struct sta_info
+ * and used for small objects that live until the STA entry is freed. */
+#ifndef STA_ARENA_SIZE
+#define STA_ARENA_SIZE 256
+#endif /* STA_ARENA_SIZE */
+
 
 struct sta_info {
 	struct sta_info *next; /* next entry in sta list */
@@ -76,6 +82,7 @@ struct sta_info {
 
 	/* IEEE 802.11f (IAPP) related data */
 	struct ieee80211_mgmt *last_assoc_req;
+	size_t last_assoc_req_len;
 
 	u32 acct_session_id_hi;
 	u32 acct_session_id_lo;
@@ -113,6 +120,20 @@ struct sta_info {
 
 	struct wpabuf *wps_ie; /* WPS IE from (Re)Association Request */
 	struct wpabuf *p2p_ie; /* P2P IE from (Re)Association Request */
+
+	/* Driver data from the latest bulk fetch (ap_sta_read_data()); valid
+	 * only if drv_data_gen matches hapd->sta_data_gen */
+	struct hostap_sta_driver_data *drv_data;
+	unsigned int drv_data_gen;
+
+	/* Per-STA arena (STA_ARENA_SIZE octets following struct sta_info) */
+	u8 *arena;
+	size_t arena_used; /* octets allocated from the arena */
+	size_t arena_last; /* offset of the most recent arena allocation */
+	size_t arena_heap; /* octets currently allocated from heap because the
+			    * arena was full */
+	unsigned int arena_allocs; /* number of arena allocations */
+	unsigned int arena_fallbacks; /* number of heap fallbacks */
 };
 
 
@@ -130,9 +151,17 @@ struct sta_info {
 #define AP_MAX_INACTIVITY_AFTER_DISASSOC (1 * 30)
 /* Number of seconds to keep STA entry after it has been deauthenticated. */
 #define AP_MAX_INACTIVITY_AFTER_DEAUTH (1 * 5)
+/* Number of milliseconds station data fetched from the driver for all
+ * stations with a single request is used before fetching it again. */
+#define AP_STA_DATA_CACHE_TTL_MS 500
+/* Inactivity checks are aligned to multiples of this many seconds so that the
+ * checks of all stations due in the same period share a single bulk station
+ * data fetch from the driver. */
+#define AP_STA_INACT_BUCKET 5
 
 
 struct hostapd_data;
+struct hostap_sta_driver_data;
 
 int ap_for_each_sta(struct hostapd_data *hapd,
 		    int (*cb)(struct hostapd_data *hapd, struct sta_info *sta,
@@ -149,6 +178,13 @@ void ap_sta_session_timeout(struct hostapd_data *hapd, struct sta_info *sta,
 void ap_sta_no_session_timeout(struct hostapd_data *hapd,
 			       struct sta_info *sta);
 struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr);
+void * ap_sta_arena_alloc(struct sta_info *sta, size_t len);
+void * ap_sta_arena_realloc(struct sta_info *sta, void *ptr, size_t old_len,
+			    size_t len);
+void ap_sta_arena_free(struct sta_info *sta, void *ptr, size_t len);
+int ap_sta_read_data(struct hostapd_data *hapd, struct sta_info *sta,
+		     struct hostap_sta_driver_data *data, int fresh);
+int ap_sta_get_inact_sec(struct hostapd_data *hapd, struct sta_info *sta);
 void ap_sta_disassociate(struct hostapd_data *hapd, struct sta_info *sta,
 			 u16 reason);
 void ap_sta_deauthenticate(struct hostapd_data *hapd, struct sta_info *sta,
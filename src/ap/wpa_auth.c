@@ -499,9 +499,15 @@ void wpa_deinit(struct wpa_authenticator *wpa_auth)
  * wpa_reconfig - Update WPA authenticator configuration
  * @wpa_auth: Pointer to WPA authenticator data from wpa_init()
  * @conf: Configuration for WPA authenticator
+ * @keep_gtk: Whether to keep the current GTK
+ * Returns: 0 on success, -1 on failure
+ *
+ * keep_gtk is used when the associated stations are kept across the
+ * reconfiguration. The group cipher has not changed in that case and a new
+ * GTK would not be delivered to the stations that already hold the old one.
  */
 int wpa_reconfig(struct wpa_authenticator *wpa_auth,
-		 struct wpa_auth_config *conf)
+		 struct wpa_auth_config *conf, int keep_gtk)
 {
 	struct wpa_group *group;
 	if (wpa_auth == NULL)
@@ -513,6 +519,9 @@ int wpa_reconfig(struct wpa_authenticator *wpa_auth,
 		return -1;
 	}
 
+	if (keep_gtk)
+		return 0;
+
 	/*
 	 * Reinitialize GTK to make sure it is suitable for the new
 	 * configuration.
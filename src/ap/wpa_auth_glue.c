@@ -538,11 +538,11 @@ int hostapd_setup_wpa(struct hostapd_data *hapd)
 }
 
 
-void hostapd_reconfig_wpa(struct hostapd_data *hapd)
+void hostapd_reconfig_wpa(struct hostapd_data *hapd, int keep_gtk)
 {
 	struct wpa_auth_config wpa_auth_conf;
 	hostapd_wpa_auth_conf(hapd->conf, &wpa_auth_conf);
-	wpa_reconfig(hapd->wpa_auth, &wpa_auth_conf);
+	wpa_reconfig(hapd->wpa_auth, &wpa_auth_conf, keep_gtk);
 }
 
 
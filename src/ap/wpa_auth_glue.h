@@ -16,7 +16,7 @@
 #define WPA_AUTH_GLUE_H
 
 int hostapd_setup_wpa(struct hostapd_data *hapd);
-void hostapd_reconfig_wpa(struct hostapd_data *hapd);
+void hostapd_reconfig_wpa(struct hostapd_data *hapd, int keep_gtk);
 void hostapd_deinit_wpa(struct hostapd_data *hapd);
 
 #endif /* WPA_AUTH_GLUE_H */
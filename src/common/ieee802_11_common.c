@@ -306,6 +306,113 @@ int ieee802_11_ie_count(const u8 *ies, size_t ies_len)
 }
 
 
+/**
+ * ieee802_11_ie_slot - Map an element ID to an IE index slot
+ * @eid: Element ID
+ * Returns: Slot number or -1 if the element is not indexed
+ */
+int ieee802_11_ie_slot(u8 eid)
+{
+	switch (eid) {
+	case WLAN_EID_SSID:
+		return IE_SLOT_SSID;
+	case WLAN_EID_SUPP_RATES:
+		return IE_SLOT_SUPP_RATES;
+	case WLAN_EID_DS_PARAMS:
+		return IE_SLOT_DS_PARAMS;
+	case WLAN_EID_HT_CAP:
+		return IE_SLOT_HT_CAP;
+	case WLAN_EID_RSN:
+		return IE_SLOT_RSN;
+	case WLAN_EID_EXT_SUPP_RATES:
+		return IE_SLOT_EXT_SUPP_RATES;
+	case WLAN_EID_MOBILITY_DOMAIN:
+		return IE_SLOT_MOBILITY_DOMAIN;
+	case WLAN_EID_EXT_CAPAB:
+		return IE_SLOT_EXT_CAPAB;
+	default:
+		return -1;
+	}
+}
+
+
+/**
+ * ieee802_11_vendor_ie_slot - Map a vendor IE type to an IE index slot
+ * @vendor_type: Vendor IE type (OUI and OUI type as a 32-bit value)
+ * Returns: Slot number or -1 if the vendor IE type is not indexed
+ */
+int ieee802_11_vendor_ie_slot(u32 vendor_type)
+{
+	switch (vendor_type) {
+	case WPA_IE_VENDOR_TYPE:
+		return IE_SLOT_WPA;
+	case WPS_IE_VENDOR_TYPE:
+		return IE_SLOT_WPS;
+	case P2P_IE_VENDOR_TYPE:
+		return IE_SLOT_P2P;
+	default:
+		return -1;
+	}
+}
+
+
+/**
+ * ieee802_11_ie_index_build - Build an index of commonly used IEs
+ * @idx: Index to fill in
+ * @ies: IE buffer
+ * @ies_len: Length of the IE buffer in octets
+ *
+ * The first instance of each indexed element is recorded so that lookups with
+ * ieee802_11_ie_index_get() return the same element as a linear search of
+ * the buffer. The index is marked invalid if the buffer is too long to be
+ * described with 16-bit offsets.
+ */
+void ieee802_11_ie_index_build(struct ieee802_11_ie_index *idx,
+			       const u8 *ies, size_t ies_len)
+{
+	const u8 *pos, *end;
+	int slot;
+
+	os_memset(idx, 0, sizeof(*idx));
+	if (ies == NULL || ies_len >= 0xffff)
+		return;
+
+	pos = ies;
+	end = ies + ies_len;
+	while (pos + 1 < end) {
+		if (pos + 2 + pos[1] > end)
+			break;
+		if (pos[0] == WLAN_EID_VENDOR_SPECIFIC) {
+			slot = pos[1] >= 4 ?
+				ieee802_11_vendor_ie_slot(WPA_GET_BE32(&pos[2])) :
+				-1;
+		} else
+			slot = ieee802_11_ie_slot(pos[0]);
+		if (slot >= 0 && idx->off[slot] == 0)
+			idx->off[slot] = pos - ies + 1;
+		pos += 2 + pos[1];
+	}
+
+	idx->valid = 1;
+}
+
+
+/**
+ * ieee802_11_ie_index_get - Get an element using an IE index
+ * @idx: Index built with ieee802_11_ie_index_build() for ies
+ * @ies: IE buffer
+ * @slot: Slot from ieee802_11_ie_slot() or ieee802_11_vendor_ie_slot()
+ * Returns: Pointer to the element or %NULL if not present
+ */
+const u8 * ieee802_11_ie_index_get(const struct ieee802_11_ie_index *idx,
+				   const u8 *ies, int slot)
+{
+	if (idx->off[slot] == 0)
+		return NULL;
+	return ies + idx->off[slot] - 1;
+}
+
+
 struct wpabuf * ieee802_11_vendor_ie_concat(const u8 *ies, size_t ies_len,
 					    u32 oui_type)
 {
@@ -73,12 +73,49 @@ struct ieee802_11_elems {
 
 typedef enum { ParseOK = 0, ParseUnknown = 1, ParseFailed = -1 } ParseRes;
 
+/*
+ * Elements that are looked up repeatedly from scan results and BSS entries
+ * (e.g., during network selection and sorting) and are therefore located once
+ * when the IEs are received.
+ */
+enum ieee802_11_ie_slot {
+	IE_SLOT_SSID,
+	IE_SLOT_SUPP_RATES,
+	IE_SLOT_DS_PARAMS,
+	IE_SLOT_HT_CAP,
+	IE_SLOT_RSN,
+	IE_SLOT_EXT_SUPP_RATES,
+	IE_SLOT_MOBILITY_DOMAIN,
+	IE_SLOT_EXT_CAPAB,
+	IE_SLOT_WPA,
+	IE_SLOT_WPS,
+	IE_SLOT_P2P,
+	NUM_IE_SLOTS
+};
+
+/**
+ * struct ieee802_11_ie_index - Offsets of the first instance of indexed IEs
+ * @off: Offset + 1 of the element from the start of the IE buffer; 0 if the
+ *	element is not present
+ * @valid: Whether the index has been built for the current IE buffer
+ */
+struct ieee802_11_ie_index {
+	u16 off[NUM_IE_SLOTS];
+	u8 valid;
+};
+
 ParseRes ieee802_11_parse_elems(const u8 *start, size_t len,
 				struct ieee802_11_elems *elems,
 				int show_errors);
 int ieee802_11_ie_count(const u8 *ies, size_t ies_len);
 struct wpabuf * ieee802_11_vendor_ie_concat(const u8 *ies, size_t ies_len,
 					    u32 oui_type);
+void ieee802_11_ie_index_build(struct ieee802_11_ie_index *idx,
+			       const u8 *ies, size_t ies_len);
+int ieee802_11_ie_slot(u8 eid);
+int ieee802_11_vendor_ie_slot(u32 vendor_type);
+const u8 * ieee802_11_ie_index_get(const struct ieee802_11_ie_index *idx,
+				   const u8 *ies, int slot);
 struct ieee80211_hdr;
 const u8 * get_hdr_bssid(const struct ieee80211_hdr *hdr, size_t len);
 
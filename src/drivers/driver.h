@@ -26,6 +26,7 @@
 #define WPA_SUPPLICANT_DRIVER_VERSION 4
 
 #include "common/defs.h"
+#include "common/ieee802_11_common.h"
 
 #define HOSTAPD_CHAN_DISABLED 0x00000001
 #define HOSTAPD_CHAN_PASSIVE_SCAN 0x00000002
@@ -140,6 +141,9 @@ struct hostapd_hw_modes {
  * ago the last Beacon or Probe Response frame was received)
  * @ie_len: length of the following IE field in octets
  * @beacon_ie_len: length of the following Beacon IE field in octets
+ * @ie_index: index of commonly used IEs within the first IE field; built by
+ * wpa_supplicant when the results are fetched (drivers do not need to fill
+ * this in)
  *
  * This structure is used as a generic format for scan results from the
  * driver. Each driver interface implementation is responsible for converting
@@ -163,6 +167,7 @@ struct wpa_scan_res {
 	unsigned int age;
 	size_t ie_len;
 	size_t beacon_ie_len;
+	struct ieee802_11_ie_index ie_index;
 	/*
 	 * Followed by ie_len octets of IEs from Probe Response frame (or if
 	 * the driver does not indicate source of IEs, these may also be from
@@ -1529,6 +1534,25 @@ struct wpa_driver_ops {
 	int (*read_sta_data)(void *priv, struct hostap_sta_driver_data *data,
 			     const u8 *addr);
 
+	/**
+	 * read_all_sta_data - Fetch data for all stations (AP only)
+	 * @priv: Private driver interface data
+	 * @cb: Callback function to call for each station
+	 * @ctx: Context data for the callback
+	 * Returns: 0 on success, -1 on failure
+	 *
+	 * This function can be used to fetch the same information as
+	 * read_sta_data() for all stations of the interface with a single
+	 * request to the driver instead of one request per station. The
+	 * callback function is called once for each station known to the
+	 * driver.
+	 */
+	int (*read_all_sta_data)(void *priv,
+				 void (*cb)(void *ctx, const u8 *addr,
+					    const struct
+					    hostap_sta_driver_data *data),
+				 void *ctx);
+
 	/**
 	 * hapd_send_eapol - Send an EAPOL packet (AP only)
 	 * @priv: private driver interface data
@@ -2452,6 +2476,19 @@ struct wpa_driver_ops {
 	 */
 	void (*poll_client)(void *priv, const u8 *own_addr,
 			    const u8 *addr, int qos);
+
+	/**
+	 * driver_stats - Fetch driver interface statistics
+	 * @priv: Private driver interface data
+	 * @buf: Buffer for the text formatted statistics
+	 * @buflen: Maximum buffer length
+	 * Returns: Number of bytes written to buf or -1 on failure
+	 *
+	 * This optional function can be used to report driver wrapper specific
+	 * counters (e.g., events lost due to event socket overruns) in
+	 * name=value format, one entry per line.
+	 */
+	int (*driver_stats)(void *priv, char *buf, size_t buflen);
 };
 
 
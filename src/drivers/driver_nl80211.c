@@ -48,6 +48,8 @@
 #define nl_handle nl_sock
 #define nl80211_handle_alloc nl_socket_alloc_cb
 #define nl80211_handle_destroy nl_socket_free
+/* libnl 2.0 reports ENOBUFS from recvmsg() as NLE_NOMEM */
+#define NL80211_ERR_NOBUFS NLE_NOMEM
 #else
 /*
  * libnl 1.1 has a bug, it tries to allocate socket numbers densely
@@ -99,8 +101,20 @@ static inline int __genl_ctrl_alloc_cache(struct nl_handle *h,
 	return 0;
 }
 #define genl_ctrl_alloc_cache __genl_ctrl_alloc_cache
+#define nl_socket_set_buffer_size nl_set_buffer_size
+#define NL80211_ERR_NOBUFS ENOBUFS
 #endif /* CONFIG_LIBNL20 */
 
+/*
+ * Receive buffer size for the event sockets. A burst of events (e.g., a large
+ * number of stations associating at the same time) can overrun the default
+ * socket buffer in which case the kernel drops the messages.
+ */
+#define NL80211_EVENT_SOCK_RCVBUF (256 * 1024)
+
+/* Maximum number of messages to process per event socket read callback */
+#define NL80211_EVENT_BATCH 32
+
 
 struct nl80211_handles {
 	struct nl_handle *handle;
@@ -150,6 +164,16 @@ static void nl_destroy_handles(struct nl80211_handles *handles)
 }
 
 
+static void nl80211_set_event_sock_buffer(struct nl80211_handles *handles,
+					  const char *dbg)
+{
+	if (nl_socket_set_buffer_size(handles->handle,
+				      NL80211_EVENT_SOCK_RCVBUF, 0) < 0)
+		wpa_printf(MSG_DEBUG, "nl80211: Failed to set receive buffer "
+			   "size for %s socket", dbg);
+}
+
+
 #ifndef IFF_LOWER_UP
 #define IFF_LOWER_UP   0x10000         /* driver signals L1 up         */
 #endif
@@ -186,6 +210,16 @@ struct i802_bss {
 	unsigned int beacon_set:1;
 	unsigned int added_if_into_bridge:1;
 	unsigned int added_bridge:1;
+
+	/*
+	 * Per-BSS socket for management frames registered with
+	 * NL80211_CMD_REGISTER_FRAME on this interface. The kernel delivers
+	 * the frames only to the registering socket, so no ifindex lookup is
+	 * needed when processing them.
+	 */
+	struct nl80211_handles nl_mgmt;
+	unsigned int mgmt_rx;
+	unsigned int mgmt_overruns;
 };
 
 struct wpa_driver_nl80211_data {
@@ -206,7 +240,9 @@ struct wpa_driver_nl80211_data {
 
 	int scan_complete_events;
 
-	struct nl80211_handles nl_event, nl_preq;
+	struct nl80211_handles nl_event;
+	unsigned int events_rx;
+	unsigned int event_overruns;
 
 	u8 auth_bssid[ETH_ALEN];
 	u8 bssid[ETH_ALEN];
@@ -269,6 +305,8 @@ static int nl80211_send_frame_cmd(struct wpa_driver_nl80211_data *drv,
 				  const u8 *buf, size_t buf_len, u64 *cookie,
 				  int no_cck);
 static int wpa_driver_nl80211_probe_req_report(void *priv, int report);
+static int nl80211_mgmt_subscribe_ap(struct i802_bss *bss);
+static void nl80211_mgmt_unsubscribe(struct i802_bss *bss);
 
 #ifdef HOSTAPD
 static void add_ifidx(struct wpa_driver_nl80211_data *drv, int ifidx);
@@ -1096,8 +1134,8 @@ static void mlme_event(struct wpa_driver_nl80211_data *drv,
 	}
 
 	wpa_printf(MSG_DEBUG, "nl80211: MLME event %d", cmd);
-	wpa_hexdump(MSG_MSGDUMP, "nl80211: MLME event frame",
-		    nla_data(frame), nla_len(frame));
+	wpa_hexdump_hot(MSG_MSGDUMP, "nl80211: MLME event frame",
+			nla_data(frame), nla_len(frame));
 
 	switch (cmd) {
 	case NL80211_CMD_AUTHENTICATE:
@@ -1697,6 +1735,8 @@ static int process_event(struct nl_msg *msg, void *arg)
 	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
 		  genlmsg_attrlen(gnlh, 0), NULL);
 
+	drv->events_rx++;
+
 	if (tb[NL80211_ATTR_IFINDEX]) {
 		int ifindex = nla_get_u32(tb[NL80211_ATTR_IFINDEX]);
 		if (ifindex != drv->ifindex && !have_ifidx(drv, ifindex)) {
@@ -1820,6 +1860,99 @@ static int process_event(struct nl_msg *msg, void *arg)
 }
 
 
+static int process_bss_event(struct nl_msg *msg, void *arg)
+{
+	struct i802_bss *bss = arg;
+	struct wpa_driver_nl80211_data *drv = bss->drv;
+	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	union wpa_event_data event;
+
+	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
+		  genlmsg_attrlen(gnlh, 0), NULL);
+
+	bss->mgmt_rx++;
+
+	if (gnlh->cmd != NL80211_CMD_FRAME || tb[NL80211_ATTR_FRAME] == NULL) {
+		wpa_printf(MSG_DEBUG, "nl80211: Ignored unexpected event "
+			   "(cmd=%d) on %s management socket",
+			   gnlh->cmd, bss->ifname);
+		return NL_SKIP;
+	}
+
+	if (!is_ap_interface(drv->nlmode)) {
+		/* Probe Request reporting for P2P Listen */
+		mlme_event(drv, gnlh->cmd, tb[NL80211_ATTR_FRAME],
+			   tb[NL80211_ATTR_MAC], tb[NL80211_ATTR_TIMED_OUT],
+			   tb[NL80211_ATTR_WIPHY_FREQ], tb[NL80211_ATTR_ACK],
+			   tb[NL80211_ATTR_COOKIE]);
+		return NL_SKIP;
+	}
+
+	/*
+	 * Deliver all frames as EVENT_RX_MGMT in AP mode to match the frames
+	 * received through the monitor interface.
+	 */
+	wpa_hexdump_hot(MSG_MSGDUMP, "nl80211: Management frame",
+			nla_data(tb[NL80211_ATTR_FRAME]),
+			nla_len(tb[NL80211_ATTR_FRAME]));
+	os_memset(&event, 0, sizeof(event));
+	event.rx_mgmt.frame = nla_data(tb[NL80211_ATTR_FRAME]);
+	event.rx_mgmt.frame_len = nla_len(tb[NL80211_ATTR_FRAME]);
+	/*
+	 * Unlike the radiotap header of the monitor interface, the frame event
+	 * reports the signal strength, but not the data rate.
+	 */
+	if (tb[NL80211_ATTR_RX_SIGNAL_DBM])
+		event.rx_mgmt.ssi_signal =
+			nla_get_u32(tb[NL80211_ATTR_RX_SIGNAL_DBM]);
+	wpa_supplicant_event(drv->ctx, EVENT_RX_MGMT, &event);
+
+	return NL_SKIP;
+}
+
+
+static int nl80211_sock_pending(int sock)
+{
+	fd_set rfds;
+	struct timeval tv;
+
+	if (sock >= FD_SETSIZE)
+		return 0;
+	FD_ZERO(&rfds);
+	FD_SET(sock, &rfds);
+	tv.tv_sec = 0;
+	tv.tv_usec = 0;
+	return select(sock + 1, &rfds, NULL, NULL, &tv) > 0;
+}
+
+
+/*
+ * Process up to NL80211_EVENT_BATCH messages that are already queued on the
+ * socket instead of returning to eloop after each one. Receive buffer overruns
+ * (ENOBUFS) are counted since they mean that the kernel dropped events.
+ */
+static void nl80211_recv_batch(int sock, struct nl_handle *handle,
+			       struct nl_cb *cb, unsigned int *overruns,
+			       const char *dbg)
+{
+	int i, res;
+
+	for (i = 0; i < NL80211_EVENT_BATCH; i++) {
+		res = nl_recvmsgs(handle, cb);
+		if (res == -NL80211_ERR_NOBUFS) {
+			(*overruns)++;
+			wpa_printf(MSG_INFO, "nl80211: Receive buffer overrun "
+				   "on %s socket - events lost (%u overruns)",
+				   dbg, *overruns);
+		} else if (res < 0)
+			break;
+		if (!nl80211_sock_pending(sock))
+			break;
+	}
+}
+
+
 static void wpa_driver_nl80211_event_receive(int sock, void *eloop_ctx,
 					     void *handle)
 {
@@ -1833,7 +1966,23 @@ static void wpa_driver_nl80211_event_receive(int sock, void *eloop_ctx,
 		return;
 	nl_cb_set(cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM, no_seq_check, NULL);
 	nl_cb_set(cb, NL_CB_VALID, NL_CB_CUSTOM, process_event, drv);
-	nl_recvmsgs(handle, cb);
+	nl80211_recv_batch(sock, handle, cb, &drv->event_overruns, "event");
+	nl_cb_put(cb);
+}
+
+
+static void wpa_driver_nl80211_mgmt_receive(int sock, void *eloop_ctx,
+					    void *handle)
+{
+	struct nl_cb *cb;
+	struct i802_bss *bss = eloop_ctx;
+
+	cb = nl_cb_clone(bss->drv->global->nl_cb);
+	if (!cb)
+		return;
+	nl_cb_set(cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM, no_seq_check, NULL);
+	nl_cb_set(cb, NL_CB_VALID, NL_CB_CUSTOM, process_bss_event, bss);
+	nl80211_recv_batch(sock, handle, cb, &bss->mgmt_overruns, "mgmt");
 	nl_cb_put(cb);
 }
 
@@ -2152,6 +2301,7 @@ static int wpa_driver_nl80211_init_nl(struct wpa_driver_nl80211_data *drv)
 
 	if (nl_create_handles(&drv->nl_event, global->nl_cb, "event"))
 		goto err3;
+	nl80211_set_event_sock_buffer(&drv->nl_event, "event");
 
 	ret = nl_get_multicast_id(drv, "nl80211", "scan");
 	if (ret >= 0)
@@ -2331,10 +2481,11 @@ failed:
 }
 
 
-static int nl80211_register_frame(struct wpa_driver_nl80211_data *drv,
+static int nl80211_register_frame(struct i802_bss *bss,
 				  struct nl_handle *nl_handle,
 				  u16 type, const u8 *match, size_t match_len)
 {
+	struct wpa_driver_nl80211_data *drv = bss->drv;
 	struct nl_msg *msg;
 	int ret = -1;
 
@@ -2344,7 +2495,7 @@ static int nl80211_register_frame(struct wpa_driver_nl80211_data *drv,
 
 	nl80211_cmd(drv, msg, 0, NL80211_CMD_REGISTER_ACTION);
 
-	NLA_PUT_U32(msg, NL80211_ATTR_IFINDEX, drv->ifindex);
+	NLA_PUT_U32(msg, NL80211_ATTR_IFINDEX, bss->ifindex);
 	NLA_PUT_U16(msg, NL80211_ATTR_FRAME_TYPE, type);
 	NLA_PUT(msg, NL80211_ATTR_FRAME_MATCH, match_len, match);
 
@@ -2369,7 +2520,7 @@ static int nl80211_register_action_frame(struct wpa_driver_nl80211_data *drv,
 					 const u8 *match, size_t match_len)
 {
 	u16 type = (WLAN_FC_TYPE_MGMT << 2) | (WLAN_FC_STYPE_ACTION << 4);
-	return nl80211_register_frame(drv, drv->nl_event.handle,
+	return nl80211_register_frame(&drv->first_bss, drv->nl_event.handle,
 				      type, match, match_len);
 }
 
@@ -2538,8 +2689,7 @@ static void wpa_driver_nl80211_deinit(void *priv)
 		l2_packet_deinit(drv->l2);
 #endif /* CONFIG_AP */
 
-	if (drv->nl_preq.handle)
-		wpa_driver_nl80211_probe_req_report(bss, 0);
+	nl80211_mgmt_unsubscribe(bss);
 	if (bss->added_if_into_bridge) {
 		if (linux_br_del_if(drv->global->ioctl_sock, bss->brname,
 				    bss->ifname) < 0)
@@ -5279,7 +5429,7 @@ static int wpa_driver_nl80211_ap(struct wpa_driver_nl80211_data *drv,
 		return -1;
 	}
 
-	if (drv->no_monitor_iface_capab) {
+	if (drv->no_monitor_iface_capab && !drv->first_bss.nl_mgmt.handle) {
 		if (wpa_driver_nl80211_probe_req_report(&drv->first_bss, 1) < 0)
 		{
 			wpa_printf(MSG_DEBUG, "nl80211: Failed to enable "
@@ -5839,15 +5989,22 @@ static int wpa_driver_nl80211_set_mode(struct i802_bss *bss,
 
 done:
 	if (!ret && is_ap_interface(nlmode)) {
-		/* Setup additional AP mode functionality if needed */
+		/*
+		 * Setup additional AP mode functionality if needed. The monitor
+		 * interface is still used for frame injection, TX status, and
+		 * data frames from unassociated stations even when management
+		 * frames are received through nl80211.
+		 */
+		if (!was_ap)
+			nl80211_mgmt_subscribe_ap(bss);
 		if (!drv->no_monitor_iface_capab && drv->monitor_ifidx < 0 &&
 		    nl80211_create_monitor_interface(drv) &&
 		    !drv->no_monitor_iface_capab)
 			return -1;
 	} else if (!ret && !is_ap_interface(nlmode)) {
 		/* Remove additional AP mode functionality */
-		if (was_ap && drv->no_monitor_iface_capab)
-			wpa_driver_nl80211_probe_req_report(bss, 0);
+		if (was_ap)
+			nl80211_mgmt_unsubscribe(bss);
 		nl80211_remove_monitor_interface(drv);
 		bss->beacon_set = 0;
 	}
@@ -6104,11 +6261,9 @@ static int i802_flush(void *priv)
 }
 
 
-static int get_sta_handler(struct nl_msg *msg, void *arg)
+static int nl80211_parse_sta_info(struct nlattr **tb,
+				  struct hostap_sta_driver_data *data)
 {
-	struct nlattr *tb[NL80211_ATTR_MAX + 1];
-	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
-	struct hostap_sta_driver_data *data = arg;
 	struct nlattr *stats[NL80211_STA_INFO_MAX + 1];
 	static struct nla_policy stats_policy[NL80211_STA_INFO_MAX + 1] = {
 		[NL80211_STA_INFO_INACTIVE_TIME] = { .type = NLA_U32 },
@@ -6118,24 +6273,15 @@ static int get_sta_handler(struct nl_msg *msg, void *arg)
 		[NL80211_STA_INFO_TX_PACKETS] = { .type = NLA_U32 },
 	};
 
-	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
-		  genlmsg_attrlen(gnlh, 0), NULL);
-
-	/*
-	 * TODO: validate the interface and mac address!
-	 * Otherwise, there's a race condition as soon as
-	 * the kernel starts sending station notifications.
-	 */
-
 	if (!tb[NL80211_ATTR_STA_INFO]) {
 		wpa_printf(MSG_DEBUG, "sta stats missing!");
-		return NL_SKIP;
+		return -1;
 	}
 	if (nla_parse_nested(stats, NL80211_STA_INFO_MAX,
 			     tb[NL80211_ATTR_STA_INFO],
 			     stats_policy)) {
 		wpa_printf(MSG_DEBUG, "failed to parse nested attributes!");
-		return NL_SKIP;
+		return -1;
 	}
 
 	if (stats[NL80211_STA_INFO_INACTIVE_TIME])
@@ -6152,6 +6298,27 @@ static int get_sta_handler(struct nl_msg *msg, void *arg)
 		data->tx_packets =
 			nla_get_u32(stats[NL80211_STA_INFO_TX_PACKETS]);
 
+	return 0;
+}
+
+
+static int get_sta_handler(struct nl_msg *msg, void *arg)
+{
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
+	struct hostap_sta_driver_data *data = arg;
+
+	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
+		  genlmsg_attrlen(gnlh, 0), NULL);
+
+	/*
+	 * TODO: validate the interface and mac address!
+	 * Otherwise, there's a race condition as soon as
+	 * the kernel starts sending station notifications.
+	 */
+
+	nl80211_parse_sta_info(tb, data);
+
 	return NL_SKIP;
 }
 
@@ -6178,6 +6345,68 @@ static int i802_read_sta_data(void *priv, struct hostap_sta_driver_data *data,
 }
 
 
+struct nl80211_sta_dump_arg {
+	int ifindex;
+	void (*cb)(void *ctx, const u8 *addr,
+		   const struct hostap_sta_driver_data *data);
+	void *ctx;
+};
+
+
+static int get_sta_dump_handler(struct nl_msg *msg, void *arg)
+{
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
+	struct nl80211_sta_dump_arg *dump = arg;
+	struct hostap_sta_driver_data data;
+
+	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
+		  genlmsg_attrlen(gnlh, 0), NULL);
+
+	if (!tb[NL80211_ATTR_MAC] ||
+	    (tb[NL80211_ATTR_IFINDEX] &&
+	     (int) nla_get_u32(tb[NL80211_ATTR_IFINDEX]) != dump->ifindex))
+		return NL_SKIP;
+
+	os_memset(&data, 0, sizeof(data));
+	data.inactive_msec = (unsigned long) -1;
+	if (nl80211_parse_sta_info(tb, &data) == 0)
+		dump->cb(dump->ctx, nla_data(tb[NL80211_ATTR_MAC]), &data);
+
+	return NL_SKIP;
+}
+
+
+static int i802_read_all_sta_data(void *priv,
+				  void (*cb)(void *ctx, const u8 *addr,
+					     const struct
+					     hostap_sta_driver_data *data),
+				  void *ctx)
+{
+	struct i802_bss *bss = priv;
+	struct wpa_driver_nl80211_data *drv = bss->drv;
+	struct nl80211_sta_dump_arg dump;
+	struct nl_msg *msg;
+
+	dump.ifindex = if_nametoindex(bss->ifname);
+	dump.cb = cb;
+	dump.ctx = ctx;
+
+	msg = nlmsg_alloc();
+	if (!msg)
+		return -ENOMEM;
+
+	nl80211_cmd(drv, msg, NLM_F_DUMP, NL80211_CMD_GET_STATION);
+
+	NLA_PUT_U32(msg, NL80211_ATTR_IFINDEX, dump.ifindex);
+
+	return send_and_recv_msgs(drv, msg, get_sta_dump_handler, &dump);
+ nla_put_failure:
+	nlmsg_free(msg);
+	return -ENOBUFS;
+}
+
+
 static int i802_set_tx_queue_params(void *priv, int queue, int aifs,
 				    int cw_min, int cw_max, int burst_time)
 {
@@ -6752,6 +6981,7 @@ static int wpa_driver_nl80211_if_add(void *priv, enum wpa_driver_if_type type,
 		drv->first_bss.next = new_bss;
 		if (drv_priv)
 			*drv_priv = new_bss;
+		nl80211_mgmt_subscribe_ap(new_bss);
 	}
 #endif /* HOSTAPD */
 
@@ -6803,6 +7033,7 @@ static int wpa_driver_nl80211_if_remove(void *priv,
 		for (tbss = &drv->first_bss; tbss; tbss = tbss->next) {
 			if (tbss->next == bss) {
 				tbss->next = bss->next;
+				nl80211_mgmt_unsubscribe(bss);
 				os_free(bss);
 				bss = NULL;
 				break;
@@ -7017,43 +7248,122 @@ nla_put_failure:
 }
 
 
+static int nl80211_mgmt_create(struct i802_bss *bss)
+{
+	if (nl_create_handles(&bss->nl_mgmt, bss->drv->global->nl_cb, "mgmt"))
+		return -1;
+	nl80211_set_event_sock_buffer(&bss->nl_mgmt, "mgmt");
+	return 0;
+}
+
+
+static void nl80211_mgmt_register_read(struct i802_bss *bss)
+{
+	eloop_register_read_sock(nl_socket_get_fd(bss->nl_mgmt.handle),
+				 wpa_driver_nl80211_mgmt_receive, bss,
+				 bss->nl_mgmt.handle);
+}
+
+
+/**
+ * nl80211_mgmt_subscribe_ap - Register for AP mode management frames
+ * @bss: BSS (interface) for which the frames are registered
+ * Returns: 0 on success, -1 on failure
+ *
+ * The frames that hostapd needs to process for the BSS are registered on a
+ * separate netlink socket for the interface, so that they are received
+ * without going through the monitor interface and the frames for each BSS
+ * are delivered on their own socket. Action frames are optional since some
+ * of them may already have been registered for other uses (e.g., P2P) and
+ * those will still be received through the existing registration.
+ */
+static int nl80211_mgmt_subscribe_ap(struct i802_bss *bss)
+{
+	static const u16 stypes[] = {
+		WLAN_FC_STYPE_AUTH,
+		WLAN_FC_STYPE_ASSOC_REQ,
+		WLAN_FC_STYPE_REASSOC_REQ,
+		WLAN_FC_STYPE_DISASSOC,
+		WLAN_FC_STYPE_DEAUTH,
+		WLAN_FC_STYPE_PROBE_REQ,
+	};
+	size_t i;
+
+	if (bss->nl_mgmt.handle)
+		nl80211_mgmt_unsubscribe(bss);
+
+	if (nl80211_mgmt_create(bss))
+		return -1;
+
+	for (i = 0; i < sizeof(stypes) / sizeof(stypes[0]); i++) {
+		if (nl80211_register_frame(bss, bss->nl_mgmt.handle,
+					   (WLAN_FC_TYPE_MGMT << 2) |
+					   (stypes[i] << 4),
+					   NULL, 0) < 0)
+			goto out_err;
+	}
+
+	if (nl80211_register_frame(bss, bss->nl_mgmt.handle,
+				   (WLAN_FC_TYPE_MGMT << 2) |
+				   (WLAN_FC_STYPE_ACTION << 4),
+				   NULL, 0) < 0)
+		wpa_printf(MSG_DEBUG, "nl80211: Action frames not registered "
+			   "for AP mode on %s", bss->ifname);
+
+	nl80211_mgmt_register_read(bss);
+	wpa_printf(MSG_DEBUG, "nl80211: Receiving AP mode management frames "
+		   "for %s through nl80211", bss->ifname);
+
+	return 0;
+
+out_err:
+	wpa_printf(MSG_DEBUG, "nl80211: Could not register AP mode "
+		   "management frames for %s", bss->ifname);
+	nl_destroy_handles(&bss->nl_mgmt);
+	return -1;
+}
+
+
+static void nl80211_mgmt_unsubscribe(struct i802_bss *bss)
+{
+	if (bss->nl_mgmt.handle == NULL)
+		return;
+	/* Closing the socket removes the frame registrations */
+	eloop_unregister_read_sock(nl_socket_get_fd(bss->nl_mgmt.handle));
+	nl_destroy_handles(&bss->nl_mgmt);
+}
+
+
 static int wpa_driver_nl80211_probe_req_report(void *priv, int report)
 {
 	struct i802_bss *bss = priv;
-	struct wpa_driver_nl80211_data *drv = bss->drv;
 
 	if (!report) {
-		if (drv->nl_preq.handle) {
-			eloop_unregister_read_sock(
-				nl_socket_get_fd(drv->nl_preq.handle));
-			nl_destroy_handles(&drv->nl_preq);
-		}
+		nl80211_mgmt_unsubscribe(bss);
 		return 0;
 	}
 
-	if (drv->nl_preq.handle) {
+	if (bss->nl_mgmt.handle) {
 		wpa_printf(MSG_DEBUG, "nl80211: Probe Request reporting "
 			   "already on!");
 		return 0;
 	}
 
-	if (nl_create_handles(&drv->nl_preq, drv->global->nl_cb, "preq"))
+	if (nl80211_mgmt_create(bss))
 		return -1;
 
-	if (nl80211_register_frame(drv, drv->nl_preq.handle,
+	if (nl80211_register_frame(bss, bss->nl_mgmt.handle,
 				   (WLAN_FC_TYPE_MGMT << 2) |
 				   (WLAN_FC_STYPE_PROBE_REQ << 4),
 				   NULL, 0) < 0)
 		goto out_err;
 
-	eloop_register_read_sock(nl_socket_get_fd(drv->nl_preq.handle),
-				 wpa_driver_nl80211_event_receive, drv,
-				 drv->nl_preq.handle);
+	nl80211_mgmt_register_read(bss);
 
 	return 0;
 
  out_err:
-	nl_destroy_handles(&drv->nl_preq);
+	nl_destroy_handles(&bss->nl_mgmt);
 	return -1;
 }
 
@@ -7549,6 +7859,39 @@ nla_put_failure:
 #endif /* CONFIG TDLS */
 
 
+static int nl80211_driver_stats(void *priv, char *buf, size_t buflen)
+{
+	struct i802_bss *bss = priv;
+	struct wpa_driver_nl80211_data *drv = bss->drv;
+	struct i802_bss *tbss;
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+
+	ret = os_snprintf(pos, end - pos,
+			  "events=%u\n"
+			  "event_overruns=%u\n",
+			  drv->events_rx, drv->event_overruns);
+	if (ret < 0 || ret >= end - pos)
+		return pos - buf;
+	pos += ret;
+
+	for (tbss = &drv->first_bss; tbss; tbss = tbss->next) {
+		ret = os_snprintf(pos, end - pos,
+				  "%s_mgmt_socket=%d\n"
+				  "%s_mgmt_frames=%u\n"
+				  "%s_mgmt_overruns=%u\n",
+				  tbss->ifname, tbss->nl_mgmt.handle != NULL,
+				  tbss->ifname, tbss->mgmt_rx,
+				  tbss->ifname, tbss->mgmt_overruns);
+		if (ret < 0 || ret >= end - pos)
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
+
+
 const struct wpa_driver_ops wpa_driver_nl80211_ops = {
 	.name = "nl80211",
 	.desc = "Linux nl80211/cfg80211",
@@ -7589,6 +7932,7 @@ const struct wpa_driver_ops wpa_driver_nl80211_ops = {
 	.get_seqnum = i802_get_seqnum,
 	.flush = i802_flush,
 	.read_sta_data = i802_read_sta_data,
+	.read_all_sta_data = i802_read_all_sta_data,
 	.get_inact_sec = i802_get_inact_sec,
 	.sta_clear_stats = i802_sta_clear_stats,
 	.set_rts = i802_set_rts,
@@ -7619,6 +7963,7 @@ const struct wpa_driver_ops wpa_driver_nl80211_ops = {
 	.flush_pmkid = nl80211_flush_pmkid,
 	.set_rekey_info = nl80211_set_rekey_info,
 	.poll_client = nl80211_poll_client,
+	.driver_stats = nl80211_driver_stats,
 #ifdef CONFIG_TDLS
 	.send_tdls_mgmt = nl80211_send_tdls_mgmt,
 	.tdls_oper = nl80211_tdls_oper,
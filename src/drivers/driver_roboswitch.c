@@ -226,6 +226,8 @@ static int wpa_driver_roboswitch_set_param(void *priv, const char *param)
 		}
 		*sep = '\0';
 		l2_packet_get_own_addr(drv->l2, drv->own_addr);
+		/* Only EAPOL frames are of interest on this interface */
+		l2_packet_set_rx_filter(drv->l2, ETH_P_EAPOL);
 	} else {
 		wpa_printf(MSG_DEBUG, "%s: Ignoring unicast frames", __func__);
 		drv->l2 = NULL;
@@ -31,6 +31,7 @@
 #include "common.h"
 #include "eloop.h"
 #include "driver.h"
+#include "l2_packet/l2_packet.h"
 
 #ifdef _MSC_VER
 #pragma pack(push, 1)
@@ -54,7 +55,7 @@ struct wpa_driver_wired_data {
 	char ifname[IFNAMSIZ + 1];
 	void *ctx;
 
-	int sock; /* raw packet socket for driver access */
+	struct l2_packet_data *l2; /* EAPOL frames for driver access */
 	int dhcp_sock; /* socket for dhcp packets */
 	int use_pae_group_addr;
 
@@ -116,11 +117,11 @@ static int wired_multicast_membership(int sock, int ifindex,
 
 
 #ifdef __linux__
-static void handle_data(void *ctx, unsigned char *buf, size_t len)
+static void handle_data(void *ctx, const u8 *buf, size_t len)
 {
 #ifdef HOSTAPD
-	struct ieee8023_hdr *hdr;
-	u8 *pos, *sa;
+	const struct ieee8023_hdr *hdr;
+	const u8 *pos, *sa;
 	size_t left;
 	union wpa_event_data event;
 
@@ -132,7 +133,7 @@ static void handle_data(void *ctx, unsigned char *buf, size_t len)
 		return;
 	}
 
-	hdr = (struct ieee8023_hdr *) buf;
+	hdr = (const struct ieee8023_hdr *) buf;
 
 	switch (ntohs(hdr->ethertype)) {
 		case ETH_P_PAE:
@@ -142,7 +143,7 @@ static void handle_data(void *ctx, unsigned char *buf, size_t len)
 			event.new_sta.addr = sa;
 			wpa_supplicant_event(ctx, EVENT_NEW_STA, &event);
 
-			pos = (u8 *) (hdr + 1);
+			pos = (const u8 *) (hdr + 1);
 			left = len - sizeof(*hdr);
 			drv_event_eapol_rx(ctx, sa, pos, left);
 		break;
@@ -156,18 +157,10 @@ static void handle_data(void *ctx, unsigned char *buf, size_t len)
 }
 
 
-static void handle_read(int sock, void *eloop_ctx, void *sock_ctx)
+static void handle_read(void *ctx, const u8 *src_addr, const u8 *buf,
+			size_t len)
 {
-	int len;
-	unsigned char buf[3000];
-
-	len = recv(sock, buf, sizeof(buf), 0);
-	if (len < 0) {
-		perror("recv");
-		return;
-	}
-
-	handle_data(eloop_ctx, buf, len);
+	handle_data(ctx, buf, len);
 }
 
 
@@ -208,41 +201,30 @@ static int wired_init_sockets(struct wpa_driver_wired_data *drv, u8 *own_addr)
 {
 #ifdef __linux__
 	struct ifreq ifr;
-	struct sockaddr_ll addr;
 	struct sockaddr_in addr2;
 	int n = 1;
 
-	drv->sock = socket(PF_PACKET, SOCK_RAW, htons(ETH_P_PAE));
-	if (drv->sock < 0) {
-		perror("socket[PF_PACKET,SOCK_RAW]");
-		return -1;
-	}
-
-	if (eloop_register_read_sock(drv->sock, handle_read, drv->ctx, NULL)) {
-		printf("Could not register read socket\n");
+	/*
+	 * EAPOL frames are received through l2_packet, so that the memory
+	 * mapped receive ring (CONFIG_L2_PACKET_MMAP) and the in-kernel
+	 * filter for frames addressed to other hosts are used.
+	 */
+	drv->l2 = l2_packet_init(drv->ifname, NULL, ETH_P_PAE, handle_read,
+				 drv->ctx, 1);
+	if (drv->l2 == NULL)
 		return -1;
-	}
-
-	os_memset(&ifr, 0, sizeof(ifr));
-	os_strlcpy(ifr.ifr_name, drv->ifname, sizeof(ifr.ifr_name));
-	if (ioctl(drv->sock, SIOCGIFINDEX, &ifr) != 0) {
-		perror("ioctl(SIOCGIFINDEX)");
-		return -1;
-	}
+	l2_packet_set_rx_filter(drv->l2, ETH_P_PAE);
 
-	os_memset(&addr, 0, sizeof(addr));
-	addr.sll_family = AF_PACKET;
-	addr.sll_ifindex = ifr.ifr_ifindex;
-	wpa_printf(MSG_DEBUG, "Opening raw packet socket for ifindex %d",
-		   addr.sll_ifindex);
-
-	if (bind(drv->sock, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
-		perror("bind");
+	/* packet socket for PAE group address membership */
+	drv->pf_sock = socket(PF_PACKET, SOCK_DGRAM, 0);
+	if (drv->pf_sock < 0) {
+		perror("socket[PF_PACKET,SOCK_DGRAM]");
 		return -1;
 	}
 
 	/* filter multicast address */
-	if (wired_multicast_membership(drv->sock, ifr.ifr_ifindex,
+	if (wired_multicast_membership(drv->pf_sock,
+				       if_nametoindex(drv->ifname),
 				       pae_group_addr, 1) < 0) {
 		wpa_printf(MSG_ERROR, "wired: Failed to add multicast group "
 			   "membership");
@@ -251,7 +233,7 @@ static int wired_init_sockets(struct wpa_driver_wired_data *drv, u8 *own_addr)
 
 	os_memset(&ifr, 0, sizeof(ifr));
 	os_strlcpy(ifr.ifr_name, drv->ifname, sizeof(ifr.ifr_name));
-	if (ioctl(drv->sock, SIOCGIFHWADDR, &ifr) != 0) {
+	if (ioctl(drv->pf_sock, SIOCGIFHWADDR, &ifr) != 0) {
 		perror("ioctl(SIOCGIFHWADDR)");
 		return -1;
 	}
@@ -338,11 +320,10 @@ static int wired_send_eapol(void *priv, const u8 *addr,
 	pos = (u8 *) (hdr + 1);
 	os_memcpy(pos, data, data_len);
 
-	res = send(drv->sock, (u8 *) hdr, len, 0);
+	res = l2_packet_send(drv->l2, hdr->dest, ETH_P_PAE, (u8 *) hdr, len);
 	os_free(hdr);
 
 	if (res < 0) {
-		perror("wired_send_eapol: send");
 		printf("wired_send_eapol - packet len: %lu - failed\n",
 		       (unsigned long) len);
 	}
@@ -351,6 +332,24 @@ static int wired_send_eapol(void *priv, const u8 *addr,
 }
 
 
+static void wired_driver_hapd_deinit(void *priv)
+{
+	struct wpa_driver_wired_data *drv = priv;
+
+	l2_packet_deinit(drv->l2);
+
+	if (drv->dhcp_sock >= 0) {
+		eloop_unregister_read_sock(drv->dhcp_sock);
+		close(drv->dhcp_sock);
+	}
+
+	if (drv->pf_sock >= 0)
+		close(drv->pf_sock);
+
+	os_free(drv);
+}
+
+
 static void * wired_driver_hapd_init(struct hostapd_data *hapd,
 				     struct wpa_init_params *params)
 {
@@ -365,9 +364,11 @@ static void * wired_driver_hapd_init(struct hostapd_data *hapd,
 	drv->ctx = hapd;
 	os_strlcpy(drv->ifname, params->ifname, sizeof(drv->ifname));
 	drv->use_pae_group_addr = params->use_pae_group_addr;
+	drv->dhcp_sock = -1;
+	drv->pf_sock = -1;
 
 	if (wired_init_sockets(drv, params->own_addr)) {
-		os_free(drv);
+		wired_driver_hapd_deinit(drv);
 		return NULL;
 	}
 
@@ -375,20 +376,6 @@ static void * wired_driver_hapd_init(struct hostapd_data *hapd,
 }
 
 
-static void wired_driver_hapd_deinit(void *priv)
-{
-	struct wpa_driver_wired_data *drv = priv;
-
-	if (drv->sock >= 0)
-		close(drv->sock);
-
-	if (drv->dhcp_sock >= 0)
-		close(drv->dhcp_sock);
-
-	os_free(drv);
-}
-
-
 static int wpa_driver_wired_get_ssid(void *priv, u8 *ssid)
 {
 	ssid[0] = 0;
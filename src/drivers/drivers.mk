@@ -24,6 +24,9 @@ endif
 ifdef CONFIG_DRIVER_WIRED
 DRV_CFLAGS += -DCONFIG_DRIVER_WIRED
 DRV_OBJS += src/drivers/driver_wired.c
+ifndef CONFIG_L2_PACKET
+CONFIG_L2_PACKET=linux
+endif
 endif
 
 ifdef CONFIG_DRIVER_MADWIFI
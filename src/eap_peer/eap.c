@@ -154,6 +154,8 @@ SM_STATE(EAP, INITIALIZE)
 	os_free(sm->eapKeyData);
 	sm->eapKeyData = NULL;
 	sm->eapKeyAvailable = FALSE;
+	os_memset(&sm->tls_start, 0, sizeof(sm->tls_start));
+	sm->tls_time = 0;
 	eapol_set_bool(sm, EAPOL_eapRestart, FALSE);
 	sm->lastId = -1; /* new session - make sure this does not match with
 			  * the first EAP-Packet */
@@ -1925,6 +1927,20 @@ int eap_key_available(struct eap_sm *sm)
 }
 
 
+/**
+ * eap_get_tls_time - Get TLS handshake duration
+ * @sm: Pointer to EAP state machine allocated with eap_peer_sm_init()
+ * Returns: Duration of the TLS handshake of the current authentication in
+ * milliseconds or 0 if no TLS handshake was completed
+ *
+ * For tunneled methods, this is the duration of the outer TLS handshake.
+ */
+unsigned int eap_get_tls_time(struct eap_sm *sm)
+{
+	return sm ? sm->tls_time : 0;
+}
+
+
 /**
  * eap_notify_success - Notify EAP state machine about external success trigger
  * @sm: Pointer to EAP state machine allocated with eap_peer_sm_init()
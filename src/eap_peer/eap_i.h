@@ -335,6 +335,9 @@ struct eap_sm {
 	struct wps_context *wps;
 
 	int prev_failure;
+
+	struct os_time tls_start; /* start of the (outer) TLS handshake */
+	unsigned int tls_time; /* TLS handshake duration in ms */
 };
 
 const u8 * eap_get_config_identity(struct eap_sm *sm, size_t *len);
@@ -446,12 +446,29 @@ static int eap_tls_process_input(struct eap_sm *sm, struct eap_ssl_data *data,
 		wpabuf_free(data->tls_out);
 		WPA_ASSERT(data->tls_out == NULL);
 	}
+	if (sm->tls_time == 0 && sm->tls_start.sec == 0 &&
+	    !tls_connection_established(sm->ssl_ctx, data->conn))
+		os_get_reltime(&sm->tls_start);
+
 	appl_data = NULL;
 	data->tls_out = tls_connection_handshake(sm->ssl_ctx, data->conn,
 						 msg, &appl_data);
 
 	eap_peer_tls_reset_input(data);
 
+	if (sm->tls_start.sec &&
+	    tls_connection_established(sm->ssl_ctx, data->conn)) {
+		struct os_time now, diff;
+		os_get_reltime(&now);
+		os_time_sub(&now, &sm->tls_start, &diff);
+		sm->tls_time = diff.sec * 1000 + diff.usec / 1000;
+		if (sm->tls_time == 0)
+			sm->tls_time = 1;
+		os_memset(&sm->tls_start, 0, sizeof(sm->tls_start));
+		wpa_printf(MSG_DEBUG, "SSL: TLS handshake completed in %u ms",
+			   sm->tls_time);
+	}
+
 	if (appl_data &&
 	    tls_connection_established(sm->ssl_ctx, data->conn) &&
 	    !tls_connection_get_failed(sm->ssl_ctx, data->conn)) {
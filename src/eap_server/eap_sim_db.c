@@ -23,22 +23,56 @@
 
 #include "includes.h"
 #include <sys/un.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 
 #include "common.h"
 #include "crypto/random.h"
 #include "eap_common/eap_sim_common.h"
 #include "eap_server/eap_sim_db.h"
 #include "eloop.h"
+#include "list.h"
+
+/* Maximum number of GSM triplets requested from the gateway at a time */
+#define EAP_SIM_DB_MAX_TRIPLETS 12
+
+/* Pending requests without a response are dropped after this many seconds */
+#define EAP_SIM_DB_PENDING_TIMEOUT 60
+
+/* Maximum number of pending requests */
+#define EAP_SIM_DB_MAX_PENDING 10000
+
+/* Prefetched GSM triplets are discarded after this many seconds */
+#define EAP_SIM_DB_TRIPLET_LIFETIME 3600
+
+/* Maximum number of IMSIs with prefetched GSM triplets */
+#define EAP_SIM_DB_MAX_CACHED 100000
+
+/*
+ * Chained hash table with a power of two number of buckets that doubles when
+ * the number of entries exceeds the number of buckets. Entries are linked
+ * through a pointer at offset next_off within the entry, so that the same
+ * entry can be in more than one table.
+ */
+struct eap_sim_db_hash {
+	void **table;
+	size_t size;
+	size_t count;
+	size_t next_off;
+	u32 (*hash)(const void *entry);
+};
 
 struct eap_sim_pseudonym {
-	struct eap_sim_pseudonym *next;
+	struct eap_sim_pseudonym *hnext; /* in pseudonym_hash */
+	struct eap_sim_pseudonym *hnext_identity; /* in pseudonym_id_hash */
 	u8 *identity;
 	size_t identity_len;
 	char *pseudonym;
 };
 
 struct eap_sim_db_pending {
-	struct eap_sim_db_pending *next;
+	struct eap_sim_db_pending *hnext;
+	struct dl_list list;
 	u8 imsi[20];
 	size_t imsi_len;
 	enum { PENDING, SUCCESS, FAILURE } state;
@@ -47,9 +81,9 @@ struct eap_sim_db_pending {
 	int aka;
 	union {
 		struct {
-			u8 kc[EAP_SIM_MAX_CHAL][EAP_SIM_KC_LEN];
-			u8 sres[EAP_SIM_MAX_CHAL][EAP_SIM_SRES_LEN];
-			u8 rand[EAP_SIM_MAX_CHAL][GSM_RAND_LEN];
+			u8 kc[EAP_SIM_DB_MAX_TRIPLETS][EAP_SIM_KC_LEN];
+			u8 sres[EAP_SIM_DB_MAX_TRIPLETS][EAP_SIM_SRES_LEN];
+			u8 rand[EAP_SIM_DB_MAX_TRIPLETS][GSM_RAND_LEN];
 			int num_chal;
 		} sim;
 		struct {
@@ -63,46 +97,513 @@ struct eap_sim_db_pending {
 	} u;
 };
 
+/* Prefetched GSM triplets for an IMSI */
+struct eap_sim_db_triplets {
+	struct eap_sim_db_triplets *hnext;
+	u8 imsi[20];
+	size_t imsi_len;
+	struct os_time timestamp;
+	int num;
+	u8 kc[EAP_SIM_DB_MAX_TRIPLETS][EAP_SIM_KC_LEN];
+	u8 sres[EAP_SIM_DB_MAX_TRIPLETS][EAP_SIM_SRES_LEN];
+	u8 rand[EAP_SIM_DB_MAX_TRIPLETS][GSM_RAND_LEN];
+};
+
 struct eap_sim_db_data {
 	int sock;
 	char *fname;
 	char *local_sock;
 	void (*get_complete_cb)(void *ctx, void *session_ctx);
 	void *ctx;
-	struct eap_sim_pseudonym *pseudonyms;
-	struct eap_sim_reauth *reauths;
-	struct eap_sim_db_pending *pending;
+	struct eap_sim_db_hash pseudonym_hash;
+	struct eap_sim_db_hash pseudonym_id_hash;
+	struct eap_sim_db_hash reauth_hash;
+	struct eap_sim_db_hash reauth_id_hash;
+	struct eap_sim_db_hash pending_hash;
+	struct dl_list pending; /* struct eap_sim_db_pending; oldest last */
+	struct eap_sim_db_hash triplet_hash;
+	int sim_batch; /* number of authentications to fetch triplets for */
+	char *db_file; /* persistent pseudonym/reauth state or %NULL */
+	FILE *db;
+	unsigned int db_records; /* number of records in db_file */
 };
 
 
+static u32 eap_sim_db_hash_buf(const u8 *buf, size_t len)
+{
+	u32 hash = 2166136261U;
+
+	while (len--) {
+		hash ^= *buf++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+
+static void eap_sim_db_hash_init(struct eap_sim_db_hash *h, size_t next_off,
+				 u32 (*hash)(const void *entry))
+{
+	h->table = NULL;
+	h->size = 0;
+	h->count = 0;
+	h->next_off = next_off;
+	h->hash = hash;
+}
+
+
+static void ** eap_sim_db_hash_next(struct eap_sim_db_hash *h, void *entry)
+{
+	return (void **) ((u8 *) entry + h->next_off);
+}
+
+
+static void * eap_sim_db_hash_first(struct eap_sim_db_hash *h, u32 hash)
+{
+	if (h->size == 0)
+		return NULL;
+	return h->table[hash & (h->size - 1)];
+}
+
+
+static void eap_sim_db_hash_insert(struct eap_sim_db_hash *h, void **table,
+				   size_t size, void *entry)
+{
+	size_t idx = h->hash(entry) & (size - 1);
+
+	*eap_sim_db_hash_next(h, entry) = table[idx];
+	table[idx] = entry;
+}
+
+
+static int eap_sim_db_hash_add(struct eap_sim_db_hash *h, void *entry)
+{
+	if (h->count >= h->size) {
+		size_t nsize = h->size ? h->size * 2 : 16;
+		void **ntable, *e, *next;
+		size_t i;
+
+		ntable = os_zalloc(nsize * sizeof(void *));
+		if (ntable == NULL) {
+			if (h->size == 0)
+				return -1;
+		} else {
+			for (i = 0; i < h->size; i++) {
+				for (e = h->table[i]; e; e = next) {
+					next = *eap_sim_db_hash_next(h, e);
+					eap_sim_db_hash_insert(h, ntable,
+							       nsize, e);
+				}
+			}
+			os_free(h->table);
+			h->table = ntable;
+			h->size = nsize;
+		}
+	}
+
+	eap_sim_db_hash_insert(h, h->table, h->size, entry);
+	h->count++;
+	return 0;
+}
+
+
+static void eap_sim_db_hash_del(struct eap_sim_db_hash *h, void *entry)
+{
+	void **pos;
+
+	if (h->size == 0)
+		return;
+
+	pos = &h->table[h->hash(entry) & (h->size - 1)];
+	while (*pos) {
+		if (*pos == entry) {
+			*pos = *eap_sim_db_hash_next(h, entry);
+			h->count--;
+			return;
+		}
+		pos = eap_sim_db_hash_next(h, *pos);
+	}
+}
+
+
+/* Remove all entries from the hash table and call free_entry() for them */
+static void eap_sim_db_hash_flush(struct eap_sim_db_hash *h,
+				  void (*free_entry)(void *entry))
+{
+	void *e, *next;
+	size_t i;
+
+	for (i = 0; i < h->size; i++) {
+		for (e = h->table[i]; e; e = next) {
+			next = *eap_sim_db_hash_next(h, e);
+			if (free_entry)
+				free_entry(e);
+		}
+	}
+	os_free(h->table);
+	h->table = NULL;
+	h->size = 0;
+	h->count = 0;
+}
+
+
+static u32 eap_sim_db_pseudonym_hash(const void *entry)
+{
+	const struct eap_sim_pseudonym *p = entry;
+	return eap_sim_db_hash_buf((const u8 *) p->pseudonym,
+				   os_strlen(p->pseudonym));
+}
+
+
+static u32 eap_sim_db_pseudonym_id_hash(const void *entry)
+{
+	const struct eap_sim_pseudonym *p = entry;
+	return eap_sim_db_hash_buf(p->identity, p->identity_len);
+}
+
+
+static u32 eap_sim_db_reauth_hash(const void *entry)
+{
+	const struct eap_sim_reauth *r = entry;
+	return eap_sim_db_hash_buf((const u8 *) r->reauth_id,
+				   os_strlen(r->reauth_id));
+}
+
+
+static u32 eap_sim_db_reauth_id_hash(const void *entry)
+{
+	const struct eap_sim_reauth *r = entry;
+	return eap_sim_db_hash_buf(r->identity, r->identity_len);
+}
+
+
+static u32 eap_sim_db_pending_hash_val(const u8 *imsi, size_t imsi_len,
+				       int aka)
+{
+	return eap_sim_db_hash_buf(imsi, imsi_len) ^ (aka ? 0x5bd1e995 : 0);
+}
+
+
+static u32 eap_sim_db_pending_hash(const void *entry)
+{
+	const struct eap_sim_db_pending *p = entry;
+	return eap_sim_db_pending_hash_val(p->imsi, p->imsi_len, p->aka);
+}
+
+
+static u32 eap_sim_db_triplet_hash(const void *entry)
+{
+	const struct eap_sim_db_triplets *t = entry;
+	return eap_sim_db_hash_buf(t->imsi, t->imsi_len);
+}
+
+
 static struct eap_sim_db_pending *
 eap_sim_db_get_pending(struct eap_sim_db_data *data, const u8 *imsi,
 		       size_t imsi_len, int aka)
 {
-	struct eap_sim_db_pending *entry, *prev = NULL;
+	struct eap_sim_db_pending *entry;
 
-	entry = data->pending;
+	entry = eap_sim_db_hash_first(
+		&data->pending_hash,
+		eap_sim_db_pending_hash_val(imsi, imsi_len, aka));
 	while (entry) {
 		if (entry->aka == aka && entry->imsi_len == imsi_len &&
 		    os_memcmp(entry->imsi, imsi, imsi_len) == 0) {
-			if (prev)
-				prev->next = entry->next;
-			else
-				data->pending = entry->next;
+			eap_sim_db_hash_del(&data->pending_hash, entry);
+			dl_list_del(&entry->list);
 			break;
 		}
-		prev = entry;
-		entry = entry->next;
+		entry = entry->hnext;
 	}
 	return entry;
 }
 
 
+/*
+ * Add an entry to the pending list. The list is kept in age order for
+ * eap_sim_db_expire_pending(), so an entry that is put back after
+ * eap_sim_db_get_pending() (e.g., still waiting for the gateway) is inserted
+ * behind the newer entries instead of at the head of the list.
+ */
 static void eap_sim_db_add_pending(struct eap_sim_db_data *data,
 				   struct eap_sim_db_pending *entry)
 {
-	entry->next = data->pending;
-	data->pending = entry;
+	struct eap_sim_db_pending *p;
+
+	if (eap_sim_db_hash_add(&data->pending_hash, entry) < 0) {
+		os_free(entry);
+		return;
+	}
+
+	dl_list_for_each(p, &data->pending, struct eap_sim_db_pending, list) {
+		if (!os_time_before(&entry->timestamp, &p->timestamp)) {
+			dl_list_add(p->list.prev, &entry->list);
+			return;
+		}
+	}
+	dl_list_add_tail(&data->pending, &entry->list);
+}
+
+
+static struct eap_sim_db_triplets *
+eap_sim_db_get_triplets(struct eap_sim_db_data *data, const u8 *imsi,
+			size_t imsi_len)
+{
+	struct eap_sim_db_triplets *t;
+
+	t = eap_sim_db_hash_first(&data->triplet_hash,
+				  eap_sim_db_hash_buf(imsi, imsi_len));
+	while (t) {
+		if (t->imsi_len == imsi_len &&
+		    os_memcmp(t->imsi, imsi, imsi_len) == 0)
+			break;
+		t = t->hnext;
+	}
+	return t;
+}
+
+
+/* Store triplets that were not used for the current authentication */
+static void eap_sim_db_store_triplets(struct eap_sim_db_data *data,
+				      struct eap_sim_db_pending *entry,
+				      int first)
+{
+	struct eap_sim_db_triplets *t;
+	int i;
+
+	if (first >= entry->u.sim.num_chal)
+		return;
+
+	t = eap_sim_db_get_triplets(data, entry->imsi, entry->imsi_len);
+	if (t == NULL) {
+		if (data->triplet_hash.count >= EAP_SIM_DB_MAX_CACHED)
+			return;
+		t = os_zalloc(sizeof(*t));
+		if (t == NULL)
+			return;
+		os_memcpy(t->imsi, entry->imsi, entry->imsi_len);
+		t->imsi_len = entry->imsi_len;
+		if (eap_sim_db_hash_add(&data->triplet_hash, t) < 0) {
+			os_free(t);
+			return;
+		}
+	}
+
+	os_get_time(&t->timestamp);
+	for (i = first; i < entry->u.sim.num_chal &&
+		     t->num < EAP_SIM_DB_MAX_TRIPLETS; i++) {
+		os_memcpy(t->kc[t->num], entry->u.sim.kc[i], EAP_SIM_KC_LEN);
+		os_memcpy(t->sres[t->num], entry->u.sim.sres[i],
+			  EAP_SIM_SRES_LEN);
+		os_memcpy(t->rand[t->num], entry->u.sim.rand[i],
+			  GSM_RAND_LEN);
+		t->num++;
+	}
+	wpa_printf(MSG_DEBUG, "EAP-SIM DB: %d prefetched triplet(s) stored",
+		   t->num);
+}
+
+
+/* Take max_chal triplets from the prefetched ones, if enough are available */
+static int eap_sim_db_use_triplets(struct eap_sim_db_data *data,
+				   const u8 *imsi, size_t imsi_len,
+				   int max_chal, u8 *_rand, u8 *kc, u8 *sres)
+{
+	struct eap_sim_db_triplets *t;
+	struct os_time now;
+	int i;
+
+	t = eap_sim_db_get_triplets(data, imsi, imsi_len);
+	if (t == NULL)
+		return 0;
+
+	os_get_time(&now);
+	if (now.sec - t->timestamp.sec > EAP_SIM_DB_TRIPLET_LIFETIME ||
+	    t->num < max_chal) {
+		/* Do not mix triplets from different requests */
+		eap_sim_db_hash_del(&data->triplet_hash, t);
+		os_free(t);
+		return 0;
+	}
+
+	for (i = 0; i < max_chal; i++) {
+		os_memcpy(_rand + i * GSM_RAND_LEN, t->rand[i], GSM_RAND_LEN);
+		os_memcpy(kc + i * EAP_SIM_KC_LEN, t->kc[i], EAP_SIM_KC_LEN);
+		os_memcpy(sres + i * EAP_SIM_SRES_LEN, t->sres[i],
+			  EAP_SIM_SRES_LEN);
+	}
+	t->num -= max_chal;
+	os_memmove(t->kc, t->kc[max_chal], t->num * EAP_SIM_KC_LEN);
+	os_memmove(t->sres, t->sres[max_chal], t->num * EAP_SIM_SRES_LEN);
+	os_memmove(t->rand, t->rand[max_chal], t->num * GSM_RAND_LEN);
+	if (t->num == 0) {
+		eap_sim_db_hash_del(&data->triplet_hash, t);
+		os_free(t);
+	}
+
+	return max_chal;
+}
+
+
+/*
+ * Persistent pseudonym and re-authentication state
+ *
+ * Changes are appended to the db file as text lines:
+ * P <identity> <pseudonym>
+ * R <identity> <reauth_id> <counter> <aka_prime> <MK> <K_encr> <K_aut> <K_re>
+ * D <reauth_id>
+ * (identity and keys as hex strings). The file is read and compacted when
+ * the database is initialized. It is compacted again at runtime once it has
+ * more than EAP_SIM_DB_COMPACT_FACTOR times as many records as there are
+ * live entries.
+ */
+
+#define EAP_SIM_DB_COMPACT_FACTOR 4
+#define EAP_SIM_DB_COMPACT_MIN_RECORDS 100
+
+
+static void eap_sim_db_write_hex(FILE *f, const u8 *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		fprintf(f, "%02x", buf[i]);
+}
+
+
+static void eap_sim_db_write_pseudonym(FILE *f, struct eap_sim_pseudonym *p)
+{
+	fprintf(f, "P ");
+	eap_sim_db_write_hex(f, p->identity, p->identity_len);
+	fprintf(f, " %s\n", p->pseudonym);
+}
+
+
+static void eap_sim_db_write_reauth(FILE *f, struct eap_sim_reauth *r)
+{
+	fprintf(f, "R ");
+	eap_sim_db_write_hex(f, r->identity, r->identity_len);
+	fprintf(f, " %s %u %d ", r->reauth_id, r->counter, r->aka_prime);
+	eap_sim_db_write_hex(f, r->mk, EAP_SIM_MK_LEN);
+	fprintf(f, " ");
+	eap_sim_db_write_hex(f, r->k_encr, EAP_SIM_K_ENCR_LEN);
+	fprintf(f, " ");
+	eap_sim_db_write_hex(f, r->k_aut, EAP_AKA_PRIME_K_AUT_LEN);
+	fprintf(f, " ");
+	eap_sim_db_write_hex(f, r->k_re, EAP_AKA_PRIME_K_RE_LEN);
+	fprintf(f, "\n");
+}
+
+
+static FILE * eap_sim_db_open_db(const char *fname, int append)
+{
+	int fd;
+	FILE *f;
+
+	/* The file contains keys, so do not allow others to read it */
+	fd = open(fname, O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC),
+		  S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		wpa_printf(MSG_ERROR, "EAP-SIM DB: Could not open '%s': %s",
+			   fname, strerror(errno));
+		return NULL;
+	}
+	f = fdopen(fd, "a");
+	if (f == NULL)
+		close(fd);
+	return f;
+}
+
+
+/* Write out the current state to a new db file that replaces the old one */
+static int eap_sim_db_compact(struct eap_sim_db_data *data)
+{
+	char *tmp;
+	size_t len;
+	FILE *f;
+	size_t i;
+	struct eap_sim_pseudonym *p;
+	struct eap_sim_reauth *r;
+	int ret;
+
+	len = os_strlen(data->db_file) + 5;
+	tmp = os_malloc(len);
+	if (tmp == NULL)
+		return -1;
+	os_snprintf(tmp, len, "%s.new", data->db_file);
+
+	f = eap_sim_db_open_db(tmp, 0);
+	if (f == NULL) {
+		os_free(tmp);
+		return -1;
+	}
+
+	for (i = 0; i < data->pseudonym_hash.size; i++) {
+		for (p = data->pseudonym_hash.table[i]; p; p = p->hnext)
+			eap_sim_db_write_pseudonym(f, p);
+	}
+	for (i = 0; i < data->reauth_hash.size; i++) {
+		for (r = data->reauth_hash.table[i]; r; r = r->hnext)
+			eap_sim_db_write_reauth(f, r);
+	}
+
+	ret = fclose(f);
+	if (ret == 0)
+		ret = rename(tmp, data->db_file);
+	if (ret < 0) {
+		wpa_printf(MSG_ERROR, "EAP-SIM DB: Failed to write '%s': %s",
+			   tmp, strerror(errno));
+		unlink(tmp);
+	}
+	os_free(tmp);
+	return ret;
+}
+
+
+/* Must be called only after the in-memory tables have been updated, so that
+ * a compaction writes out the change that was just journaled */
+static void eap_sim_db_journal_written(struct eap_sim_db_data *data)
+{
+	size_t live;
+
+	data->db_records++;
+	live = data->pseudonym_hash.count + data->reauth_hash.count;
+	if (data->db_records < EAP_SIM_DB_COMPACT_MIN_RECORDS ||
+	    data->db_records <= EAP_SIM_DB_COMPACT_FACTOR * live)
+		return;
+
+	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Compacting '%s' (%u records for "
+		   "%u entries)", data->db_file, data->db_records,
+		   (unsigned int) live);
+	fclose(data->db);
+	eap_sim_db_compact(data);
+	/* Reset the count also on failure to avoid retrying on every update */
+	data->db_records = live;
+	data->db = eap_sim_db_open_db(data->db_file, 1);
+}
+
+
+static void eap_sim_db_journal_pseudonym(struct eap_sim_db_data *data,
+					 struct eap_sim_pseudonym *p)
+{
+	if (data->db == NULL)
+		return;
+	eap_sim_db_write_pseudonym(data->db, p);
+	fflush(data->db);
+	eap_sim_db_journal_written(data);
+}
+
+
+static void eap_sim_db_journal_reauth(struct eap_sim_db_data *data,
+				      struct eap_sim_reauth *r)
+{
+	if (data->db == NULL)
+		return;
+	eap_sim_db_write_reauth(data->db, r);
+	fflush(data->db);
+	eap_sim_db_journal_written(data);
 }
 
 
@@ -137,7 +638,7 @@ static void eap_sim_db_sim_resp_auth(struct eap_sim_db_data *data,
 	}
 
 	num_chal = 0;
-	while (num_chal < EAP_SIM_MAX_CHAL) {
+	while (num_chal < EAP_SIM_DB_MAX_TRIPLETS) {
 		end = os_strchr(start, ' ');
 		if (end)
 			*end = '\0';
@@ -388,6 +889,178 @@ static void eap_sim_db_close_socket(struct eap_sim_db_data *data)
 }
 
 
+static struct eap_sim_pseudonym *
+eap_sim_db_get_pseudonym(struct eap_sim_db_data *data, const u8 *identity,
+			 size_t identity_len);
+static struct eap_sim_pseudonym *
+eap_sim_db_get_pseudonym_id(struct eap_sim_db_data *data, const u8 *identity,
+			    size_t identity_len);
+static struct eap_sim_reauth *
+eap_sim_db_get_reauth(struct eap_sim_db_data *data, const u8 *identity,
+		      size_t identity_len);
+static int eap_sim_db_add_pseudonym_data(struct eap_sim_db_data *data,
+					 const u8 *identity,
+					 size_t identity_len,
+					 char *pseudonym);
+static struct eap_sim_reauth *
+eap_sim_db_add_reauth_data(struct eap_sim_db_data *data, const u8 *identity,
+			   size_t identity_len, char *reauth_id, u16 counter);
+static void eap_sim_db_del_reauth(struct eap_sim_db_data *data,
+				  struct eap_sim_reauth *r);
+
+
+static int eap_sim_db_load_line(struct eap_sim_db_data *data, char *buf)
+{
+	char *pos, *id, *name, *tmp;
+	u8 *identity;
+	size_t identity_len;
+	struct eap_sim_reauth *r;
+	int ret = -1;
+
+	if (buf[0] == 'D' && buf[1] == ' ') {
+		r = eap_sim_db_get_reauth(data, (u8 *) buf + 2,
+					  os_strlen(buf + 2));
+		if (r)
+			eap_sim_db_del_reauth(data, r);
+		return 0;
+	}
+
+	if ((buf[0] != 'P' && buf[0] != 'R') || buf[1] != ' ')
+		return -1;
+
+	id = buf + 2;
+	pos = os_strchr(id, ' ');
+	if (pos == NULL)
+		return -1;
+	*pos++ = '\0';
+	name = pos;
+	pos = os_strchr(name, ' ');
+	if (pos)
+		*pos++ = '\0';
+
+	identity_len = os_strlen(id) / 2;
+	identity = os_malloc(identity_len + 1);
+	if (identity == NULL)
+		return -1;
+	tmp = os_strdup(name);
+	if (tmp == NULL || hexstr2bin(id, identity, identity_len))
+		goto fail;
+
+	if (buf[0] == 'P') {
+		ret = eap_sim_db_add_pseudonym_data(data, identity,
+						    identity_len, tmp);
+		tmp = NULL;
+		goto fail;
+	}
+
+	if (pos == NULL)
+		goto fail;
+	r = eap_sim_db_add_reauth_data(data, identity, identity_len, tmp,
+				       atoi(pos));
+	tmp = NULL;
+	if (r == NULL)
+		goto fail;
+	pos = os_strchr(pos, ' ');
+	if (pos == NULL)
+		goto fail_reauth;
+	r->aka_prime = atoi(++pos);
+	pos = os_strchr(pos, ' ');
+	if (pos == NULL || hexstr2bin(++pos, r->mk, EAP_SIM_MK_LEN))
+		goto fail_reauth;
+	pos = os_strchr(pos, ' ');
+	if (pos == NULL || hexstr2bin(++pos, r->k_encr, EAP_SIM_K_ENCR_LEN))
+		goto fail_reauth;
+	pos = os_strchr(pos, ' ');
+	if (pos == NULL ||
+	    hexstr2bin(++pos, r->k_aut, EAP_AKA_PRIME_K_AUT_LEN))
+		goto fail_reauth;
+	pos = os_strchr(pos, ' ');
+	if (pos == NULL || hexstr2bin(++pos, r->k_re, EAP_AKA_PRIME_K_RE_LEN))
+		goto fail_reauth;
+	ret = 0;
+	goto fail;
+
+fail_reauth:
+	eap_sim_db_del_reauth(data, r);
+fail:
+	os_free(tmp);
+	os_free(identity);
+	return ret;
+}
+
+
+static int eap_sim_db_load(struct eap_sim_db_data *data)
+{
+	FILE *f;
+	char buf[600], *pos;
+	int line = 0;
+
+	f = fopen(data->db_file, "r");
+	if (f) {
+		while (fgets(buf, sizeof(buf), f)) {
+			line++;
+			pos = os_strchr(buf, '\n');
+			if (pos)
+				*pos = '\0';
+			if (eap_sim_db_load_line(data, buf) < 0)
+				wpa_printf(MSG_INFO, "EAP-SIM DB: Ignored "
+					   "invalid line %d in '%s'",
+					   line, data->db_file);
+		}
+		fclose(f);
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Loaded %u pseudonym(s) "
+			   "and %u reauth entries from '%s'",
+			   (unsigned int) data->pseudonym_hash.count,
+			   (unsigned int) data->reauth_hash.count,
+			   data->db_file);
+	}
+
+	if (eap_sim_db_compact(data) < 0)
+		return -1;
+	data->db_records = data->pseudonym_hash.count +
+		data->reauth_hash.count;
+
+	data->db = eap_sim_db_open_db(data->db_file, 1);
+	return data->db ? 0 : -1;
+}
+
+
+/* Parse options following the external server address in the configuration
+ * string */
+static int eap_sim_db_parse_options(struct eap_sim_db_data *data, char *pos)
+{
+	char *end;
+
+	while (pos && *pos) {
+		end = os_strchr(pos, ' ');
+		if (end)
+			*end++ = '\0';
+
+		if (os_strncmp(pos, "db=", 3) == 0) {
+			os_free(data->db_file);
+			data->db_file = os_strdup(pos + 3);
+			if (data->db_file == NULL)
+				return -1;
+		} else if (os_strncmp(pos, "sim_batch=", 10) == 0) {
+			data->sim_batch = atoi(pos + 10);
+			if (data->sim_batch < 1) {
+				wpa_printf(MSG_ERROR, "EAP-SIM DB: Invalid "
+					   "sim_batch value");
+				return -1;
+			}
+		} else if (*pos) {
+			wpa_printf(MSG_ERROR, "EAP-SIM DB: Unknown option "
+				   "'%s'", pos);
+			return -1;
+		}
+
+		pos = end;
+	}
+
+	return 0;
+}
+
+
 /**
  * eap_sim_db_init - Initialize EAP-SIM DB / authentication gateway interface
  * @config: Configuration data (e.g., file name)
@@ -400,6 +1073,7 @@ void * eap_sim_db_init(const char *config,
 		       void *ctx)
 {
 	struct eap_sim_db_data *data;
+	char *pos;
 
 	data = os_zalloc(sizeof(*data));
 	if (data == NULL)
@@ -408,9 +1082,40 @@ void * eap_sim_db_init(const char *config,
 	data->sock = -1;
 	data->get_complete_cb = get_complete_cb;
 	data->ctx = ctx;
+	data->sim_batch = 1;
+	eap_sim_db_hash_init(&data->pseudonym_hash,
+			     offsetof(struct eap_sim_pseudonym, hnext),
+			     eap_sim_db_pseudonym_hash);
+	eap_sim_db_hash_init(&data->pseudonym_id_hash,
+			     offsetof(struct eap_sim_pseudonym,
+				      hnext_identity),
+			     eap_sim_db_pseudonym_id_hash);
+	eap_sim_db_hash_init(&data->reauth_hash,
+			     offsetof(struct eap_sim_reauth, hnext),
+			     eap_sim_db_reauth_hash);
+	eap_sim_db_hash_init(&data->reauth_id_hash,
+			     offsetof(struct eap_sim_reauth, hnext_identity),
+			     eap_sim_db_reauth_id_hash);
+	eap_sim_db_hash_init(&data->pending_hash,
+			     offsetof(struct eap_sim_db_pending, hnext),
+			     eap_sim_db_pending_hash);
+	dl_list_init(&data->pending);
+	eap_sim_db_hash_init(&data->triplet_hash,
+			     offsetof(struct eap_sim_db_triplets, hnext),
+			     eap_sim_db_triplet_hash);
+
 	data->fname = os_strdup(config);
 	if (data->fname == NULL)
 		goto fail;
+	pos = os_strchr(data->fname, ' ');
+	if (pos) {
+		*pos++ = '\0';
+		if (eap_sim_db_parse_options(data, pos) < 0)
+			goto fail;
+	}
+
+	if (data->db_file && eap_sim_db_load(data) < 0)
+		goto fail;
 
 	if (os_strncmp(data->fname, "unix:", 5) == 0) {
 		if (eap_sim_db_open_socket(data))
@@ -420,23 +1125,29 @@ void * eap_sim_db_init(const char *config,
 	return data;
 
 fail:
-	eap_sim_db_close_socket(data);
-	os_free(data->fname);
-	os_free(data);
+	eap_sim_db_deinit(data);
 	return NULL;
 }
 
 
-static void eap_sim_db_free_pseudonym(struct eap_sim_pseudonym *p)
+static void eap_sim_db_free_entry(void *entry)
+{
+	os_free(entry);
+}
+
+
+static void eap_sim_db_free_pseudonym(void *entry)
 {
+	struct eap_sim_pseudonym *p = entry;
 	os_free(p->identity);
 	os_free(p->pseudonym);
 	os_free(p);
 }
 
 
-static void eap_sim_db_free_reauth(struct eap_sim_reauth *r)
+static void eap_sim_db_free_reauth(void *entry)
 {
+	struct eap_sim_reauth *r = entry;
 	os_free(r->identity);
 	os_free(r->reauth_id);
 	os_free(r);
@@ -450,33 +1161,20 @@ static void eap_sim_db_free_reauth(struct eap_sim_reauth *r)
 void eap_sim_db_deinit(void *priv)
 {
 	struct eap_sim_db_data *data = priv;
-	struct eap_sim_pseudonym *p, *prev;
-	struct eap_sim_reauth *r, *prevr;
-	struct eap_sim_db_pending *pending, *prev_pending;
 
 	eap_sim_db_close_socket(data);
 	os_free(data->fname);
-
-	p = data->pseudonyms;
-	while (p) {
-		prev = p;
-		p = p->next;
-		eap_sim_db_free_pseudonym(prev);
-	}
-
-	r = data->reauths;
-	while (r) {
-		prevr = r;
-		r = r->next;
-		eap_sim_db_free_reauth(prevr);
-	}
-
-	pending = data->pending;
-	while (pending) {
-		prev_pending = pending;
-		pending = pending->next;
-		os_free(prev_pending);
-	}
+	if (data->db)
+		fclose(data->db);
+	os_free(data->db_file);
+
+	eap_sim_db_hash_flush(&data->pseudonym_id_hash, NULL);
+	eap_sim_db_hash_flush(&data->pseudonym_hash,
+			      eap_sim_db_free_pseudonym);
+	eap_sim_db_hash_flush(&data->reauth_id_hash, NULL);
+	eap_sim_db_hash_flush(&data->reauth_hash, eap_sim_db_free_reauth);
+	eap_sim_db_hash_flush(&data->pending_hash, eap_sim_db_free_entry);
+	eap_sim_db_hash_flush(&data->triplet_hash, eap_sim_db_free_entry);
 
 	os_free(data);
 }
@@ -512,9 +1210,28 @@ static int eap_sim_db_send(struct eap_sim_db_data *data, const char *msg,
 
 static void eap_sim_db_expire_pending(struct eap_sim_db_data *data)
 {
-	/* TODO: add limit for maximum length for pending list; remove latest
-	 * (i.e., last) entry from the list if the limit is reached; could also
-	 * use timeout to expire pending entries */
+	struct eap_sim_db_pending *entry;
+	struct os_time now;
+
+	/*
+	 * Remove the oldest entries if the gateway did not reply to them in
+	 * time or if the limit for pending requests is reached. Entries are
+	 * added to the head of the list, so the oldest ones are at the tail.
+	 */
+	os_get_time(&now);
+	while ((entry = dl_list_last(&data->pending, struct eap_sim_db_pending,
+				     list))) {
+		if (data->pending_hash.count <= EAP_SIM_DB_MAX_PENDING &&
+		    now.sec - entry->timestamp.sec <=
+		    EAP_SIM_DB_PENDING_TIMEOUT)
+			break;
+		wpa_hexdump_ascii(MSG_DEBUG, "EAP-SIM DB: Expire pending "
+				  "entry for IMSI",
+				  entry->imsi, entry->imsi_len);
+		eap_sim_db_hash_del(&data->pending_hash, entry);
+		dl_list_del(&entry->list);
+		os_free(entry);
+	}
 }
 
 
@@ -552,7 +1269,7 @@ int eap_sim_db_get_gsm_triplets(void *priv, const u8 *identity,
 {
 	struct eap_sim_db_data *data = priv;
 	struct eap_sim_db_pending *entry;
-	int len, ret;
+	int len, ret, num;
 	size_t i;
 	char msg[40];
 
@@ -603,10 +1320,26 @@ int eap_sim_db_get_gsm_triplets(void *priv, const u8 *identity,
 		os_memcpy(sres, entry->u.sim.sres,
 			  num_chal * EAP_SIM_SRES_LEN);
 		os_memcpy(kc, entry->u.sim.kc, num_chal * EAP_SIM_KC_LEN);
+		eap_sim_db_store_triplets(data, entry, num_chal);
 		os_free(entry);
 		return num_chal;
 	}
 
+	ret = eap_sim_db_use_triplets(data, identity, identity_len, max_chal,
+				      _rand, kc, sres);
+	if (ret > 0) {
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Using %d prefetched "
+			   "triplets", ret);
+		return ret;
+	}
+
+	/* Fetch triplets for the following authentications, too */
+	num = max_chal * data->sim_batch;
+	if (num > EAP_SIM_DB_MAX_TRIPLETS)
+		num = EAP_SIM_DB_MAX_TRIPLETS;
+	if (num < max_chal)
+		num = max_chal;
+
 	if (data->sock < 0) {
 		if (eap_sim_db_open_socket(data) < 0)
 			return EAP_SIM_DB_FAILURE;
@@ -617,7 +1350,7 @@ int eap_sim_db_get_gsm_triplets(void *priv, const u8 *identity,
 		return EAP_SIM_DB_FAILURE;
 	os_memcpy(msg + len, identity, identity_len);
 	len += identity_len;
-	ret = os_snprintf(msg + len, sizeof(msg) - len, " %d", max_chal);
+	ret = os_snprintf(msg + len, sizeof(msg) - len, " %d", num);
 	if (ret < 0 || (size_t) ret >= sizeof(msg) - len)
 		return EAP_SIM_DB_FAILURE;
 	len += ret;
@@ -643,11 +1376,21 @@ int eap_sim_db_get_gsm_triplets(void *priv, const u8 *identity,
 }
 
 
+/* Length of the identity without a possible realm */
+static size_t eap_sim_db_id_len(const u8 *identity, size_t identity_len)
+{
+	size_t len = 0;
+
+	while (len < identity_len && identity[len] != '@')
+		len++;
+	return len;
+}
+
+
 static struct eap_sim_pseudonym *
 eap_sim_db_get_pseudonym(struct eap_sim_db_data *data, const u8 *identity,
 			 size_t identity_len)
 {
-	char *pseudonym;
 	size_t len;
 	struct eap_sim_pseudonym *p;
 
@@ -657,28 +1400,17 @@ eap_sim_db_get_pseudonym(struct eap_sim_db_data *data, const u8 *identity,
 		return NULL;
 
 	/* Remove possible realm from identity */
-	len = 0;
-	while (len < identity_len) {
-		if (identity[len] == '@')
-			break;
-		len++;
-	}
-
-	pseudonym = os_malloc(len + 1);
-	if (pseudonym == NULL)
-		return NULL;
-	os_memcpy(pseudonym, identity, len);
-	pseudonym[len] = '\0';
+	len = eap_sim_db_id_len(identity, identity_len);
 
-	p = data->pseudonyms;
+	p = eap_sim_db_hash_first(&data->pseudonym_hash,
+				  eap_sim_db_hash_buf(identity, len));
 	while (p) {
-		if (os_strcmp(p->pseudonym, pseudonym) == 0)
+		if (os_strlen(p->pseudonym) == len &&
+		    os_memcmp(p->pseudonym, identity, len) == 0)
 			break;
-		p = p->next;
+		p = p->hnext;
 	}
 
-	os_free(pseudonym);
-
 	return p;
 }
 
@@ -694,12 +1426,13 @@ eap_sim_db_get_pseudonym_id(struct eap_sim_db_data *data, const u8 *identity,
 	     identity[0] != EAP_AKA_PERMANENT_PREFIX))
 		return NULL;
 
-	p = data->pseudonyms;
+	p = eap_sim_db_hash_first(&data->pseudonym_id_hash,
+				  eap_sim_db_hash_buf(identity, identity_len));
 	while (p) {
 		if (identity_len == p->identity_len &&
 		    os_memcmp(p->identity, identity, identity_len) == 0)
 			break;
-		p = p->next;
+		p = p->hnext_identity;
 	}
 
 	return p;
@@ -710,7 +1443,6 @@ static struct eap_sim_reauth *
 eap_sim_db_get_reauth(struct eap_sim_db_data *data, const u8 *identity,
 		      size_t identity_len)
 {
-	char *reauth_id;
 	size_t len;
 	struct eap_sim_reauth *r;
 
@@ -720,28 +1452,17 @@ eap_sim_db_get_reauth(struct eap_sim_db_data *data, const u8 *identity,
 		return NULL;
 
 	/* Remove possible realm from identity */
-	len = 0;
-	while (len < identity_len) {
-		if (identity[len] == '@')
-			break;
-		len++;
-	}
+	len = eap_sim_db_id_len(identity, identity_len);
 
-	reauth_id = os_malloc(len + 1);
-	if (reauth_id == NULL)
-		return NULL;
-	os_memcpy(reauth_id, identity, len);
-	reauth_id[len] = '\0';
-
-	r = data->reauths;
+	r = eap_sim_db_hash_first(&data->reauth_hash,
+				  eap_sim_db_hash_buf(identity, len));
 	while (r) {
-		if (os_strcmp(r->reauth_id, reauth_id) == 0)
+		if (os_strlen(r->reauth_id) == len &&
+		    os_memcmp(r->reauth_id, identity, len) == 0)
 			break;
-		r = r->next;
+		r = r->hnext;
 	}
 
-	os_free(reauth_id);
-
 	return r;
 }
 
@@ -764,12 +1485,13 @@ eap_sim_db_get_reauth_id(struct eap_sim_db_data *data, const u8 *identity,
 		identity_len = p->identity_len;
 	}
 
-	r = data->reauths;
+	r = eap_sim_db_hash_first(&data->reauth_id_hash,
+				  eap_sim_db_hash_buf(identity, identity_len));
 	while (r) {
 		if (identity_len == r->identity_len &&
 		    os_memcmp(r->identity, identity, identity_len) == 0)
 			break;
-		r = r->next;
+		r = r->hnext_identity;
 	}
 
 	return r;
@@ -885,27 +1607,12 @@ char * eap_sim_db_get_next_reauth_id(void *priv, int aka)
 }
 
 
-/**
- * eap_sim_db_add_pseudonym - EAP-SIM DB: Add new pseudonym
- * @priv: Private data pointer from eap_sim_db_init()
- * @identity: Identity of the user (may be permanent identity or pseudonym)
- * @identity_len: Length of identity
- * @pseudonym: Pseudonym for this user. This needs to be an allocated buffer,
- * e.g., return value from eap_sim_db_get_next_pseudonym(). Caller must not
- * free it.
- * Returns: 0 on success, -1 on failure
- *
- * This function adds a new pseudonym for EAP-SIM user. EAP-SIM DB is
- * responsible of freeing pseudonym buffer once it is not needed anymore.
- */
-int eap_sim_db_add_pseudonym(void *priv, const u8 *identity,
-			     size_t identity_len, char *pseudonym)
+static int eap_sim_db_add_pseudonym_data(struct eap_sim_db_data *data,
+					 const u8 *identity,
+					 size_t identity_len,
+					 char *pseudonym)
 {
-	struct eap_sim_db_data *data = priv;
 	struct eap_sim_pseudonym *p;
-	wpa_hexdump_ascii(MSG_DEBUG, "EAP-SIM DB: Add pseudonym for identity",
-			  identity, identity_len);
-	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pseudonym: %s", pseudonym);
 
 	/* TODO: could store last two pseudonyms */
 	p = eap_sim_db_get_pseudonym(data, identity, identity_len);
@@ -915,8 +1622,15 @@ int eap_sim_db_add_pseudonym(void *priv, const u8 *identity,
 	if (p) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Replacing previous "
 			   "pseudonym: %s", p->pseudonym);
+		eap_sim_db_hash_del(&data->pseudonym_hash, p);
 		os_free(p->pseudonym);
 		p->pseudonym = pseudonym;
+		if (eap_sim_db_hash_add(&data->pseudonym_hash, p) < 0) {
+			eap_sim_db_hash_del(&data->pseudonym_id_hash, p);
+			eap_sim_db_free_pseudonym(p);
+			return -1;
+		}
+		eap_sim_db_journal_pseudonym(data, p);
 		return 0;
 	}
 
@@ -926,7 +1640,6 @@ int eap_sim_db_add_pseudonym(void *priv, const u8 *identity,
 		return -1;
 	}
 
-	p->next = data->pseudonyms;
 	p->identity = os_malloc(identity_len);
 	if (p->identity == NULL) {
 		os_free(p);
@@ -936,13 +1649,48 @@ int eap_sim_db_add_pseudonym(void *priv, const u8 *identity,
 	os_memcpy(p->identity, identity, identity_len);
 	p->identity_len = identity_len;
 	p->pseudonym = pseudonym;
-	data->pseudonyms = p;
+	if (eap_sim_db_hash_add(&data->pseudonym_hash, p) < 0) {
+		eap_sim_db_free_pseudonym(p);
+		return -1;
+	}
+	if (eap_sim_db_hash_add(&data->pseudonym_id_hash, p) < 0) {
+		eap_sim_db_hash_del(&data->pseudonym_hash, p);
+		eap_sim_db_free_pseudonym(p);
+		return -1;
+	}
+	eap_sim_db_journal_pseudonym(data, p);
 
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Added new pseudonym entry");
 	return 0;
 }
 
 
+/**
+ * eap_sim_db_add_pseudonym - EAP-SIM DB: Add new pseudonym
+ * @priv: Private data pointer from eap_sim_db_init()
+ * @identity: Identity of the user (may be permanent identity or pseudonym)
+ * @identity_len: Length of identity
+ * @pseudonym: Pseudonym for this user. This needs to be an allocated buffer,
+ * e.g., return value from eap_sim_db_get_next_pseudonym(). Caller must not
+ * free it.
+ * Returns: 0 on success, -1 on failure
+ *
+ * This function adds a new pseudonym for EAP-SIM user. EAP-SIM DB is
+ * responsible of freeing pseudonym buffer once it is not needed anymore.
+ */
+int eap_sim_db_add_pseudonym(void *priv, const u8 *identity,
+			     size_t identity_len, char *pseudonym)
+{
+	struct eap_sim_db_data *data = priv;
+	wpa_hexdump_ascii(MSG_DEBUG, "EAP-SIM DB: Add pseudonym for identity",
+			  identity, identity_len);
+	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pseudonym: %s", pseudonym);
+
+	return eap_sim_db_add_pseudonym_data(data, identity, identity_len,
+					     pseudonym);
+}
+
+
 static struct eap_sim_reauth *
 eap_sim_db_add_reauth_data(struct eap_sim_db_data *data, const u8 *identity,
 			   size_t identity_len, char *reauth_id, u16 counter)
@@ -960,8 +1708,14 @@ eap_sim_db_add_reauth_data(struct eap_sim_db_data *data, const u8 *identity,
 	if (r) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Replacing previous "
 			   "reauth_id: %s", r->reauth_id);
+		eap_sim_db_hash_del(&data->reauth_hash, r);
 		os_free(r->reauth_id);
 		r->reauth_id = reauth_id;
+		if (eap_sim_db_hash_add(&data->reauth_hash, r) < 0) {
+			eap_sim_db_hash_del(&data->reauth_id_hash, r);
+			eap_sim_db_free_reauth(r);
+			return NULL;
+		}
 	} else {
 		r = os_zalloc(sizeof(*r));
 		if (r == NULL) {
@@ -969,7 +1723,6 @@ eap_sim_db_add_reauth_data(struct eap_sim_db_data *data, const u8 *identity,
 			return NULL;
 		}
 
-		r->next = data->reauths;
 		r->identity = os_malloc(identity_len);
 		if (r->identity == NULL) {
 			os_free(r);
@@ -979,7 +1732,15 @@ eap_sim_db_add_reauth_data(struct eap_sim_db_data *data, const u8 *identity,
 		os_memcpy(r->identity, identity, identity_len);
 		r->identity_len = identity_len;
 		r->reauth_id = reauth_id;
-		data->reauths = r;
+		if (eap_sim_db_hash_add(&data->reauth_hash, r) < 0) {
+			eap_sim_db_free_reauth(r);
+			return NULL;
+		}
+		if (eap_sim_db_hash_add(&data->reauth_id_hash, r) < 0) {
+			eap_sim_db_hash_del(&data->reauth_hash, r);
+			eap_sim_db_free_reauth(r);
+			return NULL;
+		}
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Added new reauth entry");
 	}
 
@@ -989,6 +1750,15 @@ eap_sim_db_add_reauth_data(struct eap_sim_db_data *data, const u8 *identity,
 }
 
 
+static void eap_sim_db_del_reauth(struct eap_sim_db_data *data,
+				  struct eap_sim_reauth *r)
+{
+	eap_sim_db_hash_del(&data->reauth_hash, r);
+	eap_sim_db_hash_del(&data->reauth_id_hash, r);
+	eap_sim_db_free_reauth(r);
+}
+
+
 /**
  * eap_sim_db_add_reauth - EAP-SIM DB: Add new re-authentication entry
  * @priv: Private data pointer from eap_sim_db_init()
@@ -1019,6 +1789,7 @@ int eap_sim_db_add_reauth(void *priv, const u8 *identity,
 
 	os_memcpy(r->mk, mk, EAP_SIM_MK_LEN);
 	r->aka_prime = 0;
+	eap_sim_db_journal_reauth(data, r);
 
 	return 0;
 }
@@ -1060,6 +1831,7 @@ int eap_sim_db_add_reauth_prime(void *priv, const u8 *identity,
 	os_memcpy(r->k_encr, k_encr, EAP_SIM_K_ENCR_LEN);
 	os_memcpy(r->k_aut, k_aut, EAP_AKA_PRIME_K_AUT_LEN);
 	os_memcpy(r->k_re, k_re, EAP_AKA_PRIME_K_RE_LEN);
+	eap_sim_db_journal_reauth(data, r);
 
 	return 0;
 }
@@ -1127,20 +1899,15 @@ eap_sim_db_get_reauth_entry(void *priv, const u8 *identity,
 void eap_sim_db_remove_reauth(void *priv, struct eap_sim_reauth *reauth)
 {
 	struct eap_sim_db_data *data = priv;
-	struct eap_sim_reauth *r, *prev = NULL;
-	r = data->reauths;
-	while (r) {
-		if (r == reauth) {
-			if (prev)
-				prev->next = r->next;
-			else
-				data->reauths = r->next;
-			eap_sim_db_free_reauth(r);
-			return;
-		}
-		prev = r;
-		r = r->next;
+	int journal = data->db != NULL;
+
+	if (journal) {
+		fprintf(data->db, "D %s\n", reauth->reauth_id);
+		fflush(data->db);
 	}
+	eap_sim_db_del_reauth(data, reauth);
+	if (journal)
+		eap_sim_db_journal_written(data);
 }
 
 
@@ -61,7 +61,8 @@ const u8 * eap_sim_db_get_permanent(void *priv, const u8 *identity,
 				    size_t identity_len, size_t *len);
 
 struct eap_sim_reauth {
-	struct eap_sim_reauth *next;
+	struct eap_sim_reauth *hnext; /* hash chain by reauth_id */
+	struct eap_sim_reauth *hnext_identity; /* hash chain by identity */
 	u8 *identity;
 	size_t identity_len;
 	char *reauth_id;
@@ -142,6 +142,11 @@ struct eapol_sm {
 	Boolean cached_pmk;
 
 	Boolean unicast_key_received, broadcast_key_received;
+
+	/* Timing of the current authentication */
+	struct os_time eap_tx_time; /* last EAPOL-Start or EAP-Response */
+	struct os_time eap_first_rx; /* first EAP packet */
+	struct eapol_sm_timing timing;
 };
 
 
@@ -185,6 +190,51 @@ struct ieee802_1x_eapol_key {
 #endif /* _MSC_VER */
 
 
+static unsigned int eapol_ms_since(const struct os_time *t)
+{
+	struct os_time now, diff;
+
+	os_get_reltime(&now);
+	if (os_time_before(&now, t))
+		return 0;
+	os_time_sub(&now, t, &diff);
+	return diff.sec * 1000 + diff.usec / 1000;
+}
+
+
+static void eapol_sm_rx_eap_timing(struct eapol_sm *sm)
+{
+	unsigned int rtt;
+
+	if (sm->eap_first_rx.sec == 0)
+		os_get_reltime(&sm->eap_first_rx);
+	if (sm->eap_tx_time.sec == 0)
+		return;
+	rtt = eapol_ms_since(&sm->eap_tx_time);
+	sm->timing.eap_rounds++;
+	sm->timing.eap_rtt_total += rtt;
+	if (rtt > sm->timing.eap_rtt_max)
+		sm->timing.eap_rtt_max = rtt;
+	/* Do not count retransmitted requests as new round trips */
+	os_memset(&sm->eap_tx_time, 0, sizeof(sm->eap_tx_time));
+}
+
+
+static void eapol_sm_auth_done(struct eapol_sm *sm)
+{
+	if (sm->eap_first_rx.sec == 0 || sm->timing.eap_time)
+		return;
+	sm->timing.eap_time = eapol_ms_since(&sm->eap_first_rx);
+	if (sm->timing.eap_time == 0)
+		sm->timing.eap_time = 1;
+	sm->timing.tls_time = eap_get_tls_time(sm->eap);
+	wpa_printf(MSG_DEBUG, "EAPOL: EAP authentication took %u ms "
+		   "(%u round trips, max RTT %u ms, TLS %u ms)",
+		   sm->timing.eap_time, sm->timing.eap_rounds,
+		   sm->timing.eap_rtt_max, sm->timing.tls_time);
+}
+
+
 static void eapol_sm_txLogoff(struct eapol_sm *sm);
 static void eapol_sm_txStart(struct eapol_sm *sm);
 static void eapol_sm_processKey(struct eapol_sm *sm);
@@ -292,6 +342,10 @@ SM_STATE(SUPP_PAE, CONNECTING)
 #else /* CONFIG_WPS */
 		sm->startWhen = 3;
 #endif /* CONFIG_WPS */
+		/* New authentication - start timing from scratch */
+		os_memset(&sm->timing, 0, sizeof(sm->timing));
+		os_memset(&sm->eap_tx_time, 0, sizeof(sm->eap_tx_time));
+		os_memset(&sm->eap_first_rx, 0, sizeof(sm->eap_first_rx));
 	}
 	eapol_enable_timer_tick(sm);
 	sm->eapolEap = FALSE;
@@ -499,6 +553,7 @@ SM_STATE(SUPP_BE, SUCCESS)
 	SM_ENTRY(SUPP_BE, SUCCESS);
 	sm->keyRun = TRUE;
 	sm->suppSuccess = TRUE;
+	eapol_sm_auth_done(sm);
 
 	if (eap_key_available(sm->eap)) {
 		/* New key received - clear IEEE 802.1X EAPOL-Key replay
@@ -512,6 +567,7 @@ SM_STATE(SUPP_BE, FAIL)
 {
 	SM_ENTRY(SUPP_BE, FAIL);
 	sm->suppFail = TRUE;
+	eapol_sm_auth_done(sm);
 }
 
 
@@ -636,6 +692,7 @@ static void eapol_sm_txStart(struct eapol_sm *sm)
 	wpa_printf(MSG_DEBUG, "EAPOL: txStart");
 	sm->ctx->eapol_send(sm->ctx->eapol_send_ctx,
 			    IEEE802_1X_TYPE_EAPOL_START, (u8 *) "", 0);
+	os_get_reltime(&sm->eap_tx_time);
 	sm->dot1xSuppEapolStartFramesTx++;
 	sm->dot1xSuppEapolFramesTx++;
 }
@@ -839,6 +896,7 @@ static void eapol_sm_txSuppRsp(struct eapol_sm *sm)
 	sm->ctx->eapol_send(sm->ctx->eapol_send_ctx,
 			    IEEE802_1X_TYPE_EAP_PACKET, wpabuf_head(resp),
 			    wpabuf_len(resp));
+	os_get_reltime(&sm->eap_tx_time);
 
 	/* eapRespData is not used anymore, so free it here */
 	wpabuf_free(resp);
@@ -1098,6 +1156,21 @@ int eapol_sm_get_status(struct eapol_sm *sm, char *buf, size_t buflen,
 }
 
 
+/**
+ * eapol_sm_get_timing - Get timing of the current EAP authentication
+ * @sm: Pointer to EAPOL state machine allocated with eapol_sm_init()
+ * @timing: Buffer for returning the timing information
+ */
+void eapol_sm_get_timing(struct eapol_sm *sm, struct eapol_sm_timing *timing)
+{
+	if (sm == NULL) {
+		os_memset(timing, 0, sizeof(*timing));
+		return;
+	}
+	*timing = sm->timing;
+}
+
+
 /**
  * eapol_sm_get_mib - Get EAPOL state machine MIBs
  * @sm: Pointer to EAPOL state machine allocated with eapol_sm_init()
@@ -1243,6 +1316,7 @@ int eapol_sm_rx_eapol(struct eapol_sm *sm, const u8 *src, const u8 *buf,
 			 */
 			eapol_sm_abort_cached(sm);
 		}
+		eapol_sm_rx_eap_timing(sm);
 		wpabuf_free(sm->eapReqData);
 		sm->eapReqData = wpabuf_alloc_copy(hdr + 1, plen);
 		if (sm->eapReqData) {
@@ -239,6 +239,27 @@ struct eapol_ctx {
 };
 
 
+/**
+ * struct eapol_sm_timing - Timing of the current EAP authentication
+ * @eap_rounds: Number of measured EAP request/response round trips
+ * @eap_rtt_total: Sum of the round trip times in milliseconds
+ * @eap_rtt_max: Longest round trip time in milliseconds
+ * @eap_time: Time from the first EAP request to EAP success or failure in
+ *	milliseconds (0 if authentication has not completed)
+ * @tls_time: TLS handshake duration in milliseconds (0 if TLS was not used)
+ *
+ * A round trip is measured from transmission of EAPOL-Start or an EAP
+ * response to the reception of the next EAP packet.
+ */
+struct eapol_sm_timing {
+	unsigned int eap_rounds;
+	unsigned int eap_rtt_total;
+	unsigned int eap_rtt_max;
+	unsigned int eap_time;
+	unsigned int tls_time;
+};
+
+
 struct eap_peer_config;
 
 #ifdef IEEE8021X_EAPOL
@@ -272,6 +293,7 @@ void eapol_sm_request_reauth(struct eapol_sm *sm);
 void eapol_sm_notify_lower_layer_success(struct eapol_sm *sm, int in_eapol_sm);
 void eapol_sm_invalidate_cached_session(struct eapol_sm *sm);
 const char * eapol_sm_get_method_name(struct eapol_sm *sm);
+void eapol_sm_get_timing(struct eapol_sm *sm, struct eapol_sm_timing *timing);
 #else /* IEEE8021X_EAPOL */
 static inline struct eapol_sm *eapol_sm_init(struct eapol_ctx *ctx)
 {
@@ -363,6 +385,11 @@ static inline const char * eapol_sm_get_method_name(struct eapol_sm *sm)
 {
 	return NULL;
 }
+static inline void eapol_sm_get_timing(struct eapol_sm *sm,
+				       struct eapol_sm_timing *timing)
+{
+	os_memset(timing, 0, sizeof(*timing));
+}
 #endif /* IEEE8021X_EAPOL */
 
 #endif /* EAPOL_SUPP_SM_H */
@@ -127,4 +127,20 @@ int l2_packet_get_ip_addr(struct l2_packet_data *l2, char *buf, size_t len);
  */
 void l2_packet_notify_auth_start(struct l2_packet_data *l2);
 
+/**
+ * l2_packet_set_rx_filter - Drop unneeded received packets early
+ * @l2: Pointer to internal l2_packet data from l2_packet_init()
+ * @ethertype: Ethertype of the packets to receive in host byte order or 0 to
+ *	receive all ethertypes
+ * Returns: 0 on success, -1 on failure (e.g., if not supported)
+ *
+ * This function can be used to limit the received packets to the ones with
+ * the given ethertype that are addressed to the own or to a multicast address
+ * (i.e., broadcast packets and packets for other hosts are dropped). This is
+ * mainly useful for interfaces that are opened for all ethertypes and see a
+ * lot of unrelated traffic; the Linux implementation drops the packets in
+ * the kernel before they are queued to the socket.
+ */
+int l2_packet_set_rx_filter(struct l2_packet_data *l2, u16 ethertype);
+
 #endif /* L2_PACKET_H */
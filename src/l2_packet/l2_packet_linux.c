@@ -14,8 +14,14 @@
 
 #include "includes.h"
 #include <sys/ioctl.h>
+#ifdef CONFIG_L2_PACKET_MMAP
+#include <sys/mman.h>
+#include <linux/if_packet.h>
+#else /* CONFIG_L2_PACKET_MMAP */
 #include <netpacket/packet.h>
+#endif /* CONFIG_L2_PACKET_MMAP */
 #include <net/if.h>
+#include <linux/filter.h>
 
 #include "common.h"
 #include "eloop.h"
@@ -32,9 +38,129 @@ struct l2_packet_data {
 	void *rx_callback_ctx;
 	int l2_hdr; /* whether to include layer 2 (Ethernet) header data
 		     * buffers */
+#ifdef CONFIG_L2_PACKET_MMAP
+	u8 *ring; /* TPACKET_V3 RX ring or %NULL if not in use */
+	size_t ring_len;
+	unsigned int block; /* next block to process */
+	int in_rx; /* frames from the ring are being delivered */
+	int deinit_pending; /* l2_packet_deinit() called from rx_callback */
+#endif /* CONFIG_L2_PACKET_MMAP */
 };
 
 
+#ifdef CONFIG_L2_PACKET_MMAP
+
+/*
+ * RX ring parameters. Frames are stored back to back in blocks and a block
+ * is handed over to user space when it is full or when the retire timeout
+ * (in milliseconds) expires, so all frames in a block are processed with a
+ * single wakeup.
+ */
+#define L2_PACKET_RING_BLOCK_SIZE (1 << 15)
+#define L2_PACKET_RING_BLOCK_NR 8
+#define L2_PACKET_RING_FRAME_SIZE 2048
+#define L2_PACKET_RING_TIMEOUT 2
+
+
+static int l2_packet_init_ring(struct l2_packet_data *l2)
+{
+	struct tpacket_req3 req;
+	int val = TPACKET_V3;
+
+	if (setsockopt(l2->fd, SOL_PACKET, PACKET_VERSION, &val,
+		       sizeof(val)) < 0) {
+		wpa_printf(MSG_DEBUG, "l2_packet: TPACKET_V3 not supported: "
+			   "%s", strerror(errno));
+		return -1;
+	}
+
+	os_memset(&req, 0, sizeof(req));
+	req.tp_block_size = L2_PACKET_RING_BLOCK_SIZE;
+	req.tp_block_nr = L2_PACKET_RING_BLOCK_NR;
+	req.tp_frame_size = L2_PACKET_RING_FRAME_SIZE;
+	req.tp_frame_nr = L2_PACKET_RING_BLOCK_SIZE /
+		L2_PACKET_RING_FRAME_SIZE * L2_PACKET_RING_BLOCK_NR;
+	req.tp_retire_blk_tov = L2_PACKET_RING_TIMEOUT;
+	if (setsockopt(l2->fd, SOL_PACKET, PACKET_RX_RING, &req,
+		       sizeof(req)) < 0) {
+		wpa_printf(MSG_DEBUG, "l2_packet: setsockopt[PACKET_RX_RING]: "
+			   "%s", strerror(errno));
+		goto fail;
+	}
+
+	l2->ring_len = (size_t) req.tp_block_size * req.tp_block_nr;
+	l2->ring = mmap(NULL, l2->ring_len, PROT_READ | PROT_WRITE,
+			MAP_SHARED, l2->fd, 0);
+	if (l2->ring == MAP_FAILED) {
+		wpa_printf(MSG_DEBUG, "l2_packet: mmap: %s", strerror(errno));
+		l2->ring = NULL;
+		os_memset(&req, 0, sizeof(req));
+		setsockopt(l2->fd, SOL_PACKET, PACKET_RX_RING, &req,
+			   sizeof(req));
+		goto fail;
+	}
+
+	return 0;
+
+fail:
+	val = TPACKET_V1;
+	setsockopt(l2->fd, SOL_PACKET, PACKET_VERSION, &val, sizeof(val));
+	return -1;
+}
+
+
+static void l2_packet_deinit_ring(struct l2_packet_data *l2)
+{
+	if (l2->ring) {
+		munmap(l2->ring, l2->ring_len);
+		l2->ring = NULL;
+	}
+}
+
+
+static void l2_packet_receive_ring(struct l2_packet_data *l2)
+{
+	struct tpacket_block_desc *desc;
+	struct tpacket3_hdr *hdr;
+	struct sockaddr_ll *ll;
+	unsigned int blocks, i;
+
+	l2->in_rx = 1;
+	for (blocks = 0; blocks < L2_PACKET_RING_BLOCK_NR; blocks++) {
+		desc = (struct tpacket_block_desc *)
+			(l2->ring + l2->block * L2_PACKET_RING_BLOCK_SIZE);
+		if (!(desc->hdr.bh1.block_status & TP_STATUS_USER))
+			break;
+
+		hdr = (struct tpacket3_hdr *)
+			((u8 *) desc + desc->hdr.bh1.offset_to_first_pkt);
+		for (i = 0; i < desc->hdr.bh1.num_pkts; i++) {
+			ll = (struct sockaddr_ll *)
+				((u8 *) hdr +
+				 TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+			/* Frames are delivered directly from the ring */
+			if (!l2->deinit_pending)
+				l2->rx_callback(l2->rx_callback_ctx,
+						ll->sll_addr,
+						(u8 *) hdr + (l2->l2_hdr ?
+							      hdr->tp_mac :
+							      hdr->tp_net),
+						hdr->tp_snaplen);
+			hdr = (struct tpacket3_hdr *)
+				((u8 *) hdr + hdr->tp_next_offset);
+		}
+
+		/* Return the block to the kernel */
+		__sync_synchronize();
+		desc->hdr.bh1.block_status = TP_STATUS_KERNEL;
+		l2->block = (l2->block + 1) % L2_PACKET_RING_BLOCK_NR;
+	}
+	l2->in_rx = 0;
+}
+
+#endif /* CONFIG_L2_PACKET_MMAP */
+
+
 int l2_packet_get_own_addr(struct l2_packet_data *l2, u8 *addr)
 {
 	os_memcpy(addr, l2->own_addr, ETH_ALEN);
@@ -80,6 +206,15 @@ static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 	struct sockaddr_ll ll;
 	socklen_t fromlen;
 
+#ifdef CONFIG_L2_PACKET_MMAP
+	if (l2->ring) {
+		l2_packet_receive_ring(l2);
+		if (l2->deinit_pending)
+			l2_packet_deinit(l2);
+		return;
+	}
+#endif /* CONFIG_L2_PACKET_MMAP */
+
 	os_memset(&ll, 0, sizeof(ll));
 	fromlen = sizeof(ll);
 	res = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *) &ll,
@@ -131,6 +266,13 @@ struct l2_packet_data * l2_packet_init(
 	}
 	l2->ifindex = ifr.ifr_ifindex;
 
+#ifdef CONFIG_L2_PACKET_MMAP
+	/* Fall back to recvfrom() if the ring cannot be used */
+	if (l2_packet_init_ring(l2) == 0)
+		wpa_printf(MSG_DEBUG, "l2_packet: Using mmap RX ring on %s",
+			   l2->ifname);
+#endif /* CONFIG_L2_PACKET_MMAP */
+
 	os_memset(&ll, 0, sizeof(ll));
 	ll.sll_family = PF_PACKET;
 	ll.sll_ifindex = ifr.ifr_ifindex;
@@ -138,6 +280,9 @@ struct l2_packet_data * l2_packet_init(
 	if (bind(l2->fd, (struct sockaddr *) &ll, sizeof(ll)) < 0) {
 		wpa_printf(MSG_ERROR, "%s: bind[PF_PACKET]: %s",
 			   __func__, strerror(errno));
+#ifdef CONFIG_L2_PACKET_MMAP
+		l2_packet_deinit_ring(l2);
+#endif /* CONFIG_L2_PACKET_MMAP */
 		close(l2->fd);
 		os_free(l2);
 		return NULL;
@@ -146,6 +291,9 @@ struct l2_packet_data * l2_packet_init(
 	if (ioctl(l2->fd, SIOCGIFHWADDR, &ifr) < 0) {
 		wpa_printf(MSG_ERROR, "%s: ioctl[SIOCGIFHWADDR]: %s",
 			   __func__, strerror(errno));
+#ifdef CONFIG_L2_PACKET_MMAP
+		l2_packet_deinit_ring(l2);
+#endif /* CONFIG_L2_PACKET_MMAP */
 		close(l2->fd);
 		os_free(l2);
 		return NULL;
@@ -163,6 +311,15 @@ void l2_packet_deinit(struct l2_packet_data *l2)
 	if (l2 == NULL)
 		return;
 
+#ifdef CONFIG_L2_PACKET_MMAP
+	if (l2->in_rx) {
+		/* Called from rx_callback; free once the ring is processed */
+		l2->deinit_pending = 1;
+		return;
+	}
+	l2_packet_deinit_ring(l2);
+#endif /* CONFIG_L2_PACKET_MMAP */
+
 	if (l2->fd >= 0) {
 		eloop_unregister_read_sock(l2->fd);
 		close(l2->fd);
@@ -172,6 +329,43 @@ void l2_packet_deinit(struct l2_packet_data *l2)
 }
 
 
+int l2_packet_set_rx_filter(struct l2_packet_data *l2, u16 ethertype)
+{
+	struct sock_filter insns[] = {
+		/* Accept only frames to own or to a multicast address */
+		BPF_STMT(BPF_LD | BPF_B | BPF_ABS, SKF_AD_OFF + SKF_AD_PKTTYPE),
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PACKET_HOST, 1, 0),
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PACKET_MULTICAST, 0, 3),
+		/* Accept only the given ethertype */
+		BPF_STMT(BPF_LD | BPF_H | BPF_ABS,
+			 SKF_AD_OFF + SKF_AD_PROTOCOL),
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ethertype, 0, 1),
+		BPF_STMT(BPF_RET | BPF_K, ~0U),
+		BPF_STMT(BPF_RET | BPF_K, 0),
+	};
+	struct sock_fprog prog;
+
+	if (l2 == NULL)
+		return -1;
+
+	if (ethertype == 0) {
+		/* Any ethertype */
+		insns[4] = (struct sock_filter) BPF_STMT(BPF_JMP | BPF_JA, 0);
+	}
+
+	prog.len = sizeof(insns) / sizeof(insns[0]);
+	prog.filter = insns;
+	if (setsockopt(l2->fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog,
+		       sizeof(prog)) < 0) {
+		wpa_printf(MSG_ERROR, "l2_packet: setsockopt[SO_ATTACH_FILTER]:"
+			   " %s", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+
 int l2_packet_get_ip_addr(struct l2_packet_data *l2, char *buf, size_t len)
 {
 	int s;
@@ -520,3 +520,9 @@ int l2_packet_get_ip_addr(struct l2_packet_data *l2, char *buf, size_t len)
 void l2_packet_notify_auth_start(struct l2_packet_data *l2)
 {
 }
+
+
+int l2_packet_set_rx_filter(struct l2_packet_data *l2, u16 ethertype)
+{
+	return -1;
+}
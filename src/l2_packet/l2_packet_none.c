@@ -121,3 +121,10 @@ void l2_packet_notify_auth_start(struct l2_packet_data *l2)
 {
 	/* This function can be left empty */
 }
+
+
+int l2_packet_set_rx_filter(struct l2_packet_data *l2, u16 ethertype)
+{
+	/* Optional; return -1 if packets cannot be filtered */
+	return -1;
+}
@@ -384,3 +384,9 @@ void l2_packet_notify_auth_start(struct l2_packet_data *l2)
 			       l2, l2->pcap);
 #endif /* CONFIG_WINPCAP */
 }
+
+
+int l2_packet_set_rx_filter(struct l2_packet_data *l2, u16 ethertype)
+{
+	return -1;
+}
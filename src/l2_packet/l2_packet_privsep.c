@@ -265,3 +265,9 @@ void l2_packet_notify_auth_start(struct l2_packet_data *l2)
 {
 	wpa_priv_cmd(l2, PRIVSEP_CMD_L2_NOTIFY_AUTH_START, NULL, 0);
 }
+
+
+int l2_packet_set_rx_filter(struct l2_packet_data *l2, u16 ethertype)
+{
+	return -1;
+}
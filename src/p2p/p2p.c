@@ -53,16 +53,16 @@ static void p2p_scan_timeout(void *eloop_ctx, void *timeout_ctx);
 
 static void p2p_expire_peers(struct p2p_data *p2p)
 {
-	struct p2p_device *dev, *n;
+	struct p2p_device *dev;
 	struct os_time now;
 
 	os_get_time(&now);
-	dl_list_for_each_safe(dev, n, &p2p->devices, struct p2p_device, list) {
+	/* The least recently seen peers are at the end of the LRU list */
+	while ((dev = dl_list_last(&p2p->lru, struct p2p_device, lru))) {
 		if (dev->last_seen.sec + P2P_PEER_EXPIRATION_AGE >= now.sec)
-			continue;
+			break;
 		wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: Expiring old peer "
 			"entry " MACSTR, MAC2STR(dev->info.p2p_device_addr));
-		dl_list_del(&dev->list);
 		p2p_device_free(p2p, dev);
 	}
 }
@@ -261,7 +261,8 @@ static void p2p_device_clear_reported(struct p2p_data *p2p)
 struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	for (dev = p2p->dev_hash[P2P_DEV_HASH(addr)]; dev; dev = dev->hnext) {
 		if (os_memcmp(dev->info.p2p_device_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -279,7 +280,18 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 					     const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	if (is_zero_ether_addr(addr)) {
+		/* Peers without a known interface address are not hashed */
+		dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+			if (is_zero_ether_addr(dev->interface_addr))
+				return dev;
+		}
+		return NULL;
+	}
+
+	for (dev = p2p->iface_hash[P2P_DEV_HASH(addr)]; dev;
+	     dev = dev->iface_hnext) {
 		if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -287,6 +299,78 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 }
 
 
+static void p2p_iface_hash_del(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	struct p2p_device **pos;
+
+	if (is_zero_ether_addr(dev->interface_addr))
+		return;
+
+	for (pos = &p2p->iface_hash[P2P_DEV_HASH(dev->interface_addr)]; *pos;
+	     pos = &(*pos)->iface_hnext) {
+		if (*pos == dev) {
+			*pos = dev->iface_hnext;
+			break;
+		}
+	}
+}
+
+
+/**
+ * p2p_device_set_interface_addr - Set P2P Interface Address of a peer entry
+ * @p2p: P2P module context from p2p_init()
+ * @dev: Peer entry
+ * @addr: P2P Interface Address of the peer
+ */
+static void p2p_device_set_interface_addr(struct p2p_data *p2p,
+					  struct p2p_device *dev,
+					  const u8 *addr)
+{
+	if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
+		return;
+
+	p2p_iface_hash_del(p2p, dev);
+	os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+	if (is_zero_ether_addr(addr))
+		return;
+	dev->iface_hnext = p2p->iface_hash[P2P_DEV_HASH(addr)];
+	p2p->iface_hash[P2P_DEV_HASH(addr)] = dev;
+}
+
+
+/**
+ * p2p_device_seen - Update the time a peer entry was last seen
+ * @p2p: P2P module context from p2p_init()
+ * @dev: Peer entry
+ *
+ * This moves the entry to the front of the LRU list, so that the list remains
+ * ordered by last_seen.
+ */
+static void p2p_device_seen(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	os_get_time(&dev->last_seen);
+	dl_list_del(&dev->lru);
+	dl_list_add(&p2p->lru, &dev->lru);
+}
+
+
+static void p2p_remove_oldest_peers(struct p2p_data *p2p, size_t max_peers)
+{
+	struct p2p_device *dev;
+
+	while (p2p->num_devices > max_peers) {
+		dev = dl_list_last(&p2p->lru, struct p2p_device, lru);
+		if (dev == NULL)
+			break;
+		wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG,
+			"P2P: Remove oldest peer entry " MACSTR " to make "
+			"room for a new peer",
+			MAC2STR(dev->info.p2p_device_addr));
+		p2p_device_free(p2p, dev);
+	}
+}
+
+
 /**
  * p2p_create_device - Create a peer entry
  * @p2p: P2P module context from p2p_init()
@@ -299,32 +383,24 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 static struct p2p_device * p2p_create_device(struct p2p_data *p2p,
 					     const u8 *addr)
 {
-	struct p2p_device *dev, *oldest = NULL;
-	size_t count = 0;
+	struct p2p_device *dev;
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev)
 		return dev;
 
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
-		count++;
-		if (oldest == NULL ||
-		    os_time_before(&dev->last_seen, &oldest->last_seen))
-			oldest = dev;
-	}
-	if (count + 1 > p2p->cfg->max_peers && oldest) {
-		wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG,
-			"P2P: Remove oldest peer entry to make room for a new "
-			"peer");
-		dl_list_del(&oldest->list);
-		p2p_device_free(p2p, oldest);
-	}
+	p2p_remove_oldest_peers(p2p, p2p->cfg->max_peers - 1);
 
 	dev = os_zalloc(sizeof(*dev));
 	if (dev == NULL)
 		return NULL;
 	dl_list_add(&p2p->devices, &dev->list);
+	dl_list_add(&p2p->lru, &dev->lru);
 	os_memcpy(dev->info.p2p_device_addr, addr, ETH_ALEN);
+	dev->hnext = p2p->dev_hash[P2P_DEV_HASH(addr)];
+	p2p->dev_hash[P2P_DEV_HASH(addr)] = dev;
+	p2p->num_devices++;
+	os_get_time(&dev->last_seen);
 
 	return dev;
 }
@@ -397,9 +473,9 @@ static int p2p_add_group_clients(struct p2p_data *p2p, const u8 *go_dev_addr,
 			dev->flags |= P2P_DEV_REPORTED | P2P_DEV_REPORTED_ONCE;
 		}
 
-		os_memcpy(dev->interface_addr, cli->p2p_interface_addr,
-			  ETH_ALEN);
-		os_get_time(&dev->last_seen);
+		p2p_device_set_interface_addr(p2p, dev,
+					      cli->p2p_interface_addr);
+		p2p_device_seen(p2p, dev);
 		os_memcpy(dev->member_in_go_dev, go_dev_addr, ETH_ALEN);
 		os_memcpy(dev->member_in_go_iface, go_interface_addr,
 			  ETH_ALEN);
@@ -537,11 +613,11 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq, int level,
 		p2p_parse_free(&msg);
 		return -1;
 	}
-	os_get_time(&dev->last_seen);
+	p2p_device_seen(p2p, dev);
 	dev->flags &= ~(P2P_DEV_PROBE_REQ_ONLY | P2P_DEV_GROUP_CLIENT_ONLY);
 
 	if (os_memcmp(addr, p2p_dev_addr, ETH_ALEN) != 0)
-		os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+		p2p_device_set_interface_addr(p2p, dev, addr);
 	if (msg.ssid &&
 	    (msg.ssid[1] != P2P_WILDCARD_SSID_LEN ||
 	     os_memcmp(msg.ssid + 2, P2P_WILDCARD_SSID, P2P_WILDCARD_SSID_LEN)
@@ -623,8 +699,21 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq, int level,
 
 static void p2p_device_free(struct p2p_data *p2p, struct p2p_device *dev)
 {
+	struct p2p_device **pos;
 	int i;
 
+	dl_list_del(&dev->list);
+	dl_list_del(&dev->lru);
+	for (pos = &p2p->dev_hash[P2P_DEV_HASH(dev->info.p2p_device_addr)];
+	     *pos; pos = &(*pos)->hnext) {
+		if (*pos == dev) {
+			*pos = dev->hnext;
+			break;
+		}
+	}
+	p2p_iface_hash_del(p2p, dev);
+	p2p->num_devices--;
+
 	if (p2p->go_neg_peer == dev)
 		p2p->go_neg_peer = NULL;
 	if (p2p->invite_peer == dev)
@@ -1195,7 +1284,7 @@ int p2p_authorize(struct p2p_data *p2p, const u8 *peer_addr,
 void p2p_add_dev_info(struct p2p_data *p2p, const u8 *addr,
 		      struct p2p_device *dev, struct p2p_message *msg)
 {
-	os_get_time(&dev->last_seen);
+	p2p_device_seen(p2p, dev);
 
 	p2p_copy_wps_info(dev, 0, msg);
 
@@ -1536,7 +1625,7 @@ static void p2p_add_dev_from_probe_req(struct p2p_data *p2p, const u8 *addr,
 	if (dev) {
 		if (dev->country[0] == 0 && msg.listen_channel)
 			os_memcpy(dev->country, msg.listen_channel, 3);
-		os_get_time(&dev->last_seen);
+		p2p_device_seen(p2p, dev);
 		p2p_parse_free(&msg);
 		return; /* already known */
 	}
@@ -1547,7 +1636,6 @@ static void p2p_add_dev_from_probe_req(struct p2p_data *p2p, const u8 *addr,
 		return;
 	}
 
-	os_get_time(&dev->last_seen);
 	dev->flags |= P2P_DEV_PROBE_REQ_ONLY;
 
 	if (msg.listen_channel) {
@@ -1578,7 +1666,7 @@ struct p2p_device * p2p_add_dev_from_go_neg_req(struct p2p_data *p2p,
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev) {
-		os_get_time(&dev->last_seen);
+		p2p_device_seen(p2p, dev);
 		return dev; /* already known */
 	}
 
@@ -2079,6 +2167,7 @@ struct p2p_data * p2p_init(const struct p2p_config *cfg)
 	p2p->dev_capab |= P2P_DEV_CAPAB_CLIENT_DISCOVERABILITY;
 
 	dl_list_init(&p2p->devices);
+	dl_list_init(&p2p->lru);
 
 	eloop_register_timeout(P2P_PEER_EXPIRATION_INTERVAL, 0,
 			       p2p_expiration_timeout, p2p, NULL);
@@ -2116,10 +2205,8 @@ void p2p_flush(struct p2p_data *p2p)
 	p2p->go_neg_peer = NULL;
 	eloop_cancel_timeout(p2p_find_timeout, p2p, NULL);
 	dl_list_for_each_safe(dev, prev, &p2p->devices, struct p2p_device,
-			      list) {
-		dl_list_del(&dev->list);
+			      list)
 		p2p_device_free(p2p, dev);
-	}
 	p2p_free_sd_queries(p2p);
 	os_free(p2p->after_scan_tx);
 	p2p->after_scan_tx = NULL;
@@ -3611,6 +3698,18 @@ void p2p_set_intra_bss_dist(struct p2p_data *p2p, int enabled)
 }
 
 
+int p2p_set_max_peers(struct p2p_data *p2p, size_t max_peers)
+{
+	if (max_peers < 1)
+		return -1;
+	wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: Maximum number of peers %u",
+		(unsigned int) max_peers);
+	p2p->cfg->max_peers = max_peers;
+	p2p_remove_oldest_peers(p2p, max_peers);
+	return 0;
+}
+
+
 void p2p_update_channel_list(struct p2p_data *p2p, struct p2p_channels *chan)
 {
 	wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: Update channel list");
@@ -1449,6 +1449,17 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq, int level,
  */
 void p2p_set_intra_bss_dist(struct p2p_data *p2p, int enabled);
 
+/**
+ * p2p_set_max_peers - Set maximum number of peers to remember
+ * @p2p: P2P module context from p2p_init()
+ * @max_peers: Maximum number of peer entries (at least 1)
+ * Returns: 0 on success, -1 on failure
+ *
+ * If there are more peers than the new limit, the least recently seen entries
+ * are removed.
+ */
+int p2p_set_max_peers(struct p2p_data *p2p, size_t max_peers);
+
 /**
  * p2p_supported_freq - Check whether channel is supported for P2P
  * @p2p: P2P module context from p2p_init()
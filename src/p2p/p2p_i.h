@@ -31,6 +31,9 @@ enum p2p_go_state {
  */
 struct p2p_device {
 	struct dl_list list;
+	struct dl_list lru; /* in p2p_data::lru; most recently seen first */
+	struct p2p_device *hnext; /* in p2p_data::dev_hash */
+	struct p2p_device *iface_hnext; /* in p2p_data::iface_hash */
 	struct os_time last_seen;
 	int listen_freq;
 	enum p2p_wps_method wps_method;
@@ -218,6 +221,31 @@ struct p2p_data {
 	 */
 	struct dl_list devices;
 
+#define P2P_DEV_HASH_SIZE 64
+#define P2P_DEV_HASH(a) (((a)[3] ^ (a)[4] ^ (a)[5]) & (P2P_DEV_HASH_SIZE - 1))
+	/**
+	 * dev_hash - Peers hashed by P2P Device Address
+	 */
+	struct p2p_device *dev_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * iface_hash - Peers with a known P2P Interface Address hashed by it
+	 */
+	struct p2p_device *iface_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * lru - Peers ordered by last_seen, most recently seen first
+	 *
+	 * Expiration and removal of peers to stay within max_peers look only
+	 * at the end of this list.
+	 */
+	struct dl_list lru;
+
+	/**
+	 * num_devices - Number of entries in devices
+	 */
+	size_t num_devices;
+
 	/**
 	 * go_neg_peer - Pointer to GO Negotiation peer
 	 */
@@ -358,7 +358,17 @@ void p2p_sd_response(struct p2p_data *p2p, int freq, const u8 *dst,
 	if (wpabuf_len(resp_tlvs) > 1400) {
 		wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: SD response long "
 			"enough to require fragmentation");
-		if (p2p->sd_resp) {
+		if (p2p->sd_resp &&
+		    wpabuf_len(p2p->sd_resp) == wpabuf_len(resp_tlvs) &&
+		    os_memcmp(wpabuf_head(p2p->sd_resp), wpabuf_head(resp_tlvs),
+			      wpabuf_len(resp_tlvs)) == 0) {
+			/*
+			 * Peers repeat the same query during discovery; reuse
+			 * the previously fragmented response.
+			 */
+			wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: Reuse "
+				"previous SD response");
+		} else if (p2p->sd_resp) {
 			/*
 			 * TODO: Could consider storing the fragmented response
 			 * separately for each peer to avoid having to drop old
@@ -369,10 +379,12 @@ void p2p_sd_response(struct p2p_data *p2p, int freq, const u8 *dst,
 			wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: Drop "
 				"previous SD response");
 			wpabuf_free(p2p->sd_resp);
+			p2p->sd_resp = NULL;
 		}
 		os_memcpy(p2p->sd_resp_addr, dst, ETH_ALEN);
 		p2p->sd_resp_dialog_token = dialog_token;
-		p2p->sd_resp = wpabuf_dup(resp_tlvs);
+		if (p2p->sd_resp == NULL)
+			p2p->sd_resp = wpabuf_dup(resp_tlvs);
 		p2p->sd_resp_pos = 0;
 		p2p->sd_frag_id = 0;
 		resp = p2p_build_sd_response(dialog_token, WLAN_STATUS_SUCCESS,
@@ -584,7 +596,8 @@ void p2p_rx_gas_comeback_req(struct p2p_data *p2p, const u8 *sa,
 		return;
 	}
 
-	if (p2p->sd_resp == NULL) {
+	if (p2p->sd_resp == NULL ||
+	    p2p->sd_resp_pos >= wpabuf_len(p2p->sd_resp)) {
 		wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: No pending SD "
 			"response fragment available");
 		return;
@@ -619,10 +632,12 @@ void p2p_rx_gas_comeback_req(struct p2p_data *p2p, const u8 *sa,
 			"remain to be sent",
 			(int) (wpabuf_len(p2p->sd_resp) - p2p->sd_resp_pos));
 	} else {
+		/*
+		 * Keep the response to be reused if the same query is
+		 * received again.
+		 */
 		wpa_msg(p2p->cfg->msg_ctx, MSG_DEBUG, "P2P: All fragments of "
 			"SD response sent");
-		wpabuf_free(p2p->sd_resp);
-		p2p->sd_resp = NULL;
 	}
 
 	p2p->pending_action_state = P2P_NO_PENDING_ACTION;
@@ -874,6 +889,11 @@ void * p2p_sd_request(struct p2p_data *p2p, const u8 *dst,
 void p2p_sd_service_update(struct p2p_data *p2p)
 {
 	p2p->srv_update_indic++;
+	if (p2p->sd_resp && p2p->sd_resp_pos >= wpabuf_len(p2p->sd_resp)) {
+		/* Completed response is for the old set of services */
+		wpabuf_free(p2p->sd_resp);
+		p2p->sd_resp = NULL;
+	}
 }
 
 
@@ -18,6 +18,7 @@
 #include "radius.h"
 #include "radius_client.h"
 #include "eloop.h"
+#include "list.h"
 
 /* Defaults for RADIUS retransmit values (exponential backoff) */
 
@@ -42,11 +43,30 @@
 /**
  * RADIUS_CLIENT_MAX_ENTRIES - RADIUS client maximum pending messages
  *
- * Maximum number of entries in retransmit list (oldest entries will be
- * removed, if this limit is exceeded).
+ * Default maximum number of entries in retransmit list (oldest entries will be
+ * removed, if this limit is exceeded). This can be changed with
+ * struct hostapd_radius_servers::max_pending.
  */
 #define RADIUS_CLIENT_MAX_ENTRIES 30
 
+/**
+ * RADIUS_CLIENT_MAX_PORTS - RADIUS client maximum number of source ports
+ *
+ * Each source port (socket) has its own 8-bit RADIUS Identifier space, so up
+ * to 256 requests per port can be pending at the same time. The number of
+ * ports is configured with struct hostapd_radius_servers::num_client_ports.
+ */
+#define RADIUS_CLIENT_MAX_PORTS 16
+
+/* Request identifier used internally and returned by radius_client_get_id():
+ * source port index and the RADIUS Identifier of the message */
+#define RADIUS_CLIENT_ID(port, identifier) (((port) << 8) | (identifier))
+#define RADIUS_CLIENT_ID_PORT(id) ((id) >> 8)
+
+/* eloop socket context: message type and source port index */
+#define RADIUS_SOCK_CTX(msg_type, port) \
+	((void *) (long) (((port) << 8) | (msg_type)))
+
 /**
  * RADIUS_CLIENT_NUM_FAILOVER - RADIUS client failover point
  *
@@ -140,12 +160,23 @@ struct radius_msg_list {
 	 */
 	size_t shared_secret_len;
 
+	/**
+	 * id - Request identifier (source port index and RADIUS Identifier)
+	 */
+	int id;
+
+	/**
+	 * queued - Whether the message is waiting for room in the in-flight
+	 * window of the server
+	 */
+	int queued;
+
 	/* TODO: server config with failover to backup server(s) */
 
 	/**
-	 * next - Next message in the list
+	 * list - Entry in the list of pending messages (newest first)
 	 */
-	struct radius_msg_list *next;
+	struct dl_list list;
 };
 
 
@@ -169,34 +200,39 @@ struct radius_client_data {
 	struct hostapd_radius_servers *conf;
 
 	/**
-	 * auth_serv_sock - IPv4 socket for RADIUS authentication messages
+	 * num_ports - Number of source ports (sockets) per server type
+	 */
+	int num_ports;
+
+	/**
+	 * auth_serv_sock - IPv4 sockets for RADIUS authentication messages
 	 */
-	int auth_serv_sock;
+	int auth_serv_sock[RADIUS_CLIENT_MAX_PORTS];
 
 	/**
-	 * acct_serv_sock - IPv4 socket for RADIUS accounting messages
+	 * acct_serv_sock - IPv4 sockets for RADIUS accounting messages
 	 */
-	int acct_serv_sock;
+	int acct_serv_sock[RADIUS_CLIENT_MAX_PORTS];
 
 	/**
-	 * auth_serv_sock6 - IPv6 socket for RADIUS authentication messages
+	 * auth_serv_sock6 - IPv6 sockets for RADIUS authentication messages
 	 */
-	int auth_serv_sock6;
+	int auth_serv_sock6[RADIUS_CLIENT_MAX_PORTS];
 
 	/**
-	 * acct_serv_sock6 - IPv6 socket for RADIUS accounting messages
+	 * acct_serv_sock6 - IPv6 sockets for RADIUS accounting messages
 	 */
-	int acct_serv_sock6;
+	int acct_serv_sock6[RADIUS_CLIENT_MAX_PORTS];
 
 	/**
-	 * auth_sock - Currently used socket for RADIUS authentication server
+	 * auth_sock - Currently used sockets for RADIUS authentication server
 	 */
-	int auth_sock;
+	int auth_sock[RADIUS_CLIENT_MAX_PORTS];
 
 	/**
-	 * acct_sock - Currently used socket for RADIUS accounting server
+	 * acct_sock - Currently used sockets for RADIUS accounting server
 	 */
-	int acct_sock;
+	int acct_sock[RADIUS_CLIENT_MAX_PORTS];
 
 	/**
 	 * auth_handlers - Authentication message handlers
@@ -221,7 +257,7 @@ struct radius_client_data {
 	/**
 	 * msgs - Pending outgoing RADIUS messages
 	 */
-	struct radius_msg_list *msgs;
+	struct dl_list msgs;
 
 	/**
 	 * num_msgs - Number of pending messages in the msgs list
@@ -229,19 +265,64 @@ struct radius_client_data {
 	size_t num_msgs;
 
 	/**
-	 * next_radius_identifier - Next RADIUS message identifier to use
+	 * in_flight - Number of sent, unanswered messages in the msgs list
+	 *
+	 * Indexed by radius_client_is_acct(); queued messages are not counted.
 	 */
-	u8 next_radius_identifier;
+	int in_flight[2];
+
+	/**
+	 * pending - Pending messages indexed by request identifier
+	 *
+	 * This table has num_ports * 256 entries and is used to find the
+	 * request that matches a received response.
+	 */
+	struct radius_msg_list **pending;
+
+	/**
+	 * next_id - Counter for allocating request identifiers
+	 */
+	int next_id;
+
+	/**
+	 * reserved_id - Identifier returned by the last radius_client_get_id()
+	 * call that has not yet been used in radius_client_send(), or -1
+	 */
+	int reserved_id;
+
+	/**
+	 * rx_id - Identifier of the request whose response is being
+	 * processed by RX handlers, or -1
+	 */
+	int rx_id;
+
+	/**
+	 * drop_cb - Handler for requests dropped without a response
+	 */
+	void (*drop_cb)(void *ctx, struct radius_msg *msg, RadiusType msg_type,
+			os_time_t first_try);
+
+	/**
+	 * drop_ctx - Context pointer for drop_cb
+	 */
+	void *drop_ctx;
 };
 
 
 static int
 radius_change_server(struct radius_client_data *radius,
 		     struct hostapd_radius_server *nserv,
-		     struct hostapd_radius_server *oserv,
-		     int sock, int sock6, int auth);
-static int radius_client_init_acct(struct radius_client_data *radius);
-static int radius_client_init_auth(struct radius_client_data *radius);
+		     struct hostapd_radius_server *oserv, int auth);
+static int radius_client_init_socks(struct radius_client_data *radius,
+				    int auth);
+static void radius_client_close_socks(struct radius_client_data *radius,
+				      int auth);
+
+
+static int radius_client_is_acct(RadiusType msg_type)
+{
+	return msg_type == RADIUS_ACCT || msg_type == RADIUS_ACCT_INTERIM;
+}
 
 
 static void radius_client_msg_free(struct radius_msg_list *req)
@@ -251,6 +332,40 @@ static void radius_client_msg_free(struct radius_msg_list *req)
 }
 
 
+static void radius_client_msg_unlink(struct radius_client_data *radius,
+				     struct radius_msg_list *req)
+{
+	dl_list_del(&req->list);
+	if (radius->pending[req->id] == req)
+		radius->pending[req->id] = NULL;
+	radius->num_msgs--;
+	if (!req->queued)
+		radius->in_flight[radius_client_is_acct(req->msg_type)]--;
+}
+
+
+static void radius_client_msg_remove(struct radius_client_data *radius,
+				     struct radius_msg_list *req)
+{
+	radius_client_msg_unlink(radius, req);
+	radius_client_msg_free(req);
+}
+
+
+/*
+ * Remove a request that is given up on without a response. Unlike
+ * radius_client_msg_remove(), this reports the message to drop_cb.
+ */
+static void radius_client_msg_drop(struct radius_client_data *radius,
+				   struct radius_msg_list *req)
+{
+	if (radius->drop_cb)
+		radius->drop_cb(radius->drop_ctx, req->msg, req->msg_type,
+				req->first_try);
+	radius_client_msg_remove(radius, req);
+}
+
+
 /**
  * radius_client_register - Register a RADIUS client RX handler
  * @radius: RADIUS client context from radius_client_init()
@@ -309,21 +424,29 @@ static void radius_client_handle_send_error(struct radius_client_data *radius,
 	perror("send[RADIUS]");
 	if (_errno == ENOTCONN || _errno == EDESTADDRREQ || _errno == EINVAL ||
 	    _errno == EBADF) {
+		int auth = !radius_client_is_acct(msg_type);
 		hostapd_logger(radius->ctx, NULL, HOSTAPD_MODULE_RADIUS,
 			       HOSTAPD_LEVEL_INFO,
 			       "Send failed - maybe interface status changed -"
 			       " try to connect again");
-		eloop_unregister_read_sock(s);
-		close(s);
-		if (msg_type == RADIUS_ACCT || msg_type == RADIUS_ACCT_INTERIM)
-			radius_client_init_acct(radius);
-		else
-			radius_client_init_auth(radius);
+		radius_client_close_socks(radius, auth);
+		radius_client_init_socks(radius, auth);
 	}
 #endif /* CONFIG_NATIVE_WINDOWS */
 }
 
 
+static int radius_client_msg_sock(struct radius_client_data *radius,
+				  struct radius_msg_list *entry)
+{
+	int port = RADIUS_CLIENT_ID_PORT(entry->id);
+
+	if (radius_client_is_acct(entry->msg_type))
+		return radius->acct_sock[port];
+	return radius->auth_sock[port];
+}
+
+
 static int radius_client_retransmit(struct radius_client_data *radius,
 				    struct radius_msg_list *entry,
 				    os_time_t now)
@@ -332,9 +455,7 @@ static int radius_client_retransmit(struct radius_client_data *radius,
 	int s;
 	struct wpabuf *buf;
 
-	if (entry->msg_type == RADIUS_ACCT ||
-	    entry->msg_type == RADIUS_ACCT_INTERIM) {
-		s = radius->acct_sock;
+	if (radius_client_is_acct(entry->msg_type)) {
 		if (entry->attempts == 0)
 			conf->acct_server->requests++;
 		else {
@@ -342,7 +463,6 @@ static int radius_client_retransmit(struct radius_client_data *radius,
 			conf->acct_server->retransmissions++;
 		}
 	} else {
-		s = radius->auth_sock;
 		if (entry->attempts == 0)
 			conf->auth_server->requests++;
 		else {
@@ -350,6 +470,7 @@ static int radius_client_retransmit(struct radius_client_data *radius,
 			conf->auth_server->retransmissions++;
 		}
 	}
+	s = radius_client_msg_sock(radius, entry);
 
 	/* retransmit; remove entry if too many attempts */
 	entry->attempts++;
@@ -376,64 +497,87 @@ static int radius_client_retransmit(struct radius_client_data *radius,
 }
 
 
+/*
+ * Send queued messages (oldest first) to the extent the in-flight window of
+ * the current server allows.
+ */
+static int radius_client_send_queued(struct radius_client_data *radius)
+{
+	struct hostapd_radius_servers *conf = radius->conf;
+	struct radius_msg_list *entry;
+	struct os_time now;
+	int room[2], acct, sent = 0;
+
+	if (conf->max_in_flight <= 0)
+		return 0;
+
+	room[0] = conf->max_in_flight - radius->in_flight[0];
+	room[1] = conf->max_in_flight - radius->in_flight[1];
+	if (room[0] <= 0 && room[1] <= 0)
+		return 0;
+
+	os_get_time(&now);
+	dl_list_for_each_reverse(entry, &radius->msgs, struct radius_msg_list,
+				 list) {
+		if (!entry->queued)
+			continue;
+		acct = radius_client_is_acct(entry->msg_type);
+		if (room[acct] <= 0)
+			continue;
+		room[acct]--;
+		entry->queued = 0;
+		radius->in_flight[acct]++;
+		entry->attempts = 0;
+		entry->next_wait = RADIUS_CLIENT_FIRST_WAIT;
+		radius_client_retransmit(radius, entry, now.sec);
+		entry->first_try = entry->last_attempt.sec;
+		sent++;
+	}
+
+	return sent;
+}
+
+
+static void radius_client_update_timeout(struct radius_client_data *radius);
+
+
 static void radius_client_timer(void *eloop_ctx, void *timeout_ctx)
 {
 	struct radius_client_data *radius = eloop_ctx;
 	struct hostapd_radius_servers *conf = radius->conf;
 	struct os_time now;
-	os_time_t first;
-	struct radius_msg_list *entry, *prev, *tmp;
-	int auth_failover = 0, acct_failover = 0;
+	struct radius_msg_list *entry, *n;
+	int auth_failover = 0, acct_failover = 0, removed = 0;
 	char abuf[50];
 
-	entry = radius->msgs;
-	if (!entry)
+	if (dl_list_empty(&radius->msgs))
 		return;
 
 	os_get_time(&now);
-	first = 0;
 
-	prev = NULL;
-	while (entry) {
+	dl_list_for_each_safe(entry, n, &radius->msgs, struct radius_msg_list,
+			      list) {
+		if (entry->queued)
+			continue;
+
 		if (now.sec >= entry->next_try &&
 		    radius_client_retransmit(radius, entry, now.sec)) {
-			if (prev)
-				prev->next = entry->next;
-			else
-				radius->msgs = entry->next;
-
-			tmp = entry;
-			entry = entry->next;
-			radius_client_msg_free(tmp);
-			radius->num_msgs--;
+			radius_client_msg_drop(radius, entry);
+			removed++;
 			continue;
 		}
 
 		if (entry->attempts > RADIUS_CLIENT_NUM_FAILOVER) {
-			if (entry->msg_type == RADIUS_ACCT ||
-			    entry->msg_type == RADIUS_ACCT_INTERIM)
+			if (radius_client_is_acct(entry->msg_type))
 				acct_failover++;
 			else
 				auth_failover++;
 		}
-
-		if (first == 0 || entry->next_try < first)
-			first = entry->next_try;
-
-		prev = entry;
-		entry = entry->next;
 	}
 
-	if (radius->msgs) {
-		if (first < now.sec)
-			first = now.sec;
-		eloop_register_timeout(first - now.sec, 0,
-				       radius_client_timer, radius, NULL);
-		hostapd_logger(radius->ctx, NULL, HOSTAPD_MODULE_RADIUS,
-			       HOSTAPD_LEVEL_DEBUG, "Next RADIUS client "
-			       "retransmit in %ld seconds",
-			       (long int) (first - now.sec));
-	}
+	if (removed)
+		radius_client_send_queued(radius);
+	radius_client_update_timeout(radius);
 
 	if (auth_failover && conf->num_auth_servers > 1) {
 		struct hostapd_radius_server *next, *old;
@@ -445,7 +589,8 @@ static void radius_client_timer(void *eloop_ctx, void *timeout_ctx)
 			       hostapd_ip_txt(&old->addr, abuf, sizeof(abuf)),
 			       old->port);
 
-		for (entry = radius->msgs; entry; entry = entry->next) {
+		dl_list_for_each(entry, &radius->msgs, struct radius_msg_list,
+				 list) {
 			if (entry->msg_type == RADIUS_AUTH)
 				old->timeouts++;
 		}
@@ -454,9 +599,7 @@ static void radius_client_timer(void *eloop_ctx, void *timeout_ctx)
 		if (next > &(conf->auth_servers[conf->num_auth_servers - 1]))
 			next = conf->auth_servers;
 		conf->auth_server = next;
-		radius_change_server(radius, next, old,
-				     radius->auth_serv_sock,
-				     radius->auth_serv_sock6, 1);
+		radius_change_server(radius, next, old, 1);
 	}
 
 	if (acct_failover && conf->num_acct_servers > 1) {
@@ -469,9 +612,9 @@ static void radius_client_timer(void *eloop_ctx, void *timeout_ctx)
 			       hostapd_ip_txt(&old->addr, abuf, sizeof(abuf)),
 			       old->port);
 
-		for (entry = radius->msgs; entry; entry = entry->next) {
-			if (entry->msg_type == RADIUS_ACCT ||
-			    entry->msg_type == RADIUS_ACCT_INTERIM)
+		dl_list_for_each(entry, &radius->msgs, struct radius_msg_list,
+				 list) {
+			if (radius_client_is_acct(entry->msg_type))
 				old->timeouts++;
 		}
 
@@ -479,9 +622,7 @@ static void radius_client_timer(void *eloop_ctx, void *timeout_ctx)
 		if (next > &conf->acct_servers[conf->num_acct_servers - 1])
 			next = conf->acct_servers;
 		conf->acct_server = next;
-		radius_change_server(radius, next, old,
-				     radius->acct_serv_sock,
-				     radius->acct_serv_sock6, 0);
+		radius_change_server(radius, next, old, 0);
 	}
 }
 
@@ -494,16 +635,17 @@ static void radius_client_update_timeout(struct radius_client_data *radius)
 
 	eloop_cancel_timeout(radius_client_timer, radius, NULL);
 
-	if (radius->msgs == NULL) {
-		return;
-	}
-
 	first = 0;
-	for (entry = radius->msgs; entry; entry = entry->next) {
+	dl_list_for_each(entry, &radius->msgs, struct radius_msg_list, list) {
+		if (entry->queued)
+			continue;
 		if (first == 0 || entry->next_try < first)
 			first = entry->next_try;
 	}
 
+	if (first == 0)
+		return;
+
 	os_get_time(&now);
 	if (first < now.sec)
 		first = now.sec;
@@ -519,9 +661,11 @@ static void radius_client_list_add(struct radius_client_data *radius,
 				   struct radius_msg *msg,
 				   RadiusType msg_type,
 				   const u8 *shared_secret,
-				   size_t shared_secret_len, const u8 *addr)
+				   size_t shared_secret_len, const u8 *addr,
+				   int id, int queued)
 {
-	struct radius_msg_list *entry, *prev;
+	struct radius_msg_list *entry;
+	size_t max_pending;
 
 	if (eloop_terminated()) {
 		/* No point in adding entries to retransmit queue since event
@@ -546,59 +690,106 @@ static void radius_client_list_add(struct radius_client_data *radius,
 	os_get_time(&entry->last_attempt);
 	entry->first_try = entry->last_attempt.sec;
 	entry->next_try = entry->first_try + RADIUS_CLIENT_FIRST_WAIT;
-	entry->attempts = 1;
+	entry->attempts = queued ? 0 : 1;
 	entry->next_wait = RADIUS_CLIENT_FIRST_WAIT * 2;
-	entry->next = radius->msgs;
-	radius->msgs = entry;
-	radius_client_update_timeout(radius);
-
-	if (radius->num_msgs >= RADIUS_CLIENT_MAX_ENTRIES) {
+	entry->id = id;
+	entry->queued = queued;
+	if (!queued)
+		radius->in_flight[radius_client_is_acct(msg_type)]++;
+	dl_list_add(&radius->msgs, &entry->list);
+	radius->pending[id] = entry;
+	radius->num_msgs++;
+
+	max_pending = radius->conf->max_pending > 0 ?
+		(size_t) radius->conf->max_pending : RADIUS_CLIENT_MAX_ENTRIES;
+	if (radius->num_msgs > max_pending) {
 		printf("Removing the oldest un-ACKed RADIUS packet due to "
 		       "retransmit list limits.\n");
-		prev = NULL;
-		while (entry->next) {
-			prev = entry;
-			entry = entry->next;
-		}
-		if (prev) {
-			prev->next = NULL;
-			radius_client_msg_free(entry);
-		}
-	} else
-		radius->num_msgs++;
+		radius_client_msg_drop(
+			radius, dl_list_last(&radius->msgs,
+					     struct radius_msg_list, list));
+	}
+
+	radius_client_update_timeout(radius);
 }
 
 
 static void radius_client_list_del(struct radius_client_data *radius,
 				   RadiusType msg_type, const u8 *addr)
 {
-	struct radius_msg_list *entry, *prev, *tmp;
+	struct radius_msg_list *entry, *n;
+	int removed = 0;
 
 	if (addr == NULL)
 		return;
 
-	entry = radius->msgs;
-	prev = NULL;
-	while (entry) {
+	dl_list_for_each_safe(entry, n, &radius->msgs, struct radius_msg_list,
+			      list) {
 		if (entry->msg_type == msg_type &&
 		    os_memcmp(entry->addr, addr, ETH_ALEN) == 0) {
-			if (prev)
-				prev->next = entry->next;
-			else
-				radius->msgs = entry->next;
-			tmp = entry;
-			entry = entry->next;
 			hostapd_logger(radius->ctx, addr,
 				       HOSTAPD_MODULE_RADIUS,
 				       HOSTAPD_LEVEL_DEBUG,
 				       "Removing matching RADIUS message");
-			radius_client_msg_free(tmp);
-			radius->num_msgs--;
-			continue;
+			radius_client_msg_remove(radius, entry);
+			removed++;
 		}
-		prev = entry;
-		entry = entry->next;
 	}
+
+	if (removed && radius_client_send_queued(radius))
+		radius_client_update_timeout(radius);
+}
+
+
+static void radius_client_release_id(struct radius_client_data *radius,
+				     int id)
+{
+	struct radius_msg_list *entry = radius->pending[id];
+
+	if (entry == NULL)
+		return;
+
+	/* remove entry with matching id from retransmit list to avoid using
+	 * new reply from the RADIUS server with an old request */
+	hostapd_logger(radius->ctx, entry->addr, HOSTAPD_MODULE_RADIUS,
+		       HOSTAPD_LEVEL_DEBUG,
+		       "Removing pending RADIUS message, since its id (%d) is "
+		       "reused", id & 0xff);
+	radius_client_msg_drop(radius, entry);
+	if (radius_client_send_queued(radius))
+		radius_client_update_timeout(radius);
+}
+
+
+/*
+ * Find the request identifier (source port) for a message that is about to be
+ * sent. This is normally the value from the preceding radius_client_get_id()
+ * call.
+ */
+static int radius_client_msg_id(struct radius_client_data *radius,
+				struct radius_msg *msg)
+{
+	u8 identifier = radius_msg_get_hdr(msg)->identifier;
+	int port, id;
+
+	if (radius->reserved_id >= 0 &&
+	    (radius->reserved_id & 0xff) == identifier) {
+		id = radius->reserved_id;
+		radius->reserved_id = -1;
+	} else {
+		id = RADIUS_CLIENT_ID(0, identifier);
+		for (port = 0; port < radius->num_ports; port++) {
+			if (radius->pending[RADIUS_CLIENT_ID(port,
+							     identifier)] ==
+			    NULL) {
+				id = RADIUS_CLIENT_ID(port, identifier);
+				break;
+			}
+		}
+	}
+
+	radius_client_release_id(radius, id);
+	return id;
 }
 
 
@@ -618,7 +809,12 @@ static void radius_client_list_del(struct radius_client_data *radius,
  *
  * The message is added on the retransmission queue and will be retransmitted
  * automatically until a response is received or maximum number of retries
- * (RADIUS_CLIENT_MAX_RETRIES) is reached.
+ * (RADIUS_CLIENT_MAX_RETRIES) is reached. If the in-flight window of the
+ * server (struct hostapd_radius_servers::max_in_flight) is full, the message
+ * is queued and sent once a response to an earlier request is received.
+ *
+ * The message is sent through the source port that was selected when its
+ * identifier was allocated with radius_client_get_id().
  *
  * The related device MAC address can be used to identify pending messages that
  * can be removed with radius_client_flush_auth() or with interim accounting
@@ -629,10 +825,11 @@ int radius_client_send(struct radius_client_data *radius,
 		       const u8 *addr)
 {
 	struct hostapd_radius_servers *conf = radius->conf;
+	struct hostapd_radius_server *serv;
 	const u8 *shared_secret;
 	size_t shared_secret_len;
 	char *name;
-	int s, res;
+	int s, res = 0, id, acct, queued = 0;
 	struct wpabuf *buf;
 
 	if (msg_type == RADIUS_ACCT_INTERIM) {
@@ -640,7 +837,8 @@ int radius_client_send(struct radius_client_data *radius,
 		radius_client_list_del(radius, msg_type, addr);
 	}
 
-	if (msg_type == RADIUS_ACCT || msg_type == RADIUS_ACCT_INTERIM) {
+	acct = radius_client_is_acct(msg_type);
+	if (acct) {
 		if (conf->acct_server == NULL) {
 			hostapd_logger(radius->ctx, NULL,
 				       HOSTAPD_MODULE_RADIUS,
@@ -648,12 +846,11 @@ int radius_client_send(struct radius_client_data *radius,
 				       "No accounting server configured");
 			return -1;
 		}
-		shared_secret = conf->acct_server->shared_secret;
-		shared_secret_len = conf->acct_server->shared_secret_len;
+		serv = conf->acct_server;
+		shared_secret = serv->shared_secret;
+		shared_secret_len = serv->shared_secret_len;
 		radius_msg_finish_acct(msg, shared_secret, shared_secret_len);
 		name = "accounting";
-		s = radius->acct_sock;
-		conf->acct_server->requests++;
 	} else {
 		if (conf->auth_server == NULL) {
 			hostapd_logger(radius->ctx, NULL,
@@ -662,27 +859,43 @@ int radius_client_send(struct radius_client_data *radius,
 				       "No authentication server configured");
 			return -1;
 		}
-		shared_secret = conf->auth_server->shared_secret;
-		shared_secret_len = conf->auth_server->shared_secret_len;
+		serv = conf->auth_server;
+		shared_secret = serv->shared_secret;
+		shared_secret_len = serv->shared_secret_len;
 		radius_msg_finish(msg, shared_secret, shared_secret_len);
 		name = "authentication";
-		s = radius->auth_sock;
-		conf->auth_server->requests++;
 	}
 
-	hostapd_logger(radius->ctx, NULL, HOSTAPD_MODULE_RADIUS,
-		       HOSTAPD_LEVEL_DEBUG, "Sending RADIUS message to %s "
-		       "server", name);
-	if (conf->msg_dumps)
-		radius_msg_dump(msg);
+	id = radius_client_msg_id(radius, msg);
+	if (conf->max_in_flight > 0 &&
+	    radius->in_flight[acct] >= conf->max_in_flight)
+		queued = 1;
 
-	buf = radius_msg_get_buf(msg);
-	res = send(s, wpabuf_head(buf), wpabuf_len(buf), 0);
-	if (res < 0)
-		radius_client_handle_send_error(radius, s, msg_type);
+	if (queued) {
+		hostapd_logger(radius->ctx, NULL, HOSTAPD_MODULE_RADIUS,
+			       HOSTAPD_LEVEL_DEBUG, "Queueing RADIUS message "
+			       "to %s server (%d requests in flight)",
+			       name, conf->max_in_flight);
+	} else {
+		serv->requests++;
+		hostapd_logger(radius->ctx, NULL, HOSTAPD_MODULE_RADIUS,
+			       HOSTAPD_LEVEL_DEBUG, "Sending RADIUS message to "
+			       "%s server", name);
+		if (conf->msg_dumps)
+			radius_msg_dump(msg);
+
+		if (acct)
+			s = radius->acct_sock[RADIUS_CLIENT_ID_PORT(id)];
+		else
+			s = radius->auth_sock[RADIUS_CLIENT_ID_PORT(id)];
+		buf = radius_msg_get_buf(msg);
+		res = send(s, wpabuf_head(buf), wpabuf_len(buf), 0);
+		if (res < 0)
+			radius_client_handle_send_error(radius, s, msg_type);
+	}
 
 	radius_client_list_add(radius, msg, msg_type, shared_secret,
-			       shared_secret_len, addr);
+			       shared_secret_len, addr, id, queued);
 
 	return res;
 }
@@ -692,14 +905,15 @@ static void radius_client_receive(int sock, void *eloop_ctx, void *sock_ctx)
 {
 	struct radius_client_data *radius = eloop_ctx;
 	struct hostapd_radius_servers *conf = radius->conf;
-	RadiusType msg_type = (RadiusType) sock_ctx;
+	RadiusType msg_type = (RadiusType) ((long) sock_ctx & 0xff);
+	int port = (long) sock_ctx >> 8;
 	int len, roundtrip;
 	unsigned char buf[3000];
 	struct radius_msg *msg;
 	struct radius_hdr *hdr;
 	struct radius_rx_handler *handlers;
 	size_t num_handlers, i;
-	struct radius_msg_list *req, *prev_req;
+	struct radius_msg_list *req;
 	struct os_time now;
 	struct hostapd_radius_server *rconf;
 	int invalid_authenticator = 0;
@@ -756,21 +970,17 @@ static void radius_client_receive(int sock, void *eloop_ctx, void *sock_ctx)
 		break;
 	}
 
-	prev_req = NULL;
-	req = radius->msgs;
-	while (req) {
-		/* TODO: also match by src addr:port of the packet when using
-		 * alternative RADIUS servers (?) */
-		if ((req->msg_type == msg_type ||
-		     (req->msg_type == RADIUS_ACCT_INTERIM &&
-		      msg_type == RADIUS_ACCT)) &&
-		    radius_msg_get_hdr(req->msg)->identifier ==
-		    hdr->identifier)
-			break;
-
-		prev_req = req;
-		req = req->next;
-	}
+	/* TODO: also match by src addr:port of the packet when using
+	 * alternative RADIUS servers (?) */
+	req = NULL;
+	if (port < radius->num_ports)
+		req = radius->pending[RADIUS_CLIENT_ID(port, hdr->identifier)];
+	if (req &&
+	    (req->queued ||
+	     !(req->msg_type == msg_type ||
+	       (req->msg_type == RADIUS_ACCT_INTERIM &&
+		msg_type == RADIUS_ACCT))))
+		req = NULL;
 
 	if (req == NULL) {
 		hostapd_logger(radius->ctx, NULL, HOSTAPD_MODULE_RADIUS,
@@ -792,11 +1002,8 @@ static void radius_client_receive(int sock, void *eloop_ctx, void *sock_ctx)
 	rconf->round_trip_time = roundtrip;
 
 	/* Remove ACKed RADIUS packet from retransmit list */
-	if (prev_req)
-		prev_req->next = req->next;
-	else
-		radius->msgs = req->next;
-	radius->num_msgs--;
+	radius_client_msg_unlink(radius, req);
+	radius->rx_id = req->id;
 
 	for (i = 0; i < num_handlers; i++) {
 		RadiusRxResult res;
@@ -808,8 +1015,8 @@ static void radius_client_receive(int sock, void *eloop_ctx, void *sock_ctx)
 			radius_msg_free(msg);
 			/* continue */
 		case RADIUS_RX_QUEUED:
-			radius_client_msg_free(req);
-			return;
+			msg = NULL;
+			goto done;
 		case RADIUS_RX_INVALID_AUTHENTICATOR:
 			invalid_authenticator++;
 			/* continue */
@@ -829,7 +1036,12 @@ static void radius_client_receive(int sock, void *eloop_ctx, void *sock_ctx)
 		       msg_type, hdr->code, hdr->identifier,
 		       invalid_authenticator ? " [INVALID AUTHENTICATOR]" :
 		       "");
+
+ done:
+	radius->rx_id = -1;
 	radius_client_msg_free(req);
+	if (radius_client_send_queued(radius))
+		radius_client_update_timeout(radius);
 
  fail:
 	radius_msg_free(msg);
@@ -842,43 +1054,71 @@ static void radius_client_receive(int sock, void *eloop_ctx, void *sock_ctx)
  * Returns: Allocated identifier
  *
  * This function is used to fetch a unique (among pending requests) identifier
- * for a new RADIUS message.
+ * for a new RADIUS message. The returned value identifies both the source
+ * port and the RADIUS Identifier; its eight least significant bits are the
+ * RADIUS Identifier to use in radius_msg_new(). The message has to be sent
+ * with radius_client_send() before the next identifier is requested. The
+ * value can be compared against radius_client_get_req_id() in RX handlers.
  */
-u8 radius_client_get_id(struct radius_client_data *radius)
+int radius_client_get_id(struct radius_client_data *radius)
 {
-	struct radius_msg_list *entry, *prev, *_remove;
-	u8 id = radius->next_radius_identifier++;
-
-	/* remove entries with matching id from retransmit list to avoid
-	 * using new reply from the RADIUS server with an old request */
-	entry = radius->msgs;
-	prev = NULL;
-	while (entry) {
-		if (radius_msg_get_hdr(entry->msg)->identifier == id) {
-			hostapd_logger(radius->ctx, entry->addr,
-				       HOSTAPD_MODULE_RADIUS,
-				       HOSTAPD_LEVEL_DEBUG,
-				       "Removing pending RADIUS message, "
-				       "since its id (%d) is reused", id);
-			if (prev)
-				prev->next = entry->next;
-			else
-				radius->msgs = entry->next;
-			_remove = entry;
-		} else {
-			_remove = NULL;
-			prev = entry;
-		}
-		entry = entry->next;
-
-		if (_remove)
-			radius_client_msg_free(_remove);
+	int size = radius->num_ports * 256;
+	int i, n, id = 0;
+
+	/* Rotate over the source ports so that a RADIUS Identifier is reused
+	 * on a port only after all identifiers on all ports have been used */
+	for (i = 0; i < size; i++) {
+		n = radius->next_id;
+		radius->next_id = (n + 1) % size;
+		id = RADIUS_CLIENT_ID(n % radius->num_ports,
+				      n / radius->num_ports);
+		if (radius->pending[id] == NULL)
+			break;
 	}
 
+	radius_client_release_id(radius, id);
+	radius->reserved_id = id;
+
 	return id;
 }
 
 
+/**
+ * radius_client_get_req_id - Get the identifier of the matched request
+ * @radius: RADIUS client context from radius_client_init()
+ * Returns: Identifier (from radius_client_get_id()) of the request that the
+ * RADIUS message currently being processed by RX handlers is a response to,
+ * or -1 if not called from an RX handler
+ */
+int radius_client_get_req_id(struct radius_client_data *radius)
+{
+	return radius->rx_id;
+}
+
+
+/**
+ * radius_client_set_drop_cb - Set handler for dropped requests
+ * @radius: RADIUS client context from radius_client_init()
+ * @cb: Handler or %NULL to remove the handler
+ * @ctx: Context pointer for the handler
+ *
+ * The handler is called for requests that are removed without a response
+ * having been received, e.g., due to too many retransmissions, retransmit list
+ * limits, or radius_client_flush(). The message is freed after the handler
+ * returns. This allows callers (e.g., accounting) to store requests that
+ * would otherwise be lost.
+ */
+void radius_client_set_drop_cb(struct radius_client_data *radius,
+			       void (*cb)(void *ctx, struct radius_msg *msg,
+					  RadiusType msg_type,
+					  os_time_t first_try),
+			       void *ctx)
+{
+	radius->drop_cb = cb;
+	radius->drop_ctx = ctx;
+}
+
+
 /**
  * radius_client_flush - Flush all pending RADIUS client messages
  * @radius: RADIUS client context from radius_client_init()
@@ -886,33 +1126,54 @@ u8 radius_client_get_id(struct radius_client_data *radius)
  */
 void radius_client_flush(struct radius_client_data *radius, int only_auth)
 {
-	struct radius_msg_list *entry, *prev, *tmp;
+	struct radius_msg_list *entry, *n;
+	int removed = 0;
 
 	if (!radius)
 		return;
 
-	prev = NULL;
-	entry = radius->msgs;
-
-	while (entry) {
+	dl_list_for_each_safe(entry, n, &radius->msgs, struct radius_msg_list,
+			      list) {
 		if (!only_auth || entry->msg_type == RADIUS_AUTH) {
-			if (prev)
-				prev->next = entry->next;
-			else
-				radius->msgs = entry->next;
-
-			tmp = entry;
-			entry = entry->next;
-			radius_client_msg_free(tmp);
-			radius->num_msgs--;
-		} else {
-			prev = entry;
-			entry = entry->next;
+			radius_client_msg_drop(radius, entry);
+			removed++;
+		}
+	}
+
+	if (dl_list_empty(&radius->msgs))
+		eloop_cancel_timeout(radius_client_timer, radius, NULL);
+	else if (removed && radius_client_send_queued(radius))
+		radius_client_update_timeout(radius);
+}
+
+
+/**
+ * radius_client_flush_acct - Flush pending RADIUS accounting messages
+ * @radius: RADIUS client context from radius_client_init()
+ *
+ * The removed messages are reported to the handler registered with
+ * radius_client_set_drop_cb().
+ */
+void radius_client_flush_acct(struct radius_client_data *radius)
+{
+	struct radius_msg_list *entry, *n;
+	int removed = 0;
+
+	if (!radius)
+		return;
+
+	dl_list_for_each_safe(entry, n, &radius->msgs, struct radius_msg_list,
+			      list) {
+		if (radius_client_is_acct(entry->msg_type)) {
+			radius_client_msg_drop(radius, entry);
+			removed++;
 		}
 	}
 
-	if (radius->msgs == NULL)
+	if (dl_list_empty(&radius->msgs))
 		eloop_cancel_timeout(radius_client_timer, radius, NULL);
+	else if (removed && radius_client_send_queued(radius))
+		radius_client_update_timeout(radius);
 }
 
 
@@ -925,7 +1186,7 @@ static void radius_client_update_acct_msgs(struct radius_client_data *radius,
 	if (!radius)
 		return;
 
-	for (entry = radius->msgs; entry; entry = entry->next) {
+	dl_list_for_each(entry, &radius->msgs, struct radius_msg_list, list) {
 		if (entry->msg_type == RADIUS_ACCT) {
 			entry->shared_secret = shared_secret;
 			entry->shared_secret_len = shared_secret_len;
@@ -936,11 +1197,9 @@ static void radius_client_update_acct_msgs(struct radius_client_data *radius,
 }
 
 
-static int
-radius_change_server(struct radius_client_data *radius,
-		     struct hostapd_radius_server *nserv,
-		     struct hostapd_radius_server *oserv,
-		     int sock, int sock6, int auth)
+static int radius_client_connect(struct radius_client_data *radius,
+				 struct hostapd_radius_server *nserv,
+				 int port, int auth)
 {
 	struct sockaddr_in serv, claddr;
 #ifdef CONFIG_IPV6
@@ -948,53 +1207,12 @@ radius_change_server(struct radius_client_data *radius,
 #endif /* CONFIG_IPV6 */
 	struct sockaddr *addr, *cl_addr;
 	socklen_t addrlen, claddrlen;
+#ifdef CONFIG_IPV6
 	char abuf[50];
+#endif /* CONFIG_IPV6 */
 	int sel_sock;
-	struct radius_msg_list *entry;
 	struct hostapd_radius_servers *conf = radius->conf;
 
-	hostapd_logger(radius->ctx, NULL, HOSTAPD_MODULE_RADIUS,
-		       HOSTAPD_LEVEL_INFO,
-		       "%s server %s:%d",
-		       auth ? "Authentication" : "Accounting",
-		       hostapd_ip_txt(&nserv->addr, abuf, sizeof(abuf)),
-		       nserv->port);
-
-	if (!oserv || nserv->shared_secret_len != oserv->shared_secret_len ||
-	    os_memcmp(nserv->shared_secret, oserv->shared_secret,
-		      nserv->shared_secret_len) != 0) {
-		/* Pending RADIUS packets used different shared secret, so
-		 * they need to be modified. Update accounting message
-		 * authenticators here. Authentication messages are removed
-		 * since they would require more changes and the new RADIUS
-		 * server may not be prepared to receive them anyway due to
-		 * missing state information. Client will likely retry
-		 * authentication, so this should not be an issue. */
-		if (auth)
-			radius_client_flush(radius, 1);
-		else {
-			radius_client_update_acct_msgs(
-				radius, nserv->shared_secret,
-				nserv->shared_secret_len);
-		}
-	}
-
-	/* Reset retry counters for the new server */
-	for (entry = radius->msgs; entry; entry = entry->next) {
-		if ((auth && entry->msg_type != RADIUS_AUTH) ||
-		    (!auth && entry->msg_type != RADIUS_ACCT))
-			continue;
-		entry->next_try = entry->first_try + RADIUS_CLIENT_FIRST_WAIT;
-		entry->attempts = 0;
-		entry->next_wait = RADIUS_CLIENT_FIRST_WAIT * 2;
-	}
-
-	if (radius->msgs) {
-		eloop_cancel_timeout(radius_client_timer, radius, NULL);
-		eloop_register_timeout(RADIUS_CLIENT_FIRST_WAIT, 0,
-				       radius_client_timer, radius, NULL);
-	}
-
 	switch (nserv->addr.af) {
 	case AF_INET:
 		os_memset(&serv, 0, sizeof(serv));
@@ -1003,7 +1221,8 @@ radius_change_server(struct radius_client_data *radius,
 		serv.sin_port = htons(nserv->port);
 		addr = (struct sockaddr *) &serv;
 		addrlen = sizeof(serv);
-		sel_sock = sock;
+		sel_sock = auth ? radius->auth_serv_sock[port] :
+			radius->acct_serv_sock[port];
 		break;
 #ifdef CONFIG_IPV6
 	case AF_INET6:
@@ -1014,7 +1233,8 @@ radius_change_server(struct radius_client_data *radius,
 		serv6.sin6_port = htons(nserv->port);
 		addr = (struct sockaddr *) &serv6;
 		addrlen = sizeof(serv6);
-		sel_sock = sock6;
+		sel_sock = auth ? radius->auth_serv_sock6[port] :
+			radius->acct_serv_sock6[port];
 		break;
 #endif /* CONFIG_IPV6 */
 	default:
@@ -1081,36 +1301,93 @@ radius_change_server(struct radius_client_data *radius,
 #endif /* CONFIG_NATIVE_WINDOWS */
 
 	if (auth)
-		radius->auth_sock = sel_sock;
+		radius->auth_sock[port] = sel_sock;
 	else
-		radius->acct_sock = sel_sock;
+		radius->acct_sock[port] = sel_sock;
 
 	return 0;
 }
 
 
+static int
+radius_change_server(struct radius_client_data *radius,
+		     struct hostapd_radius_server *nserv,
+		     struct hostapd_radius_server *oserv, int auth)
+{
+	char abuf[50];
+	struct radius_msg_list *entry;
+	int port, ret = 0;
+
+	hostapd_logger(radius->ctx, NULL, HOSTAPD_MODULE_RADIUS,
+		       HOSTAPD_LEVEL_INFO,
+		       "%s server %s:%d",
+		       auth ? "Authentication" : "Accounting",
+		       hostapd_ip_txt(&nserv->addr, abuf, sizeof(abuf)),
+		       nserv->port);
+
+	if (!oserv || nserv->shared_secret_len != oserv->shared_secret_len ||
+	    os_memcmp(nserv->shared_secret, oserv->shared_secret,
+		      nserv->shared_secret_len) != 0) {
+		/* Pending RADIUS packets used different shared secret, so
+		 * they need to be modified. Update accounting message
+		 * authenticators here. Authentication messages are removed
+		 * since they would require more changes and the new RADIUS
+		 * server may not be prepared to receive them anyway due to
+		 * missing state information. Client will likely retry
+		 * authentication, so this should not be an issue. */
+		if (auth)
+			radius_client_flush(radius, 1);
+		else {
+			radius_client_update_acct_msgs(
+				radius, nserv->shared_secret,
+				nserv->shared_secret_len);
+		}
+	}
+
+	/* Reset retry counters for the new server */
+	dl_list_for_each(entry, &radius->msgs, struct radius_msg_list, list) {
+		if ((auth && entry->msg_type != RADIUS_AUTH) ||
+		    (!auth && entry->msg_type != RADIUS_ACCT) ||
+		    entry->queued)
+			continue;
+		entry->next_try = entry->first_try + RADIUS_CLIENT_FIRST_WAIT;
+		entry->attempts = 0;
+		entry->next_wait = RADIUS_CLIENT_FIRST_WAIT * 2;
+	}
+
+	if (!dl_list_empty(&radius->msgs)) {
+		eloop_cancel_timeout(radius_client_timer, radius, NULL);
+		eloop_register_timeout(RADIUS_CLIENT_FIRST_WAIT, 0,
+				       radius_client_timer, radius, NULL);
+	}
+
+	for (port = 0; port < radius->num_ports; port++) {
+		if (radius_client_connect(radius, nserv, port, auth) < 0)
+			ret = -1;
+	}
+
+	return ret;
+}
+
+
 static void radius_retry_primary_timer(void *eloop_ctx, void *timeout_ctx)
 {
 	struct radius_client_data *radius = eloop_ctx;
 	struct hostapd_radius_servers *conf = radius->conf;
 	struct hostapd_radius_server *oserv;
 
-	if (radius->auth_sock >= 0 && conf->auth_servers &&
+	if (radius->auth_sock[0] >= 0 && conf->auth_servers &&
 	    conf->auth_server != conf->auth_servers) {
 		oserv = conf->auth_server;
 		conf->auth_server = conf->auth_servers;
-		radius_change_server(radius, conf->auth_server, oserv,
-				     radius->auth_serv_sock,
-				     radius->auth_serv_sock6, 1);
+		radius_change_server(radius, conf->auth_server, oserv, 1);
 	}
 
-	if (radius->acct_sock >= 0 && conf->acct_servers &&
+	if (radius->acct_sock[0] >= 0 && conf->acct_servers &&
 	    conf->acct_server != conf->acct_servers) {
 		oserv = conf->acct_server;
 		conf->acct_server = conf->acct_servers;
-		radius_change_server(radius, conf->acct_server, oserv,
-				     radius->acct_serv_sock,
-				     radius->acct_serv_sock6, 0);
+		radius_change_server(radius, conf->acct_server, oserv, 0);
 	}
 
 	if (conf->retry_primary_interval)
@@ -1136,107 +1413,93 @@ static int radius_client_disable_pmtu_discovery(int s)
 }
 
 
-static int radius_client_init_auth(struct radius_client_data *radius)
+static int radius_client_init_socks(struct radius_client_data *radius,
+				    int auth)
 {
 	struct hostapd_radius_servers *conf = radius->conf;
-	int ok = 0;
-
-	radius->auth_serv_sock = socket(PF_INET, SOCK_DGRAM, 0);
-	if (radius->auth_serv_sock < 0)
-		perror("socket[PF_INET,SOCK_DGRAM]");
-	else {
-		radius_client_disable_pmtu_discovery(radius->auth_serv_sock);
-		ok++;
-	}
-
+	RadiusType msg_type = auth ? RADIUS_AUTH : RADIUS_ACCT;
+	int *socks = auth ? radius->auth_serv_sock : radius->acct_serv_sock;
 #ifdef CONFIG_IPV6
-	radius->auth_serv_sock6 = socket(PF_INET6, SOCK_DGRAM, 0);
-	if (radius->auth_serv_sock6 < 0)
-		perror("socket[PF_INET6,SOCK_DGRAM]");
-	else
-		ok++;
+	int *socks6 = auth ? radius->auth_serv_sock6 : radius->acct_serv_sock6;
 #endif /* CONFIG_IPV6 */
+	int port, ok;
 
-	if (ok == 0)
-		return -1;
+	for (port = 0; port < radius->num_ports; port++) {
+		ok = 0;
+		socks[port] = socket(PF_INET, SOCK_DGRAM, 0);
+		if (socks[port] < 0)
+			perror("socket[PF_INET,SOCK_DGRAM]");
+		else {
+			radius_client_disable_pmtu_discovery(socks[port]);
+			ok++;
+		}
 
-	radius_change_server(radius, conf->auth_server, NULL,
-			     radius->auth_serv_sock, radius->auth_serv_sock6,
-			     1);
+#ifdef CONFIG_IPV6
+		socks6[port] = socket(PF_INET6, SOCK_DGRAM, 0);
+		if (socks6[port] < 0)
+			perror("socket[PF_INET6,SOCK_DGRAM]");
+		else
+			ok++;
+#endif /* CONFIG_IPV6 */
 
-	if (radius->auth_serv_sock >= 0 &&
-	    eloop_register_read_sock(radius->auth_serv_sock,
-				     radius_client_receive, radius,
-				     (void *) RADIUS_AUTH)) {
-		printf("Could not register read socket for authentication "
-		       "server\n");
-		return -1;
+		if (ok == 0)
+			return -1;
 	}
 
+	radius_change_server(radius, auth ? conf->auth_server :
+			     conf->acct_server, NULL, auth);
+
+	for (port = 0; port < radius->num_ports; port++) {
+		if (socks[port] >= 0 &&
+		    eloop_register_read_sock(socks[port],
+					     radius_client_receive, radius,
+					     RADIUS_SOCK_CTX(msg_type,
+							     port))) {
+			printf("Could not register read socket for %s "
+			       "server\n",
+			       auth ? "authentication" : "accounting");
+			return -1;
+		}
+
 #ifdef CONFIG_IPV6
-	if (radius->auth_serv_sock6 >= 0 &&
-	    eloop_register_read_sock(radius->auth_serv_sock6,
-				     radius_client_receive, radius,
-				     (void *) RADIUS_AUTH)) {
-		printf("Could not register read socket for authentication "
-		       "server\n");
-		return -1;
-	}
+		if (socks6[port] >= 0 &&
+		    eloop_register_read_sock(socks6[port],
+					     radius_client_receive, radius,
+					     RADIUS_SOCK_CTX(msg_type,
+							     port))) {
+			printf("Could not register read socket for %s "
+			       "server\n",
+			       auth ? "authentication" : "accounting");
+			return -1;
+		}
 #endif /* CONFIG_IPV6 */
+	}
 
 	return 0;
 }
 
 
-static int radius_client_init_acct(struct radius_client_data *radius)
+static void radius_client_close_socks(struct radius_client_data *radius,
+				      int auth)
 {
-	struct hostapd_radius_servers *conf = radius->conf;
-	int ok = 0;
-
-	radius->acct_serv_sock = socket(PF_INET, SOCK_DGRAM, 0);
-	if (radius->acct_serv_sock < 0)
-		perror("socket[PF_INET,SOCK_DGRAM]");
-	else {
-		radius_client_disable_pmtu_discovery(radius->acct_serv_sock);
-		ok++;
-	}
-
-#ifdef CONFIG_IPV6
-	radius->acct_serv_sock6 = socket(PF_INET6, SOCK_DGRAM, 0);
-	if (radius->acct_serv_sock6 < 0)
-		perror("socket[PF_INET6,SOCK_DGRAM]");
-	else
-		ok++;
-#endif /* CONFIG_IPV6 */
-
-	if (ok == 0)
-		return -1;
-
-	radius_change_server(radius, conf->acct_server, NULL,
-			     radius->acct_serv_sock, radius->acct_serv_sock6,
-			     0);
-
-	if (radius->acct_serv_sock >= 0 &&
-	    eloop_register_read_sock(radius->acct_serv_sock,
-				     radius_client_receive, radius,
-				     (void *) RADIUS_ACCT)) {
-		printf("Could not register read socket for accounting "
-		       "server\n");
-		return -1;
-	}
-
-#ifdef CONFIG_IPV6
-	if (radius->acct_serv_sock6 >= 0 &&
-	    eloop_register_read_sock(radius->acct_serv_sock6,
-				     radius_client_receive, radius,
-				     (void *) RADIUS_ACCT)) {
-		printf("Could not register read socket for accounting "
-		       "server\n");
-		return -1;
+	int *socks = auth ? radius->auth_serv_sock : radius->acct_serv_sock;
+	int *socks6 = auth ? radius->auth_serv_sock6 : radius->acct_serv_sock6;
+	int *cur = auth ? radius->auth_sock : radius->acct_sock;
+	int port;
+
+	for (port = 0; port < RADIUS_CLIENT_MAX_PORTS; port++) {
+		if (socks[port] >= 0) {
+			eloop_unregister_read_sock(socks[port]);
+			close(socks[port]);
+			socks[port] = -1;
+		}
+		if (socks6[port] >= 0) {
+			eloop_unregister_read_sock(socks6[port]);
+			close(socks6[port]);
+			socks6[port] = -1;
+		}
+		cur[port] = -1;
 	}
-#endif /* CONFIG_IPV6 */
-
-	return 0;
 }
 
 
@@ -1254,6 +1517,7 @@ struct radius_client_data *
 radius_client_init(void *ctx, struct hostapd_radius_servers *conf)
 {
 	struct radius_client_data *radius;
+	int port;
 
 	radius = os_zalloc(sizeof(struct radius_client_data));
 	if (radius == NULL)
@@ -1261,16 +1525,33 @@ radius_client_init(void *ctx, struct hostapd_radius_servers *conf)
 
 	radius->ctx = ctx;
 	radius->conf = conf;
-	radius->auth_serv_sock = radius->acct_serv_sock =
-		radius->auth_serv_sock6 = radius->acct_serv_sock6 =
-		radius->auth_sock = radius->acct_sock = -1;
+	dl_list_init(&radius->msgs);
+	radius->reserved_id = radius->rx_id = -1;
+	for (port = 0; port < RADIUS_CLIENT_MAX_PORTS; port++) {
+		radius->auth_serv_sock[port] = radius->acct_serv_sock[port] =
+			radius->auth_serv_sock6[port] =
+			radius->acct_serv_sock6[port] =
+			radius->auth_sock[port] = radius->acct_sock[port] = -1;
+	}
 
-	if (conf->auth_server && radius_client_init_auth(radius)) {
+	radius->num_ports = conf->num_client_ports;
+	if (radius->num_ports < 1)
+		radius->num_ports = 1;
+	if (radius->num_ports > RADIUS_CLIENT_MAX_PORTS)
+		radius->num_ports = RADIUS_CLIENT_MAX_PORTS;
+	radius->pending = os_zalloc(radius->num_ports * 256 *
+				    sizeof(struct radius_msg_list *));
+	if (radius->pending == NULL) {
+		os_free(radius);
+		return NULL;
+	}
+
+	if (conf->auth_server && radius_client_init_socks(radius, 1)) {
 		radius_client_deinit(radius);
 		return NULL;
 	}
 
-	if (conf->acct_server && radius_client_init_acct(radius)) {
+	if (conf->acct_server && radius_client_init_socks(radius, 0)) {
 		radius_client_deinit(radius);
 		return NULL;
 	}
@@ -1293,20 +1574,13 @@ void radius_client_deinit(struct radius_client_data *radius)
 	if (!radius)
 		return;
 
-	if (radius->auth_serv_sock >= 0)
-		eloop_unregister_read_sock(radius->auth_serv_sock);
-	if (radius->acct_serv_sock >= 0)
-		eloop_unregister_read_sock(radius->acct_serv_sock);
-#ifdef CONFIG_IPV6
-	if (radius->auth_serv_sock6 >= 0)
-		eloop_unregister_read_sock(radius->auth_serv_sock6);
-	if (radius->acct_serv_sock6 >= 0)
-		eloop_unregister_read_sock(radius->acct_serv_sock6);
-#endif /* CONFIG_IPV6 */
+	radius_client_close_socks(radius, 1);
+	radius_client_close_socks(radius, 0);
 
 	eloop_cancel_timeout(radius_retry_primary_timer, radius, NULL);
 
 	radius_client_flush(radius, 0);
+	os_free(radius->pending);
 	os_free(radius->auth_handlers);
 	os_free(radius->acct_handlers);
 	os_free(radius);
@@ -1326,11 +1600,11 @@ void radius_client_deinit(struct radius_client_data *radius)
 void radius_client_flush_auth(struct radius_client_data *radius,
 			      const u8 *addr)
 {
-	struct radius_msg_list *entry, *prev, *tmp;
+	struct radius_msg_list *entry, *n;
+	int removed = 0;
 
-	prev = NULL;
-	entry = radius->msgs;
-	while (entry) {
+	dl_list_for_each_safe(entry, n, &radius->msgs, struct radius_msg_list,
+			      list) {
 		if (entry->msg_type == RADIUS_AUTH &&
 		    os_memcmp(entry->addr, addr, ETH_ALEN) == 0) {
 			hostapd_logger(radius->ctx, addr,
@@ -1338,22 +1612,13 @@ void radius_client_flush_auth(struct radius_client_data *radius,
 				       HOSTAPD_LEVEL_DEBUG,
 				       "Removing pending RADIUS authentication"
 				       " message for removed client");
-
-			if (prev)
-				prev->next = entry->next;
-			else
-				radius->msgs = entry->next;
-
-			tmp = entry;
-			entry = entry->next;
-			radius_client_msg_free(tmp);
-			radius->num_msgs--;
-			continue;
+			radius_client_msg_remove(radius, entry);
+			removed++;
 		}
-
-		prev = entry;
-		entry = entry->next;
 	}
+
+	if (removed && radius_client_send_queued(radius))
+		radius_client_update_timeout(radius);
 }
 
 
@@ -1366,7 +1631,8 @@ static int radius_client_dump_auth_server(char *buf, size_t buflen,
 	char abuf[50];
 
 	if (cli) {
-		for (msg = cli->msgs; msg; msg = msg->next) {
+		dl_list_for_each(msg, &cli->msgs, struct radius_msg_list,
+				 list) {
 			if (msg->msg_type == RADIUS_AUTH)
 				pending++;
 		}
@@ -1415,9 +1681,9 @@ static int radius_client_dump_acct_server(char *buf, size_t buflen,
 	char abuf[50];
 
 	if (cli) {
-		for (msg = cli->msgs; msg; msg = msg->next) {
-			if (msg->msg_type == RADIUS_ACCT ||
-			    msg->msg_type == RADIUS_ACCT_INTERIM)
+		dl_list_for_each(msg, &cli->msgs, struct radius_msg_list,
+				 list) {
+			if (radius_client_is_acct(msg->msg_type))
 				pending++;
 		}
 	}
@@ -1491,6 +1757,16 @@ int radius_client_get_mib(struct radius_client_data *radius, char *buf,
 }
 
 
+/**
+ * radius_client_reconfig - Update RADIUS client configuration
+ * @radius: RADIUS client context from radius_client_init()
+ * @conf: New RADIUS server configuration
+ *
+ * The new configuration is used for the following requests. The number of
+ * source ports (num_client_ports) is only applied in radius_client_init()
+ * since the open sockets and the pending request table depend on it; a
+ * changed value takes effect when the RADIUS client is initialized again.
+ */
 void radius_client_reconfig(struct radius_client_data *radius,
 			    struct hostapd_radius_servers *conf)
 {
@@ -171,6 +171,33 @@ struct hostapd_radius_servers {
 	 */
 	int msg_dumps;
 
+	/**
+	 * num_client_ports - Number of local UDP source ports to use
+	 *
+	 * Each source port has its own 256 value RADIUS Identifier space, so
+	 * using more than one port allows more than 256 requests to be pending
+	 * at the same time. 0 means a single port. This is only used in
+	 * radius_client_init(); radius_client_reconfig() does not change the
+	 * number of ports.
+	 */
+	int num_client_ports;
+
+	/**
+	 * max_pending - Maximum number of pending messages
+	 *
+	 * The oldest pending message is removed if this limit is exceeded.
+	 * 0 means the default (RADIUS_CLIENT_MAX_ENTRIES).
+	 */
+	int max_pending;
+
+	/**
+	 * max_in_flight - Maximum number of unanswered requests per server
+	 *
+	 * Messages exceeding this window are queued and sent when responses
+	 * to earlier requests are received. 0 means no limit.
+	 */
+	int max_in_flight;
+
 	/**
 	 * client_addr - Client (local) address to use if force_client_addr
 	 */
@@ -250,8 +277,15 @@ int radius_client_register(struct radius_client_data *radius,
 int radius_client_send(struct radius_client_data *radius,
 		       struct radius_msg *msg,
 		       RadiusType msg_type, const u8 *addr);
-u8 radius_client_get_id(struct radius_client_data *radius);
+int radius_client_get_id(struct radius_client_data *radius);
+int radius_client_get_req_id(struct radius_client_data *radius);
+void radius_client_set_drop_cb(struct radius_client_data *radius,
+			       void (*cb)(void *ctx, struct radius_msg *msg,
+					  RadiusType msg_type,
+					  os_time_t first_try),
+			       void *ctx);
 void radius_client_flush(struct radius_client_data *radius, int only_auth);
+void radius_client_flush_acct(struct radius_client_data *radius);
 struct radius_client_data *
 radius_client_init(void *ctx, struct hostapd_radius_servers *conf);
 void radius_client_deinit(struct radius_client_data *radius);
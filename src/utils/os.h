@@ -36,6 +36,16 @@ struct os_time {
  */
 int os_get_time(struct os_time *t);
 
+/**
+ * os_get_reltime - Get relative time (sec, usec)
+ * @t: Pointer to buffer for the time
+ * Returns: 0 on success, -1 on failure
+ *
+ * The returned time is from a monotonic clock that is not affected by changes
+ * to the system time. It is only meaningful for measuring time differences.
+ */
+int os_get_reltime(struct os_time *t);
+
 
 /* Helper macros for handling struct os_time */
 
@@ -203,6 +213,47 @@ void * os_zalloc(size_t size);
  * these functions need to be implemented in os_*.c file for the target system.
  */
 
+#if defined(CONFIG_WPABUF_POOL) || defined(CONFIG_OS_MALLOC_POOL)
+
+/**
+ * os_pool_alloc - Allocate memory from the size-class pools
+ * @size: Size of the buffer to allocate
+ * Returns: Allocated buffer or %NULL on failure
+ *
+ * Small allocations are served from per-size-class free lists that are
+ * carved out of larger slabs and larger ones fall back to malloc(). Memory
+ * from this function must be freed with os_pool_free().
+ */
+void * os_pool_alloc(size_t size);
+
+/**
+ * os_pool_realloc - Re-allocate memory from the size-class pools
+ * @ptr: Old buffer from os_pool_alloc() or os_pool_realloc(); can be %NULL
+ * @size: Size of the new buffer
+ * Returns: Allocated buffer or %NULL on failure
+ */
+void * os_pool_realloc(void *ptr, size_t size);
+
+/**
+ * os_pool_free - Free memory from os_pool_alloc()
+ * @ptr: Buffer from os_pool_alloc() or os_pool_realloc(); can be %NULL
+ */
+void os_pool_free(void *ptr);
+
+/**
+ * os_pool_stats - Write per-size-class allocation statistics
+ * @buf: Buffer for the text output
+ * @buflen: Length of buf in octets
+ * Returns: Number of octets written to buf
+ *
+ * allocs and frees are cumulative counts since startup while in_use is the
+ * number of currently allocated blocks. Allocations that are too large for
+ * the size classes are reported as class=large.
+ */
+int os_pool_stats(char *buf, size_t buflen);
+
+#endif /* CONFIG_WPABUF_POOL || CONFIG_OS_MALLOC_POOL */
+
 #ifdef OS_NO_C_LIB_DEFINES
 
 /**
@@ -389,7 +440,7 @@ int os_snprintf(char *str, size_t size, const char *format, ...);
 
 #else /* OS_NO_C_LIB_DEFINES */
 
-#ifdef WPA_TRACE
+#if defined(WPA_TRACE) || defined(CONFIG_OS_MALLOC_POOL)
 void * os_malloc(size_t size);
 void * os_realloc(void *ptr, size_t size);
 void os_free(void *ptr);
@@ -411,7 +462,7 @@ char * os_strdup(const char *s);
 #define os_strdup(s) strdup(s)
 #endif
 #endif
-#endif /* WPA_TRACE */
+#endif /* WPA_TRACE || CONFIG_OS_MALLOC_POOL */
 
 #ifndef os_memcpy
 #define os_memcpy(d, s, n) memcpy((d), (s), (n))
@@ -23,6 +23,7 @@
  */
 
 #include "includes.h"
+#include <time.h>
 
 #undef OS_REJECT_C_LIB_FUNCTIONS
 #include "os.h"
@@ -47,6 +48,21 @@ int os_get_time(struct os_time *t)
 }
 
 
+int os_get_reltime(struct os_time *t)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+		t->sec = ts.tv_sec;
+		t->usec = ts.tv_nsec / 1000;
+		return 0;
+	}
+#endif /* CLOCK_MONOTONIC */
+	return os_get_time(t);
+}
+
+
 int os_mktime(int year, int month, int day, int hour, int min, int sec,
 	      os_time_t *t)
 {
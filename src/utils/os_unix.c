@@ -45,6 +45,269 @@ struct os_alloc_trace {
 
 #endif /* WPA_TRACE */
 
+#if defined(CONFIG_WPABUF_POOL) || defined(CONFIG_OS_MALLOC_POOL)
+
+#include "common.h"
+
+/*
+ * Size-class memory pools
+ *
+ * Each allocation is prefixed with a small header that records the size
+ * class. Chunks of a class are carved out of slabs that are kept until the
+ * program exits, so long running processes that allocate and free short
+ * lived buffers (frames, EAPOL and RADIUS messages) reuse the same memory
+ * instead of fragmenting the C library heap. Allocations larger than the
+ * largest class are passed to malloc().
+ */
+
+#define POOL_MAGIC 0x5bc1a000
+#define POOL_MAGIC_MASK 0xffffff00
+#define POOL_FREED_MAGIC 0x2f4e9100
+#define POOL_LARGE 0xff
+#define POOL_SLAB_SIZE 8192
+
+struct os_pool_hdr {
+	unsigned int magic; /* POOL_MAGIC | class */
+	size_t len; /* requested length */
+};
+
+#define POOL_HDR_LEN ((sizeof(struct os_pool_hdr) + 15) & ~15)
+
+struct os_pool_slab {
+	struct os_pool_slab *next;
+};
+
+struct os_pool_class {
+	size_t size; /* chunk size including header */
+	void *free_list;
+	struct os_pool_slab *slabs;
+	unsigned long allocs;
+	unsigned long frees;
+	unsigned long in_use;
+	unsigned long max_in_use;
+	unsigned long num_slabs;
+};
+
+static struct os_pool_class pool_classes[] = {
+	{ 64 }, { 128 }, { 256 }, { 512 }, { 1024 }, { 2048 }, { 4096 }
+};
+
+#define POOL_NUM_CLASSES \
+	(sizeof(pool_classes) / sizeof(pool_classes[0]))
+
+/* Allocations that do not fit in any size class; size and slabs unused */
+static struct os_pool_class pool_large;
+
+
+static int os_pool_class_index(size_t size)
+{
+	unsigned int i;
+
+	for (i = 0; i < POOL_NUM_CLASSES; i++) {
+		if (POOL_HDR_LEN + size <= pool_classes[i].size)
+			return i;
+	}
+	return -1;
+}
+
+
+static int os_pool_add_slab(struct os_pool_class *c)
+{
+	struct os_pool_slab *slab;
+	size_t slab_len, count, i;
+	u8 *pos;
+
+	count = (POOL_SLAB_SIZE - POOL_HDR_LEN) / c->size;
+	if (count < 4)
+		count = 4;
+	slab_len = POOL_HDR_LEN + count * c->size;
+	slab = malloc(slab_len);
+	if (slab == NULL)
+		return -1;
+	slab->next = c->slabs;
+	c->slabs = slab;
+	c->num_slabs++;
+
+	/* Free chunks are linked through their data area */
+	pos = (u8 *) slab + POOL_HDR_LEN;
+	for (i = 0; i < count; i++) {
+		*(void **) (pos + POOL_HDR_LEN) = c->free_list;
+		c->free_list = pos;
+		pos += c->size;
+	}
+	return 0;
+}
+
+
+void * os_pool_alloc(size_t size)
+{
+	struct os_pool_hdr *hdr;
+	struct os_pool_class *c;
+	int idx;
+
+	idx = os_pool_class_index(size);
+	if (idx < 0) {
+		hdr = malloc(POOL_HDR_LEN + size);
+		if (hdr == NULL)
+			return NULL;
+		hdr->magic = POOL_MAGIC | POOL_LARGE;
+		hdr->len = size;
+		pool_large.allocs++;
+		pool_large.in_use++;
+		if (pool_large.in_use > pool_large.max_in_use)
+			pool_large.max_in_use = pool_large.in_use;
+		return (u8 *) hdr + POOL_HDR_LEN;
+	}
+
+	c = &pool_classes[idx];
+	if (c->free_list == NULL && os_pool_add_slab(c) < 0)
+		return NULL;
+	hdr = c->free_list;
+	c->free_list = *(void **) ((u8 *) hdr + POOL_HDR_LEN);
+	hdr->magic = POOL_MAGIC | idx;
+	hdr->len = size;
+	c->allocs++;
+	c->in_use++;
+	if (c->in_use > c->max_in_use)
+		c->max_in_use = c->in_use;
+	return (u8 *) hdr + POOL_HDR_LEN;
+}
+
+
+static struct os_pool_hdr * os_pool_get_hdr(void *ptr)
+{
+	struct os_pool_hdr *hdr;
+
+	hdr = (struct os_pool_hdr *) ((u8 *) ptr - POOL_HDR_LEN);
+	if ((hdr->magic & POOL_MAGIC_MASK) != POOL_MAGIC ||
+	    ((hdr->magic & 0xff) != POOL_LARGE &&
+	     (hdr->magic & 0xff) >= POOL_NUM_CLASSES)) {
+		wpa_printf(MSG_ERROR, "os_pool: invalid magic 0x%x%s for %p",
+			   hdr->magic,
+			   (hdr->magic & POOL_MAGIC_MASK) == POOL_FREED_MAGIC ?
+			   " (already freed)" : "", ptr);
+		abort();
+	}
+	return hdr;
+}
+
+
+void os_pool_free(void *ptr)
+{
+	struct os_pool_hdr *hdr;
+	struct os_pool_class *c;
+	unsigned int idx;
+
+	if (ptr == NULL)
+		return;
+	hdr = os_pool_get_hdr(ptr);
+	idx = hdr->magic & 0xff;
+	hdr->magic = POOL_FREED_MAGIC | idx;
+	if (idx == POOL_LARGE) {
+		pool_large.frees++;
+		pool_large.in_use--;
+		free(hdr);
+		return;
+	}
+
+	c = &pool_classes[idx];
+	c->frees++;
+	c->in_use--;
+	*(void **) ((u8 *) hdr + POOL_HDR_LEN) = c->free_list;
+	c->free_list = hdr;
+}
+
+
+void * os_pool_realloc(void *ptr, size_t size)
+{
+	struct os_pool_hdr *hdr;
+	unsigned int idx;
+	void *n;
+
+	if (ptr == NULL)
+		return os_pool_alloc(size);
+	hdr = os_pool_get_hdr(ptr);
+	idx = hdr->magic & 0xff;
+
+	if (idx == POOL_LARGE && os_pool_class_index(size) < 0) {
+		hdr = realloc(hdr, POOL_HDR_LEN + size);
+		if (hdr == NULL)
+			return NULL;
+		hdr->len = size;
+		return (u8 *) hdr + POOL_HDR_LEN;
+	}
+	if (idx != POOL_LARGE && POOL_HDR_LEN + size <= pool_classes[idx].size)
+	{
+		hdr->len = size;
+		return ptr;
+	}
+
+	n = os_pool_alloc(size);
+	if (n == NULL)
+		return NULL;
+	os_memcpy(n, ptr, hdr->len < size ? hdr->len : size);
+	os_pool_free(ptr);
+	return n;
+}
+
+
+int os_pool_stats(char *buf, size_t buflen)
+{
+	char *pos = buf, *end = buf + buflen;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < POOL_NUM_CLASSES; i++) {
+		struct os_pool_class *c = &pool_classes[i];
+		ret = os_snprintf(pos, end - pos,
+				  "class=%lu allocs=%lu frees=%lu in_use=%lu "
+				  "max_in_use=%lu slabs=%lu\n",
+				  (unsigned long) (c->size - POOL_HDR_LEN),
+				  c->allocs, c->frees, c->in_use,
+				  c->max_in_use, c->num_slabs);
+		if (ret < 0 || ret >= end - pos)
+			return pos - buf;
+		pos += ret;
+	}
+	ret = os_snprintf(pos, end - pos,
+			  "class=large allocs=%lu frees=%lu in_use=%lu "
+			  "max_in_use=%lu\n",
+			  pool_large.allocs, pool_large.frees, pool_large.in_use,
+			  pool_large.max_in_use);
+	if (ret < 0 || ret >= end - pos)
+		return pos - buf;
+	pos += ret;
+	return pos - buf;
+}
+
+
+static void os_pool_deinit(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < POOL_NUM_CLASSES; i++) {
+		struct os_pool_class *c = &pool_classes[i];
+		struct os_pool_slab *slab, *prev;
+
+		if (c->in_use)
+			wpa_printf(MSG_DEBUG, "os_pool: %lu chunk(s) of class "
+				   "%lu still in use at exit",
+				   c->in_use,
+				   (unsigned long) (c->size - POOL_HDR_LEN));
+		slab = c->slabs;
+		while (slab) {
+			prev = slab;
+			slab = slab->next;
+			free(prev);
+		}
+		c->slabs = NULL;
+		c->free_list = NULL;
+		c->num_slabs = 0;
+	}
+}
+
+#endif /* CONFIG_WPABUF_POOL || CONFIG_OS_MALLOC_POOL */
+
 
 void os_sleep(os_time_t sec, os_time_t usec)
 {
@@ -66,6 +329,21 @@ int os_get_time(struct os_time *t)
 }
 
 
+int os_get_reltime(struct os_time *t)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+		t->sec = ts.tv_sec;
+		t->usec = ts.tv_nsec / 1000;
+		return 0;
+	}
+#endif /* CLOCK_MONOTONIC */
+	return os_get_time(t);
+}
+
+
 int os_mktime(int year, int month, int day, int hour, int min, int sec,
 	      os_time_t *t)
 {
@@ -309,6 +587,9 @@ void os_program_deinit(void)
 		wpa_printf(MSG_INFO, "MEMLEAK: total %lu bytes",
 			   (unsigned long) total);
 #endif /* WPA_TRACE */
+#if defined(CONFIG_WPABUF_POOL) || defined(CONFIG_OS_MALLOC_POOL)
+	os_pool_deinit();
+#endif /* CONFIG_WPABUF_POOL || CONFIG_OS_MALLOC_POOL */
 }
 
 
@@ -368,7 +649,49 @@ char * os_readfile(const char *name, size_t *len)
 }
 
 
-#ifndef WPA_TRACE
+#if defined(CONFIG_OS_MALLOC_POOL) && !defined(WPA_TRACE)
+
+void * os_malloc(size_t size)
+{
+	return os_pool_alloc(size);
+}
+
+
+void * os_realloc(void *ptr, size_t size)
+{
+	return os_pool_realloc(ptr, size);
+}
+
+
+void os_free(void *ptr)
+{
+	os_pool_free(ptr);
+}
+
+
+void * os_zalloc(size_t size)
+{
+	void *ptr = os_pool_alloc(size);
+	if (ptr)
+		os_memset(ptr, 0, size);
+	return ptr;
+}
+
+
+char * os_strdup(const char *s)
+{
+	size_t len;
+	char *d;
+	len = os_strlen(s);
+	d = os_pool_alloc(len + 1);
+	if (d == NULL)
+		return NULL;
+	os_memcpy(d, s, len);
+	d[len] = '\0';
+	return d;
+}
+
+#elif !defined(WPA_TRACE)
 void * os_zalloc(size_t size)
 {
 	return calloc(1, size);
@@ -53,6 +53,21 @@ int os_get_time(struct os_time *t)
 }
 
 
+int os_get_reltime(struct os_time *t)
+{
+	LARGE_INTEGER freq, counter;
+
+	if (!QueryPerformanceFrequency(&freq) || freq.QuadPart == 0 ||
+	    !QueryPerformanceCounter(&counter))
+		return os_get_time(t);
+	t->sec = (os_time_t) (counter.QuadPart / freq.QuadPart);
+	t->usec = (os_time_t) ((counter.QuadPart % freq.QuadPart) * 1000000 /
+			       freq.QuadPart);
+
+	return 0;
+}
+
+
 int os_mktime(int year, int month, int day, int hour, int min, int sec,
 	      os_time_t *t)
 {
@@ -63,6 +63,547 @@ static FILE *out_file = NULL;
 #endif /* CONFIG_DEBUG_FILE */
 
 
+#ifdef CONFIG_DEBUG_RINGBUF
+
+#include <stddef.h>
+
+/*
+ * In-memory debug ring buffer
+ *
+ * Messages are stored as binary records: the format string pointer and the
+ * raw argument values (strings are copied into the record). The text is only
+ * produced when the ring is dumped, so recording a message does not need to
+ * run the formatter or do any I/O. Format strings are stored by reference
+ * and must have static storage duration, which is the case for the string
+ * literals used with wpa_printf(). Hexdump titles are copied into the record
+ * since some callers build them in stack buffers.
+ */
+
+#define RINGBUF_MAX_ARGS 16
+#define RINGBUF_DATA_LEN 128
+#define RINGBUF_TITLE_LEN 32
+
+enum ringbuf_rec_type {
+	RINGBUF_PRINTF, RINGBUF_HEXDUMP, RINGBUF_HEXDUMP_ASCII
+};
+
+enum ringbuf_arg_type {
+	RINGBUF_ARG_INT, RINGBUF_ARG_UINT, RINGBUF_ARG_DOUBLE, RINGBUF_ARG_PTR,
+	RINGBUF_ARG_STR, RINGBUF_ARG_NULL_STR
+};
+
+struct ringbuf_rec {
+	struct os_time t;
+	const char *fmt; /* format string; NULL for hexdumps */
+	int level;
+	u8 type; /* enum ringbuf_rec_type */
+	u8 nargs;
+	u8 truncated;
+	u8 arg_type[RINGBUF_MAX_ARGS];
+	union {
+		long long i;
+		double d;
+		const void *p;
+		struct {
+			u16 pos;
+			u16 len;
+		} str;
+	} arg[RINGBUF_MAX_ARGS];
+	size_t hex_len; /* original length of hexdump data */
+	u16 hex_pos; /* hexdump data follows the title in data[] */
+	u16 data_used;
+	u8 data[RINGBUF_DATA_LEN];
+};
+
+int wpa_debug_ringbuf_level = MSG_ERROR + 1;
+static struct ringbuf_rec *ringbuf = NULL;
+static unsigned int ringbuf_size = 0; /* number of records; power of two */
+static unsigned int ringbuf_next = 0; /* total number of records written */
+
+
+/**
+ * wpa_debug_ringbuf_init - Start recording debug messages into memory
+ * @records: Number of messages to keep (rounded up to a power of two)
+ * @level: Minimum level (MSG_*) of messages to record
+ * Returns: 0 on success, -1 on failure
+ *
+ * Messages at or above @level are stored in the ring buffer regardless of
+ * the current wpa_debug_level. Stored messages can be retrieved with
+ * wpa_debug_ringbuf_dump().
+ */
+int wpa_debug_ringbuf_init(unsigned int records, int level)
+{
+	unsigned int size = 1;
+
+	if (records == 0 || records > 0x100000)
+		return -1;
+	while (size < records)
+		size <<= 1;
+
+	wpa_debug_ringbuf_deinit();
+	ringbuf = os_zalloc(size * sizeof(struct ringbuf_rec));
+	if (ringbuf == NULL)
+		return -1;
+	ringbuf_size = size;
+	ringbuf_next = 0;
+	wpa_debug_ringbuf_level = level;
+	return 0;
+}
+
+
+/**
+ * wpa_debug_ringbuf_deinit - Stop recording debug messages into memory
+ */
+void wpa_debug_ringbuf_deinit(void)
+{
+	wpa_debug_ringbuf_level = MSG_ERROR + 1;
+	os_free(ringbuf);
+	ringbuf = NULL;
+	ringbuf_size = 0;
+	ringbuf_next = 0;
+}
+
+
+static struct ringbuf_rec * ringbuf_new_rec(int level, int type,
+					     const char *fmt)
+{
+	struct ringbuf_rec *rec;
+
+	if (ringbuf == NULL)
+		return NULL;
+	rec = &ringbuf[ringbuf_next & (ringbuf_size - 1)];
+	ringbuf_next++;
+	os_get_time(&rec->t);
+	rec->fmt = fmt;
+	rec->level = level;
+	rec->type = type;
+	rec->nargs = 0;
+	rec->truncated = 0;
+	rec->hex_len = 0;
+	rec->hex_pos = 0;
+	rec->data_used = 0;
+	return rec;
+}
+
+
+/*
+ * Skip flags, field width, and precision of a conversion specification. The
+ * values of '*' width/precision are taken from ap when rec is not NULL and the
+ * precision (-1 if not specified) is returned in prec.
+ */
+static const char * ringbuf_skip_spec(const char *pos, struct ringbuf_rec *rec,
+				      va_list *ap, int *prec)
+{
+	if (prec)
+		*prec = -1;
+	while (*pos && os_strchr("-+ #0", *pos))
+		pos++;
+	if (*pos == '*') {
+		if (rec && rec->nargs < RINGBUF_MAX_ARGS) {
+			rec->arg_type[rec->nargs] = RINGBUF_ARG_INT;
+			rec->arg[rec->nargs++].i = va_arg(*ap, int);
+		}
+		pos++;
+	} else {
+		while (*pos >= '0' && *pos <= '9')
+			pos++;
+	}
+	if (*pos == '.') {
+		pos++;
+		if (*pos == '*') {
+			if (rec && rec->nargs < RINGBUF_MAX_ARGS) {
+				rec->arg_type[rec->nargs] = RINGBUF_ARG_INT;
+				rec->arg[rec->nargs].i = va_arg(*ap, int);
+				if (prec)
+					*prec = rec->arg[rec->nargs].i;
+				rec->nargs++;
+			}
+			pos++;
+		} else {
+			if (prec)
+				*prec = 0;
+			while (*pos >= '0' && *pos <= '9') {
+				if (prec)
+					*prec = *prec * 10 + *pos - '0';
+				pos++;
+			}
+		}
+	}
+	return pos;
+}
+
+
+static void ringbuf_store_args(struct ringbuf_rec *rec, const char *fmt,
+			       va_list ap)
+{
+	const char *pos = fmt;
+	va_list aq;
+
+	va_copy(aq, ap);
+	while ((pos = os_strchr(pos, '%')) != NULL) {
+		char lmod = 0, lmod2 = 0;
+		int idx, prec;
+
+		pos++;
+		if (*pos == '%') {
+			pos++;
+			continue;
+		}
+		pos = ringbuf_skip_spec(pos, rec, &aq, &prec);
+		if (os_strchr("hljztL", *pos) && *pos) {
+			lmod = *pos++;
+			if ((lmod == 'h' || lmod == 'l') && *pos == lmod)
+				lmod2 = *pos++;
+		}
+		if (rec->nargs >= RINGBUF_MAX_ARGS || *pos == '\0') {
+			rec->truncated = 1;
+			break;
+		}
+		idx = rec->nargs;
+		switch (*pos) {
+		case 'd':
+		case 'i':
+			rec->arg_type[idx] = RINGBUF_ARG_INT;
+			if (lmod == 'l' && lmod2)
+				rec->arg[idx].i = va_arg(aq, long long);
+			else if (lmod == 'l')
+				rec->arg[idx].i = va_arg(aq, long);
+			else if (lmod == 'j')
+				rec->arg[idx].i = va_arg(aq, intmax_t);
+			else if (lmod == 'z' || lmod == 't')
+				rec->arg[idx].i = va_arg(aq, ptrdiff_t);
+			else
+				rec->arg[idx].i = va_arg(aq, int);
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			rec->arg_type[idx] = RINGBUF_ARG_UINT;
+			if (lmod == 'l' && lmod2)
+				rec->arg[idx].i = va_arg(aq, unsigned long long);
+			else if (lmod == 'l')
+				rec->arg[idx].i = va_arg(aq, unsigned long);
+			else if (lmod == 'j')
+				rec->arg[idx].i = va_arg(aq, uintmax_t);
+			else if (lmod == 'z' || lmod == 't')
+				rec->arg[idx].i = va_arg(aq, size_t);
+			else
+				rec->arg[idx].i = va_arg(aq, unsigned int);
+			break;
+		case 'c':
+			rec->arg_type[idx] = RINGBUF_ARG_INT;
+			rec->arg[idx].i = va_arg(aq, int);
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			rec->arg_type[idx] = RINGBUF_ARG_DOUBLE;
+			if (lmod == 'L')
+				rec->arg[idx].d = va_arg(aq, long double);
+			else
+				rec->arg[idx].d = va_arg(aq, double);
+			break;
+		case 'p':
+			rec->arg_type[idx] = RINGBUF_ARG_PTR;
+			rec->arg[idx].p = va_arg(aq, void *);
+			break;
+		case 's':
+		{
+			const char *str = va_arg(aq, const char *);
+			size_t len, max;
+
+			if (str == NULL) {
+				rec->arg_type[idx] = RINGBUF_ARG_NULL_STR;
+				break;
+			}
+			/*
+			 * With a precision, the string does not need to be
+			 * nul terminated, so do not read past it.
+			 */
+			max = RINGBUF_DATA_LEN - rec->data_used;
+			if (prec >= 0 && (size_t) prec < max)
+				max = prec;
+			for (len = 0; len < max && str[len]; len++)
+				;
+			os_memcpy(rec->data + rec->data_used, str, len);
+			rec->arg_type[idx] = RINGBUF_ARG_STR;
+			rec->arg[idx].str.pos = rec->data_used;
+			rec->arg[idx].str.len = len;
+			rec->data_used += len;
+			break;
+		}
+		default:
+			/* Unsupported conversion (e.g., %n) */
+			rec->truncated = 1;
+			break;
+		}
+		if (rec->truncated)
+			break;
+		rec->nargs++;
+		pos++;
+	}
+	va_end(aq);
+}
+
+
+static void ringbuf_printf(int level, const char *fmt, va_list ap)
+{
+	struct ringbuf_rec *rec;
+
+	rec = ringbuf_new_rec(level, RINGBUF_PRINTF, fmt);
+	if (rec)
+		ringbuf_store_args(rec, fmt, ap);
+}
+
+
+static void ringbuf_hexdump(int level, int type, const char *title,
+			    const u8 *buf, size_t len, int show)
+{
+	struct ringbuf_rec *rec;
+	size_t copy;
+
+	rec = ringbuf_new_rec(level, type, NULL);
+	if (rec == NULL)
+		return;
+	copy = os_strlen(title);
+	if (copy > RINGBUF_TITLE_LEN)
+		copy = RINGBUF_TITLE_LEN;
+	os_memcpy(rec->data, title, copy);
+	rec->data[copy] = '\0';
+	rec->hex_pos = rec->data_used = copy + 1;
+	rec->hex_len = len;
+	if (buf == NULL) {
+		rec->nargs = 1; /* [NULL] marker */
+		return;
+	}
+	if (!show) {
+		rec->truncated = 1; /* [REMOVED] marker */
+		return;
+	}
+	copy = RINGBUF_DATA_LEN - rec->hex_pos;
+	if (len < copy)
+		copy = len;
+	os_memcpy(rec->data + rec->hex_pos, buf, copy);
+	rec->data_used += copy;
+}
+
+
+static int ringbuf_decode_printf(const struct ringbuf_rec *rec, char *buf,
+				 size_t buflen)
+{
+	const char *pos = rec->fmt, *start;
+	char *out = buf, *end = buf + buflen;
+	int i = 0, ret;
+
+	while (*pos && out < end - 1) {
+		char spec[48], *spos;
+		const char *conv;
+		int star;
+
+		if (*pos != '%' || pos[1] == '%') {
+			*out++ = *pos;
+			pos += *pos == '%' ? 2 : 1;
+			continue;
+		}
+
+		/* Rebuild the specification with '*' values filled in and
+		 * the length modifier matching the stored argument type. */
+		start = pos++;
+		conv = ringbuf_skip_spec(pos, NULL, NULL, NULL);
+		while (*conv && os_strchr("hljztL", *conv))
+			conv++;
+		if (i >= rec->nargs || *conv == '\0')
+			break;
+		spos = spec;
+		for (; start < conv && spos < spec + sizeof(spec) - 24;
+		     start++) {
+			if (os_strchr("hljztL", *start))
+				continue;
+			if (*start != '*') {
+				*spos++ = *start;
+				continue;
+			}
+			star = i < rec->nargs ? (int) rec->arg[i++].i : 0;
+			spos += os_snprintf(spos, 12, "%d", star);
+		}
+		if (i >= rec->nargs)
+			break;
+		if (rec->arg_type[i] == RINGBUF_ARG_INT && *conv != 'c') {
+			*spos++ = 'l';
+			*spos++ = 'l';
+		} else if (rec->arg_type[i] == RINGBUF_ARG_UINT) {
+			*spos++ = 'l';
+			*spos++ = 'l';
+		}
+		*spos++ = *conv;
+		*spos = '\0';
+
+		switch (rec->arg_type[i]) {
+		case RINGBUF_ARG_INT:
+			if (*conv == 'c')
+				ret = os_snprintf(out, end - out, spec,
+						  (int) rec->arg[i].i);
+			else
+				ret = os_snprintf(out, end - out, spec,
+						  rec->arg[i].i);
+			break;
+		case RINGBUF_ARG_UINT:
+			ret = os_snprintf(out, end - out, spec,
+					  (unsigned long long) rec->arg[i].i);
+			break;
+		case RINGBUF_ARG_DOUBLE:
+			ret = os_snprintf(out, end - out, spec, rec->arg[i].d);
+			break;
+		case RINGBUF_ARG_PTR:
+			ret = os_snprintf(out, end - out, spec, rec->arg[i].p);
+			break;
+		case RINGBUF_ARG_STR:
+		{
+			char str[RINGBUF_DATA_LEN + 1];
+
+			os_memcpy(str, rec->data + rec->arg[i].str.pos,
+				  rec->arg[i].str.len);
+			str[rec->arg[i].str.len] = '\0';
+			ret = os_snprintf(out, end - out, spec, str);
+			break;
+		}
+		default:
+			ret = os_snprintf(out, end - out, "(null)");
+			break;
+		}
+		if (ret < 0 || ret >= end - out) {
+			out = end - 1;
+			break;
+		}
+		out += ret;
+		i++;
+		pos = conv + 1;
+	}
+	*out = '\0';
+
+	if (rec->truncated) {
+		ret = os_snprintf(out, end - out, " [...]");
+		if (ret > 0 && ret < end - out)
+			out += ret;
+	}
+	return out - buf;
+}
+
+
+static int ringbuf_decode_hexdump(const struct ringbuf_rec *rec, char *buf,
+				  size_t buflen)
+{
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+	size_t i;
+
+	ret = os_snprintf(pos, end - pos, "%s - hexdump%s(len=%lu):",
+			  (const char *) rec->data,
+			  rec->type == RINGBUF_HEXDUMP_ASCII ? "_ascii" : "",
+			  (unsigned long) rec->hex_len);
+	if (ret < 0 || ret >= end - pos)
+		return buflen - 1;
+	pos += ret;
+	if (rec->nargs)
+		ret = os_snprintf(pos, end - pos, " [NULL]");
+	else if (rec->truncated)
+		ret = os_snprintf(pos, end - pos, " [REMOVED]");
+	else
+		ret = 0;
+	if (ret < 0 || ret >= end - pos)
+		return buflen - 1;
+	pos += ret;
+	for (i = rec->hex_pos; i < rec->data_used && end - pos > 3; i++) {
+		ret = os_snprintf(pos, end - pos, " %02x", rec->data[i]);
+		pos += ret;
+	}
+	if (!rec->nargs && !rec->truncated &&
+	    rec->data_used - rec->hex_pos < rec->hex_len) {
+		ret = os_snprintf(pos, end - pos, " [...]");
+		if (ret > 0 && ret < end - pos)
+			pos += ret;
+	}
+	return pos - buf;
+}
+
+
+static int ringbuf_decode(const struct ringbuf_rec *rec, char *buf,
+			  size_t buflen)
+{
+	int ret, len;
+
+	ret = os_snprintf(buf, buflen, "%ld.%06u: ", (long) rec->t.sec,
+			  (unsigned int) rec->t.usec);
+	if (ret < 0 || (size_t) ret >= buflen)
+		return -1;
+	if (rec->type == RINGBUF_PRINTF)
+		len = ringbuf_decode_printf(rec, buf + ret, buflen - ret - 1);
+	else
+		len = ringbuf_decode_hexdump(rec, buf + ret, buflen - ret - 1);
+	ret += len;
+	buf[ret++] = '\n';
+	buf[ret] = '\0';
+	return ret;
+}
+
+
+/**
+ * wpa_debug_ringbuf_dump - Decode messages stored in the debug ring buffer
+ * @skip: Number of the most recent messages to skip
+ * @buf: Buffer for the text output
+ * @buflen: Length of buf in octets
+ * Returns: Number of octets written to buf or -1 if the ring is not in use
+ *
+ * Writes the most recent stored messages (after skipping @skip newest ones)
+ * that fit into @buf, oldest first and one message per line. Larger dumps can
+ * be fetched in pieces by increasing @skip by the number of lines received.
+ */
+int wpa_debug_ringbuf_dump(unsigned int skip, char *buf, size_t buflen)
+{
+	char line[512];
+	unsigned int first, last, idx;
+	size_t total = 0;
+	int len;
+
+	if (ringbuf == NULL)
+		return -1;
+	first = ringbuf_next > ringbuf_size ? ringbuf_next - ringbuf_size : 0;
+	if (ringbuf_next - first <= skip)
+		return 0;
+	last = ringbuf_next - skip;
+
+	/* Find the oldest message that still fits into the buffer */
+	for (idx = last; idx > first; idx--) {
+		len = ringbuf_decode(&ringbuf[(idx - 1) & (ringbuf_size - 1)],
+				     line, sizeof(line));
+		if (len < 0 || total + len >= buflen)
+			break;
+		total += len;
+	}
+
+	total = 0;
+	for (; idx < last; idx++) {
+		len = ringbuf_decode(&ringbuf[idx & (ringbuf_size - 1)],
+				     line, sizeof(line));
+		if (len < 0 || total + len >= buflen)
+			break;
+		os_memcpy(buf + total, line, len);
+		total += len;
+	}
+	if (buflen)
+		buf[total] = '\0';
+	return total;
+}
+
+#endif /* CONFIG_DEBUG_RINGBUF */
+
+
 void wpa_debug_print_timestamp(void)
 {
 	struct os_time tv;
@@ -133,6 +674,16 @@ void wpa_printf(int level, const char *fmt, ...)
 {
 	va_list ap;
 
+	if (level < CONFIG_MIN_DEBUG_LEVEL)
+		return;
+#ifdef CONFIG_DEBUG_RINGBUF
+	if (level >= wpa_debug_ringbuf_level) {
+		va_start(ap, fmt);
+		ringbuf_printf(level, fmt, ap);
+		va_end(ap);
+	}
+#endif /* CONFIG_DEBUG_RINGBUF */
+
 	va_start(ap, fmt);
 	if (level >= wpa_debug_level) {
 #ifdef CONFIG_DEBUG_SYSLOG
@@ -164,6 +715,12 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 			 size_t len, int show)
 {
 	size_t i;
+	if (level < CONFIG_MIN_DEBUG_LEVEL)
+		return;
+#ifdef CONFIG_DEBUG_RINGBUF
+	if (level >= wpa_debug_ringbuf_level)
+		ringbuf_hexdump(level, RINGBUF_HEXDUMP, title, buf, len, show);
+#endif /* CONFIG_DEBUG_RINGBUF */
 	if (level < wpa_debug_level)
 		return;
 	wpa_debug_print_timestamp();
@@ -216,6 +773,13 @@ static void _wpa_hexdump_ascii(int level, const char *title, const u8 *buf,
 	const u8 *pos = buf;
 	const size_t line_len = 16;
 
+	if (level < CONFIG_MIN_DEBUG_LEVEL)
+		return;
+#ifdef CONFIG_DEBUG_RINGBUF
+	if (level >= wpa_debug_ringbuf_level)
+		ringbuf_hexdump(level, RINGBUF_HEXDUMP_ASCII, title, buf, len,
+				show);
+#endif /* CONFIG_DEBUG_RINGBUF */
 	if (level < wpa_debug_level)
 		return;
 	wpa_debug_print_timestamp();
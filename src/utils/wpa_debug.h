@@ -48,6 +48,10 @@ PRINTF_FORMAT(2, 3);
 
 #define wpa_printf android_printf
 
+#define wpa_debug_enabled(level) 1
+#define wpa_printf_hot android_printf
+#define wpa_hexdump_hot(l,t,b,le) do {} while (0)
+
 #else /* CONFIG_ANDROID_LOG */
 
 #ifdef CONFIG_NO_STDOUT_DEBUG
@@ -63,6 +67,9 @@ PRINTF_FORMAT(2, 3);
 #define wpa_debug_open_file(p) do { } while (0)
 #define wpa_debug_close_file() do { } while (0)
 #define wpa_dbg(args...) do { } while (0)
+#define wpa_debug_enabled(level) 0
+#define wpa_printf_hot(args...) do { } while (0)
+#define wpa_hexdump_hot(l,t,b,le) do { } while (0)
 
 static inline int wpa_debug_reopen_file(void)
 {
@@ -181,6 +188,50 @@ void wpa_hexdump_ascii_key(int level, const char *title, const u8 *buf,
  */
 #define wpa_dbg(args...) wpa_msg(args)
 
+/*
+ * Messages below CONFIG_MIN_DEBUG_LEVEL are never shown. A build can set this
+ * (e.g., to MSG_INFO) to let the compiler remove wpa_printf_hot() and
+ * wpa_hexdump_hot() calls with lower constant levels from hot paths.
+ */
+#ifndef CONFIG_MIN_DEBUG_LEVEL
+#define CONFIG_MIN_DEBUG_LEVEL MSG_EXCESSIVE
+#endif /* CONFIG_MIN_DEBUG_LEVEL */
+
+extern int wpa_debug_level;
+
+#ifdef CONFIG_DEBUG_RINGBUF
+extern int wpa_debug_ringbuf_level;
+#define wpa_debug_runtime_enabled(level) \
+	((level) >= wpa_debug_level || (level) >= wpa_debug_ringbuf_level)
+#else /* CONFIG_DEBUG_RINGBUF */
+#define wpa_debug_runtime_enabled(level) ((level) >= wpa_debug_level)
+#endif /* CONFIG_DEBUG_RINGBUF */
+
+/**
+ * wpa_debug_enabled - Check whether a message at the given level is recorded
+ * @level: priority level (MSG_*) of the message
+ * Returns: Non-zero if a message at this level would be printed or stored
+ */
+#define wpa_debug_enabled(level) \
+	((level) >= CONFIG_MIN_DEBUG_LEVEL && wpa_debug_runtime_enabled(level))
+
+/*
+ * wpa_printf_hot() and wpa_hexdump_hot() behave like wpa_printf() and
+ * wpa_hexdump(), but check the level before evaluating any of the arguments.
+ * They are meant for per-frame debug messages on hot paths.
+ */
+#define wpa_printf_hot(level, args...)				\
+	do {							\
+		if (wpa_debug_enabled(level))			\
+			wpa_printf((level), args);		\
+	} while (0)
+
+#define wpa_hexdump_hot(level, title, buf, len)			\
+	do {							\
+		if (wpa_debug_enabled(level))			\
+			wpa_hexdump((level), (title), (buf), (len));	\
+	} while (0)
+
 #endif /* CONFIG_NO_STDOUT_DEBUG */
 
 #endif /* CONFIG_ANDROID_LOG */
@@ -290,6 +341,33 @@ static inline void wpa_debug_close_syslog(void)
 #endif /* CONFIG_DEBUG_SYSLOG */
 
 
+#if defined(CONFIG_DEBUG_RINGBUF) && !defined(CONFIG_NO_STDOUT_DEBUG) && \
+	!defined(CONFIG_ANDROID_LOG)
+
+int wpa_debug_ringbuf_init(unsigned int records, int level);
+void wpa_debug_ringbuf_deinit(void);
+int wpa_debug_ringbuf_dump(unsigned int skip, char *buf, size_t buflen);
+
+#else /* CONFIG_DEBUG_RINGBUF */
+
+static inline int wpa_debug_ringbuf_init(unsigned int records, int level)
+{
+	return -1;
+}
+
+static inline void wpa_debug_ringbuf_deinit(void)
+{
+}
+
+static inline int wpa_debug_ringbuf_dump(unsigned int skip, char *buf,
+					 size_t buflen)
+{
+	return -1;
+}
+
+#endif /* CONFIG_DEBUG_RINGBUF */
+
+
 #ifdef EAPOL_TEST
 #define WPA_ASSERT(a)						       \
 	do {							       \
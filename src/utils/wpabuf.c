@@ -32,6 +32,24 @@ static struct wpabuf_trace * wpabuf_get_trace(const struct wpabuf *buf)
 }
 #endif /* WPA_TRACE */
 
+#if defined(CONFIG_WPABUF_POOL) && !defined(CONFIG_OS_MALLOC_POOL) && \
+	!defined(WPA_TRACE)
+/* Allocate wpabuf structures from the size-class pools */
+static void * wpabuf_zalloc(size_t size)
+{
+	void *ptr = os_pool_alloc(size);
+	if (ptr)
+		os_memset(ptr, 0, size);
+	return ptr;
+}
+#define wpabuf_realloc(p, s) os_pool_realloc((p), (s))
+#define wpabuf_mem_free(p) os_pool_free((p))
+#else /* CONFIG_WPABUF_POOL */
+#define wpabuf_zalloc(s) os_zalloc((s))
+#define wpabuf_realloc(p, s) os_realloc((p), (s))
+#define wpabuf_mem_free(p) os_free((p))
+#endif /* CONFIG_WPABUF_POOL */
+
 
 static void wpabuf_overflow(const struct wpabuf *buf, size_t len)
 {
@@ -93,8 +111,8 @@ int wpabuf_resize(struct wpabuf **_buf, size_t add_len)
 				  sizeof(struct wpabuf) + buf->used, 0,
 				  add_len);
 #else /* WPA_TRACE */
-			nbuf = os_realloc(buf, sizeof(struct wpabuf) +
-					  buf->used + add_len);
+			nbuf = wpabuf_realloc(buf, sizeof(struct wpabuf) +
+					      buf->used + add_len);
 			if (nbuf == NULL)
 				return -1;
 			buf = (struct wpabuf *) nbuf;
@@ -126,7 +144,7 @@ struct wpabuf * wpabuf_alloc(size_t len)
 	trace->magic = WPABUF_MAGIC;
 	buf = (struct wpabuf *) (trace + 1);
 #else /* WPA_TRACE */
-	struct wpabuf *buf = os_zalloc(sizeof(struct wpabuf) + len);
+	struct wpabuf *buf = wpabuf_zalloc(sizeof(struct wpabuf) + len);
 	if (buf == NULL)
 		return NULL;
 #endif /* WPA_TRACE */
@@ -147,7 +165,7 @@ struct wpabuf * wpabuf_alloc_ext_data(u8 *data, size_t len)
 	trace->magic = WPABUF_MAGIC;
 	buf = (struct wpabuf *) (trace + 1);
 #else /* WPA_TRACE */
-	struct wpabuf *buf = os_zalloc(sizeof(struct wpabuf));
+	struct wpabuf *buf = wpabuf_zalloc(sizeof(struct wpabuf));
 	if (buf == NULL)
 		return NULL;
 #endif /* WPA_TRACE */
@@ -201,7 +219,7 @@ void wpabuf_free(struct wpabuf *buf)
 	if (buf == NULL)
 		return;
 	os_free(buf->ext_data);
-	os_free(buf);
+	wpabuf_mem_free(buf);
 #endif /* WPA_TRACE */
 }
 
@@ -0,0 +1,385 @@
+/*
+ * IEEE 802.11 IE index - test program
+ * Copyright (c) 2026, The hostap project contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Alternatively, this software may be distributed under the terms of BSD
+ * license.
+ *
+ * See README and COPYING for more details.
+ *
+ * Builds a synthetic set of scan results, verifies that lookups through
+ * struct ieee802_11_ie_index, wpa_scan_get_ie(), and wpa_bss_get_ie() (after
+ * wpa_bss_copy_ies()) match a linear search of the IE buffer, and compares
+ * the time used for the lookups done during network selection.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "common/ieee802_11_defs.h"
+#include "common/ieee802_11_common.h"
+#include "drivers/driver.h"
+#include "../wpa_supplicant/wpa_supplicant_i.h"
+#include "../wpa_supplicant/scan.h"
+#include "../wpa_supplicant/bss.h"
+
+#define NUM_BSS 500
+#define NUM_NETWORKS 20
+#define MAX_IES 512
+
+
+struct test_bss {
+	u8 ies[MAX_IES];
+	size_t ies_len;
+	struct ieee802_11_ie_index idx;
+};
+
+
+static const u8 * linear_get_ie(const u8 *ies, size_t len, u8 eid)
+{
+	const u8 *pos = ies, *end = ies + len;
+
+	while (pos + 1 < end) {
+		if (pos + 2 + pos[1] > end)
+			break;
+		if (pos[0] == eid)
+			return pos;
+		pos += 2 + pos[1];
+	}
+
+	return NULL;
+}
+
+
+static const u8 * linear_get_vendor_ie(const u8 *ies, size_t len,
+				       u32 vendor_type)
+{
+	const u8 *pos = ies, *end = ies + len;
+
+	while (pos + 1 < end) {
+		if (pos + 2 + pos[1] > end)
+			break;
+		if (pos[0] == WLAN_EID_VENDOR_SPECIFIC && pos[1] >= 4 &&
+		    vendor_type == WPA_GET_BE32(&pos[2]))
+			return pos;
+		pos += 2 + pos[1];
+	}
+
+	return NULL;
+}
+
+
+static u8 * add_ie(u8 *pos, u8 eid, const u8 *data, u8 len)
+{
+	*pos++ = eid;
+	*pos++ = len;
+	os_memcpy(pos, data, len);
+	return pos + len;
+}
+
+
+static u8 * add_vendor_ie(u8 *pos, u32 vendor_type, u8 len)
+{
+	*pos++ = WLAN_EID_VENDOR_SPECIFIC;
+	*pos++ = 4 + len;
+	WPA_PUT_BE32(pos, vendor_type);
+	pos += 4;
+	os_memset(pos, 0x11, len);
+	return pos + len;
+}
+
+
+static void gen_bss(struct test_bss *bss, int i)
+{
+	u8 buf[64], *pos = bss->ies;
+	int j;
+
+	os_snprintf((char *) buf, sizeof(buf), "network-%d", i % 50);
+	pos = add_ie(pos, WLAN_EID_SSID, buf, os_strlen((char *) buf));
+	os_memset(buf, 0x82, 8);
+	pos = add_ie(pos, WLAN_EID_SUPP_RATES, buf, 8);
+	buf[0] = 1 + i % 11;
+	pos = add_ie(pos, WLAN_EID_DS_PARAMS, buf, 1);
+	os_memset(buf, 0, sizeof(buf));
+	pos = add_ie(pos, WLAN_EID_ERP_INFO, buf, 1);
+	if (i % 3)
+		pos = add_ie(pos, WLAN_EID_RSN, buf, 20);
+	pos = add_ie(pos, WLAN_EID_EXT_SUPP_RATES, buf, 4);
+	pos = add_ie(pos, WLAN_EID_HT_CAP, buf, 26);
+	pos = add_ie(pos, WLAN_EID_HT_OPERATION, buf, 22);
+	if (i % 4 == 0)
+		pos = add_ie(pos, WLAN_EID_MOBILITY_DOMAIN, buf, 3);
+	pos = add_ie(pos, WLAN_EID_EXT_CAPAB, buf, 8);
+	/* Vendor specific IEs from other vendors before the indexed ones */
+	for (j = 0; j < 4; j++)
+		pos = add_vendor_ie(pos, 0x00904c33 + j, 20);
+	if (i % 3 != 1)
+		pos = add_vendor_ie(pos, WPA_IE_VENDOR_TYPE, 18);
+	pos = add_vendor_ie(pos, 0x0050f202, 20); /* WMM */
+	if (i % 5 == 0)
+		pos = add_vendor_ie(pos, WPS_IE_VENDOR_TYPE, 60);
+	if (i % 7 == 0)
+		pos = add_vendor_ie(pos, P2P_IE_VENDOR_TYPE, 10);
+	if (i % 2)
+		pos = add_vendor_ie(pos, WPA_IE_VENDOR_TYPE, 18);
+	bss->ies_len = pos - bss->ies;
+}
+
+
+static const u8 eids[] = {
+	WLAN_EID_SSID, WLAN_EID_SUPP_RATES, WLAN_EID_DS_PARAMS,
+	WLAN_EID_HT_CAP, WLAN_EID_RSN, WLAN_EID_EXT_SUPP_RATES,
+	WLAN_EID_MOBILITY_DOMAIN, WLAN_EID_EXT_CAPAB, WLAN_EID_ERP_INFO
+};
+#define NUM_EIDS (sizeof(eids) / sizeof(eids[0]))
+
+static const u32 vendor_types[] = {
+	WPA_IE_VENDOR_TYPE, WPS_IE_VENDOR_TYPE, P2P_IE_VENDOR_TYPE, 0x0050f202
+};
+#define NUM_VENDOR_TYPES (sizeof(vendor_types) / sizeof(vendor_types[0]))
+
+
+static const u8 * index_get_ie(const struct test_bss *bss, u8 eid)
+{
+	int slot = ieee802_11_ie_slot(eid);
+	if (slot < 0)
+		return linear_get_ie(bss->ies, bss->ies_len, eid);
+	return ieee802_11_ie_index_get(&bss->idx, bss->ies, slot);
+}
+
+
+static const u8 * index_get_vendor_ie(const struct test_bss *bss, u32 type)
+{
+	int slot = ieee802_11_vendor_ie_slot(type);
+	if (slot < 0)
+		return linear_get_vendor_ie(bss->ies, bss->ies_len, type);
+	return ieee802_11_ie_index_get(&bss->idx, bss->ies, slot);
+}
+
+
+static int verify(struct test_bss *bss, int num)
+{
+	int i, ret = 0;
+	size_t j;
+
+	for (i = 0; i < num; i++) {
+		for (j = 0; j < NUM_EIDS; j++) {
+			if (index_get_ie(&bss[i], eids[j]) !=
+			    linear_get_ie(bss[i].ies, bss[i].ies_len,
+					  eids[j])) {
+				printf("BSS %d: mismatch for element %u\n",
+				       i, eids[j]);
+				ret = -1;
+			}
+		}
+		for (j = 0; j < NUM_VENDOR_TYPES; j++) {
+			if (index_get_vendor_ie(&bss[i], vendor_types[j]) !=
+			    linear_get_vendor_ie(bss[i].ies, bss[i].ies_len,
+						 vendor_types[j])) {
+				printf("BSS %d: mismatch for vendor IE "
+				       "%08x\n", i, vendor_types[j]);
+				ret = -1;
+			}
+		}
+	}
+
+	return ret;
+}
+
+
+/*
+ * Verify a lookup result against a linear search of the same IEs. The two
+ * buffers may differ, so compare offsets instead of pointers.
+ */
+static int check_ie(const char *what, int i, u32 type, const u8 *res,
+		    const u8 *res_ies, const u8 *lin, const u8 *lin_ies)
+{
+	if ((res == NULL) != (lin == NULL) ||
+	    (res && res - res_ies != lin - lin_ies)) {
+		printf("BSS %d: %s mismatch for %08x\n", i, what, type);
+		return -1;
+	}
+	return 0;
+}
+
+
+static int verify_scan_res_bss(struct test_bss *bss, int num)
+{
+	struct wpa_scan_res *res;
+	struct wpa_bss *wbss;
+	const u8 *ies, *res_ies, *bss_ies;
+	size_t j;
+	int i, valid, ret = 0;
+
+	res = os_zalloc(sizeof(*res) + 2 * MAX_IES);
+	wbss = os_zalloc(sizeof(*wbss) + 2 * MAX_IES);
+	if (res == NULL || wbss == NULL) {
+		os_free(res);
+		os_free(wbss);
+		return -1;
+	}
+	res_ies = (const u8 *) (res + 1);
+	bss_ies = (const u8 *) (wbss + 1);
+
+	for (i = 0; i < num; i++) {
+		ies = bss[i].ies;
+		/* Beacon IEs follow the Probe Response IEs */
+		os_memcpy(res + 1, ies, bss[i].ies_len);
+		os_memcpy((u8 *) (res + 1) + bss[i].ies_len, ies,
+			  bss[i].ies_len);
+		res->ie_len = res->beacon_ie_len = bss[i].ies_len;
+
+		/*
+		 * Without an index (driver wrapper did not build one), the
+		 * lookups fall back to a linear search and wpa_bss_copy_ies()
+		 * builds the index for the BSS entry.
+		 */
+		for (valid = 0; valid < 2; valid++) {
+			os_memset(&res->ie_index, 0, sizeof(res->ie_index));
+			if (valid)
+				ieee802_11_ie_index_build(&res->ie_index,
+							  res_ies,
+							  res->ie_len);
+			os_memset(wbss, 0, sizeof(*wbss));
+			wpa_bss_copy_ies(wbss, res);
+			if (wbss->ie_len != res->ie_len ||
+			    wbss->beacon_ie_len != res->beacon_ie_len ||
+			    !wbss->ie_index.valid ||
+			    os_memcmp(bss_ies, res_ies,
+				      res->ie_len + res->beacon_ie_len) != 0) {
+				printf("BSS %d: wpa_bss_copy_ies failed\n", i);
+				ret = -1;
+				continue;
+			}
+
+			for (j = 0; j < NUM_EIDS; j++) {
+				const u8 *lin = linear_get_ie(ies,
+							      bss[i].ies_len,
+							      eids[j]);
+				ret |= check_ie("wpa_scan_get_ie", i, eids[j],
+						wpa_scan_get_ie(res, eids[j]),
+						res_ies, lin, ies);
+				ret |= check_ie("wpa_bss_get_ie", i, eids[j],
+						wpa_bss_get_ie(wbss, eids[j]),
+						bss_ies, lin, ies);
+			}
+			for (j = 0; j < NUM_VENDOR_TYPES; j++) {
+				u32 type = vendor_types[j];
+				const u8 *lin = linear_get_vendor_ie(
+					ies, bss[i].ies_len, type);
+				ret |= check_ie("wpa_scan_get_vendor_ie", i,
+						type,
+						wpa_scan_get_vendor_ie(res,
+								       type),
+						res_ies, lin, ies);
+				ret |= check_ie("wpa_bss_get_vendor_ie", i,
+						type,
+						wpa_bss_get_vendor_ie(wbss,
+								      type),
+						bss_ies, lin, ies);
+			}
+		}
+	}
+
+	os_free(res);
+	os_free(wbss);
+	return ret;
+}
+
+
+static double elapsed_since(struct os_time *start)
+{
+	struct os_time now;
+	double e;
+
+	os_get_time(&now);
+	e = (now.sec - start->sec) + (now.usec - start->usec) / 1000000.0;
+	return e > 0 ? e : 0.000001;
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct test_bss *bss;
+	struct os_time start;
+	double linear, indexed, build;
+	unsigned long found = 0;
+	int i, n, rounds = 20, ret;
+
+	bss = os_zalloc(NUM_BSS * sizeof(*bss));
+	if (bss == NULL)
+		return -1;
+
+	for (i = 0; i < NUM_BSS; i++)
+		gen_bss(&bss[i], i);
+
+	os_get_time(&start);
+	for (n = 0; n < rounds; n++) {
+		for (i = 0; i < NUM_BSS; i++)
+			ieee802_11_ie_index_build(&bss[i].idx, bss[i].ies,
+						  bss[i].ies_len);
+	}
+	build = elapsed_since(&start);
+
+	ret = verify(bss, NUM_BSS);
+	if (verify_scan_res_bss(bss, NUM_BSS) < 0)
+		ret = -1;
+
+	/*
+	 * Network selection looks up SSID, WPA, RSN, and WPS IEs for each
+	 * scan result and configured network.
+	 */
+	os_get_time(&start);
+	for (n = 0; n < rounds; n++) {
+		for (i = 0; i < NUM_BSS * NUM_NETWORKS; i++) {
+			const u8 *ies = bss[i % NUM_BSS].ies;
+			size_t len = bss[i % NUM_BSS].ies_len;
+			found += linear_get_ie(ies, len, WLAN_EID_SSID) !=
+				NULL;
+			found += linear_get_ie(ies, len, WLAN_EID_RSN) !=
+				NULL;
+			found += linear_get_vendor_ie(ies, len,
+						      WPA_IE_VENDOR_TYPE) !=
+				NULL;
+			found += linear_get_vendor_ie(ies, len,
+						      WPS_IE_VENDOR_TYPE) !=
+				NULL;
+		}
+	}
+	linear = elapsed_since(&start);
+
+	os_get_time(&start);
+	for (n = 0; n < rounds; n++) {
+		for (i = 0; i < NUM_BSS * NUM_NETWORKS; i++) {
+			const struct test_bss *b = &bss[i % NUM_BSS];
+			found -= index_get_ie(b, WLAN_EID_SSID) != NULL;
+			found -= index_get_ie(b, WLAN_EID_RSN) != NULL;
+			found -= index_get_vendor_ie(b, WPA_IE_VENDOR_TYPE) !=
+				NULL;
+			found -= index_get_vendor_ie(b, WPS_IE_VENDOR_TYPE) !=
+				NULL;
+		}
+	}
+	indexed = elapsed_since(&start);
+
+	if (found != 0) {
+		printf("Lookup count mismatch\n");
+		ret = -1;
+	}
+
+	printf("%d BSSes x %d networks, %d rounds\n", NUM_BSS, NUM_NETWORKS,
+	       rounds);
+	printf("index build: %.3f ms/scan\n", build * 1000 / rounds);
+	printf("linear lookups: %.3f ms/scan\n", linear * 1000 / rounds);
+	printf("indexed lookups: %.3f ms/scan\n", indexed * 1000 / rounds);
+
+	os_free(bss);
+
+	if (ret == 0)
+		printf("IE index tests passed\n");
+	return ret;
+}
@@ -26,12 +26,11 @@ struct wlantest_bss * bss_find(struct wlantest *wt, const u8 *bssid)
 {
 	struct wlantest_bss *bss;
 
-	dl_list_for_each(bss, &wt->bss, struct wlantest_bss, list) {
-		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0)
-			return bss;
-	}
+	bss = wt->bss_hash[WLANTEST_HASH(bssid)];
+	while (bss && os_memcmp(bss->bssid, bssid, ETH_ALEN) != 0)
+		bss = bss->hnext;
 
-	return NULL;
+	return bss;
 }
 
 
@@ -54,6 +53,8 @@ struct wlantest_bss * bss_get(struct wlantest *wt, const u8 *bssid)
 	dl_list_init(&bss->tdls);
 	os_memcpy(bss->bssid, bssid, ETH_ALEN);
 	dl_list_add(&wt->bss, &bss->list);
+	bss->hnext = wt->bss_hash[WLANTEST_HASH(bssid)];
+	wt->bss_hash[WLANTEST_HASH(bssid)] = bss;
 	wpa_printf(MSG_DEBUG, "Discovered new BSS - " MACSTR,
 		   MAC2STR(bss->bssid));
 	return bss;
@@ -74,11 +75,19 @@ void tdls_deinit(struct wlantest_tdls *tdls)
 }
 
 
-void bss_deinit(struct wlantest_bss *bss)
+void bss_deinit(struct wlantest *wt, struct wlantest_bss *bss)
 {
+	struct wlantest_bss **pos;
 	struct wlantest_sta *sta, *n;
 	struct wlantest_pmk *pmk, *np;
 	struct wlantest_tdls *tdls, *nt;
+
+	pos = &wt->bss_hash[WLANTEST_HASH(bss->bssid)];
+	while (*pos && *pos != bss)
+		pos = &(*pos)->hnext;
+	if (*pos)
+		*pos = bss->hnext;
+
 	dl_list_for_each_safe(sta, n, &bss->sta, struct wlantest_sta, list)
 		sta_deinit(sta);
 	dl_list_for_each_safe(pmk, np, &bss->pmk, struct wlantest_pmk, list)
@@ -90,19 +99,93 @@ void bss_deinit(struct wlantest_bss *bss)
 }
 
 
-int bss_add_pmk_from_passphrase(struct wlantest_bss *bss,
+static unsigned int pmk_cache_hash(const u8 *ssid, size_t ssid_len,
+				   const char *passphrase)
+{
+	unsigned int hash = 0;
+	size_t i;
+
+	for (i = 0; i < ssid_len; i++)
+		hash = hash * 31 + ssid[i];
+	while (*passphrase)
+		hash = hash * 31 + (u8) *passphrase++;
+
+	return hash % PMK_CACHE_HASH_SIZE;
+}
+
+
+/*
+ * Get the PMK for the given SSID and passphrase. The PBKDF2 derivation is
+ * expensive, so the result is cached to avoid repeating it for each BSS that
+ * uses the same SSID (e.g., multiple APs in an ESS).
+ */
+static const u8 * pmk_cache_get(struct wlantest *wt, const u8 *ssid,
+				size_t ssid_len, const char *passphrase)
+{
+	unsigned int hash = pmk_cache_hash(ssid, ssid_len, passphrase);
+	struct wlantest_pmk_cache *entry;
+
+	for (entry = wt->pmk_cache[hash]; entry; entry = entry->hnext) {
+		if (entry->ssid_len == ssid_len &&
+		    os_memcmp(entry->ssid, ssid, ssid_len) == 0 &&
+		    os_strcmp(entry->passphrase, passphrase) == 0)
+			return entry->pmk;
+	}
+
+	entry = os_zalloc(sizeof(*entry));
+	if (entry == NULL)
+		return NULL;
+	if (pbkdf2_sha1(passphrase, (char *) ssid, ssid_len, 4096,
+			entry->pmk, sizeof(entry->pmk)) < 0) {
+		os_free(entry);
+		return NULL;
+	}
+	os_memcpy(entry->ssid, ssid, ssid_len);
+	entry->ssid_len = ssid_len;
+	os_strlcpy(entry->passphrase, passphrase, sizeof(entry->passphrase));
+	entry->hnext = wt->pmk_cache[hash];
+	wt->pmk_cache[hash] = entry;
+
+	return entry->pmk;
+}
+
+
+void pmk_cache_flush(struct wlantest *wt)
+{
+	struct wlantest_pmk_cache *entry, *prev;
+	int i;
+
+	for (i = 0; i < PMK_CACHE_HASH_SIZE; i++) {
+		entry = wt->pmk_cache[i];
+		while (entry) {
+			prev = entry;
+			entry = entry->hnext;
+			os_free(prev);
+		}
+		wt->pmk_cache[i] = NULL;
+	}
+}
+
+
+int bss_add_pmk_from_passphrase(struct wlantest *wt, struct wlantest_bss *bss,
 				const char *passphrase)
 {
 	struct wlantest_pmk *pmk;
+	const u8 *val;
+
+	val = pmk_cache_get(wt, bss->ssid, bss->ssid_len, passphrase);
+	if (val == NULL)
+		return -1;
+
+	dl_list_for_each(pmk, &bss->pmk, struct wlantest_pmk, list) {
+		if (os_memcmp(pmk->pmk, val, sizeof(pmk->pmk)) == 0)
+			return 0; /* already known for this BSS */
+	}
 
 	pmk = os_zalloc(sizeof(*pmk));
 	if (pmk == NULL)
 		return -1;
-	if (pbkdf2_sha1(passphrase, (char *) bss->ssid, bss->ssid_len, 4096,
-			pmk->pmk, sizeof(pmk->pmk)) < 0) {
-		os_free(pmk);
-		return -1;
-	}
+	os_memcpy(pmk->pmk, val, sizeof(pmk->pmk));
 
 	wpa_printf(MSG_INFO, "Add possible PMK for BSSID " MACSTR
 		   " based on passphrase '%s'",
@@ -128,7 +211,7 @@ static void bss_add_pmk(struct wlantest *wt, struct wlantest_bss *bss)
 		     os_memcmp(p->ssid, bss->ssid, p->ssid_len) != 0))
 			continue;
 
-		if (bss_add_pmk_from_passphrase(bss, p->passphrase) < 0)
+		if (bss_add_pmk_from_passphrase(wt, bss, p->passphrase) < 0)
 			break;
 	}
 }
@@ -299,5 +382,5 @@ void bss_flush(struct wlantest *wt)
 {
 	struct wlantest_bss *bss, *n;
 	dl_list_for_each_safe(bss, n, &wt->bss, struct wlantest_bss, list)
-		bss_deinit(bss);
+		bss_deinit(wt, bss);
 }
@@ -93,32 +93,61 @@ static void xor_aes_block(u8 *dst, const u8 *src)
 }
 
 
-u8 * ccmp_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
-		  const u8 *data, size_t data_len, size_t *decrypted_len)
+/*
+ * Expanded AES keys are kept in a small direct-mapped cache indexed by the
+ * first octet of the TK so that the key schedule is not recomputed (and the
+ * context reallocated) for every received frame.
+ */
+#define CCMP_AES_CACHE_SIZE 64
+
+static struct ccmp_aes_cache {
+	u8 tk[16];
+	void *aes;
+} ccmp_aes_cache[CCMP_AES_CACHE_SIZE];
+
+
+static void * ccmp_aes_get(const u8 *tk)
+{
+	struct ccmp_aes_cache *c;
+
+	c = &ccmp_aes_cache[tk[0] % CCMP_AES_CACHE_SIZE];
+	if (c->aes && os_memcmp(c->tk, tk, 16) == 0)
+		return c->aes;
+
+	if (c->aes)
+		aes_encrypt_deinit(c->aes);
+	c->aes = aes_encrypt_init(tk, 16);
+	if (c->aes)
+		os_memcpy(c->tk, tk, 16);
+	return c->aes;
+}
+
+
+void ccmp_deinit(void)
+{
+	int i;
+
+	for (i = 0; i < CCMP_AES_CACHE_SIZE; i++) {
+		if (ccmp_aes_cache[i].aes)
+			aes_encrypt_deinit(ccmp_aes_cache[i].aes);
+		os_memset(&ccmp_aes_cache[i], 0, sizeof(ccmp_aes_cache[i]));
+	}
+}
+
+
+static int ccmp_decrypt_buf(void *aes, const struct ieee80211_hdr *hdr,
+			    const u8 *data, size_t data_len, u8 *plain,
+			    size_t *decrypted_len)
 {
 	u8 aad[2 + 30], nonce[13];
 	size_t aad_len;
 	u8 b[AES_BLOCK_SIZE], x[AES_BLOCK_SIZE], a[AES_BLOCK_SIZE];
-	void *aes;
 	const u8 *m, *mpos, *mic;
 	size_t mlen, last;
 	int i;
-	u8 *plain, *ppos;
+	u8 *ppos;
 	u8 t[8];
 
-	if (data_len < 8 + 8)
-		return NULL;
-
-	plain = os_malloc(data_len + AES_BLOCK_SIZE);
-	if (plain == NULL)
-		return NULL;
-
-	aes = aes_encrypt_init(tk, 16);
-	if (aes == NULL) {
-		os_free(plain);
-		return NULL;
-	}
-
 	m = data + 8;
 	mlen = data_len - 8 - 8;
 	last = mlen % AES_BLOCK_SIZE;
@@ -135,8 +164,6 @@ u8 * ccmp_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 	a[0] = 0x01; /* Flags = L' */
 	os_memcpy(&a[1], nonce, 13);
 
-	/* Decryption */
-
 	mic = data + data_len - 8;
 	wpa_hexdump(MSG_EXCESSIVE, "CCMP U", mic, 8);
 	/* U = T XOR S_0; S_0 = E(K, A_0) */
@@ -146,27 +173,7 @@ u8 * ccmp_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 		t[i] = mic[i] ^ x[i];
 	wpa_hexdump(MSG_EXCESSIVE, "CCMP T", t, 8);
 
-	/* plaintext = msg XOR (S_1 | S_2 | ... | S_n) */
-	ppos = plain;
-	mpos = m;
-	for (i = 1; i <= mlen / AES_BLOCK_SIZE; i++) {
-		WPA_PUT_BE16(&a[14], i);
-		/* S_i = E(K, A_i) */
-		aes_encrypt(aes, a, ppos);
-		xor_aes_block(ppos, mpos);
-		ppos += AES_BLOCK_SIZE;
-		mpos += AES_BLOCK_SIZE;
-	}
-	if (last) {
-		WPA_PUT_BE16(&a[14], i);
-		aes_encrypt(aes, a, ppos);
-		/* XOR zero-padded last block */
-		for (i = 0; i < last; i++)
-			*ppos++ ^= *mpos++;
-	}
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP decrypted", plain, mlen);
-
-	/* Authentication */
+	/* Authentication of the header */
 	/* B_0: Flags | Nonce N | l(m) */
 	b[0] = 0x40 /* Adata */ | (3 /* M' */ << 3) | 1 /* L' */;
 	os_memcpy(&b[1], nonce, 13);
@@ -185,21 +192,35 @@ u8 * ccmp_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 	aes_encrypt(aes, &aad[AES_BLOCK_SIZE], x); /* X_3 = E(K, X_2 XOR B_2)
 						    */
 
+	/*
+	 * Decryption and authentication of the payload in a single pass:
+	 * plaintext block P_i = C_i XOR S_i is fed into CBC-MAC while it is
+	 * still in cache instead of walking the whole frame twice.
+	 */
 	ppos = plain;
-	for (i = 0; i < mlen / AES_BLOCK_SIZE; i++) {
+	mpos = m;
+	for (i = 1; i <= mlen / AES_BLOCK_SIZE; i++) {
+		WPA_PUT_BE16(&a[14], i);
+		/* S_i = E(K, A_i) */
+		aes_encrypt(aes, a, ppos);
+		xor_aes_block(ppos, mpos);
 		/* X_i+1 = E(K, X_i XOR B_i) */
 		xor_aes_block(x, ppos);
-		ppos += AES_BLOCK_SIZE;
 		aes_encrypt(aes, x, x);
+		ppos += AES_BLOCK_SIZE;
+		mpos += AES_BLOCK_SIZE;
 	}
 	if (last) {
+		WPA_PUT_BE16(&a[14], i);
+		aes_encrypt(aes, a, ppos);
 		/* XOR zero-padded last block */
-		for (i = 0; i < last; i++)
-			x[i] ^= *ppos++;
+		for (i = 0; i < last; i++) {
+			ppos[i] ^= mpos[i];
+			x[i] ^= ppos[i];
+		}
 		aes_encrypt(aes, x, x);
 	}
-
-	aes_encrypt_deinit(aes);
+	wpa_hexdump(MSG_EXCESSIVE, "CCMP decrypted", plain, mlen);
 
 	if (os_memcmp(x, t, 8) != 0) {
 		u16 seq_ctrl = le_to_host16(hdr->seq_ctrl);
@@ -210,15 +231,108 @@ u8 * ccmp_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 			   WLAN_GET_SEQ_SEQ(seq_ctrl),
 			   WLAN_GET_SEQ_FRAG(seq_ctrl));
 		wpa_hexdump(MSG_DEBUG, "CCMP decrypted", plain, mlen);
+		return -1;
+	}
+
+	*decrypted_len = mlen;
+	return 0;
+}
+
+
+u8 * ccmp_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
+		  const u8 *data, size_t data_len, size_t *decrypted_len)
+{
+	void *aes;
+	u8 *plain;
+
+	if (data_len < 8 + 8)
+		return NULL;
+
+	aes = ccmp_aes_get(tk);
+	if (aes == NULL)
+		return NULL;
+
+	plain = os_malloc(data_len + AES_BLOCK_SIZE);
+	if (plain == NULL)
+		return NULL;
+
+	if (ccmp_decrypt_buf(aes, hdr, data, data_len, plain, decrypted_len) <
+	    0) {
 		os_free(plain);
 		return NULL;
 	}
 
-	*decrypted_len = mlen;
 	return plain;
 }
 
 
+/**
+ * ccmp_decrypt_batch - Decrypt a number of CCMP frames
+ * @arena: Output buffer that is reused between calls; grown as needed
+ * @frames: Frames to decrypt; plain and plain_len are set for each entry
+ * @num: Number of entries in frames
+ * Returns: Number of frames that were successfully decrypted
+ *
+ * The decrypted payloads are stored back-to-back in the arena and remain
+ * valid until the next call with the same arena. plain is set to %NULL for
+ * frames that could not be decrypted. Consecutive frames using the same TK
+ * share the expanded AES key.
+ */
+size_t ccmp_decrypt_batch(struct wlantest_arena *arena,
+			  struct wlantest_decrypt_frame *frames, size_t num)
+{
+	size_t i, need = 0, ok = 0;
+	u8 *pos;
+	const u8 *prev_tk = NULL;
+	void *aes = NULL;
+
+	for (i = 0; i < num; i++)
+		need += (frames[i].data_len + 2 * AES_BLOCK_SIZE - 1) &
+			~(size_t) (AES_BLOCK_SIZE - 1);
+	if (need > arena->size) {
+		u8 *n = os_realloc(arena->buf, need);
+		if (n == NULL)
+			return 0;
+		arena->buf = n;
+		arena->size = need;
+	}
+
+	pos = arena->buf;
+	for (i = 0; i < num; i++) {
+		struct wlantest_decrypt_frame *f = &frames[i];
+
+		f->plain = NULL;
+		f->plain_len = 0;
+		if (f->data_len < 8 + 8)
+			continue;
+		if (prev_tk == NULL || (f->tk != prev_tk &&
+					os_memcmp(f->tk, prev_tk, 16) != 0)) {
+			aes = ccmp_aes_get(f->tk);
+			prev_tk = aes ? f->tk : NULL;
+		}
+		if (aes == NULL)
+			continue;
+		if (ccmp_decrypt_buf(aes, f->hdr, f->data, f->data_len, pos,
+				     &f->plain_len) == 0) {
+			f->plain = pos;
+			ok++;
+		}
+		pos += (f->data_len + 2 * AES_BLOCK_SIZE - 1) &
+			~(size_t) (AES_BLOCK_SIZE - 1);
+	}
+
+	return ok;
+}
+
+
+void wlantest_arena_free(struct wlantest_arena *arena)
+{
+	os_free(arena->buf);
+	arena->buf = NULL;
+	arena->size = 0;
+}
+
+
 void ccmp_get_pn(u8 *pn, const u8 *data)
 {
 	pn[0] = data[7]; /* PN5 */
@@ -851,7 +851,7 @@ static void ctrl_add_passphrase(struct wlantest *wt, int sock, u8 *cmd,
 			if (bssid &&
 			    os_memcmp(p->bssid, bss->bssid, ETH_ALEN) != 0)
 				continue;
-			bss_add_pmk_from_passphrase(bss, p->passphrase);
+			bss_add_pmk_from_passphrase(wt, bss, p->passphrase);
 		}
 	}
 
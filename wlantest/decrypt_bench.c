@@ -0,0 +1,334 @@
+/*
+ * wlantest - Decryption performance test
+ * Copyright (c) 2026, The hostap project contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Alternatively, this software may be distributed under the terms of BSD
+ * license.
+ *
+ * See README and COPYING for more details.
+ *
+ * This program generates a synthetic set of CCMP, TKIP, and WEP protected
+ * data frames from a number of stations and reports the rate at which
+ * wlantest decryption routines process them. CCMP is measured both with
+ * the per-frame ccmp_decrypt() and the ccmp_decrypt_batch() interface.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "common/defs.h"
+#include "common/ieee802_11_defs.h"
+#include "wlantest.h"
+
+
+struct bench_frame {
+	u8 *frame;
+	size_t len;
+	const u8 *tk;
+};
+
+
+static void usage(void)
+{
+	printf("wlantest decryption benchmark\n"
+	       "\n"
+	       "usage:\n"
+	       "decrypt_bench [-h] [-n<frames>] [-l<payload len>] "
+	       "[-s<stations>] [-b<batch>]\n"
+	       "\n"
+	       "options:\n"
+	       "  -h = show this usage help\n"
+	       "  -n<frames> = number of frames per cipher (default: 20000)\n"
+	       "  -l<payload len> = payload length in octets (default: 1500)\n"
+	       "  -s<stations> = number of transmitting stations "
+	       "(default: 16)\n"
+	       "  -b<batch> = frames per ccmp_decrypt_batch() call "
+	       "(default: 64)\n");
+}
+
+
+static void bench_hdr(u8 *buf, int sta, int seq)
+{
+	struct ieee80211_hdr *hdr = (struct ieee80211_hdr *) buf;
+
+	os_memset(buf, 0, 24);
+	hdr->frame_control = host_to_le16((WLAN_FC_TYPE_DATA << 2) |
+					  WLAN_FC_TODS);
+	os_memset(hdr->addr1, 0x02, ETH_ALEN); /* BSSID */
+	hdr->addr2[0] = 0x02;
+	WPA_PUT_BE32(&hdr->addr2[2], sta);
+	os_memset(hdr->addr3, 0xff, ETH_ALEN);
+	hdr->seq_ctrl = host_to_le16((seq & 0xfff) << 4);
+}
+
+
+static void bench_pn(u8 *pn, int seq)
+{
+	os_memset(pn, 0, 6);
+	WPA_PUT_BE32(&pn[2], seq + 1);
+}
+
+
+static struct bench_frame * gen_frames(int cipher, int num, size_t plen,
+				       u8 *keys, int num_sta, const u8 *wep)
+{
+	struct bench_frame *f;
+	u8 *frame, pn[6];
+	int i;
+	size_t j;
+
+	f = os_zalloc(num * sizeof(*f));
+	frame = os_malloc(24 + plen);
+	if (f == NULL || frame == NULL) {
+		os_free(f);
+		os_free(frame);
+		return NULL;
+	}
+
+	for (i = 0; i < num; i++) {
+		int sta = i % num_sta;
+
+		bench_hdr(frame, sta, i);
+		for (j = 0; j < plen; j++)
+			frame[24 + j] = i + j;
+		bench_pn(pn, i / num_sta);
+		f[i].tk = &keys[32 * sta];
+		if (cipher == WPA_CIPHER_CCMP) {
+			f[i].frame = ccmp_encrypt(f[i].tk, frame, 24 + plen,
+						  24, NULL, pn, 0, &f[i].len);
+		} else if (cipher == WPA_CIPHER_TKIP) {
+			f[i].frame = tkip_encrypt(f[i].tk, frame, 24 + plen,
+						  24, NULL, pn, 0, &f[i].len);
+		} else {
+			u8 rc4key[16], *pos;
+
+			f[i].len = 24 + 4 + plen + 4;
+			f[i].frame = os_malloc(f[i].len);
+			if (f[i].frame == NULL)
+				break;
+			os_memcpy(f[i].frame, frame, 24);
+			f[i].frame[1] |= WLAN_FC_ISWEP >> 8;
+			pos = f[i].frame + 24;
+			WPA_PUT_BE24(pos, i);
+			pos[3] = 0;
+			os_memcpy(rc4key, pos, 3);
+			os_memcpy(rc4key + 3, wep, 5);
+			for (j = 8; j < sizeof(rc4key); j++)
+				rc4key[j] = rc4key[j % 8];
+			pos += 4;
+			os_memcpy(pos, frame + 24, plen);
+			WPA_PUT_LE32(pos + plen, crc32(pos, plen));
+			wep_crypt(rc4key, pos, plen + 4);
+		}
+		if (f[i].frame == NULL)
+			break;
+	}
+	os_free(frame);
+
+	if (i < num) {
+		while (i-- > 0)
+			os_free(f[i].frame);
+		os_free(f);
+		return NULL;
+	}
+
+	return f;
+}
+
+
+static void free_frames(struct bench_frame *f, int num)
+{
+	int i;
+
+	if (f == NULL)
+		return;
+	for (i = 0; i < num; i++)
+		os_free(f[i].frame);
+	os_free(f);
+}
+
+
+static double elapsed_since(struct os_time *start)
+{
+	struct os_time now;
+	double e;
+
+	os_get_time(&now);
+	e = (now.sec - start->sec) + (now.usec - start->usec) / 1000000.0;
+	return e > 0 ? e : 0.000001;
+}
+
+
+static void report(const char *name, int ok, int num, size_t plen,
+		   double elapsed)
+{
+	printf("%-12s %6d/%d frames %8.3f s %10.0f frames/s %8.1f Mbit/s\n",
+	       name, ok, num, elapsed, num / elapsed,
+	       num * plen * 8 / elapsed / 1000000.0);
+}
+
+
+static void bench_ccmp(struct bench_frame *f, int num, size_t plen,
+		       int batch)
+{
+	struct os_time start;
+	struct wlantest_arena arena;
+	struct wlantest_decrypt_frame *df;
+	int i, ok = 0;
+	size_t dlen;
+	u8 *plain;
+
+	os_get_time(&start);
+	for (i = 0; i < num; i++) {
+		plain = ccmp_decrypt(f[i].tk,
+				     (struct ieee80211_hdr *) f[i].frame,
+				     f[i].frame + 24, f[i].len - 24, &dlen);
+		if (plain && dlen == plen)
+			ok++;
+		os_free(plain);
+	}
+	report("CCMP", ok, num, plen, elapsed_since(&start));
+
+	df = os_zalloc(batch * sizeof(*df));
+	if (df == NULL)
+		return;
+	os_memset(&arena, 0, sizeof(arena));
+	ok = 0;
+	os_get_time(&start);
+	for (i = 0; i < num; i += batch) {
+		int j, n = num - i < batch ? num - i : batch;
+
+		for (j = 0; j < n; j++) {
+			df[j].tk = f[i + j].tk;
+			df[j].hdr = (struct ieee80211_hdr *) f[i + j].frame;
+			df[j].data = f[i + j].frame + 24;
+			df[j].data_len = f[i + j].len - 24;
+		}
+		ok += ccmp_decrypt_batch(&arena, df, n);
+	}
+	report("CCMP batch", ok, num, plen, elapsed_since(&start));
+	wlantest_arena_free(&arena);
+	os_free(df);
+}
+
+
+static void bench_tkip(struct bench_frame *f, int num, size_t plen)
+{
+	struct os_time start;
+	int i, ok = 0;
+	size_t dlen;
+	u8 *plain;
+
+	os_get_time(&start);
+	for (i = 0; i < num; i++) {
+		plain = tkip_decrypt(f[i].tk,
+				     (struct ieee80211_hdr *) f[i].frame,
+				     f[i].frame + 24, f[i].len - 24, &dlen);
+		if (plain && dlen == plen)
+			ok++;
+		os_free(plain);
+	}
+	report("TKIP", ok, num, plen, elapsed_since(&start));
+}
+
+
+static void bench_wep(struct wlantest *wt, struct bench_frame *f, int num,
+		      size_t plen)
+{
+	struct os_time start;
+	int i, ok = 0;
+	size_t dlen;
+	u8 *plain;
+
+	os_get_time(&start);
+	for (i = 0; i < num; i++) {
+		plain = wep_decrypt(wt, (struct ieee80211_hdr *) f[i].frame,
+				    f[i].frame + 24, f[i].len - 24, &dlen);
+		if (plain && dlen == plen)
+			ok++;
+		os_free(plain);
+	}
+	report("WEP", ok, num, plen, elapsed_since(&start));
+}
+
+
+int main(int argc, char *argv[])
+{
+	int c, num = 20000, num_sta = 16, batch = 64;
+	size_t plen = 1500;
+	struct wlantest wt;
+	struct wlantest_wep wep;
+	struct bench_frame *f;
+	u8 *keys;
+
+	for (;;) {
+		c = getopt(argc, argv, "b:hl:n:s:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'b':
+			batch = atoi(optarg);
+			break;
+		case 'h':
+			usage();
+			return 0;
+		case 'l':
+			plen = atoi(optarg);
+			break;
+		case 'n':
+			num = atoi(optarg);
+			break;
+		case 's':
+			num_sta = atoi(optarg);
+			break;
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (num < 1 || num_sta < 1 || batch < 1 || plen < 1) {
+		usage();
+		return -1;
+	}
+
+	keys = os_malloc(32 * num_sta);
+	if (keys == NULL || os_get_random(keys, 32 * num_sta) < 0) {
+		os_free(keys);
+		return -1;
+	}
+
+	os_memset(&wt, 0, sizeof(wt));
+	dl_list_init(&wt.wep);
+	os_memset(&wep, 0, sizeof(wep));
+	wep.key_len = 5;
+	os_memcpy(wep.key, "\x01\x02\x03\x04\x05", 5);
+	dl_list_add(&wt.wep, &wep.list);
+
+	printf("%d frames, %lu octet payload, %d stations\n",
+	       num, (unsigned long) plen, num_sta);
+
+	f = gen_frames(WPA_CIPHER_CCMP, num, plen, keys, num_sta, NULL);
+	if (f)
+		bench_ccmp(f, num, plen, batch);
+	free_frames(f, num);
+
+	f = gen_frames(WPA_CIPHER_TKIP, num, plen, keys, num_sta, NULL);
+	if (f)
+		bench_tkip(f, num, plen);
+	free_frames(f, num);
+
+	f = gen_frames(WPA_CIPHER_WEP40, num, plen, keys, num_sta, wep.key);
+	if (f)
+		bench_wep(&wt, f, num, plen);
+	free_frames(f, num);
+
+	ccmp_deinit();
+	os_free(keys);
+
+	return 0;
+}
@@ -13,17 +13,173 @@
  */
 
 #include "utils/includes.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
 #include <pcap.h>
 
 #include "utils/common.h"
+#include "common/ieee802_11_defs.h"
+#include "common/ieee802_11_common.h"
 #include "wlantest.h"
 
 
-int read_cap_file(struct wlantest *wt, const char *fname)
+/*
+ * Memory mapped reader for the classic pcap file format. This avoids copying
+ * each frame through the libpcap read buffer and allows the parallel reader
+ * workers to share the same view of the capture file.
+ */
+struct pcap_mmap {
+	u8 *buf;
+	size_t len;
+	size_t pos;
+	int be; /* file written in big endian byte order */
+	int nsec; /* nanosecond resolution timestamps */
+	int dlt;
+};
+
+#define PCAP_MAGIC_USEC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+#define PCAP_FILE_HDR_LEN 24
+#define PCAP_REC_HDR_LEN 16
+
+
+static u32 pcap_mmap_u32(struct pcap_mmap *m, const u8 *pos)
+{
+	return m->be ? WPA_GET_BE32(pos) : WPA_GET_LE32(pos);
+}
+
+
+/* Returns 0 on success, 1 if the file needs to be read with libpcap, or -1 */
+static int pcap_mmap_open(struct pcap_mmap *m, const char *fname)
+{
+	int fd;
+	struct stat st;
+	u32 magic;
+
+	os_memset(m, 0, sizeof(*m));
+	fd = open(fname, O_RDONLY);
+	if (fd < 0) {
+		wpa_printf(MSG_ERROR, "Failed to open pcap file '%s': %s",
+			   fname, strerror(errno));
+		return -1;
+	}
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) ||
+	    st.st_size < PCAP_FILE_HDR_LEN) {
+		close(fd);
+		return 1;
+	}
+	m->len = st.st_size;
+	m->buf = mmap(NULL, m->len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (m->buf == MAP_FAILED) {
+		m->buf = NULL;
+		return 1;
+	}
+#ifdef MADV_SEQUENTIAL
+	madvise(m->buf, m->len, MADV_SEQUENTIAL);
+#endif /* MADV_SEQUENTIAL */
+
+	magic = WPA_GET_LE32(m->buf);
+	if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC)
+		m->be = 0;
+	else {
+		magic = WPA_GET_BE32(m->buf);
+		if (magic != PCAP_MAGIC_USEC && magic != PCAP_MAGIC_NSEC) {
+			/* e.g., pcapng - let libpcap handle this */
+			munmap(m->buf, m->len);
+			m->buf = NULL;
+			return 1;
+		}
+		m->be = 1;
+	}
+	m->nsec = magic == PCAP_MAGIC_NSEC;
+	m->dlt = pcap_mmap_u32(m, m->buf + 20) & 0xffff;
+	m->pos = PCAP_FILE_HDR_LEN;
+
+	return 0;
+}
+
+
+static void pcap_mmap_close(struct pcap_mmap *m)
+{
+	if (m->buf)
+		munmap(m->buf, m->len);
+	m->buf = NULL;
+}
+
+
+/* Returns 1 if a frame was read, 0 at the end of the file, or -1 on error */
+static int pcap_mmap_next(struct pcap_mmap *m, struct pcap_pkthdr *hdr,
+			  const u8 **data)
+{
+	const u8 *pos;
+
+	if (m->pos == m->len)
+		return 0;
+	if (m->len - m->pos < PCAP_REC_HDR_LEN)
+		return -1;
+	pos = m->buf + m->pos;
+	hdr->ts.tv_sec = pcap_mmap_u32(m, pos);
+	hdr->ts.tv_usec = pcap_mmap_u32(m, pos + 4);
+	if (m->nsec)
+		hdr->ts.tv_usec /= 1000;
+	hdr->caplen = pcap_mmap_u32(m, pos + 8);
+	hdr->len = pcap_mmap_u32(m, pos + 12);
+	if (hdr->caplen > m->len - m->pos - PCAP_REC_HDR_LEN)
+		return -1;
+	*data = pos + PCAP_REC_HDR_LEN;
+	m->pos += PCAP_REC_HDR_LEN + hdr->caplen;
+	return 1;
+}
+
+
+static int read_cap_dlt_supported(int dlt)
+{
+	return dlt == DLT_IEEE802_11_RADIO || dlt == DLT_PRISM_HEADER ||
+		dlt == DLT_IEEE802_11;
+}
+
+
+/* Returns 1 if the frame was processed or 0 if it was dropped */
+static int read_cap_frame(struct wlantest *wt, int dlt,
+			  const struct pcap_pkthdr *hdr, const u8 *data)
+{
+	wpa_printf(MSG_EXCESSIVE, "pcap hdr: ts=%d.%06d "
+		   "len=%u/%u",
+		   (int) hdr->ts.tv_sec, (int) hdr->ts.tv_usec,
+		   hdr->caplen, hdr->len);
+	if (wt->write_pcap_dumper) {
+		wt->write_pcap_time = hdr->ts;
+		write_pcap_record(wt, hdr, data);
+	}
+	if (hdr->caplen < hdr->len) {
+		wpa_printf(MSG_DEBUG, "pcap: Dropped incomplete frame "
+			   "(%u/%u captured)",
+			   hdr->caplen, hdr->len);
+		return 0;
+	}
+	switch (dlt) {
+	case DLT_IEEE802_11_RADIO:
+		wlantest_process(wt, data, hdr->caplen);
+		break;
+	case DLT_PRISM_HEADER:
+		wlantest_process_prism(wt, data, hdr->caplen);
+		break;
+	case DLT_IEEE802_11:
+		wlantest_process_80211(wt, data, hdr->caplen);
+		break;
+	}
+	return 1;
+}
+
+
+static int read_cap_libpcap(struct wlantest *wt, const char *fname,
+			    unsigned int *count)
 {
 	char errbuf[PCAP_ERRBUF_SIZE];
 	pcap_t *pcap;
-	unsigned int count = 0;
 	struct pcap_pkthdr *hdr;
 	const u_char *data;
 	int res;
@@ -36,8 +192,7 @@ int read_cap_file(struct wlantest *wt, const char *fname)
 		return -1;
 	}
 	dlt = pcap_datalink(pcap);
-	if (dlt != DLT_IEEE802_11_RADIO && dlt != DLT_PRISM_HEADER &&
-	    dlt != DLT_IEEE802_11) {
+	if (!read_cap_dlt_supported(dlt)) {
 		wpa_printf(MSG_ERROR, "Unsupported pcap datalink type: %d",
 			   dlt);
 		pcap_close(pcap);
@@ -61,36 +216,256 @@ int read_cap_file(struct wlantest *wt, const char *fname)
 		}
 
 		/* Packet was read without problems */
-		wpa_printf(MSG_EXCESSIVE, "pcap hdr: ts=%d.%06d "
-			   "len=%u/%u",
-			   (int) hdr->ts.tv_sec, (int) hdr->ts.tv_usec,
-			   hdr->caplen, hdr->len);
-		if (wt->write_pcap_dumper) {
-			wt->write_pcap_time = hdr->ts;
-			pcap_dump(wt->write_pcap_dumper, hdr, data);
+		*count += read_cap_frame(wt, dlt, hdr, data);
+	}
+
+	pcap_close(pcap);
+
+	return 0;
+}
+
+
+static void read_cap_truncated(void)
+{
+	wpa_printf(MSG_INFO, "pcap: Truncated capture file");
+}
+
+
+static int read_cap_mmap(struct wlantest *wt, struct pcap_mmap *m,
+			 unsigned int *count)
+{
+	struct pcap_pkthdr hdr;
+	const u8 *data;
+	int res;
+
+	while ((res = pcap_mmap_next(m, &hdr, &data)) > 0)
+		*count += read_cap_frame(wt, m->dlt, &hdr, data);
+	if (res < 0)
+		read_cap_truncated();
+
+	return 0;
+}
+
+
+/*
+ * Select the worker for a frame based on its BSSID so that all frames of a
+ * BSS (and the stations in it) are processed by the same worker. Frames
+ * without a BSSID (e.g., ACK and CTS) are processed by the worker that
+ * received the previous frame since they are matched against it.
+ */
+static int read_cap_shard(int dlt, const u8 *data, size_t len, int workers,
+			  int prev)
+{
+	const struct ieee80211_hdr *hdr;
+	const u8 *bssid;
+	size_t hlen = 0;
+	u16 fc;
+	u32 hash;
+
+	switch (dlt) {
+	case DLT_IEEE802_11_RADIO:
+		if (len < 4)
+			return prev;
+		hlen = WPA_GET_LE16(data + 2);
+		break;
+	case DLT_PRISM_HEADER:
+		if (len < 8)
+			return prev;
+		hlen = WPA_GET_LE32(data + 4);
+		break;
+	}
+	if (hlen > len)
+		return prev;
+
+	hdr = (const struct ieee80211_hdr *) (data + hlen);
+	len -= hlen;
+	bssid = get_hdr_bssid(hdr, len);
+	if (bssid == NULL && len >= 24) {
+		fc = le_to_host16(hdr->frame_control);
+		if (WLAN_FC_GET_TYPE(fc) == WLAN_FC_TYPE_DATA &&
+		    !(fc & (WLAN_FC_TODS | WLAN_FC_FROMDS)))
+			bssid = hdr->addr3; /* IBSS or direct link */
+	}
+	if (bssid == NULL)
+		return prev;
+
+	hash = (WPA_GET_BE24(bssid) * 31) ^ WPA_GET_BE24(bssid + 3);
+	return hash % workers;
+}
+
+
+struct read_cap_worker_stats {
+	unsigned int count;
+	unsigned int rx_mgmt;
+	unsigned int rx_ctrl;
+	unsigned int rx_data;
+	unsigned int fcs_error;
+	int done;
+};
+
+
+static void read_cap_worker(struct wlantest *wt, struct pcap_mmap *m,
+			    int id, FILE *shard,
+			    struct read_cap_worker_stats *stats)
+{
+	struct pcap_pkthdr hdr;
+	const u8 *data;
+	int res, owner = 0;
+
+	wt->write_pcap_shard = shard;
+	wt->write_pcap_frame = 0;
+	wt->rx_mgmt = wt->rx_ctrl = wt->rx_data = wt->fcs_error = 0;
+
+	while ((res = pcap_mmap_next(m, &hdr, &data)) > 0) {
+		owner = read_cap_shard(m->dlt, data, hdr.caplen,
+				       wt->read_workers, owner);
+		if (owner == id)
+			stats->count += read_cap_frame(wt, m->dlt, &hdr, data);
+		wt->write_pcap_frame++;
+	}
+	if (res < 0 && id == 0)
+		read_cap_truncated();
+
+	if (shard)
+		fflush(shard);
+	stats->rx_mgmt = wt->rx_mgmt;
+	stats->rx_ctrl = wt->rx_ctrl;
+	stats->rx_data = wt->rx_data;
+	stats->fcs_error = wt->fcs_error;
+	stats->done = 1;
+}
+
+
+/*
+ * Process the capture file with wt->read_workers worker processes. Each worker
+ * has its own copy of the wlantest state and processes the frames of the BSSs
+ * assigned to it. The pcap output from the workers is written into temporary
+ * shard files that are merged back into the original frame order.
+ */
+static int read_cap_parallel(struct wlantest *wt, struct pcap_mmap *m,
+			     unsigned int *count)
+{
+	int workers = wt->read_workers;
+	struct read_cap_worker_stats *stats;
+	FILE **shards = NULL;
+	pid_t *pids;
+	int i, status, ret = -1;
+
+	stats = mmap(NULL, workers * sizeof(*stats), PROT_READ | PROT_WRITE,
+		     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (stats == MAP_FAILED)
+		return -1;
+	pids = os_zalloc(workers * sizeof(*pids));
+	if (pids == NULL)
+		goto out;
+	if (wt->write_pcap_dumper) {
+		shards = os_zalloc(workers * sizeof(*shards));
+		if (shards == NULL)
+			goto out;
+		for (i = 0; i < workers; i++) {
+			shards[i] = tmpfile();
+			if (shards[i] == NULL) {
+				wpa_printf(MSG_ERROR, "Failed to create pcap "
+					   "shard file: %s", strerror(errno));
+				goto out;
+			}
 		}
-		if (hdr->caplen < hdr->len) {
-			wpa_printf(MSG_DEBUG, "pcap: Dropped incomplete frame "
-				   "(%u/%u captured)",
-				   hdr->caplen, hdr->len);
+	}
+	ret = 0;
+
+	wpa_printf(MSG_DEBUG, "Processing capture file with %d workers",
+		   workers);
+	/* Do not let the workers inherit buffered output */
+	fflush(NULL);
+
+	for (i = 0; i < workers; i++) {
+		pids[i] = fork();
+		if (pids[i] < 0) {
+			wpa_printf(MSG_ERROR, "fork: %s", strerror(errno));
+			ret = -1;
+			break;
+		}
+		if (pids[i] == 0) {
+			read_cap_worker(wt, m, i, shards ? shards[i] : NULL,
+					&stats[i]);
+			fflush(stdout);
+			_exit(0);
+		}
+	}
+
+	for (i = 0; i < workers; i++) {
+		if (pids[i] <= 0)
+			continue;
+		if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) ||
+		    WEXITSTATUS(status) != 0 || !stats[i].done) {
+			wpa_printf(MSG_ERROR, "Capture file worker %d failed",
+				   i);
+			ret = -1;
 			continue;
 		}
-		count++;
-		switch (dlt) {
-		case DLT_IEEE802_11_RADIO:
-			wlantest_process(wt, data, hdr->caplen);
-			break;
-		case DLT_PRISM_HEADER:
-			wlantest_process_prism(wt, data, hdr->caplen);
-			break;
-		case DLT_IEEE802_11:
-			wlantest_process_80211(wt, data, hdr->caplen);
+		*count += stats[i].count;
+		wt->rx_mgmt += stats[i].rx_mgmt;
+		wt->rx_ctrl += stats[i].rx_ctrl;
+		wt->rx_data += stats[i].rx_data;
+		wt->fcs_error += stats[i].fcs_error;
+	}
+
+	if (ret == 0 && shards &&
+	    write_pcap_merge_shards(wt, shards, workers) < 0)
+		ret = -1;
+
+out:
+	if (shards) {
+		for (i = 0; i < workers; i++) {
+			if (shards[i])
+				fclose(shards[i]);
 		}
+		os_free(shards);
 	}
+	os_free(pids);
+	munmap(stats, workers * sizeof(*stats));
 
-	pcap_close(pcap);
+	return ret;
+}
 
-	wpa_printf(MSG_DEBUG, "Read %s: %u packets", fname, count);
+
+int read_cap_file(struct wlantest *wt, const char *fname)
+{
+	struct pcap_mmap m;
+	struct os_time start, end;
+	unsigned int count = 0;
+	double elapsed;
+	int res;
+
+	os_get_time(&start);
+
+	res = pcap_mmap_open(&m, fname);
+	if (res < 0)
+		return -1;
+	if (res == 0) {
+		if (!read_cap_dlt_supported(m.dlt)) {
+			wpa_printf(MSG_ERROR, "Unsupported pcap datalink "
+				   "type: %d", m.dlt);
+			pcap_mmap_close(&m);
+			return -1;
+		}
+		wpa_printf(MSG_DEBUG, "pcap datalink type: %d", m.dlt);
+		if (wt->read_workers > 1)
+			res = read_cap_parallel(wt, &m, &count);
+		else
+			res = read_cap_mmap(wt, &m, &count);
+		pcap_mmap_close(&m);
+	} else
+		res = read_cap_libpcap(wt, fname, &count);
+	if (res < 0)
+		return -1;
+
+	os_get_time(&end);
+	elapsed = (end.sec - start.sec) + (end.usec - start.usec) / 1000000.0;
+	if (elapsed <= 0)
+		elapsed = 0.000001;
+	wpa_printf(MSG_INFO, "Read %s: %u packets in %.3f seconds "
+		   "(%.0f frames/s)", fname, count, elapsed, count / elapsed);
 
 	return 0;
 }
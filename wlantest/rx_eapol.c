@@ -133,16 +133,26 @@ static void derive_ptk(struct wlantest *wt, struct wlantest_bss *bss,
 
 	wpa_printf(MSG_DEBUG, "Trying to derive PTK for " MACSTR,
 		   MAC2STR(sta->addr));
+	/*
+	 * Move the matching PMK to the head of the list since the following
+	 * handshakes with the same BSS are likely to use the same one.
+	 */
 	dl_list_for_each(pmk, &bss->pmk, struct wlantest_pmk, list) {
 		wpa_printf(MSG_DEBUG, "Try per-BSS PMK");
-		if (try_pmk(bss, sta, ver, data, len, pmk) == 0)
+		if (try_pmk(bss, sta, ver, data, len, pmk) == 0) {
+			dl_list_del(&pmk->list);
+			dl_list_add(&bss->pmk, &pmk->list);
 			return;
+		}
 	}
 
 	dl_list_for_each(pmk, &wt->pmk, struct wlantest_pmk, list) {
 		wpa_printf(MSG_DEBUG, "Try global PMK");
-		if (try_pmk(bss, sta, ver, data, len, pmk) == 0)
+		if (try_pmk(bss, sta, ver, data, len, pmk) == 0) {
+			dl_list_del(&pmk->list);
+			dl_list_add(&wt->pmk, &pmk->list);
 			return;
+		}
 	}
 	wpa_printf(MSG_DEBUG, "No matching PMK found to derive PTK");
 }
@@ -19,9 +19,6 @@
 #include "wlantest.h"
 
 
-void wep_crypt(u8 *key, u8 *buf, size_t plen);
-
-
 static inline u16 RotR1(u16 val)
 {
 	return (val >> 1) | (val << 15);
@@ -294,6 +291,40 @@ static void michael_mic_hdr(const struct ieee80211_hdr *hdr11, u8 *hdr)
 }
 
 
+/*
+ * Phase 1 of the TKIP key mixing depends only on TK, TA, and IV32, so its
+ * output stays the same for 65536 consecutive frames from a transmitter.
+ * Cache the TTAK per transmitter (direct-mapped by the last octet of TA).
+ */
+#define TKIP_TTAK_CACHE_SIZE 64
+
+static struct tkip_ttak_cache {
+	u8 tk[16];
+	u8 ta[ETH_ALEN];
+	u32 iv32;
+	u16 ttak[5];
+	int valid;
+} tkip_ttak_cache[TKIP_TTAK_CACHE_SIZE];
+
+
+static void tkip_get_ttak(u16 *ttak, const u8 *tk, const u8 *ta, u32 iv32)
+{
+	struct tkip_ttak_cache *c;
+
+	c = &tkip_ttak_cache[ta[5] % TKIP_TTAK_CACHE_SIZE];
+	if (!c->valid || c->iv32 != iv32 ||
+	    os_memcmp(c->ta, ta, ETH_ALEN) != 0 ||
+	    os_memcmp(c->tk, tk, 16) != 0) {
+		tkip_mixing_phase1(c->ttak, tk, ta, iv32);
+		os_memcpy(c->tk, tk, 16);
+		os_memcpy(c->ta, ta, ETH_ALEN);
+		c->iv32 = iv32;
+		c->valid = 1;
+	}
+	os_memcpy(ttak, c->ttak, sizeof(c->ttak));
+}
+
+
 u8 * tkip_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 		  const u8 *data, size_t data_len, size_t *decrypted_len)
 {
@@ -317,7 +348,7 @@ u8 * tkip_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 	wpa_printf(MSG_EXCESSIVE, "TKIP decrypt: iv32=%08x iv16=%04x",
 		   iv32, iv16);
 
-	tkip_mixing_phase1(ttak, tk, hdr->addr2, iv32);
+	tkip_get_ttak(ttak, tk, hdr->addr2, iv32);
 	wpa_hexdump(MSG_EXCESSIVE, "TKIP TTAK", (u8 *) ttak, sizeof(ttak));
 	tkip_mixing_phase2(rc4key, tk, ttak, iv16);
 	wpa_hexdump(MSG_EXCESSIVE, "TKIP RC4KEY", rc4key, sizeof(rc4key));
@@ -382,6 +413,57 @@ void tkip_get_pn(u8 *pn, const u8 *data)
 u8 * tkip_encrypt(const u8 *tk, u8 *frame, size_t len, size_t hdrlen, u8 *qos,
 		  u8 *pn, int keyid, size_t *encrypted_len)
 {
-	/* TODO */
-	return NULL;
+	u8 michael_hdr[16];
+	u8 mic[8];
+	struct ieee80211_hdr *hdr;
+	u16 fc;
+	const u8 *mic_key;
+	u8 *crypt, *pos;
+	u16 iv16;
+	u32 iv32;
+	u16 ttak[5];
+	u8 rc4key[16];
+	size_t plen;
+
+	if (len < hdrlen || hdrlen < 24)
+		return NULL;
+	plen = len - hdrlen;
+
+	crypt = os_malloc(hdrlen + 8 + plen + 8 + 4);
+	if (crypt == NULL)
+		return NULL;
+
+	os_memcpy(crypt, frame, hdrlen);
+	hdr = (struct ieee80211_hdr *) crypt;
+	hdr->frame_control |= host_to_le16(WLAN_FC_ISWEP);
+	pos = crypt + hdrlen;
+	*pos++ = pn[4]; /* TSC1 */
+	*pos++ = (pn[4] | 0x20) & 0x7f; /* WEPSeed[1] */
+	*pos++ = pn[5]; /* TSC0 */
+	*pos++ = 0x20 | (keyid << 6);
+	*pos++ = pn[3]; /* TSC2 */
+	*pos++ = pn[2]; /* TSC3 */
+	*pos++ = pn[1]; /* TSC4 */
+	*pos++ = pn[0]; /* TSC5 */
+
+	os_memcpy(pos, frame + hdrlen, plen);
+
+	fc = le_to_host16(hdr->frame_control);
+	michael_mic_hdr(hdr, michael_hdr);
+	mic_key = tk + ((fc & WLAN_FC_FROMDS) ? 16 : 24);
+	michael_mic(mic_key, michael_hdr, frame + hdrlen, plen, mic);
+	os_memcpy(pos + plen, mic, 8);
+	WPA_PUT_LE32(pos + plen + 8, crc32(pos, plen + 8));
+
+	iv16 = WPA_GET_BE16(&pn[4]);
+	iv32 = WPA_GET_BE32(pn);
+	tkip_mixing_phase1(ttak, tk, hdr->addr2, iv32);
+	wpa_hexdump(MSG_EXCESSIVE, "TKIP TTAK", (u8 *) ttak, sizeof(ttak));
+	tkip_mixing_phase2(rc4key, tk, ttak, iv16);
+	wpa_hexdump(MSG_EXCESSIVE, "TKIP RC4KEY", rc4key, sizeof(rc4key));
+
+	wep_crypt(rc4key, pos, plen + 8 + 4);
+
+	*encrypted_len = hdrlen + 8 + plen + 8 + 4;
+	return crypt;
 }
@@ -35,7 +35,7 @@ static void usage(void)
 	       "[-p<passphrase>]\n"
 		"         [-I<wired ifname>] [-R<wired pcap file>] "
 	       "[-P<RADIUS shared secret>]\n"
-		"         [-w<write pcap file>]\n");
+		"         [-w<write pcap file>] [-j<workers>]\n");
 }
 
 
@@ -90,6 +90,8 @@ static void wlantest_deinit(struct wlantest *wt)
 	if (wt->monitor_sock >= 0)
 		monitor_deinit(wt);
 	bss_flush(wt);
+	pmk_cache_flush(wt);
+	ccmp_deinit();
 	dl_list_for_each_safe(p, pn, &wt->passphrase,
 			      struct wlantest_passphrase, list)
 		passphrase_deinit(p);
@@ -169,6 +171,7 @@ int main(int argc, char *argv[])
 	const char *ifname_wired = NULL;
 	struct wlantest wt;
 	int ctrl_iface = 0;
+	int workers = 1;
 
 	wpa_debug_level = MSG_INFO;
 	wpa_debug_show_keys = 1;
@@ -179,7 +182,7 @@ int main(int argc, char *argv[])
 	wlantest_init(&wt);
 
 	for (;;) {
-		c = getopt(argc, argv, "cdhi:I:p:P:qr:R:w:W:");
+		c = getopt(argc, argv, "cdhi:I:j:p:P:qr:R:w:W:");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -199,6 +202,9 @@ int main(int argc, char *argv[])
 		case 'I':
 			ifname_wired = optarg;
 			break;
+		case 'j':
+			workers = atoi(optarg);
+			break;
 		case 'p':
 			add_passphrase(&wt, optarg);
 			break;
@@ -233,6 +239,19 @@ int main(int argc, char *argv[])
 		return 0;
 	}
 
+	if (workers > 1) {
+		/*
+		 * The BSS/STA state is split between the worker processes, so
+		 * it is not available for live capture or control interface.
+		 */
+		if (read_file == NULL || ifname || ifname_wired || ctrl_iface) {
+			printf("-j can only be used for reading a capture file "
+			       "(-r) without -c, -i, or -I\n");
+			return -1;
+		}
+		wt.read_workers = workers;
+	}
+
 	if (eloop_init())
 		return -1;
 
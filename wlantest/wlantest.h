@@ -26,6 +26,11 @@ struct wlantest_bss;
 
 #define MAX_RADIUS_SECRET_LEN 128
 
+#define WLANTEST_HASH_SIZE 256
+#define WLANTEST_HASH(addr) ((addr)[5])
+
+#define PMK_CACHE_HASH_SIZE 64
+
 struct wlantest_radius_secret {
 	struct dl_list list;
 	char secret[MAX_RADIUS_SECRET_LEN];
@@ -44,6 +49,15 @@ struct wlantest_pmk {
 	u8 pmk[32];
 };
 
+/* PMK derived from a passphrase, shared by all BSSs with the same SSID */
+struct wlantest_pmk_cache {
+	struct wlantest_pmk_cache *hnext;
+	u8 ssid[32];
+	size_t ssid_len;
+	char passphrase[64];
+	u8 pmk[32];
+};
+
 struct wlantest_wep {
 	struct dl_list list;
 	size_t key_len;
@@ -52,6 +66,7 @@ struct wlantest_wep {
 
 struct wlantest_sta {
 	struct dl_list list;
+	struct wlantest_sta *hnext; /* next entry in hash table list */
 	struct wlantest_bss *bss;
 	u8 addr[ETH_ALEN];
 	enum {
@@ -110,6 +125,7 @@ struct wlantest_tdls {
 
 struct wlantest_bss {
 	struct dl_list list;
+	struct wlantest_bss *hnext; /* next entry in hash table list */
 	u8 bssid[ETH_ALEN];
 	u16 capab_info;
 	u16 prev_capab_info;
@@ -126,6 +142,7 @@ struct wlantest_bss {
 	int key_mgmt;
 	int rsn_capab;
 	struct dl_list sta; /* struct wlantest_sta */
+	struct wlantest_sta *sta_hash[WLANTEST_HASH_SIZE];
 	struct dl_list pmk; /* struct wlantest_pmk */
 	u8 gtk[4][32];
 	size_t gtk_len[4];
@@ -158,10 +175,12 @@ struct wlantest {
 
 	struct dl_list passphrase; /* struct wlantest_passphrase */
 	struct dl_list bss; /* struct wlantest_bss */
+	struct wlantest_bss *bss_hash[WLANTEST_HASH_SIZE];
 	struct dl_list secret; /* struct wlantest_radius_secret */
 	struct dl_list radius; /* struct wlantest_radius */
 	struct dl_list pmk; /* struct wlantest_pmk */
 	struct dl_list wep; /* struct wlantest_wep */
+	struct wlantest_pmk_cache *pmk_cache[PMK_CACHE_HASH_SIZE];
 
 	unsigned int rx_mgmt;
 	unsigned int rx_ctrl;
@@ -171,6 +190,10 @@ struct wlantest {
 	void *write_pcap; /* pcap_t* */
 	void *write_pcap_dumper; /* pcpa_dumper_t */
 	struct timeval write_pcap_time;
+	FILE *write_pcap_shard; /* set in parallel capture file reader workers */
+	unsigned int write_pcap_frame;
+
+	int read_workers;
 
 	u8 last_hdr[30];
 	size_t last_len;
@@ -182,6 +205,10 @@ int read_cap_file(struct wlantest *wt, const char *fname);
 int read_wired_cap_file(struct wlantest *wt, const char *fname);
 int write_pcap_init(struct wlantest *wt, const char *fname);
 void write_pcap_deinit(struct wlantest *wt);
+struct pcap_pkthdr;
+void write_pcap_record(struct wlantest *wt, const struct pcap_pkthdr *h,
+		       const u8 *buf);
+int write_pcap_merge_shards(struct wlantest *wt, FILE **shards, int num);
 void write_pcap_captured(struct wlantest *wt, const u8 *buf, size_t len);
 void write_pcap_decrypted(struct wlantest *wt, const u8 *buf1, size_t len1,
 			  const u8 *buf2, size_t len2);
@@ -207,12 +234,13 @@ void rx_data_80211_encap(struct wlantest *wt, const u8 *bssid,
 
 struct wlantest_bss * bss_find(struct wlantest *wt, const u8 *bssid);
 struct wlantest_bss * bss_get(struct wlantest *wt, const u8 *bssid);
-void bss_deinit(struct wlantest_bss *bss);
+void bss_deinit(struct wlantest *wt, struct wlantest_bss *bss);
 void bss_update(struct wlantest *wt, struct wlantest_bss *bss,
 		struct ieee802_11_elems *elems);
 void bss_flush(struct wlantest *wt);
-int bss_add_pmk_from_passphrase(struct wlantest_bss *bss,
+int bss_add_pmk_from_passphrase(struct wlantest *wt, struct wlantest_bss *bss,
 				const char *passphrase);
+void pmk_cache_flush(struct wlantest *wt);
 void pmk_deinit(struct wlantest_pmk *pmk);
 void tdls_deinit(struct wlantest_tdls *tdls);
 
@@ -222,8 +250,32 @@ void sta_deinit(struct wlantest_sta *sta);
 void sta_update_assoc(struct wlantest_sta *sta,
 		      struct ieee802_11_elems *elems);
 
+/**
+ * struct wlantest_arena - Reusable output buffer for batch decryption
+ */
+struct wlantest_arena {
+	u8 *buf;
+	size_t size;
+};
+
+/**
+ * struct wlantest_decrypt_frame - Frame for ccmp_decrypt_batch()
+ */
+struct wlantest_decrypt_frame {
+	const u8 *tk;
+	const struct ieee80211_hdr *hdr;
+	const u8 *data; /* CCMP header, encrypted payload, and MIC */
+	size_t data_len;
+	u8 *plain; /* set to point into the arena or %NULL on failure */
+	size_t plain_len;
+};
+
 u8 * ccmp_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 		  const u8 *data, size_t data_len, size_t *decrypted_len);
+size_t ccmp_decrypt_batch(struct wlantest_arena *arena,
+			  struct wlantest_decrypt_frame *frames, size_t num);
+void wlantest_arena_free(struct wlantest_arena *arena);
+void ccmp_deinit(void);
 u8 * ccmp_encrypt(const u8 *tk, u8 *frame, size_t len, size_t hdrlen, u8 *qos,
 		  u8 *pn, int keyid, size_t *encrypted_len);
 void ccmp_get_pn(u8 *pn, const u8 *data);
@@ -234,6 +286,7 @@ u8 * tkip_encrypt(const u8 *tk, u8 *frame, size_t len, size_t hdrlen, u8 *qos,
 		  u8 *pn, int keyid, size_t *encrypted_len);
 void tkip_get_pn(u8 *pn, const u8 *data);
 
+void wep_crypt(u8 *key, u8 *buf, size_t plen);
 u8 * wep_decrypt(struct wlantest *wt, const struct ieee80211_hdr *hdr,
 		 const u8 *data, size_t data_len, size_t *decrypted_len);
 
@@ -51,6 +51,125 @@ void write_pcap_deinit(struct wlantest *wt)
 }
 
 
+/*
+ * Record header used in the temporary shard files written by the workers of
+ * the parallel capture file reader. frame is the index of the input frame that
+ * resulted in this record and is used to restore the original order.
+ */
+struct write_pcap_shard_hdr {
+	u32 frame;
+	u32 ts_sec;
+	u32 ts_usec;
+	u32 caplen;
+	u32 len;
+};
+
+
+void write_pcap_record(struct wlantest *wt, const struct pcap_pkthdr *h,
+		       const u8 *buf)
+{
+	struct write_pcap_shard_hdr sh;
+
+	if (wt->write_pcap_shard == NULL) {
+		pcap_dump(wt->write_pcap_dumper, h, buf);
+		return;
+	}
+
+	sh.frame = wt->write_pcap_frame;
+	sh.ts_sec = h->ts.tv_sec;
+	sh.ts_usec = h->ts.tv_usec;
+	sh.caplen = h->caplen;
+	sh.len = h->len;
+	if (fwrite(&sh, sizeof(sh), 1, wt->write_pcap_shard) != 1 ||
+	    fwrite(buf, 1, h->caplen, wt->write_pcap_shard) != h->caplen)
+		wpa_printf(MSG_ERROR, "Failed to write pcap shard record");
+}
+
+
+static int write_pcap_shard_next(FILE *f, struct write_pcap_shard_hdr *sh)
+{
+	return fread(sh, sizeof(*sh), 1, f) == 1 ? 0 : -1;
+}
+
+
+/**
+ * write_pcap_merge_shards - Merge shard files into the pcap dump file
+ * @wt: wlantest context
+ * @shards: Shard files written with write_pcap_record() by each worker
+ * @num: Number of shard files
+ * Returns: 0 on success, -1 on failure
+ *
+ * Each shard contains the records from a subset of the input frames in input
+ * order. The records are merged by the input frame index, so the dump file
+ * ends up with the same contents and order as with sequential processing.
+ */
+int write_pcap_merge_shards(struct wlantest *wt, FILE **shards, int num)
+{
+	struct write_pcap_shard_hdr *next;
+	int *valid;
+	u8 *buf = NULL;
+	size_t buf_len = 0;
+	struct pcap_pkthdr h;
+	int i, sel, ret = 0;
+
+	next = os_zalloc(num * sizeof(*next));
+	valid = os_zalloc(num * sizeof(*valid));
+	if (next == NULL || valid == NULL) {
+		os_free(next);
+		os_free(valid);
+		return -1;
+	}
+
+	for (i = 0; i < num; i++) {
+		rewind(shards[i]);
+		valid[i] = write_pcap_shard_next(shards[i], &next[i]) == 0;
+	}
+
+	for (;;) {
+		sel = -1;
+		for (i = 0; i < num; i++) {
+			if (valid[i] &&
+			    (sel < 0 || next[i].frame < next[sel].frame))
+				sel = i;
+		}
+		if (sel < 0)
+			break;
+
+		if (next[sel].caplen > buf_len) {
+			u8 *nbuf = os_realloc(buf, next[sel].caplen);
+			if (nbuf == NULL) {
+				ret = -1;
+				break;
+			}
+			buf = nbuf;
+			buf_len = next[sel].caplen;
+		}
+		if (fread(buf, 1, next[sel].caplen, shards[sel]) !=
+		    next[sel].caplen) {
+			wpa_printf(MSG_ERROR, "Truncated pcap shard");
+			ret = -1;
+			break;
+		}
+
+		os_memset(&h, 0, sizeof(h));
+		h.ts.tv_sec = next[sel].ts_sec;
+		h.ts.tv_usec = next[sel].ts_usec;
+		h.caplen = next[sel].caplen;
+		h.len = next[sel].len;
+		pcap_dump(wt->write_pcap_dumper, &h, buf);
+
+		valid[sel] = write_pcap_shard_next(shards[sel], &next[sel]) ==
+			0;
+	}
+
+	os_free(buf);
+	os_free(next);
+	os_free(valid);
+
+	return ret;
+}
+
+
 void write_pcap_captured(struct wlantest *wt, const u8 *buf, size_t len)
 {
 	struct pcap_pkthdr h;
@@ -63,7 +182,7 @@ void write_pcap_captured(struct wlantest *wt, const u8 *buf, size_t len)
 	h.ts = wt->write_pcap_time;
 	h.caplen = len;
 	h.len = len;
-	pcap_dump(wt->write_pcap_dumper, &h, buf);
+	write_pcap_record(wt, &h, buf);
 }
 
 
@@ -98,6 +217,6 @@ void write_pcap_decrypted(struct wlantest *wt, const u8 *buf1, size_t len1,
 		os_memcpy(buf + sizeof(rtap) + len1, buf2, len2);
 	h.caplen = len;
 	h.len = len;
-	pcap_dump(wt->write_pcap_dumper, &h, buf);
+	write_pcap_record(wt, &h, buf);
 	os_free(buf);
 }
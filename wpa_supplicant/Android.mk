@@ -74,6 +74,7 @@ endif
 OBJS = config.c
 OBJS += notify.c
 OBJS += bss.c
+OBJS += bss_ie.c
 OBJS += eap_register.c
 OBJS += src/utils/common.c
 OBJS += src/utils/wpa_debug.c
@@ -1337,6 +1338,7 @@ OBJS_wpa += tests/link_test.c
 endif
 OBJS_wpa += $(OBJS_l2)
 OBJS += wpa_supplicant.c events.c blacklist.c wpas_glue.c scan.c
+OBJS += conn_timeline.c
 OBJS_t := $(OBJS) $(OBJS_l2) eapol_test.c
 OBJS_t += src/radius/radius_client.c
 OBJS_t += src/radius/radius.c
@@ -25,6 +25,26 @@
 #include "scan.h"
 #include "bgscan.h"
 
+/*
+ * Channel occupancy is tracked as a weight per channel. Each time a channel is
+ * scanned, the weight decays by 1/BGSCAN_LEARN_DECAY and, if a BSS of the ESS
+ * was found on the channel, BGSCAN_LEARN_HIT is added. The weight converges to
+ * BGSCAN_LEARN_HIT * BGSCAN_LEARN_DECAY * P(hit), i.e., BGSCAN_LEARN_WEIGHT_MAX
+ * corresponds to a channel on which the ESS is always found.
+ */
+#define BGSCAN_LEARN_HIT 256
+#define BGSCAN_LEARN_DECAY 8
+#define BGSCAN_LEARN_WEIGHT_MAX (BGSCAN_LEARN_HIT * BGSCAN_LEARN_DECAY)
+/* Minimum hit probability (in percent) for including a channel */
+#define BGSCAN_LEARN_MIN_PROB 5
+/* Maximum number of channels in a partial scan */
+#define BGSCAN_LEARN_MAX_PARTIAL 8
+/* A full scan is done at least once every this many background scans */
+#define BGSCAN_LEARN_FULL_SCAN_EVERY 10
+
+#define BGSCAN_LEARN_FILE_MAGIC "WPAL"
+#define BGSCAN_LEARN_FILE_VERSION 1
+
 struct bgscan_learn_bss {
 	struct dl_list list;
 	u8 bssid[ETH_ALEN];
@@ -33,6 +53,11 @@ struct bgscan_learn_bss {
 	size_t num_neigh;
 };
 
+struct bgscan_learn_chan {
+	int freq;
+	unsigned int weight;
+};
+
 struct bgscan_learn_data {
 	struct wpa_supplicant *wpa_s;
 	const struct wpa_ssid *ssid;
@@ -45,6 +70,13 @@ struct bgscan_learn_data {
 	struct dl_list bss;
 	int *supp_freqs;
 	int probe_idx;
+	struct bgscan_learn_chan *chan;
+	size_t num_chan;
+	int *scan_freqs; /* channels of the pending scan; NULL = all */
+	int scan_pending;
+	int scans_since_full;
+	int last_scan_missed;
+	struct os_time last_full_scan;
 };
 
 
@@ -55,6 +87,18 @@ static void bss_free(struct bgscan_learn_bss *bss)
 }
 
 
+static void bgscan_learn_free_bss(struct bgscan_learn_data *data)
+{
+	struct bgscan_learn_bss *bss, *n;
+
+	dl_list_for_each_safe(bss, n, &data->bss, struct bgscan_learn_bss,
+			      list) {
+		dl_list_del(&bss->list);
+		bss_free(bss);
+	}
+}
+
+
 static int bssid_in_array(u8 *array, size_t array_len, const u8 *bssid)
 {
 	size_t i;
@@ -104,29 +148,40 @@ static struct bgscan_learn_bss * bgscan_learn_get_bss(
 }
 
 
-static int bgscan_learn_load(struct bgscan_learn_data *data)
+static struct bgscan_learn_chan * bgscan_learn_get_chan(
+	struct bgscan_learn_data *data, int freq, int add)
 {
-	FILE *f;
-	char buf[128];
-	struct bgscan_learn_bss *bss;
+	struct bgscan_learn_chan *n;
+	size_t i;
 
-	if (data->fname == NULL)
-		return 0;
+	for (i = 0; i < data->num_chan; i++) {
+		if (data->chan[i].freq == freq)
+			return &data->chan[i];
+	}
 
-	f = fopen(data->fname, "r");
-	if (f == NULL)
-		return 0;
+	if (!add || freq <= 0)
+		return NULL;
 
-	wpa_printf(MSG_DEBUG, "bgscan learn: Loading data from %s",
-		   data->fname);
+	n = os_realloc(data->chan, (data->num_chan + 1) * sizeof(*n));
+	if (n == NULL)
+		return NULL;
+	data->chan = n;
+	n = &data->chan[data->num_chan++];
+	n->freq = freq;
+	n->weight = 0;
+	return n;
+}
+
+
+static int bgscan_learn_load_text(struct bgscan_learn_data *data, FILE *f)
+{
+	char buf[128];
+	struct bgscan_learn_bss *bss;
 
+	/* Data file format used by earlier versions */
 	if (fgets(buf, sizeof(buf), f) == NULL ||
-	    os_strncmp(buf, "wpa_supplicant-bgscan-learn\n", 28) != 0) {
-		wpa_printf(MSG_INFO, "bgscan learn: Invalid data file %s",
-			   data->fname);
-		fclose(f);
+	    os_strncmp(buf, "wpa_supplicant-bgscan-learn\n", 28) != 0)
 		return -1;
-	}
 
 	while (fgets(buf, sizeof(buf), f)) {
 		if (os_strncmp(buf, "BSS ", 4) == 0) {
@@ -159,7 +214,112 @@ static int bgscan_learn_load(struct bgscan_learn_data *data)
 		}
 	}
 
+	return 0;
+}
+
+
+/*
+ * Binary data file format (all integers little endian):
+ * "WPAL" version(u8) num_chan(u16) num_chan * [freq(u16) weight(u16)]
+ * num_bss(u16) num_bss * [bssid(6) freq(u16) num_neigh(u8) num_neigh * [6]]
+ */
+static int bgscan_learn_load_bin(struct bgscan_learn_data *data,
+				 const u8 *pos, const u8 *end)
+{
+	struct bgscan_learn_bss *bss;
+	struct bgscan_learn_chan *chan;
+	unsigned int num, i, j, num_neigh;
+
+	if (end - pos < 7 ||
+	    os_memcmp(pos, BGSCAN_LEARN_FILE_MAGIC, 4) != 0 ||
+	    pos[4] != BGSCAN_LEARN_FILE_VERSION)
+		return -1;
+	pos += 5;
+
+	num = WPA_GET_LE16(pos);
+	pos += 2;
+	if ((size_t) (end - pos) < num * 4 + 2)
+		return -1;
+	for (i = 0; i < num; i++) {
+		chan = bgscan_learn_get_chan(data, WPA_GET_LE16(pos), 1);
+		if (chan) {
+			chan->weight = WPA_GET_LE16(pos + 2);
+			if (chan->weight > BGSCAN_LEARN_WEIGHT_MAX)
+				chan->weight = BGSCAN_LEARN_WEIGHT_MAX;
+		}
+		pos += 4;
+	}
+
+	num = WPA_GET_LE16(pos);
+	pos += 2;
+	for (i = 0; i < num; i++) {
+		if (end - pos < ETH_ALEN + 3)
+			return -1;
+		num_neigh = pos[ETH_ALEN + 2];
+		if ((size_t) (end - pos) < ETH_ALEN + 3 + num_neigh * ETH_ALEN)
+			return -1;
+		bss = os_zalloc(sizeof(*bss));
+		if (bss == NULL)
+			return -1;
+		os_memcpy(bss->bssid, pos, ETH_ALEN);
+		bss->freq = WPA_GET_LE16(pos + ETH_ALEN);
+		pos += ETH_ALEN + 3;
+		dl_list_add_tail(&data->bss, &bss->list);
+		for (j = 0; j < num_neigh; j++) {
+			bgscan_learn_add_neighbor(bss, pos);
+			pos += ETH_ALEN;
+		}
+	}
+
+	wpa_printf(MSG_DEBUG, "bgscan learn: Loaded %u channels and %u BSS "
+		   "entries", (unsigned int) data->num_chan, num);
+
+	return 0;
+}
+
+
+static int bgscan_learn_load(struct bgscan_learn_data *data)
+{
+	FILE *f;
+	char *buf;
+	size_t len;
+	int ret;
+
+	if (data->fname == NULL)
+		return 0;
+
+	f = fopen(data->fname, "r");
+	if (f == NULL)
+		return 0;
+	fclose(f);
+
+	wpa_printf(MSG_DEBUG, "bgscan learn: Loading data from %s",
+		   data->fname);
+
+	buf = os_readfile(data->fname, &len);
+	if (buf == NULL)
+		return -1;
+
+	ret = bgscan_learn_load_bin(data, (u8 *) buf, (u8 *) buf + len);
+	os_free(buf);
+	if (ret == 0)
+		return 0;
+
+	/* Not a valid binary file; try the old text format */
+	bgscan_learn_free_bss(data);
+	os_free(data->chan);
+	data->chan = NULL;
+	data->num_chan = 0;
+	f = fopen(data->fname, "r");
+	if (f == NULL || bgscan_learn_load_text(data, f) < 0) {
+		wpa_printf(MSG_INFO, "bgscan learn: Invalid data file %s",
+			   data->fname);
+		if (f)
+			fclose(f);
+		return -1;
+	}
 	fclose(f);
+
 	return 0;
 }
 
@@ -168,6 +328,8 @@ static void bgscan_learn_save(struct bgscan_learn_data *data)
 {
 	FILE *f;
 	struct bgscan_learn_bss *bss;
+	u8 buf[ETH_ALEN + 3];
+	size_t i, num_bss, num_neigh;
 
 	if (data->fname == NULL)
 		return;
@@ -175,23 +337,34 @@ static void bgscan_learn_save(struct bgscan_learn_data *data)
 	wpa_printf(MSG_DEBUG, "bgscan learn: Saving data to %s",
 		   data->fname);
 
-	f = fopen(data->fname, "w");
+	f = fopen(data->fname, "wb");
 	if (f == NULL)
 		return;
-	fprintf(f, "wpa_supplicant-bgscan-learn\n");
 
-	dl_list_for_each(bss, &data->bss, struct bgscan_learn_bss, list) {
-		fprintf(f, "BSS " MACSTR " %d\n",
-			MAC2STR(bss->bssid), bss->freq);
+	os_memcpy(buf, BGSCAN_LEARN_FILE_MAGIC, 4);
+	buf[4] = BGSCAN_LEARN_FILE_VERSION;
+	WPA_PUT_LE16(&buf[5], data->num_chan);
+	fwrite(buf, 7, 1, f);
+	for (i = 0; i < data->num_chan; i++) {
+		WPA_PUT_LE16(&buf[0], data->chan[i].freq);
+		WPA_PUT_LE16(&buf[2], data->chan[i].weight);
+		fwrite(buf, 4, 1, f);
 	}
 
+	num_bss = dl_list_len(&data->bss);
+	if (num_bss > 0xffff)
+		num_bss = 0xffff;
+	WPA_PUT_LE16(buf, num_bss);
+	fwrite(buf, 2, 1, f);
 	dl_list_for_each(bss, &data->bss, struct bgscan_learn_bss, list) {
-		size_t i;
-		for (i = 0; i < bss->num_neigh; i++) {
-			fprintf(f, "NEIGHBOR " MACSTR " " MACSTR "\n",
-				MAC2STR(bss->bssid),
-				MAC2STR(bss->neigh + i * ETH_ALEN));
-		}
+		if (num_bss-- == 0)
+			break;
+		num_neigh = bss->num_neigh > 255 ? 255 : bss->num_neigh;
+		os_memcpy(buf, bss->bssid, ETH_ALEN);
+		WPA_PUT_LE16(&buf[ETH_ALEN], bss->freq);
+		buf[ETH_ALEN + 2] = num_neigh;
+		fwrite(buf, ETH_ALEN + 3, 1, f);
+		fwrite(bss->neigh, ETH_ALEN, num_neigh, f);
 	}
 
 	fclose(f);
@@ -214,30 +387,100 @@ static int in_array(int *array, int val)
 }
 
 
+static int * bgscan_learn_add_freq(int *freqs, size_t *count, int freq)
+{
+	int *n;
+
+	if (freq <= 0 || in_array(freqs, freq))
+		return freqs;
+	n = os_realloc(freqs, (*count + 2) * sizeof(int));
+	if (n == NULL)
+		return freqs;
+	n[*count] = freq;
+	(*count)++;
+	n[*count] = 0;
+	return n;
+}
+
+
+static int chan_weight_cmp(const void *a, const void *b)
+{
+	const struct bgscan_learn_chan *ca = a, *cb = b;
+
+	return (int) cb->weight - (int) ca->weight;
+}
+
+
 static int * bgscan_learn_get_freqs(struct bgscan_learn_data *data,
 				    size_t *count)
 {
 	struct bgscan_learn_bss *bss;
-	int *freqs = NULL, *n;
+	int *freqs = NULL;
+	size_t i;
 
 	*count = 0;
 
-	dl_list_for_each(bss, &data->bss, struct bgscan_learn_bss, list) {
-		if (in_array(freqs, bss->freq))
-			continue;
-		n = os_realloc(freqs, (*count + 2) * sizeof(int));
-		if (n == NULL)
-			return freqs;
-		freqs = n;
-		freqs[*count] = bss->freq;
-		(*count)++;
-		freqs[*count] = 0;
+	/*
+	 * Channels with the highest probability of finding a BSS of this ESS
+	 * first. The list is kept sorted so that the save file is, too.
+	 */
+	qsort(data->chan, data->num_chan, sizeof(data->chan[0]),
+	      chan_weight_cmp);
+	for (i = 0; i < data->num_chan && *count < BGSCAN_LEARN_MAX_PARTIAL;
+	     i++) {
+		if (data->chan[i].weight * 100 <
+		    BGSCAN_LEARN_MIN_PROB * BGSCAN_LEARN_WEIGHT_MAX)
+			break;
+		freqs = bgscan_learn_add_freq(freqs, count, data->chan[i].freq);
+	}
+
+	/* Channels of the known neighbors of the current AP */
+	bss = bgscan_learn_get_bss(data, data->wpa_s->bssid);
+	if (bss) {
+		for (i = 0; i < bss->num_neigh; i++) {
+			struct bgscan_learn_bss *n;
+			n = bgscan_learn_get_bss(data,
+						 bss->neigh + i * ETH_ALEN);
+			if (n)
+				freqs = bgscan_learn_add_freq(freqs, count,
+							      n->freq);
+		}
+	}
+
+	if (*count == 0) {
+		/* No channel statistics yet; use all known BSSes */
+		dl_list_for_each(bss, &data->bss, struct bgscan_learn_bss,
+				 list)
+			freqs = bgscan_learn_add_freq(freqs, count, bss->freq);
 	}
 
 	return freqs;
 }
 
 
+static int bgscan_learn_need_full_scan(struct bgscan_learn_data *data,
+				       size_t count)
+{
+	struct os_time now;
+
+	if (count == 0)
+		return 1;
+	if (data->scans_since_full + 1 >= BGSCAN_LEARN_FULL_SCAN_EVERY)
+		return 1;
+	if (data->last_scan_missed) {
+		/*
+		 * The previous partial scan did not find the ESS on any of the
+		 * expected channels. Do a full scan, but not more often than
+		 * once per the long scan interval.
+		 */
+		os_get_time(&now);
+		if (now.sec - data->last_full_scan.sec >= data->long_interval)
+			return 1;
+	}
+	return 0;
+}
+
+
 static int * bgscan_learn_get_probe_freq(struct bgscan_learn_data *data,
 					 int *freqs, size_t count)
 {
@@ -288,9 +531,16 @@ static void bgscan_learn_timeout(void *eloop_ctx, void *timeout_ctx)
 		params.freqs = data->ssid->scan_freq;
 	else {
 		freqs = bgscan_learn_get_freqs(data, &count);
-		wpa_printf(MSG_DEBUG, "bgscan learn: BSSes in this ESS have "
-			   "been seen on %u channels", (unsigned int) count);
-		freqs = bgscan_learn_get_probe_freq(data, freqs, count);
+		wpa_printf(MSG_DEBUG, "bgscan learn: BSSes in this ESS are "
+			   "expected on %u channels", (unsigned int) count);
+		if (bgscan_learn_need_full_scan(data, count)) {
+			wpa_printf(MSG_DEBUG, "bgscan learn: Scanning all "
+				   "channels");
+			os_free(freqs);
+			freqs = NULL;
+		} else
+			freqs = bgscan_learn_get_probe_freq(data, freqs,
+							    count);
 
 		msg[0] = '\0';
 		pos = msg;
@@ -313,9 +563,21 @@ static void bgscan_learn_timeout(void *eloop_ctx, void *timeout_ctx)
 		wpa_printf(MSG_DEBUG, "bgscan learn: Failed to trigger scan");
 		eloop_register_timeout(data->scan_interval, 0,
 				       bgscan_learn_timeout, data, NULL);
+		os_free(freqs);
+		return;
+	}
+
+	os_get_time(&data->last_bgscan);
+	os_free(data->scan_freqs);
+	data->scan_freqs = freqs;
+	if (data->ssid->scan_freq)
+		return; /* configured channels; nothing to learn from choice */
+	data->scan_pending = 1;
+	if (params.freqs == NULL) {
+		data->scans_since_full = 0;
+		data->last_full_scan = data->last_bgscan;
 	} else
-		os_get_time(&data->last_bgscan);
-	os_free(freqs);
+		data->scans_since_full++;
 }
 
 
@@ -404,7 +666,9 @@ static void * bgscan_learn_init(struct wpa_supplicant *wpa_s,
 		data->long_interval = 30;
 
 	if (bgscan_learn_load(data) < 0) {
+		bgscan_learn_free_bss(data);
 		os_free(data->fname);
+		os_free(data->chan);
 		os_free(data);
 		return NULL;
 	}
@@ -440,19 +704,16 @@ static void * bgscan_learn_init(struct wpa_supplicant *wpa_s,
 static void bgscan_learn_deinit(void *priv)
 {
 	struct bgscan_learn_data *data = priv;
-	struct bgscan_learn_bss *bss, *n;
 
 	bgscan_learn_save(data);
 	eloop_cancel_timeout(bgscan_learn_timeout, data, NULL);
 	if (data->signal_threshold)
 		wpa_drv_signal_monitor(data->wpa_s, 0, 0);
 	os_free(data->fname);
-	dl_list_for_each_safe(bss, n, &data->bss, struct bgscan_learn_bss,
-			      list) {
-		dl_list_del(&bss->list);
-		bss_free(bss);
-	}
+	bgscan_learn_free_bss(data);
 	os_free(data->supp_freqs);
+	os_free(data->chan);
+	os_free(data->scan_freqs);
 	os_free(data);
 }
 
@@ -474,6 +735,77 @@ static int bgscan_learn_bss_match(struct bgscan_learn_data *data,
 }
 
 
+static int bgscan_learn_chan_hit(struct bgscan_learn_data *data,
+				 struct wpa_scan_results *scan_res, int freq)
+{
+	size_t i;
+
+	for (i = 0; i < scan_res->num; i++) {
+		if (scan_res->res[i]->freq == freq &&
+		    bgscan_learn_bss_match(data, scan_res->res[i]))
+			return 1;
+	}
+	return 0;
+}
+
+
+static void bgscan_learn_chan_scanned(struct bgscan_learn_data *data,
+				      struct wpa_scan_results *scan_res,
+				      int freq, int *hits)
+{
+	struct bgscan_learn_chan *chan;
+	int hit;
+
+	hit = bgscan_learn_chan_hit(data, scan_res, freq);
+	chan = bgscan_learn_get_chan(data, freq, hit);
+	if (chan == NULL)
+		return;
+	chan->weight -= chan->weight / BGSCAN_LEARN_DECAY;
+	if (hit) {
+		chan->weight += BGSCAN_LEARN_HIT;
+		(*hits)++;
+	}
+}
+
+
+static void bgscan_learn_update_chan(struct bgscan_learn_data *data,
+				     struct wpa_scan_results *scan_res)
+{
+	int *freqs = NULL, hits = 0, own = 0;
+	size_t i, count = 0;
+
+	if (data->scan_pending) {
+		/* Channels that were included in our own scan request */
+		freqs = data->scan_freqs ? data->scan_freqs : data->supp_freqs;
+		own = 1;
+	}
+
+	if (freqs == NULL) {
+		/*
+		 * Scan requested by someone else or the supported channels are
+		 * not known; consider the channels from which any results were
+		 * received as scanned.
+		 */
+		for (i = 0; i < scan_res->num; i++)
+			freqs = bgscan_learn_add_freq(freqs, &count,
+						      scan_res->res[i]->freq);
+		own = 0;
+	}
+
+	for (i = 0; freqs && freqs[i]; i++)
+		bgscan_learn_chan_scanned(data, scan_res, freqs[i], &hits);
+
+	if (data->scan_pending) {
+		data->last_scan_missed = data->scan_freqs && hits == 0;
+		data->scan_pending = 0;
+		os_free(data->scan_freqs);
+		data->scan_freqs = NULL;
+	}
+	if (!own)
+		os_free(freqs);
+}
+
+
 static int bgscan_learn_notify_scan(void *priv,
 				    struct wpa_scan_results *scan_res)
 {
@@ -503,6 +835,8 @@ static int bgscan_learn_notify_scan(void *priv,
 	wpa_printf(MSG_DEBUG, "bgscan learn: %u matching BSSes in scan "
 		   "results", (unsigned int) num_bssid);
 
+	bgscan_learn_update_chan(data, scan_res);
+
 	for (i = 0; i < scan_res->num; i++) {
 		struct wpa_scan_res *res = scan_res->res[i];
 		struct bgscan_learn_bss *bss;
@@ -16,8 +16,64 @@
 
 #include "common.h"
 #include "wpa_supplicant_i.h"
+#include "config.h"
 #include "blacklist.h"
 
+static void wpa_blacklist_unlink(struct wpa_supplicant *wpa_s,
+				 struct wpa_blacklist *e)
+{
+	struct wpa_blacklist **pos;
+
+	for (pos = &wpa_s->blacklist; *pos; pos = &(*pos)->next) {
+		if (*pos == e) {
+			*pos = e->next;
+			break;
+		}
+	}
+
+	for (pos = &wpa_s->blacklist_hash[WPA_BLACKLIST_HASH(e->bssid)]; *pos;
+	     pos = &(*pos)->hnext) {
+		if (*pos == e) {
+			*pos = e->hnext;
+			break;
+		}
+	}
+
+	wpa_s->num_blacklist--;
+}
+
+
+/*
+ * Apply the failure count decay to an entry. Returns 1 if the count reached
+ * zero and the entry was removed.
+ */
+static int wpa_blacklist_decay(struct wpa_supplicant *wpa_s,
+			       struct wpa_blacklist *e, struct os_time *now)
+{
+	unsigned int decay = wpa_s->conf->blacklist_decay;
+	os_time_t steps;
+
+	if (e->permanent || decay == 0)
+		return 0;
+
+	steps = (now->sec - e->last_update.sec) / decay;
+	if (steps <= 0)
+		return 0;
+
+	if (steps >= e->count) {
+		wpa_printf(MSG_DEBUG, "Removed BSSID " MACSTR " from "
+			   "blacklist (decayed)", MAC2STR(e->bssid));
+		wpa_blacklist_unlink(wpa_s, e);
+		os_free(e);
+		return 1;
+	}
+
+	e->count -= steps;
+	e->last_update.sec += steps * decay;
+	return 0;
+}
+
+
 /**
  * wpa_blacklist_get - Get the blacklist entry for a BSSID
  * @wpa_s: Pointer to wpa_supplicant data
@@ -28,18 +84,63 @@ struct wpa_blacklist * wpa_blacklist_get(struct wpa_supplicant *wpa_s,
 					 const u8 *bssid)
 {
 	struct wpa_blacklist *e;
+	struct os_time now;
 
-	e = wpa_s->blacklist;
+	if (wpa_s->num_blacklist == 0)
+		return NULL;
+
+	e = wpa_s->blacklist_hash[WPA_BLACKLIST_HASH(bssid)];
 	while (e) {
-		if (os_memcmp(e->bssid, bssid, ETH_ALEN) == 0)
+		if (os_memcmp(e->bssid, bssid, ETH_ALEN) == 0) {
+			os_get_time(&now);
+			if (wpa_blacklist_decay(wpa_s, e, &now))
+				return NULL;
 			return e;
-		e = e->next;
+		}
+		e = e->hnext;
 	}
 
 	return NULL;
 }
 
 
+/**
+ * wpa_blacklist_expire - Remove entries whose failure count has decayed
+ * @wpa_s: Pointer to wpa_supplicant data
+ */
+void wpa_blacklist_expire(struct wpa_supplicant *wpa_s)
+{
+	struct wpa_blacklist *e, *next;
+	struct os_time now;
+
+	os_get_time(&now);
+	for (e = wpa_s->blacklist; e; e = next) {
+		next = e->next;
+		wpa_blacklist_decay(wpa_s, e, &now);
+	}
+}
+
+
+static void wpa_blacklist_remove_oldest(struct wpa_supplicant *wpa_s)
+{
+	struct wpa_blacklist *e, *oldest = NULL;
+
+	/* The list is ordered by the last failure; find the last entry */
+	for (e = wpa_s->blacklist; e; e = e->next) {
+		if (!e->permanent)
+			oldest = e;
+	}
+
+	if (oldest == NULL)
+		return;
+
+	wpa_printf(MSG_DEBUG, "Removed BSSID " MACSTR " from blacklist "
+		   "(size limit)", MAC2STR(oldest->bssid));
+	wpa_blacklist_unlink(wpa_s, oldest);
+	os_free(oldest);
+}
+
+
 /**
  * wpa_blacklist_add - Add an BSSID to the blacklist
  * @wpa_s: Pointer to wpa_supplicant data
@@ -55,6 +156,10 @@ struct wpa_blacklist * wpa_blacklist_get(struct wpa_supplicant *wpa_s,
  * BSSes before retrying to associate with an BSS that rejected or timed out
  * association. It does not prevent the listed BSS from being used; it only
  * changes the order in which they are tried.
+ *
+ * The count decreases by one for each blacklist_decay seconds without a new
+ * failure and at most blacklist_max entries are kept. When the limit is
+ * reached, the entry with the oldest failure is removed.
  */
 int wpa_blacklist_add(struct wpa_supplicant *wpa_s, const u8 *bssid)
 {
@@ -63,22 +168,47 @@ int wpa_blacklist_add(struct wpa_supplicant *wpa_s, const u8 *bssid)
 	e = wpa_blacklist_get(wpa_s, bssid);
 	if (e) {
 		e->count++;
+		os_get_time(&e->last_update);
+		if (wpa_s->blacklist != e) {
+			/* Move to the head of the list */
+			wpa_blacklist_unlink(wpa_s, e);
+			goto link;
+		}
 		wpa_printf(MSG_DEBUG, "BSSID " MACSTR " blacklist count "
 			   "incremented to %d",
 			   MAC2STR(bssid), e->count);
 		return e->count;
 	}
 
+	wpa_blacklist_expire(wpa_s);
+	while (wpa_s->conf->blacklist_max &&
+	       wpa_s->num_blacklist >= wpa_s->conf->blacklist_max) {
+		unsigned int num = wpa_s->num_blacklist;
+		wpa_blacklist_remove_oldest(wpa_s);
+		if (wpa_s->num_blacklist == num)
+			break;
+	}
+
 	e = os_zalloc(sizeof(*e));
 	if (e == NULL)
 		return -1;
 	os_memcpy(e->bssid, bssid, ETH_ALEN);
 	e->count = 1;
-	e->next = wpa_s->blacklist;
-	wpa_s->blacklist = e;
+	os_get_time(&e->last_update);
 	wpa_printf(MSG_DEBUG, "Added BSSID " MACSTR " into blacklist",
 		   MAC2STR(bssid));
 
+link:
+	e->next = wpa_s->blacklist;
+	wpa_s->blacklist = e;
+	e->hnext = wpa_s->blacklist_hash[WPA_BLACKLIST_HASH(bssid)];
+	wpa_s->blacklist_hash[WPA_BLACKLIST_HASH(bssid)] = e;
+	wpa_s->num_blacklist++;
+	if (e->count > 1)
+		wpa_printf(MSG_DEBUG, "BSSID " MACSTR " blacklist count "
+			   "incremented to %d",
+			   MAC2STR(bssid), e->count);
+
 	return e->count;
 }
 
@@ -91,23 +221,18 @@ int wpa_blacklist_add(struct wpa_supplicant *wpa_s, const u8 *bssid)
  */
 int wpa_blacklist_del(struct wpa_supplicant *wpa_s, const u8 *bssid)
 {
-	struct wpa_blacklist *e, *prev = NULL;
+	struct wpa_blacklist *e;
 
-	e = wpa_s->blacklist;
+	e = wpa_s->blacklist_hash[WPA_BLACKLIST_HASH(bssid)];
 	while (e) {
 		if (os_memcmp(e->bssid, bssid, ETH_ALEN) == 0) {
-			if (prev == NULL) {
-				wpa_s->blacklist = e->next;
-			} else {
-				prev->next = e->next;
-			}
+			wpa_blacklist_unlink(wpa_s, e);
 			wpa_printf(MSG_DEBUG, "Removed BSSID " MACSTR " from "
 				   "blacklist", MAC2STR(bssid));
 			os_free(e);
 			return 0;
 		}
-		prev = e;
-		e = e->next;
+		e = e->hnext;
 	}
 	return -1;
 }
@@ -123,6 +248,8 @@ void wpa_blacklist_clear(struct wpa_supplicant *wpa_s)
 
 	e = wpa_s->blacklist;
 	wpa_s->blacklist = NULL;
+	os_memset(wpa_s->blacklist_hash, 0, sizeof(wpa_s->blacklist_hash));
+	wpa_s->num_blacklist = 0;
 	while (e) {
 		prev = e;
 		e = e->next;
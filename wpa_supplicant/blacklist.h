@@ -15,10 +15,28 @@
 #ifndef BLACKLIST_H
 #define BLACKLIST_H
 
+#define WPA_BLACKLIST_HASH(bssid) (((bssid)[4] ^ (bssid)[5]) & \
+				   (WPA_BLACKLIST_HASH_SIZE - 1))
+
+/**
+ * struct wpa_blacklist - Blacklist entry
+ * @next: Next entry in struct wpa_supplicant::blacklist; most recently failed
+ *	entries first
+ * @hnext: Next entry in the same struct wpa_supplicant::blacklist_hash bucket
+ * @bssid: BSSID
+ * @count: Number of failures; decreases by one for each blacklist_decay
+ *	seconds without a new failure and the entry is removed at zero
+ * @last_update: Time of the last failure or decay step
+ * @permanent: Whether the entry was added explicitly over the control
+ *	interface and does not decay
+ */
 struct wpa_blacklist {
 	struct wpa_blacklist *next;
+	struct wpa_blacklist *hnext;
 	u8 bssid[ETH_ALEN];
 	int count;
+	struct os_time last_update;
+	int permanent;
 };
 
 struct wpa_blacklist * wpa_blacklist_get(struct wpa_supplicant *wpa_s,
@@ -26,5 +44,6 @@ struct wpa_blacklist * wpa_blacklist_get(struct wpa_supplicant *wpa_s,
 int wpa_blacklist_add(struct wpa_supplicant *wpa_s, const u8 *bssid);
 int wpa_blacklist_del(struct wpa_supplicant *wpa_s, const u8 *bssid);
 void wpa_blacklist_clear(struct wpa_supplicant *wpa_s);
+void wpa_blacklist_expire(struct wpa_supplicant *wpa_s);
 
 #endif /* BLACKLIST_H */
@@ -46,6 +46,7 @@ static void wpa_bss_remove(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
 	dl_list_del(&bss->list);
 	dl_list_del(&bss->list_id);
 	wpa_s->num_bss--;
+	wpa_s->bss_mem -= wpa_bss_mem_size(bss);
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Remove id %u BSSID " MACSTR
 		" SSID '%s'", bss->id, MAC2STR(bss->bssid),
 		wpa_ssid_txt(bss->ssid, bss->ssid_len));
@@ -118,36 +119,74 @@ static int wpa_bss_known(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
 }
 
 
-static int wpa_bss_remove_oldest_unknown(struct wpa_supplicant *wpa_s)
+static int wpa_bss_in_use(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
 {
-	struct wpa_bss *bss;
+	return bss == wpa_s->current_bss ||
+		os_memcmp(bss->bssid, wpa_s->bssid, ETH_ALEN) == 0 ||
+		os_memcmp(bss->bssid, wpa_s->pending_bssid, ETH_ALEN) == 0;
+}
+
 
+static int wpa_bss_remove_oldest(struct wpa_supplicant *wpa_s)
+{
+	struct wpa_bss *bss, *oldest = NULL;
+
+	/*
+	 * Remove the oldest entry that is not in use and does not match with
+	 * any configured network. If there is no such entry, remove the oldest
+	 * entry that is not in use.
+	 */
 	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+		if (wpa_bss_in_use(wpa_s, bss))
+			continue;
 		if (!wpa_bss_known(wpa_s, bss)) {
-			wpa_bss_remove(wpa_s, bss);
-			return 0;
+			oldest = bss;
+			break;
 		}
+		if (oldest == NULL)
+			oldest = bss;
 	}
 
-	return -1;
+	if (oldest == NULL)
+		return -1;
+
+	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Evict id %u to limit BSS table size "
+		"(%u entries, %u octets)", oldest->id,
+		(unsigned int) wpa_s->num_bss, (unsigned int) wpa_s->bss_mem);
+	wpa_bss_remove(wpa_s, oldest);
+	return 0;
 }
 
 
-static void wpa_bss_remove_oldest(struct wpa_supplicant *wpa_s)
+static void wpa_bss_check_limits(struct wpa_supplicant *wpa_s)
 {
-	/*
-	 * Remove the oldest entry that does not match with any configured
-	 * network.
-	 */
-	if (wpa_bss_remove_oldest_unknown(wpa_s) == 0)
-		return;
+	struct wpa_config *conf = wpa_s->conf;
 
-	/*
-	 * Remove the oldest entry since no better candidate for removal was
-	 * found.
-	 */
-	wpa_bss_remove(wpa_s, dl_list_first(&wpa_s->bss,
-					    struct wpa_bss, list));
+	while (wpa_s->num_bss > conf->bss_max_count ||
+	       (conf->bss_max_mem && wpa_s->bss_mem > conf->bss_max_mem)) {
+		if (wpa_bss_remove_oldest(wpa_s) < 0)
+			break;
+	}
+}
+
+
+/*
+ * Keep struct wpa_supplicant::bss ordered by last_update so that expiration
+ * can stop at the first entry that is recent enough. Entries are normally
+ * updated with the current time, so the search from the tail ends quickly.
+ */
+static void wpa_bss_insert_by_age(struct wpa_supplicant *wpa_s,
+				  struct wpa_bss *bss)
+{
+	struct dl_list *pos = wpa_s->bss.prev;
+
+	while (pos != &wpa_s->bss) {
+		struct wpa_bss *prev = dl_list_entry(pos, struct wpa_bss, list);
+		if (!os_time_before(&bss->last_update, &prev->last_update))
+			break;
+		pos = pos->prev;
+	}
+	dl_list_add(pos, &bss->list);
 }
 
 
@@ -165,19 +204,18 @@ static void wpa_bss_add(struct wpa_supplicant *wpa_s,
 	wpa_bss_copy_res(bss, res);
 	os_memcpy(bss->ssid, ssid, ssid_len);
 	bss->ssid_len = ssid_len;
-	bss->ie_len = res->ie_len;
-	bss->beacon_ie_len = res->beacon_ie_len;
-	os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
+	wpa_bss_copy_ies(bss, res);
+	bss->ie_buf_len = res->ie_len + res->beacon_ie_len;
 
-	dl_list_add_tail(&wpa_s->bss, &bss->list);
+	wpa_bss_insert_by_age(wpa_s, bss);
 	dl_list_add_tail(&wpa_s->bss_id, &bss->list_id);
 	wpa_s->num_bss++;
+	wpa_s->bss_mem += wpa_bss_mem_size(bss);
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Add new id %u BSSID " MACSTR
 		" SSID '%s'",
 		bss->id, MAC2STR(bss->bssid), wpa_ssid_txt(ssid, ssid_len));
 	wpas_notify_bss_added(wpa_s, bss->bssid, bss->id);
-	if (wpa_s->num_bss > wpa_s->conf->bss_max_count)
-		wpa_bss_remove_oldest(wpa_s);
+	wpa_bss_check_limits(wpa_s);
 }
 
 
@@ -318,13 +356,10 @@ static void wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	bss->scan_miss_count = 0;
 	bss->last_update_idx = wpa_s->bss_update_idx;
 	wpa_bss_copy_res(bss, res);
-	/* Move the entry to the end of the list */
+	/* Move the entry to its new position in the expiration order */
 	dl_list_del(&bss->list);
-	if (bss->ie_len + bss->beacon_ie_len >=
-	    res->ie_len + res->beacon_ie_len) {
-		os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
-		bss->ie_len = res->ie_len;
-		bss->beacon_ie_len = res->beacon_ie_len;
+	if (bss->ie_buf_len >= res->ie_len + res->beacon_ie_len) {
+		wpa_bss_copy_ies(bss, res);
 	} else {
 		struct wpa_bss *nbss;
 		struct dl_list *prev = bss->list_id.prev;
@@ -333,24 +368,17 @@ static void wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 				  res->beacon_ie_len);
 		if (nbss) {
 			bss = nbss;
-			os_memcpy(bss + 1, res + 1,
-				  res->ie_len + res->beacon_ie_len);
-			bss->ie_len = res->ie_len;
-			bss->beacon_ie_len = res->beacon_ie_len;
+			wpa_s->bss_mem -= wpa_bss_mem_size(bss);
+			wpa_bss_copy_ies(bss, res);
+			bss->ie_buf_len = res->ie_len + res->beacon_ie_len;
+			wpa_s->bss_mem += wpa_bss_mem_size(bss);
 		}
 		dl_list_add(prev, &bss->list_id);
 	}
-	dl_list_add_tail(&wpa_s->bss, &bss->list);
+	wpa_bss_insert_by_age(wpa_s, bss);
 
 	notify_bss_changes(wpa_s, changes, bss);
-}
-
-
-static int wpa_bss_in_use(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
-{
-	return bss == wpa_s->current_bss ||
-		os_memcmp(bss->bssid, wpa_s->bssid, ETH_ALEN) == 0 ||
-		os_memcmp(bss->bssid, wpa_s->pending_bssid, ETH_ALEN) == 0;
+	wpa_bss_check_limits(wpa_s);
 }
 
 
@@ -551,45 +579,6 @@ struct wpa_bss * wpa_bss_get_id(struct wpa_supplicant *wpa_s, unsigned int id)
 }
 
 
-const u8 * wpa_bss_get_ie(const struct wpa_bss *bss, u8 ie)
-{
-	const u8 *end, *pos;
-
-	pos = (const u8 *) (bss + 1);
-	end = pos + bss->ie_len;
-
-	while (pos + 1 < end) {
-		if (pos + 2 + pos[1] > end)
-			break;
-		if (pos[0] == ie)
-			return pos;
-		pos += 2 + pos[1];
-	}
-
-	return NULL;
-}
-
-
-const u8 * wpa_bss_get_vendor_ie(const struct wpa_bss *bss, u32 vendor_type)
-{
-	const u8 *end, *pos;
-
-	pos = (const u8 *) (bss + 1);
-	end = pos + bss->ie_len;
-
-	while (pos + 1 < end) {
-		if (pos + 2 + pos[1] > end)
-			break;
-		if (pos[0] == WLAN_EID_VENDOR_SPECIFIC && pos[1] >= 4 &&
-		    vendor_type == WPA_GET_BE32(&pos[2]))
-			return pos;
-		pos += 2 + pos[1];
-	}
-
-	return NULL;
-}
-
-
 struct wpabuf * wpa_bss_get_vendor_ie_multi(const struct wpa_bss *bss,
 					    u32 vendor_type)
 {
@@ -15,6 +15,8 @@
 #ifndef BSS_H
 #define BSS_H
 
+#include "common/ieee802_11_common.h"
+
 struct wpa_scan_res;
 
 #define WPA_BSS_QUAL_INVALID		BIT(0)
@@ -44,6 +46,8 @@ struct wpa_scan_res;
  * @last_update: Time of the last update (i.e., Beacon or Probe Response RX)
  * @ie_len: length of the following IE field in octets (from Probe Response)
  * @beacon_ie_len: length of the following Beacon IE field in octets
+ * @ie_index: index of commonly used IEs within the first IE field
+ * @ie_buf_len: number of octets allocated for IEs after this structure
  *
  * This structure is used to store information about neighboring BSSes in
  * generic format. It is mainly updated based on scan results from the driver.
@@ -77,6 +81,8 @@ struct wpa_bss {
 #endif /* CONFIG_INTERWORKING */
 	size_t ie_len;
 	size_t beacon_ie_len;
+	struct ieee802_11_ie_index ie_index;
+	size_t ie_buf_len;
 	/* followed by ie_len octets of IEs */
 	/* followed by beacon_ie_len octets of IEs */
 };
@@ -97,9 +103,15 @@ struct wpa_bss * wpa_bss_get_bssid(struct wpa_supplicant *wpa_s,
 struct wpa_bss * wpa_bss_get_id(struct wpa_supplicant *wpa_s, unsigned int id);
 const u8 * wpa_bss_get_ie(const struct wpa_bss *bss, u8 ie);
 const u8 * wpa_bss_get_vendor_ie(const struct wpa_bss *bss, u32 vendor_type);
+void wpa_bss_copy_ies(struct wpa_bss *bss, const struct wpa_scan_res *res);
 struct wpabuf * wpa_bss_get_vendor_ie_multi(const struct wpa_bss *bss,
 					    u32 vendor_type);
 int wpa_bss_get_max_rate(const struct wpa_bss *bss);
 int wpa_bss_get_bit_rates(const struct wpa_bss *bss, u8 **rates);
 
+static inline size_t wpa_bss_mem_size(const struct wpa_bss *bss)
+{
+	return sizeof(*bss) + bss->ie_buf_len;
+}
+
 #endif /* BSS_H */
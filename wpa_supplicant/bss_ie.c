@@ -0,0 +1,142 @@
+/*
+ * IE lookup for scan results and BSS table entries
+ * Copyright (c) 2003-2010, Jouni Malinen <j@w1.fi>
+ * Copyright (c) 2026, The hostap project contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Alternatively, this software may be distributed under the terms of BSD
+ * license.
+ *
+ * See README and COPYING for more details.
+ *
+ * These helpers depend only on the IE buffers and the IE index so that they
+ * can also be used by the test programs.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "common/ieee802_11_defs.h"
+#include "common/ieee802_11_common.h"
+#include "drivers/driver.h"
+#include "wpa_supplicant_i.h"
+#include "scan.h"
+#include "bss.h"
+
+
+const u8 * wpa_scan_get_ie(const struct wpa_scan_res *res, u8 ie)
+{
+	const u8 *end, *pos;
+	int slot;
+
+	pos = (const u8 *) (res + 1);
+	end = pos + res->ie_len;
+
+	if (res->ie_index.valid && (slot = ieee802_11_ie_slot(ie)) >= 0)
+		return ieee802_11_ie_index_get(&res->ie_index, pos, slot);
+
+	while (pos + 1 < end) {
+		if (pos + 2 + pos[1] > end)
+			break;
+		if (pos[0] == ie)
+			return pos;
+		pos += 2 + pos[1];
+	}
+
+	return NULL;
+}
+
+
+
+const u8 * wpa_scan_get_vendor_ie(const struct wpa_scan_res *res,
+				  u32 vendor_type)
+{
+	const u8 *end, *pos;
+	int slot;
+
+	pos = (const u8 *) (res + 1);
+	end = pos + res->ie_len;
+
+	if (res->ie_index.valid &&
+	    (slot = ieee802_11_vendor_ie_slot(vendor_type)) >= 0)
+		return ieee802_11_ie_index_get(&res->ie_index, pos, slot);
+
+	while (pos + 1 < end) {
+		if (pos + 2 + pos[1] > end)
+			break;
+		if (pos[0] == WLAN_EID_VENDOR_SPECIFIC && pos[1] >= 4 &&
+		    vendor_type == WPA_GET_BE32(&pos[2]))
+			return pos;
+		pos += 2 + pos[1];
+	}
+
+	return NULL;
+}
+
+
+
+void wpa_bss_copy_ies(struct wpa_bss *bss, const struct wpa_scan_res *res)
+{
+	os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
+	bss->ie_len = res->ie_len;
+	bss->beacon_ie_len = res->beacon_ie_len;
+	/* The IEs are copied as-is, so the offsets in the index remain valid */
+	if (res->ie_index.valid)
+		bss->ie_index = res->ie_index;
+	else
+		ieee802_11_ie_index_build(&bss->ie_index,
+					  (const u8 *) (bss + 1), bss->ie_len);
+}
+
+
+
+const u8 * wpa_bss_get_ie(const struct wpa_bss *bss, u8 ie)
+{
+	const u8 *end, *pos;
+	int slot;
+
+	pos = (const u8 *) (bss + 1);
+	end = pos + bss->ie_len;
+
+	if (bss->ie_index.valid && (slot = ieee802_11_ie_slot(ie)) >= 0)
+		return ieee802_11_ie_index_get(&bss->ie_index, pos, slot);
+
+	while (pos + 1 < end) {
+		if (pos + 2 + pos[1] > end)
+			break;
+		if (pos[0] == ie)
+			return pos;
+		pos += 2 + pos[1];
+	}
+
+	return NULL;
+}
+
+
+
+const u8 * wpa_bss_get_vendor_ie(const struct wpa_bss *bss, u32 vendor_type)
+{
+	const u8 *end, *pos;
+	int slot;
+
+	pos = (const u8 *) (bss + 1);
+	end = pos + bss->ie_len;
+
+	if (bss->ie_index.valid &&
+	    (slot = ieee802_11_vendor_ie_slot(vendor_type)) >= 0)
+		return ieee802_11_ie_index_get(&bss->ie_index, pos, slot);
+
+	while (pos + 1 < end) {
+		if (pos + 2 + pos[1] > end)
+			break;
+		if (pos[0] == WLAN_EID_VENDOR_SPECIFIC && pos[1] >= 4 &&
+		    vendor_type == WPA_GET_BE32(&pos[2]))
+			return pos;
+		pos += 2 + pos[1];
+	}
+
+	return NULL;
+}
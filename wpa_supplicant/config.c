@@ -2196,10 +2196,15 @@ struct wpa_config * wpa_config_alloc_empty(const char *ctrl_interface,
 	config->fast_reauth = DEFAULT_FAST_REAUTH;
 	config->p2p_go_intent = DEFAULT_P2P_GO_INTENT;
 	config->p2p_intra_bss = DEFAULT_P2P_INTRA_BSS;
+	config->p2p_max_peers = DEFAULT_P2P_MAX_PEERS;
 	config->bss_max_count = DEFAULT_BSS_MAX_COUNT;
 	config->bss_expiration_age = DEFAULT_BSS_EXPIRATION_AGE;
 	config->bss_expiration_scan_count = DEFAULT_BSS_EXPIRATION_SCAN_COUNT;
 	config->max_num_sta = DEFAULT_MAX_NUM_STA;
+	config->blacklist_max = DEFAULT_BLACKLIST_MAX;
+	config->blacklist_decay = DEFAULT_BLACKLIST_DECAY;
+	config->fast_connect_age = DEFAULT_FAST_CONNECT_AGE;
+	config->conn_timeline_max = DEFAULT_CONN_TIMELINE_MAX;
 	config->access_network_type = DEFAULT_ACCESS_NETWORK_TYPE;
 
 	if (ctrl_interface)
@@ -2480,11 +2485,17 @@ static const struct global_parse_data global_fields[] = {
 	{ INT_RANGE(persistent_reconnect, 0, 1), 0 },
 	{ INT_RANGE(p2p_intra_bss, 0, 1), CFG_CHANGED_P2P_INTRA_BSS },
 	{ INT(p2p_group_idle), 0 },
+	{ INT_RANGE(p2p_max_peers, 1, 10000), CFG_CHANGED_P2P_MAX_PEERS },
 #endif /* CONFIG_P2P */
 	{ FUNC(country), CFG_CHANGED_COUNTRY },
 	{ INT(bss_max_count), 0 },
+	{ INT(bss_max_mem), 0 },
 	{ INT(bss_expiration_age), 0 },
 	{ INT(bss_expiration_scan_count), 0 },
+	{ INT(blacklist_max), 0 },
+	{ INT(blacklist_decay), 0 },
+	{ INT(fast_connect_age), 0 },
+	{ INT_RANGE(conn_timeline_max, 0, 1000), 0 },
 	{ INT_RANGE(filter_ssids, 0, 1), 0 },
 	{ INT(max_num_sta), 0 },
 	{ INT_RANGE(disassoc_low_ack, 0, 1), 0 },
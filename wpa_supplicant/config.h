@@ -24,10 +24,15 @@
 #define DEFAULT_FAST_REAUTH 1
 #define DEFAULT_P2P_GO_INTENT 7
 #define DEFAULT_P2P_INTRA_BSS 1
+#define DEFAULT_P2P_MAX_PEERS 100
 #define DEFAULT_BSS_MAX_COUNT 200
 #define DEFAULT_BSS_EXPIRATION_AGE 180
 #define DEFAULT_BSS_EXPIRATION_SCAN_COUNT 2
 #define DEFAULT_MAX_NUM_STA 128
+#define DEFAULT_BLACKLIST_MAX 128
+#define DEFAULT_BLACKLIST_DECAY 120
+#define DEFAULT_FAST_CONNECT_AGE 0
+#define DEFAULT_CONN_TIMELINE_MAX 8
 #define DEFAULT_ACCESS_NETWORK_TYPE 15
 
 #include "config_ssid.h"
@@ -47,6 +52,7 @@
 #define CFG_CHANGED_VENDOR_EXTENSION BIT(10)
 #define CFG_CHANGED_P2P_LISTEN_CHANNEL BIT(11)
 #define CFG_CHANGED_P2P_OPER_CHANNEL BIT(12)
+#define CFG_CHANGED_P2P_MAX_PEERS BIT(13)
 
 /**
  * struct wpa_config - wpa_supplicant configuration data
@@ -381,11 +387,29 @@ struct wpa_config {
 	 */
 	unsigned int p2p_group_idle;
 
+	/**
+	 * p2p_max_peers - Maximum number of P2P peers to remember
+	 *
+	 * When more peers are discovered, the least recently seen entries are
+	 * removed to make room for the new ones.
+	 */
+	unsigned int p2p_max_peers;
+
 	/**
 	 * bss_max_count - Maximum number of BSS entries to keep in memory
 	 */
 	unsigned int bss_max_count;
 
+	/**
+	 * bss_max_mem - Maximum memory in octets to use for BSS entries
+	 *
+	 * This limits the total size of the BSS table including the IEs of
+	 * each entry. Entries that are not in use and do not match any
+	 * configured network are removed first when the limit is exceeded.
+	 * 0 = no limit other than bss_max_count.
+	 */
+	unsigned int bss_max_mem;
+
 	/**
 	 * bss_expiration_age - BSS entry age after which it can be expired
 	 *
@@ -405,6 +429,47 @@ struct wpa_config {
 	 */
 	unsigned int bss_expiration_scan_count;
 
+	/**
+	 * blacklist_max - Maximum number of BSSIDs in the blacklist
+	 *
+	 * When the limit is reached, the entry with the oldest failure is
+	 * removed. Entries added with the BLACKLIST control interface command
+	 * are not removed. 0 = no limit.
+	 */
+	unsigned int blacklist_max;
+
+	/**
+	 * blacklist_decay - Blacklist failure count decay interval
+	 *
+	 * The failure count of a blacklisted BSSID is decremented by one for
+	 * each blacklist_decay seconds without a new failure and the BSSID is
+	 * removed from the blacklist when the count reaches zero. 0 = entries
+	 * do not decay.
+	 */
+	unsigned int blacklist_decay;
+
+	/**
+	 * fast_connect_age - Maximum age of BSS entries used for fast connect
+	 *
+	 * When a connection is needed, association can be started based on
+	 * BSS table entries that are not older than this many seconds
+	 * instead of waiting for a new scan. If only older entries match an
+	 * enabled network, the scan is limited to the channel of the
+	 * selected BSS. This is done once per disconnection and a full scan
+	 * is used if it fails. 0 = disabled.
+	 */
+	unsigned int fast_connect_age;
+
+	/**
+	 * conn_timeline_max - Number of connection attempts to record
+	 *
+	 * The timing of each step of the most recent connection attempts is
+	 * kept for the CONN-TIMELINE control interface command and the D-Bus
+	 * ConnectionTimeline property. 0 = do not keep records of completed
+	 * attempts; CTRL-EVENT-CONNECT-TIME is still reported.
+	 */
+	unsigned int conn_timeline_max;
+
 	/**
 	 * filter_ssids - SSID-based scan result filtering
 	 *
@@ -683,6 +683,8 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 		fprintf(f, "p2p_intra_bss=%u\n", config->p2p_intra_bss);
 	if (config->p2p_group_idle)
 		fprintf(f, "p2p_group_idle=%u\n", config->p2p_group_idle);
+	if (config->p2p_max_peers != DEFAULT_P2P_MAX_PEERS)
+		fprintf(f, "p2p_max_peers=%u\n", config->p2p_max_peers);
 #endif /* CONFIG_P2P */
 	if (config->country[0] && config->country[1]) {
 		fprintf(f, "country=%c%c\n",
@@ -690,6 +692,8 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 	}
 	if (config->bss_max_count != DEFAULT_BSS_MAX_COUNT)
 		fprintf(f, "bss_max_count=%u\n", config->bss_max_count);
+	if (config->bss_max_mem)
+		fprintf(f, "bss_max_mem=%u\n", config->bss_max_mem);
 	if (config->bss_expiration_age != DEFAULT_BSS_EXPIRATION_AGE)
 		fprintf(f, "bss_expiration_age=%u\n",
 			config->bss_expiration_age);
@@ -697,6 +701,15 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 	    DEFAULT_BSS_EXPIRATION_SCAN_COUNT)
 		fprintf(f, "bss_expiration_scan_count=%u\n",
 			config->bss_expiration_scan_count);
+	if (config->blacklist_max != DEFAULT_BLACKLIST_MAX)
+		fprintf(f, "blacklist_max=%u\n", config->blacklist_max);
+	if (config->blacklist_decay != DEFAULT_BLACKLIST_DECAY)
+		fprintf(f, "blacklist_decay=%u\n", config->blacklist_decay);
+	if (config->fast_connect_age != DEFAULT_FAST_CONNECT_AGE)
+		fprintf(f, "fast_connect_age=%u\n", config->fast_connect_age);
+	if (config->conn_timeline_max != DEFAULT_CONN_TIMELINE_MAX)
+		fprintf(f, "conn_timeline_max=%u\n",
+			config->conn_timeline_max);
 	if (config->filter_ssids)
 		fprintf(f, "filter_ssids=%d\n", config->filter_ssids);
 	if (config->max_num_sta != DEFAULT_MAX_NUM_STA)
@@ -0,0 +1,430 @@
+/*
+ * wpa_supplicant - Connection setup timeline
+ * Copyright (c) 2026, The hostap project contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Alternatively, this software may be distributed under the terms of BSD
+ * license.
+ *
+ * See README and COPYING for more details.
+ *
+ * This file records the time used for each step of a connection attempt
+ * (scan, authentication, association, EAP, and key handshakes) for the last
+ * conn_timeline_max attempts. The records are available through the
+ * CONN-TIMELINE control interface command and the D-Bus interface. The
+ * CTRL-EVENT-CONNECT-TIME event is generated from the record when the
+ * connection is completed.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "common/wpa_ctrl.h"
+#include "config.h"
+#include "wpa_supplicant_i.h"
+#include "conn_timeline.h"
+
+
+static unsigned int conn_tl_ms(const struct conn_timeline *tl)
+{
+	struct os_time now, diff;
+
+	os_get_reltime(&now);
+	if (os_time_before(&now, &tl->start))
+		return 0;
+	os_time_sub(&now, &tl->start, &diff);
+	return diff.sec * 1000 + diff.usec / 1000;
+}
+
+
+static unsigned int conn_tl_add(struct conn_timeline *tl,
+				enum conn_tl_event event, int value)
+{
+	struct conn_tl_entry *e;
+
+	if (tl->num_events == CONN_TL_MAX_EVENTS) {
+		/* Keep the last slot for the most recent event */
+		tl->dropped_events++;
+		e = &tl->events[CONN_TL_MAX_EVENTS - 1];
+	} else
+		e = &tl->events[tl->num_events++];
+	e->ms = conn_tl_ms(tl);
+	e->event = event;
+	e->value = value;
+	return e->ms;
+}
+
+
+static void conn_tl_free(struct wpa_supplicant *wpa_s,
+			 struct conn_timeline *tl)
+{
+	if (wpa_s->conn_tl_cur == tl)
+		wpa_s->conn_tl_cur = NULL;
+	dl_list_del(&tl->list);
+	wpa_s->num_conn_tl--;
+	os_free(tl);
+}
+
+
+static struct conn_timeline * conn_tl_start(struct wpa_supplicant *wpa_s)
+{
+	struct conn_timeline *tl;
+	unsigned int i;
+
+	while (wpa_s->num_conn_tl > 0 &&
+	       wpa_s->num_conn_tl >= wpa_s->conf->conn_timeline_max) {
+		tl = dl_list_first(&wpa_s->conn_tl, struct conn_timeline,
+				   list);
+		conn_tl_free(wpa_s, tl);
+	}
+
+	tl = os_zalloc(sizeof(*tl));
+	if (tl == NULL)
+		return NULL;
+	tl->id = wpa_s->conn_tl_next_id++;
+	for (i = 0; i <= WPA_COMPLETED; i++) {
+		tl->state_first[i] = -1;
+		tl->state_last[i] = -1;
+	}
+	os_get_reltime(&tl->start);
+	os_get_time(&tl->start_wall);
+	dl_list_add_tail(&wpa_s->conn_tl, &tl->list);
+	wpa_s->num_conn_tl++;
+	wpa_s->conn_tl_cur = tl;
+
+	return tl;
+}
+
+
+static unsigned int conn_tl_diff(int start, int end)
+{
+	return start < 0 || end < start ? 0 : end - start;
+}
+
+
+/*
+ * Report the time used for each phase of the final (successful) attempt to
+ * connect: from the start to authentication, authentication, association,
+ * and the handshakes until the data path was opened.
+ */
+static void conn_tl_connect_time(struct wpa_supplicant *wpa_s,
+				 const struct conn_timeline *tl)
+{
+	int auth, assoc, associated;
+
+	assoc = tl->state_last[WPA_ASSOCIATING];
+	auth = tl->state_last[WPA_AUTHENTICATING];
+	if (auth < 0 || auth > assoc)
+		auth = assoc; /* association without SME authentication */
+	associated = tl->state_last[WPA_ASSOCIATED];
+
+	wpa_msg(wpa_s, MSG_INFO, WPA_EVENT_CONNECT_TIME MACSTR
+		" scan=%u auth=%u assoc=%u handshake=%u total=%u "
+		"fast=%d pmksa=%d",
+		MAC2STR(tl->bssid), conn_tl_diff(0, auth),
+		conn_tl_diff(auth, assoc), conn_tl_diff(assoc, associated),
+		conn_tl_diff(associated, tl->total), tl->total,
+		tl->fast_connect, tl->pmksa);
+}
+
+
+static void conn_tl_end(struct wpa_supplicant *wpa_s, int success)
+{
+	struct conn_timeline *tl = wpa_s->conn_tl_cur;
+
+	tl->result = success ? CONN_TL_COMPLETED : CONN_TL_FAILED;
+	tl->total = conn_tl_ms(tl);
+	eapol_sm_get_timing(wpa_s->eapol, &tl->eap);
+	wpa_s->conn_tl_cur = NULL;
+	if (success)
+		conn_tl_connect_time(wpa_s, tl);
+	if (wpa_s->conf->conn_timeline_max == 0)
+		conn_tl_free(wpa_s, tl);
+}
+
+
+/**
+ * conn_timeline_init - Initialize connection timeline
+ * @wpa_s: Pointer to wpa_supplicant data
+ */
+void conn_timeline_init(struct wpa_supplicant *wpa_s)
+{
+	dl_list_init(&wpa_s->conn_tl);
+	wpa_s->conn_tl_next_id = 1;
+}
+
+
+/**
+ * conn_timeline_deinit - Free all connection timeline records
+ * @wpa_s: Pointer to wpa_supplicant data
+ */
+void conn_timeline_deinit(struct wpa_supplicant *wpa_s)
+{
+	struct conn_timeline *tl, *prev;
+
+	if (wpa_s->conn_tl.next == NULL)
+		return; /* not initialized */
+	dl_list_for_each_safe(tl, prev, &wpa_s->conn_tl, struct conn_timeline,
+			      list)
+		conn_tl_free(wpa_s, tl);
+}
+
+
+/**
+ * conn_timeline_state - Record a wpa_supplicant state change
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @old_state: Previous state
+ * @state: New state
+ *
+ * This starts a new record when a connection attempt begins and closes the
+ * current record when the connection is completed or the attempt is stopped.
+ */
+void conn_timeline_state(struct wpa_supplicant *wpa_s,
+			 enum wpa_states old_state, enum wpa_states state)
+{
+	struct conn_timeline *tl = wpa_s->conn_tl_cur;
+	struct wpa_ssid *ssid;
+	unsigned int ms;
+
+	if (tl == NULL) {
+		if (wpa_s->conf == NULL)
+			return;
+		/* ASSOCIATED is entered directly with ap_scan=0 */
+		if (state != WPA_SCANNING && state != WPA_AUTHENTICATING &&
+		    state != WPA_ASSOCIATING &&
+		    (state != WPA_ASSOCIATED || old_state >= WPA_ASSOCIATED))
+			return;
+		tl = conn_tl_start(wpa_s);
+		if (tl == NULL)
+			return;
+	}
+
+	ms = conn_tl_add(tl, CONN_TL_STATE, state);
+	if (tl->state_first[state] < 0)
+		tl->state_first[state] = ms;
+	tl->state_last[state] = ms;
+
+	switch (state) {
+	case WPA_AUTHENTICATING:
+	case WPA_ASSOCIATING:
+		os_memcpy(tl->bssid, wpa_s->pending_bssid, ETH_ALEN);
+		break;
+	case WPA_COMPLETED:
+		os_memcpy(tl->bssid, wpa_s->bssid, ETH_ALEN);
+		ssid = wpa_s->current_ssid;
+		if (ssid && ssid->ssid_len <= sizeof(tl->ssid)) {
+			os_memcpy(tl->ssid, ssid->ssid, ssid->ssid_len);
+			tl->ssid_len = ssid->ssid_len;
+		}
+		conn_tl_end(wpa_s, 1);
+		break;
+	case WPA_DISCONNECTED:
+		if (wpa_s->disconnected)
+			conn_tl_end(wpa_s, 0);
+		break;
+	case WPA_INACTIVE:
+	case WPA_INTERFACE_DISABLED:
+		conn_tl_end(wpa_s, 0);
+		break;
+	default:
+		break;
+	}
+}
+
+
+/**
+ * conn_timeline_event - Record an event for the current connection attempt
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @event: Event type (CONN_TL_*)
+ * @value: Event specific value
+ */
+void conn_timeline_event(struct wpa_supplicant *wpa_s,
+			 enum conn_tl_event event, int value)
+{
+	struct conn_timeline *tl = wpa_s->conn_tl_cur;
+
+	if (tl == NULL)
+		return;
+	conn_tl_add(tl, event, value);
+	if (event == CONN_TL_FAST_CONNECT)
+		tl->fast_connect = 1;
+	else if (event == CONN_TL_PMKSA)
+		tl->pmksa = 1;
+}
+
+
+static const char * conn_tl_result_txt(const struct conn_timeline *tl)
+{
+	switch (tl->result) {
+	case CONN_TL_COMPLETED:
+		return "completed";
+	case CONN_TL_FAILED:
+		return "failed";
+	default:
+		return "in-progress";
+	}
+}
+
+
+/**
+ * conn_timeline_summary - Get a one line summary of a connection attempt
+ * @tl: Connection timeline record
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of bytes written or -1 on failure
+ *
+ * The summary lists the time (in ms from the start of the attempt) when the
+ * authentication, association, 4-way handshake, and completion were first
+ * reached and the EAP timing information, if EAP was used.
+ */
+int conn_timeline_summary(const struct conn_timeline *tl, char *buf,
+			  size_t buflen)
+{
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+
+	ret = os_snprintf(pos, end - pos, "id=%u start=%ld.%06u "
+			  "bssid=" MACSTR " ssid=%s result=%s total=%u "
+			  "auth=%d assoc=%d 4way=%d completed=%d",
+			  tl->id, (long) tl->start_wall.sec,
+			  (unsigned int) tl->start_wall.usec,
+			  MAC2STR(tl->bssid),
+			  wpa_ssid_txt(tl->ssid, tl->ssid_len),
+			  conn_tl_result_txt(tl),
+			  tl->result == CONN_TL_IN_PROGRESS ?
+			  conn_tl_ms(tl) : tl->total,
+			  tl->state_first[WPA_AUTHENTICATING],
+			  tl->state_first[WPA_ASSOCIATING],
+			  tl->state_first[WPA_4WAY_HANDSHAKE],
+			  tl->state_first[WPA_COMPLETED]);
+	if (ret < 0 || ret >= end - pos)
+		return -1;
+	pos += ret;
+
+	if (tl->eap.eap_time) {
+		ret = os_snprintf(pos, end - pos, " eap=%u eap_rounds=%u "
+				  "eap_rtt_avg=%u eap_rtt_max=%u tls=%u",
+				  tl->eap.eap_time, tl->eap.eap_rounds,
+				  tl->eap.eap_rounds ? tl->eap.eap_rtt_total /
+				  tl->eap.eap_rounds : 0,
+				  tl->eap.eap_rtt_max, tl->eap.tls_time);
+		if (ret < 0 || ret >= end - pos)
+			return -1;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
+
+
+/**
+ * conn_timeline_list - List summaries of the recorded connection attempts
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of bytes written
+ *
+ * One line per record is written starting from the oldest one.
+ */
+int conn_timeline_list(struct wpa_supplicant *wpa_s, char *buf,
+		       size_t buflen)
+{
+	struct conn_timeline *tl;
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+
+	dl_list_for_each(tl, &wpa_s->conn_tl, struct conn_timeline, list) {
+		ret = conn_timeline_summary(tl, pos, end - pos - 1);
+		if (ret < 0)
+			break;
+		pos += ret;
+		*pos++ = '\n';
+	}
+	*pos = '\0';
+
+	return pos - buf;
+}
+
+
+static const char * conn_tl_event_txt(const struct conn_tl_entry *e)
+{
+	switch (e->event) {
+	case CONN_TL_STATE:
+		return wpa_supplicant_state_txt(e->value);
+	case CONN_TL_SCAN_RESULTS:
+		return "SCAN-RESULTS";
+	case CONN_TL_AUTH_RESP:
+		return "AUTH-RESP";
+	case CONN_TL_EAP_DONE:
+		return "EAP-DONE";
+	case CONN_TL_DISCONNECT:
+		return "DISCONNECT";
+	case CONN_TL_FAST_CONNECT:
+		return "FAST-CONNECT";
+	case CONN_TL_PMKSA:
+		return "PMKSA-CACHE";
+	}
+	return "UNKNOWN";
+}
+
+
+/**
+ * conn_timeline_get - Get the full timeline of a connection attempt
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @id: Record id
+ * @buf: Buffer for the text
+ * @buflen: Length of the buffer
+ * Returns: Number of bytes written or -1 if the record was not found
+ *
+ * The summary line is followed by one line per event with the time in ms
+ * from the start of the attempt, the event name and, for other than state
+ * change events, the event specific value.
+ */
+int conn_timeline_get(struct wpa_supplicant *wpa_s, unsigned int id,
+		      char *buf, size_t buflen)
+{
+	struct conn_timeline *tl;
+	const struct conn_tl_entry *e;
+	char *pos = buf, *end = buf + buflen;
+	unsigned int i;
+	int ret;
+
+	dl_list_for_each(tl, &wpa_s->conn_tl, struct conn_timeline, list) {
+		if (tl->id == id)
+			break;
+	}
+	if (&tl->list == &wpa_s->conn_tl)
+		return -1;
+
+	ret = conn_timeline_summary(tl, pos, end - pos - 1);
+	if (ret < 0)
+		return pos - buf;
+	pos += ret;
+	*pos++ = '\n';
+
+	for (i = 0; i < tl->num_events; i++) {
+		e = &tl->events[i];
+		if (e->event == CONN_TL_STATE)
+			ret = os_snprintf(pos, end - pos, "%u %s\n", e->ms,
+					  conn_tl_event_txt(e));
+		else
+			ret = os_snprintf(pos, end - pos, "%u %s %d\n", e->ms,
+					  conn_tl_event_txt(e), e->value);
+		if (ret < 0 || ret >= end - pos)
+			break;
+		pos += ret;
+	}
+
+	if (tl->dropped_events) {
+		ret = os_snprintf(pos, end - pos, "dropped=%u\n",
+				  tl->dropped_events);
+		if (ret >= 0 && ret < end - pos)
+			pos += ret;
+	}
+	*pos = '\0';
+
+	return pos - buf;
+}
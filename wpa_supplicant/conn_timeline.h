@@ -0,0 +1,86 @@
+/*
+ * wpa_supplicant - Connection setup timeline
+ * Copyright (c) 2026, The hostap project contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Alternatively, this software may be distributed under the terms of BSD
+ * license.
+ *
+ * See README and COPYING for more details.
+ */
+
+#ifndef CONN_TIMELINE_H
+#define CONN_TIMELINE_H
+
+#include "eapol_supp/eapol_supp_sm.h"
+
+#define CONN_TL_MAX_EVENTS 32
+
+enum conn_tl_event {
+	CONN_TL_STATE, /* value = new wpa_states */
+	CONN_TL_SCAN_RESULTS, /* value = number of scan results */
+	CONN_TL_AUTH_RESP, /* value = status code */
+	CONN_TL_EAP_DONE, /* value = 1 on success, 0 on failure */
+	CONN_TL_DISCONNECT, /* value = reason code */
+	CONN_TL_FAST_CONNECT, /* value = BSS id from the cached scan results */
+	CONN_TL_PMKSA /* value = 1; PMKSA cache entry used for association */
+};
+
+struct conn_tl_entry {
+	unsigned int ms; /* time since the start of the connection attempt */
+	enum conn_tl_event event;
+	int value;
+};
+
+/**
+ * struct conn_timeline - Timeline of a single connection attempt
+ *
+ * Times are measured with a monotonic clock. A connection attempt starts
+ * when scanning, authentication, or association is started while not
+ * connected and ends when the connection is completed or when the attempt is
+ * given up, e.g., due to DISCONNECT command or all networks being disabled.
+ * The record of the attempt in progress is kept even with
+ * conn_timeline_max=0 since CTRL-EVENT-CONNECT-TIME is derived from it.
+ * The events array is bounded, so the state transition times used for the
+ * summary and CTRL-EVENT-CONNECT-TIME are kept in separate fields.
+ */
+struct conn_timeline {
+	struct dl_list list;
+	unsigned int id;
+	struct os_time start; /* monotonic */
+	struct os_time start_wall;
+	u8 bssid[ETH_ALEN];
+	u8 ssid[32];
+	size_t ssid_len;
+	enum {
+		CONN_TL_IN_PROGRESS, CONN_TL_COMPLETED, CONN_TL_FAILED
+	} result;
+	unsigned int total; /* ms until completion or failure */
+	struct eapol_sm_timing eap;
+	/* ms of the first and last transition to each state; -1 if none */
+	int state_first[WPA_COMPLETED + 1];
+	int state_last[WPA_COMPLETED + 1];
+	int fast_connect; /* cached scan results were used */
+	int pmksa; /* PMKSA cache entry was used for association */
+	unsigned int num_events;
+	unsigned int dropped_events;
+	struct conn_tl_entry events[CONN_TL_MAX_EVENTS];
+};
+
+void conn_timeline_init(struct wpa_supplicant *wpa_s);
+void conn_timeline_deinit(struct wpa_supplicant *wpa_s);
+void conn_timeline_state(struct wpa_supplicant *wpa_s,
+			 enum wpa_states old_state, enum wpa_states state);
+void conn_timeline_event(struct wpa_supplicant *wpa_s,
+			 enum conn_tl_event event, int value);
+int conn_timeline_summary(const struct conn_timeline *tl, char *buf,
+			  size_t buflen);
+int conn_timeline_list(struct wpa_supplicant *wpa_s, char *buf,
+		       size_t buflen);
+int conn_timeline_get(struct wpa_supplicant *wpa_s, unsigned int id,
+		      char *buf, size_t buflen);
+
+#endif /* CONN_TIMELINE_H */
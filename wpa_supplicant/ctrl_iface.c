@@ -40,6 +40,7 @@
 #include "ctrl_iface.h"
 #include "interworking.h"
 #include "blacklist.h"
+#include "conn_timeline.h"
 #include "wpas_glue.h"
 
 extern struct wpa_driver_ops *wpa_drivers[];
@@ -961,17 +962,30 @@ static int wpa_supplicant_ctrl_iface_blacklist(struct wpa_supplicant *wpa_s,
 {
 	u8 bssid[ETH_ALEN];
 	struct wpa_blacklist *e;
+	struct os_time now;
 	char *pos, *end;
-	int ret;
+	int ret, verbose;
 
-	/* cmd: "BLACKLIST [<BSSID>]" */
-	if (*cmd == '\0') {
+	/* cmd: "BLACKLIST [<BSSID>|clear|verbose]" */
+	verbose = os_strcmp(cmd, " verbose") == 0;
+	if (*cmd == '\0' || verbose) {
+		wpa_blacklist_expire(wpa_s);
+		os_get_time(&now);
 		pos = buf;
 		end = buf + buflen;
 		e = wpa_s->blacklist;
 		while (e) {
-			ret = os_snprintf(pos, end - pos, MACSTR "\n",
-					  MAC2STR(e->bssid));
+			if (verbose)
+				ret = os_snprintf(pos, end - pos,
+						  MACSTR " count=%d age=%ld%s\n",
+						  MAC2STR(e->bssid), e->count,
+						  (long) (now.sec -
+							  e->last_update.sec),
+						  e->permanent ?
+						  " permanent" : "");
+			else
+				ret = os_snprintf(pos, end - pos, MACSTR "\n",
+						  MAC2STR(e->bssid));
 			if (ret < 0 || ret >= end - pos)
 				return pos - buf;
 			pos += ret;
@@ -995,14 +1009,18 @@ static int wpa_supplicant_ctrl_iface_blacklist(struct wpa_supplicant *wpa_s,
 
 	/*
 	 * Add the BSSID twice, so its count will be 2, causing it to be
-	 * skipped when processing scan results.
+	 * skipped when processing scan results. Explicitly added entries do
+	 * not decay.
 	 */
 	ret = wpa_blacklist_add(wpa_s, bssid);
-	if (ret != 0)
+	if (ret < 0)
 		return -1;
 	ret = wpa_blacklist_add(wpa_s, bssid);
-	if (ret != 0)
+	if (ret < 0)
 		return -1;
+	e = wpa_blacklist_get(wpa_s, bssid);
+	if (e)
+		e->permanent = 1;
 	os_memcpy(buf, "OK\n", 3);
 	return 3;
 }
@@ -2283,6 +2301,48 @@ static int wpa_supplicant_ctrl_iface_bss_expire_count(
 }
 
 
+static int wpa_supplicant_ctrl_iface_bss_mem(struct wpa_supplicant *wpa_s,
+					     char *buf, size_t buflen)
+{
+	struct wpa_bss *bss;
+	struct os_time now;
+	size_t ie_len = 0, ie_buf_len = 0;
+	int ret, oldest = 0;
+
+	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+		ie_len += bss->ie_len + bss->beacon_ie_len;
+		ie_buf_len += bss->ie_buf_len;
+	}
+
+	/* The BSS list is ordered by last update, oldest first */
+	bss = dl_list_first(&wpa_s->bss, struct wpa_bss, list);
+	if (bss) {
+		os_get_time(&now);
+		oldest = now.sec - bss->last_update.sec;
+	}
+
+	ret = os_snprintf(buf, buflen,
+			  "entries=%u\n"
+			  "max_entries=%u\n"
+			  "mem=%lu\n"
+			  "max_mem=%u\n"
+			  "entry_size=%u\n"
+			  "ie_octets=%lu\n"
+			  "ie_alloc=%lu\n"
+			  "oldest_age=%d\n",
+			  (unsigned int) wpa_s->num_bss,
+			  wpa_s->conf->bss_max_count,
+			  (unsigned long) wpa_s->bss_mem,
+			  wpa_s->conf->bss_max_mem,
+			  (unsigned int) sizeof(struct wpa_bss),
+			  (unsigned long) ie_len,
+			  (unsigned long) ie_buf_len, oldest);
+	if (ret < 0 || (size_t) ret >= buflen)
+		return 0;
+	return ret;
+}
+
+
 static void wpa_supplicant_ctrl_iface_drop_sa(struct wpa_supplicant *wpa_s)
 {
 	wpa_printf(MSG_DEBUG, "Dropping SA without deauthentication");
@@ -3229,6 +3289,17 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			reply_len = -1;
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
+	} else if (os_strcmp(buf, "LOG-DUMP") == 0) {
+		reply_len = wpa_debug_ringbuf_dump(0, reply, reply_size);
+	} else if (os_strncmp(buf, "LOG-DUMP ", 9) == 0) {
+		reply_len = wpa_debug_ringbuf_dump(atoi(buf + 9), reply,
+						   reply_size);
+#if defined(CONFIG_WPABUF_POOL) || defined(CONFIG_OS_MALLOC_POOL)
+	} else if (os_strcmp(buf, "POOL-STATS") == 0) {
+		reply_len = os_pool_stats(reply, reply_size);
+#endif /* CONFIG_WPABUF_POOL || CONFIG_OS_MALLOC_POOL */
+	} else if (os_strcmp(buf, "DRIVER-STATS") == 0) {
+		reply_len = wpa_drv_driver_stats(wpa_s, reply, reply_size);
 	} else if (os_strcmp(buf, "MIB") == 0) {
 		reply_len = wpa_sm_get_mib(wpa_s->wpa, reply, reply_size);
 		if (reply_len >= 0) {
@@ -3596,6 +3667,14 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 		if (wpa_supplicant_ctrl_iface_bss_expire_count(wpa_s,
 							       buf + 17))
 			reply_len = -1;
+	} else if (os_strcmp(buf, "BSS_MEM") == 0) {
+		reply_len = wpa_supplicant_ctrl_iface_bss_mem(wpa_s, reply,
+							      reply_size);
+	} else if (os_strcmp(buf, "CONN-TIMELINE") == 0) {
+		reply_len = conn_timeline_list(wpa_s, reply, reply_size);
+	} else if (os_strncmp(buf, "CONN-TIMELINE ", 14) == 0) {
+		reply_len = conn_timeline_get(wpa_s, atoi(buf + 14), reply,
+					      reply_size);
 #ifdef CONFIG_TDLS
 	} else if (os_strncmp(buf, "TDLS_DISCOVER ", 14) == 0) {
 		if (wpa_supplicant_ctrl_iface_tdls_discover(wpa_s, buf + 14))
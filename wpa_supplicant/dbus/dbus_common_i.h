@@ -19,12 +19,20 @@
 
 #include <dbus/dbus.h>
 
+#include "utils/list.h"
+
 struct wpas_dbus_priv {
 	DBusConnection *con;
 	int should_dispatch;
 	struct wpa_global *global;
 	u32 next_objid;
 	int dbus_new_initialized;
+
+	/* objects with properties waiting for PropertiesChanged */
+	struct dl_list dirty_objects;
+	/* minimum time between changed property flushes in ms; 0 = no limit */
+	unsigned int prop_changed_interval;
+	struct os_time last_prop_flush;
 };
 
 #endif /* DBUS_COMMON_I_H */
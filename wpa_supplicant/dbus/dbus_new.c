@@ -17,6 +17,7 @@
 #include "includes.h"
 
 #include "common.h"
+#include "eloop.h"
 #include "common/ieee802_11_defs.h"
 #include "wps/wps.h"
 #include "../config.h"
@@ -192,6 +193,212 @@ err:
 }
 
 
+/*
+ * BSS ids collected for the compact BSSDelta signal. The signal is sent in
+ * addition to BSSAdded, BSSRemoved, and PropertiesChanged so that clients can
+ * select the form they want with match rules.
+ */
+struct wpas_dbus_bss_ids {
+	unsigned int *id;
+	size_t num;
+	size_t size;
+};
+
+struct wpas_dbus_bss_delta {
+	struct wpas_dbus_bss_ids added;
+	struct wpas_dbus_bss_ids removed;
+	struct wpas_dbus_bss_ids changed;
+};
+
+
+static int wpas_dbus_bss_ids_find(const struct wpas_dbus_bss_ids *ids,
+				  unsigned int id)
+{
+	size_t i;
+
+	/* Search backwards since updates usually hit the latest entries */
+	for (i = ids->num; i > 0; i--) {
+		if (ids->id[i - 1] == id)
+			return i - 1;
+	}
+	return -1;
+}
+
+
+static int wpas_dbus_bss_ids_del(struct wpas_dbus_bss_ids *ids,
+				 unsigned int id)
+{
+	int i = wpas_dbus_bss_ids_find(ids, id);
+
+	if (i < 0)
+		return 0;
+	os_memmove(&ids->id[i], &ids->id[i + 1],
+		   (ids->num - i - 1) * sizeof(unsigned int));
+	ids->num--;
+	return 1;
+}
+
+
+static int wpas_dbus_bss_ids_add(struct wpas_dbus_bss_ids *ids,
+				 unsigned int id)
+{
+	unsigned int *n;
+	size_t size;
+
+	if (wpas_dbus_bss_ids_find(ids, id) >= 0)
+		return 0;
+
+	if (ids->num == ids->size) {
+		size = ids->size ? 2 * ids->size : 16;
+		n = os_realloc(ids->id, size * sizeof(unsigned int));
+		if (n == NULL)
+			return -1;
+		ids->id = n;
+		ids->size = size;
+	}
+	ids->id[ids->num++] = id;
+	return 0;
+}
+
+
+static dbus_bool_t wpas_dbus_append_bss_paths(struct wpa_supplicant *wpa_s,
+					      DBusMessageIter *iter,
+					      const struct wpas_dbus_bss_ids *ids)
+{
+	DBusMessageIter array_iter;
+	char path[WPAS_DBUS_OBJECT_PATH_MAX], *p = path;
+	size_t i;
+
+	if (!dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+					      DBUS_TYPE_OBJECT_PATH_AS_STRING,
+					      &array_iter))
+		return FALSE;
+
+	for (i = 0; i < ids->num; i++) {
+		os_snprintf(path, WPAS_DBUS_OBJECT_PATH_MAX,
+			    "%s/" WPAS_DBUS_NEW_BSSIDS_PART "/%u",
+			    wpa_s->dbus_new_path, ids->id[i]);
+		if (!dbus_message_iter_append_basic(&array_iter,
+						    DBUS_TYPE_OBJECT_PATH,
+						    &p))
+			return FALSE;
+	}
+
+	return dbus_message_iter_close_container(iter, &array_iter);
+}
+
+
+/**
+ * wpas_dbus_signal_bss_delta - Send collected BSS changes
+ * @wpa_s: %wpa_supplicant network interface data
+ *
+ * Sends a single BSSDelta signal with the paths of the BSS objects that were
+ * added, removed, or had properties changed since the previous signal.
+ */
+static void wpas_dbus_signal_bss_delta(struct wpa_supplicant *wpa_s)
+{
+	struct wpas_dbus_bss_delta *delta = wpa_s->dbus_bss_delta;
+	struct wpas_dbus_priv *iface = wpa_s->global->dbus;
+	DBusMessage *msg;
+	DBusMessageIter iter;
+
+	if (iface == NULL || delta == NULL ||
+	    (delta->added.num == 0 && delta->removed.num == 0 &&
+	     delta->changed.num == 0))
+		return;
+
+	msg = dbus_message_new_signal(wpa_s->dbus_new_path,
+				      WPAS_DBUS_NEW_IFACE_INTERFACE,
+				      "BSSDelta");
+	if (msg == NULL)
+		return;
+
+	dbus_message_iter_init_append(msg, &iter);
+	if (!wpas_dbus_append_bss_paths(wpa_s, &iter, &delta->added) ||
+	    !wpas_dbus_append_bss_paths(wpa_s, &iter, &delta->removed) ||
+	    !wpas_dbus_append_bss_paths(wpa_s, &iter, &delta->changed))
+		wpa_printf(MSG_ERROR, "dbus: Failed to construct signal");
+	else
+		dbus_connection_send(iface->con, msg, NULL);
+	dbus_message_unref(msg);
+
+	delta->added.num = 0;
+	delta->removed.num = 0;
+	delta->changed.num = 0;
+}
+
+
+static void wpas_dbus_bss_delta_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	wpas_dbus_signal_bss_delta(eloop_ctx);
+}
+
+
+enum wpas_dbus_bss_delta_type {
+	WPAS_DBUS_BSS_DELTA_ADDED,
+	WPAS_DBUS_BSS_DELTA_REMOVED,
+	WPAS_DBUS_BSS_DELTA_CHANGED
+};
+
+static void wpas_dbus_bss_delta_add(struct wpa_supplicant *wpa_s,
+				    enum wpas_dbus_bss_delta_type type,
+				    unsigned int id)
+{
+	struct wpas_dbus_bss_delta *delta = wpa_s->dbus_bss_delta;
+	struct wpas_dbus_bss_ids *ids;
+
+	if (delta == NULL) {
+		delta = os_zalloc(sizeof(*delta));
+		if (delta == NULL)
+			return;
+		wpa_s->dbus_bss_delta = delta;
+	}
+
+	switch (type) {
+	case WPAS_DBUS_BSS_DELTA_ADDED:
+		ids = &delta->added;
+		break;
+	case WPAS_DBUS_BSS_DELTA_REMOVED:
+		wpas_dbus_bss_ids_del(&delta->changed, id);
+		/* Added and removed again before the signal was sent */
+		if (wpas_dbus_bss_ids_del(&delta->added, id))
+			return;
+		ids = &delta->removed;
+		break;
+	default:
+		/* A new entry is reported as added only */
+		if (wpas_dbus_bss_ids_find(&delta->added, id) >= 0)
+			return;
+		ids = &delta->changed;
+		break;
+	}
+
+	if (wpas_dbus_bss_ids_add(ids, id) < 0) {
+		/* Do not lose the update; send what was collected so far */
+		wpas_dbus_signal_bss_delta(wpa_s);
+		if (wpas_dbus_bss_ids_add(ids, id) < 0)
+			return;
+	}
+	eloop_cancel_timeout(wpas_dbus_bss_delta_timeout, wpa_s, NULL);
+	eloop_register_timeout(0, 0, wpas_dbus_bss_delta_timeout, wpa_s, NULL);
+}
+
+
+static void wpas_dbus_bss_delta_free(struct wpa_supplicant *wpa_s)
+{
+	struct wpas_dbus_bss_delta *delta = wpa_s->dbus_bss_delta;
+
+	if (delta == NULL)
+		return;
+	eloop_cancel_timeout(wpas_dbus_bss_delta_timeout, wpa_s, NULL);
+	os_free(delta->added.id);
+	os_free(delta->removed.id);
+	os_free(delta->changed.id);
+	os_free(delta);
+	wpa_s->dbus_bss_delta = NULL;
+}
+
+
 /**
  * wpas_dbus_signal_bss_added - Send a BSS added signal
  * @wpa_s: %wpa_supplicant network interface data
@@ -1610,6 +1817,8 @@ void wpas_dbus_bss_signal_prop_changed(struct wpa_supplicant *wpa_s,
 		return;
 	}
 
+	wpas_dbus_bss_delta_add(wpa_s, WPAS_DBUS_BSS_DELTA_CHANGED, id);
+
 	os_snprintf(path, WPAS_DBUS_OBJECT_PATH_MAX,
 		    "%s/" WPAS_DBUS_NEW_BSSIDS_PART "/%u",
 		    wpa_s->dbus_new_path, id);
@@ -1726,6 +1935,10 @@ static const struct wpa_dbus_property_desc wpas_dbus_global_properties[] = {
 	  wpas_dbus_getter_debug_show_keys,
 	  wpas_dbus_setter_debug_show_keys
 	},
+	{ "PropertiesChangedInterval", WPAS_DBUS_NEW_INTERFACE, "u",
+	  wpas_dbus_getter_prop_changed_interval,
+	  wpas_dbus_setter_prop_changed_interval
+	},
 	{ "Interfaces", WPAS_DBUS_NEW_INTERFACE, "ao",
 	  wpas_dbus_getter_interfaces,
 	  NULL
@@ -1821,6 +2034,7 @@ void wpas_dbus_ctrl_iface_deinit(struct wpas_dbus_priv *iface)
 {
 	if (!iface->dbus_new_initialized)
 		return;
+	wpa_dbus_flush_all_changed_properties(iface);
 	wpa_printf(MSG_DEBUG, "dbus: Unregister D-Bus object '%s'",
 		   WPAS_DBUS_NEW_PATH);
 	dbus_connection_unregister_object_path(iface->con,
@@ -2071,6 +2285,7 @@ int wpas_dbus_unregister_bss(struct wpa_supplicant *wpa_s,
 	}
 
 	wpas_dbus_signal_bss_removed(wpa_s, bss_obj_path);
+	wpas_dbus_bss_delta_add(wpa_s, WPAS_DBUS_BSS_DELTA_REMOVED, id);
 	wpas_dbus_signal_prop_changed(wpa_s, WPAS_DBUS_PROP_BSSS);
 
 	return 0;
@@ -2136,6 +2351,7 @@ int wpas_dbus_register_bss(struct wpa_supplicant *wpa_s,
 	}
 
 	wpas_dbus_signal_bss_added(wpa_s, bss_obj_path);
+	wpas_dbus_bss_delta_add(wpa_s, WPAS_DBUS_BSS_DELTA_ADDED, id);
 	wpas_dbus_signal_prop_changed(wpa_s, WPAS_DBUS_PROP_BSSS);
 
 	return 0;
@@ -2461,6 +2677,10 @@ static const struct wpa_dbus_property_desc wpas_dbus_interface_properties[] = {
 	  wpas_dbus_getter_current_auth_mode,
 	  NULL
 	},
+	{ "ConnectionTimeline", WPAS_DBUS_NEW_IFACE_INTERFACE, "as",
+	  wpas_dbus_getter_conn_timeline,
+	  NULL
+	},
 	{ "Blobs", WPAS_DBUS_NEW_IFACE_INTERFACE, "a{say}",
 	  wpas_dbus_getter_blobs,
 	  NULL
@@ -2528,6 +2748,14 @@ static const struct wpa_dbus_signal_desc wpas_dbus_interface_signals[] = {
 		  END_ARGS
 	  }
 	},
+	{ "BSSDelta", WPAS_DBUS_NEW_IFACE_INTERFACE,
+	  {
+		  { "added", "ao", ARG_OUT },
+		  { "removed", "ao", ARG_OUT },
+		  { "changed", "ao", ARG_OUT },
+		  END_ARGS
+	  }
+	},
 	{ "BlobAdded", WPAS_DBUS_NEW_IFACE_INTERFACE,
 	  {
 		  { "name", "s", ARG_OUT },
@@ -2794,6 +3022,8 @@ int wpas_dbus_unregister_interface(struct wpa_supplicant *wpa_s)
 	if (ctrl_iface == NULL)
 		return 0;
 
+	wpas_dbus_bss_delta_free(wpa_s);
+
 	wpa_printf(MSG_DEBUG, "dbus: Unregister interface object '%s'",
 		   wpa_s->dbus_new_path);
 	if (wpa_dbus_unregister_object_per_iface(ctrl_iface,
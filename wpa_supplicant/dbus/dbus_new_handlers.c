@@ -29,6 +29,8 @@
 #include "../bss.h"
 #include "../scan.h"
 #include "../ctrl_iface.h"
+#include "../conn_timeline.h"
+#include "dbus_common_i.h"
 #include "dbus_new_helpers.h"
 #include "dbus_new.h"
 #include "dbus_new_handlers.h"
@@ -781,6 +783,61 @@ dbus_bool_t wpas_dbus_setter_debug_show_keys(DBusMessageIter *iter,
 }
 
 
+/**
+ * wpas_dbus_getter_prop_changed_interval - Get PropertiesChanged rate limit
+ * @iter: Pointer to incoming dbus message iter
+ * @error: Location to store error on failure
+ * @user_data: Function specific data
+ * Returns: TRUE on success, FALSE on failure
+ *
+ * Getter for "PropertiesChangedInterval" property.
+ */
+dbus_bool_t wpas_dbus_getter_prop_changed_interval(DBusMessageIter *iter,
+						   DBusError *error,
+						   void *user_data)
+{
+	struct wpa_global *global = user_data;
+	dbus_uint32_t val = global->dbus->prop_changed_interval;
+
+	return wpas_dbus_simple_property_getter(iter, DBUS_TYPE_UINT32,
+						&val, error);
+}
+
+
+/**
+ * wpas_dbus_setter_prop_changed_interval - Set PropertiesChanged rate limit
+ * @iter: Pointer to incoming dbus message iter
+ * @error: Location to store error on failure
+ * @user_data: Function specific data
+ * Returns: TRUE on success, FALSE on failure
+ *
+ * Setter for "PropertiesChangedInterval" property. The value is the minimum
+ * time in milliseconds between two batches of PropertiesChanged signals;
+ * 0 sends the changes once per event loop iteration.
+ */
+dbus_bool_t wpas_dbus_setter_prop_changed_interval(DBusMessageIter *iter,
+						   DBusError *error,
+						   void *user_data)
+{
+	struct wpa_global *global = user_data;
+	dbus_uint32_t val;
+
+	if (!wpas_dbus_simple_property_setter(iter, error, DBUS_TYPE_UINT32,
+					      &val))
+		return FALSE;
+
+	if (val > 60000) {
+		dbus_set_error_const(error, DBUS_ERROR_FAILED,
+				     "PropertiesChangedInterval must be "
+				     "<= 60000");
+		return FALSE;
+	}
+
+	global->dbus->prop_changed_interval = val;
+	return TRUE;
+}
+
+
 /**
  * wpas_dbus_getter_interfaces - Request registered interfaces list
  * @iter: Pointer to incoming dbus message iter
@@ -2476,6 +2533,61 @@ dbus_bool_t wpas_dbus_getter_current_auth_mode(DBusMessageIter *iter,
 }
 
 
+/**
+ * wpas_dbus_getter_conn_timeline - Get recent connection attempt timing
+ * @iter: Pointer to incoming dbus message iter
+ * @error: Location to store error on failure
+ * @user_data: Function specific data
+ * Returns: TRUE on success, FALSE on failure
+ *
+ * Getter for "ConnectionTimeline" property. Each string uses the same format
+ * as a line of the CONN-TIMELINE control interface command output.
+ */
+dbus_bool_t wpas_dbus_getter_conn_timeline(DBusMessageIter *iter,
+					   DBusError *error,
+					   void *user_data)
+{
+	struct wpa_supplicant *wpa_s = user_data;
+	struct conn_timeline *tl;
+	char **lines;
+	size_t num = 0;
+	dbus_bool_t success;
+
+	lines = os_zalloc((wpa_s->num_conn_tl + 1) * sizeof(char *));
+	if (lines == NULL) {
+		dbus_set_error_const(error, DBUS_ERROR_NO_MEMORY, "no memory");
+		return FALSE;
+	}
+
+	dl_list_for_each(tl, &wpa_s->conn_tl, struct conn_timeline, list) {
+		char buf[512];
+
+		if (num == wpa_s->num_conn_tl)
+			break;
+		if (conn_timeline_summary(tl, buf, sizeof(buf)) < 0)
+			continue;
+		lines[num] = os_strdup(buf);
+		if (lines[num] == NULL) {
+			dbus_set_error_const(error, DBUS_ERROR_NO_MEMORY,
+					     "no memory");
+			success = FALSE;
+			goto out;
+		}
+		num++;
+	}
+
+	success = wpas_dbus_simple_array_property_getter(iter,
+							 DBUS_TYPE_STRING,
+							 lines, num, error);
+
+out:
+	while (num)
+		os_free(lines[--num]);
+	os_free(lines);
+	return success;
+}
+
+
 /**
  * wpas_dbus_getter_bridge_ifname - Get interface name
  * @iter: Pointer to incoming dbus message iter
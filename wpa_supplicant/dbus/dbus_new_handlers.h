@@ -73,6 +73,14 @@ dbus_bool_t wpas_dbus_setter_debug_show_keys(DBusMessageIter *iter,
 					     DBusError *error,
 					     void *user_data);
 
+dbus_bool_t wpas_dbus_getter_prop_changed_interval(DBusMessageIter *iter,
+						   DBusError *error,
+						   void *user_data);
+
+dbus_bool_t wpas_dbus_setter_prop_changed_interval(DBusMessageIter *iter,
+						   DBusError *error,
+						   void *user_data);
+
 dbus_bool_t wpas_dbus_getter_interfaces(DBusMessageIter *iter,
 					DBusError *error,
 					void *user_data);
@@ -176,6 +184,10 @@ dbus_bool_t wpas_dbus_getter_current_auth_mode(DBusMessageIter *iter,
 					       DBusError *error,
 					       void *user_data);
 
+dbus_bool_t wpas_dbus_getter_conn_timeline(DBusMessageIter *iter,
+					   DBusError *error,
+					   void *user_data);
+
 dbus_bool_t wpas_dbus_getter_bsss(DBusMessageIter *iter, DBusError *error,
 				  void *user_data);
 
@@ -360,6 +360,9 @@ static DBusMessage * msg_method_handler(DBusMessage *message,
 }
 
 
+static void flush_object_desc(struct wpa_dbus_object_desc *obj_desc);
+
+
 /**
  * message_handler - Handles incoming DBus messages
  * @connection: DBus connection on which message was received
@@ -424,7 +427,12 @@ static DBusHandlerResult message_handler(DBusConnection *connection,
 		dbus_message_unref(reply);
 	}
 
-	wpa_dbus_flush_all_changed_properties(connection);
+	/*
+	 * Send the changes to the called object right away; other objects
+	 * are left to the rate limited batched flush.
+	 */
+	if (obj_dsc->dirty.next)
+		flush_object_desc(obj_dsc);
 
 	return DBUS_HANDLER_RESULT_HANDLED;
 }
@@ -447,6 +455,9 @@ void free_dbus_object_desc(struct wpa_dbus_object_desc *obj_dsc)
 	if (obj_dsc->user_data_free_func)
 		obj_dsc->user_data_free_func(obj_dsc->user_data);
 
+	if (obj_dsc->dirty.next)
+		dl_list_del(&obj_dsc->dirty);
+
 	os_free(obj_dsc->path);
 	os_free(obj_dsc->prop_changed_flags);
 	os_free(obj_dsc);
@@ -482,6 +493,7 @@ int wpa_dbus_ctrl_iface_init(struct wpas_dbus_priv *iface,
 	};
 
 	obj_desc->connection = iface->con;
+	obj_desc->priv = iface;
 	obj_desc->path = os_strdup(dbus_path);
 
 	/* Register the message handler for the global dbus interface */
@@ -551,6 +563,7 @@ int wpa_dbus_register_object_per_iface(
 
 	con = ctrl_iface->con;
 	obj_desc->connection = con;
+	obj_desc->priv = ctrl_iface;
 	obj_desc->path = os_strdup(path);
 
 	dbus_error_init(&error);
@@ -575,9 +588,6 @@ int wpa_dbus_register_object_per_iface(
 }
 
 
-static void flush_object_timeout_handler(void *eloop_ctx, void *timeout_ctx);
-
-
 /**
  * wpa_dbus_unregister_object_per_iface - Unregisters DBus object
  * @ctrl_iface: Pointer to dbus private data
@@ -596,9 +606,8 @@ int wpa_dbus_unregister_object_per_iface(
 	if (!obj_desc) {
 		wpa_printf(MSG_ERROR, "dbus: %s: Could not obtain object's "
 			   "private data: %s", __func__, path);
-	} else {
-		eloop_cancel_timeout(flush_object_timeout_handler, con,
-				     obj_desc);
+	} else if (obj_desc->dirty.next) {
+		dl_list_del(&obj_desc->dirty);
 	}
 
 	if (!dbus_connection_unregister_object_path(con, path))
@@ -770,50 +779,62 @@ static void send_prop_changed_signal(
 }
 
 
-static void flush_object_timeout_handler(void *eloop_ctx, void *timeout_ctx)
+static void flush_object_desc(struct wpa_dbus_object_desc *obj_desc)
 {
-	DBusConnection *con = eloop_ctx;
-	struct wpa_dbus_object_desc *obj_desc = timeout_ctx;
+	const struct wpa_dbus_property_desc *dsc;
+	int i;
+
+	if (obj_desc->dirty.next)
+		dl_list_del(&obj_desc->dirty);
 
-	wpa_printf(MSG_DEBUG, "dbus: %s: Timeout - sending changed properties "
-		   "of object %s", __func__, obj_desc->path);
-	wpa_dbus_flush_object_changed_properties(con, obj_desc->path);
+	for (dsc = obj_desc->properties, i = 0; dsc && dsc->dbus_property;
+	     dsc++, i++) {
+		if (obj_desc->prop_changed_flags == NULL ||
+		    !obj_desc->prop_changed_flags[i])
+			continue;
+		send_prop_changed_signal(obj_desc->connection, obj_desc->path,
+					 dsc->dbus_interface, obj_desc);
+	}
 }
 
 
-static void recursive_flush_changed_properties(DBusConnection *con,
-					       const char *path)
+static void flush_changed_timeout_handler(void *eloop_ctx, void *timeout_ctx)
 {
-	char **objects = NULL;
-	char subobj_path[WPAS_DBUS_OBJECT_PATH_MAX];
-	int i;
+	struct wpas_dbus_priv *iface = eloop_ctx;
 
-	wpa_dbus_flush_object_changed_properties(con, path);
-
-	if (!dbus_connection_list_registered(con, path, &objects))
-		goto out;
-
-	for (i = 0; objects[i]; i++) {
-		os_snprintf(subobj_path, WPAS_DBUS_OBJECT_PATH_MAX,
-			    "%s/%s", path, objects[i]);
-		recursive_flush_changed_properties(con, subobj_path);
-	}
-
-out:
-	dbus_free_string_array(objects);
+	wpa_dbus_flush_all_changed_properties(iface);
 }
 
 
 /**
  * wpa_dbus_flush_all_changed_properties - Send all PropertiesChanged signals
- * @con: DBus connection
+ * @iface: dbus priv struct
  *
- * Traverses through all registered objects and sends PropertiesChanged for
- * each properties.
+ * Sends PropertiesChanged for each object that has properties marked as
+ * changed since the previous flush.
  */
-void wpa_dbus_flush_all_changed_properties(DBusConnection *con)
+void wpa_dbus_flush_all_changed_properties(struct wpas_dbus_priv *iface)
 {
-	recursive_flush_changed_properties(con, WPAS_DBUS_NEW_PATH);
+	struct wpa_dbus_object_desc *obj_desc;
+	unsigned int count = 0;
+
+	if (iface == NULL)
+		return;
+
+	eloop_cancel_timeout(flush_changed_timeout_handler, iface, NULL);
+
+	while ((obj_desc = dl_list_first(&iface->dirty_objects,
+					 struct wpa_dbus_object_desc,
+					 dirty))) {
+		flush_object_desc(obj_desc);
+		count++;
+	}
+
+	if (count) {
+		os_get_time(&iface->last_prop_flush);
+		wpa_printf(MSG_MSGDUMP, "dbus: Sent changed properties of %u "
+			   "object(s)", count);
+	}
 }
 
 
@@ -828,37 +849,58 @@ void wpa_dbus_flush_all_changed_properties(DBusConnection *con)
  *
  * You need to call this function after wpa_dbus_mark_property_changed()
  * if you want to send PropertiesChanged signal immediately (i.e., without
- * waiting timeout to expire). PropertiesChanged signal for an object is sent
- * automatically short time after first marking property as changed. All
- * PropertiesChanged signals are sent automatically after responding on DBus
- * message, so if you marked a property changed as a result of DBus call
- * (e.g., param setter), you usually do not need to call this function.
+ * waiting for the next batched flush). Changed properties of all objects are
+ * otherwise collected and sent together once per eloop iteration or, if
+ * wpas_dbus_priv::prop_changed_interval is set, at most once per interval.
+ * PropertiesChanged signals of the object a DBus method call was addressed to
+ * are sent automatically after responding to the call, so if you marked a
+ * property of that object changed as a result of the call (e.g., param
+ * setter), you usually do not need to call this function.
  */
 void wpa_dbus_flush_object_changed_properties(DBusConnection *con,
 					      const char *path)
 {
 	struct wpa_dbus_object_desc *obj_desc = NULL;
-	const struct wpa_dbus_property_desc *dsc;
-	int i;
 
 	dbus_connection_get_object_path_data(con, path, (void **) &obj_desc);
 	if (!obj_desc)
 		return;
-	eloop_cancel_timeout(flush_object_timeout_handler, con, obj_desc);
-
-	dsc = obj_desc->properties;
-	for (dsc = obj_desc->properties, i = 0; dsc && dsc->dbus_property;
-	     dsc++, i++) {
-		if (obj_desc->prop_changed_flags == NULL ||
-		    !obj_desc->prop_changed_flags[i])
-			continue;
-		send_prop_changed_signal(con, path, dsc->dbus_interface,
-					 obj_desc);
-	}
+	flush_object_desc(obj_desc);
 }
 
 
-#define WPA_DBUS_SEND_PROP_CHANGED_TIMEOUT 5000
+static void schedule_changed_flush(struct wpas_dbus_priv *iface)
+{
+	struct os_time now, next;
+	unsigned int ival = iface->prop_changed_interval;
+
+	if (eloop_is_timeout_registered(flush_changed_timeout_handler, iface,
+					NULL))
+		return;
+
+	next.sec = next.usec = 0;
+	if (ival) {
+		/* Rate limit: at most one flush per interval */
+		os_get_time(&now);
+		next.sec = iface->last_prop_flush.sec + ival / 1000;
+		next.usec = iface->last_prop_flush.usec + (ival % 1000) * 1000;
+		if (next.usec >= 1000000) {
+			next.sec++;
+			next.usec -= 1000000;
+		}
+		if (os_time_before(&now, &next))
+			os_time_sub(&next, &now, &next);
+		else
+			next.sec = next.usec = 0;
+	}
+
+	/*
+	 * A zero timeout runs on the next eloop iteration, so all properties
+	 * changed while processing the current event end up in one flush.
+	 */
+	eloop_register_timeout(next.sec, next.usec,
+			       flush_changed_timeout_handler, iface, NULL);
+}
 
 
 /**
@@ -871,8 +913,8 @@ void wpa_dbus_flush_object_changed_properties(DBusConnection *con,
  * Iterates over all properties registered with an object and marks the one
  * given in parameters as changed. All parameters registered for an object
  * within a single interface will be aggregated together and sent in one
- * PropertiesChanged signal when function
- * wpa_dbus_flush_object_changed_properties() is called.
+ * PropertiesChanged signal. The object is queued for the next batched flush
+ * (see wpa_dbus_flush_object_changed_properties()).
  */
 void wpa_dbus_mark_property_changed(struct wpas_dbus_priv *iface,
 				    const char *path, const char *interface,
@@ -907,12 +949,9 @@ void wpa_dbus_mark_property_changed(struct wpas_dbus_priv *iface,
 		return;
 	}
 
-	if (!eloop_is_timeout_registered(flush_object_timeout_handler,
-					 iface->con, obj_desc->path)) {
-		eloop_register_timeout(0, WPA_DBUS_SEND_PROP_CHANGED_TIMEOUT,
-				       flush_object_timeout_handler,
-				       iface->con, obj_desc);
-	}
+	if (obj_desc->dirty.next == NULL)
+		dl_list_add_tail(&iface->dirty_objects, &obj_desc->dirty);
+	schedule_changed_flush(iface);
 }
 
 
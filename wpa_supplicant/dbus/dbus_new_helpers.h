@@ -18,6 +18,8 @@
 
 #include <dbus/dbus.h>
 
+#include "utils/list.h"
+
 typedef DBusMessage * (* WPADBusMethodHandler)(DBusMessage *message,
 					       void *user_data);
 typedef void (* WPADBusArgumentFreeFunction)(void *handler_arg);
@@ -37,6 +39,9 @@ struct wpa_dbus_object_desc {
 
 	/* property changed flags */
 	u8 *prop_changed_flags;
+	/* entry in wpas_dbus_priv::dirty_objects while any flag is set */
+	struct dl_list dirty;
+	struct wpas_dbus_priv *priv;
 
 	/* argument for method handlers and properties
 	 * getter and setter functions */
@@ -131,7 +136,7 @@ dbus_bool_t wpa_dbus_get_object_properties(struct wpas_dbus_priv *iface,
 					   DBusMessageIter *iter);
 
 
-void wpa_dbus_flush_all_changed_properties(DBusConnection *con);
+void wpa_dbus_flush_all_changed_properties(struct wpas_dbus_priv *iface);
 
 void wpa_dbus_flush_object_changed_properties(DBusConnection *con,
 					      const char *path);
@@ -663,4 +663,12 @@ static inline void wpa_drv_set_rekey_info(struct wpa_supplicant *wpa_s,
 	wpa_s->driver->set_rekey_info(wpa_s->drv_priv, kek, kck, replay_ctr);
 }
 
+static inline int wpa_drv_driver_stats(struct wpa_supplicant *wpa_s,
+				       char *buf, size_t buflen)
+{
+	if (!wpa_s->driver->driver_stats)
+		return -1;
+	return wpa_s->driver->driver_stats(wpa_s->drv_priv, buf, buflen);
+}
+
 #endif /* DRIVER_I_H */
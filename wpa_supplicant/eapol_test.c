@@ -55,7 +55,7 @@ struct eapol_test_data {
 	int no_mppe_keys;
 	int num_mppe_ok, num_mppe_mismatch;
 
-	u8 radius_identifier;
+	int radius_identifier;
 	struct radius_msg *last_recv_radius;
 	struct in_addr own_ip_addr;
 	struct radius_client_data *radius;
@@ -34,6 +34,7 @@
 #include "common/ieee802_11_common.h"
 #include "crypto/random.h"
 #include "blacklist.h"
+#include "conn_timeline.h"
 #include "wpas_glue.h"
 #include "wps_supplicant.h"
 #include "ibss_rsn.h"
@@ -324,9 +325,144 @@ static int wpa_supplicant_match_privacy(struct wpa_scan_res *bss,
 }
 
 
+#define WPA_SEL_SSID_HASH_SIZE 128
+
+/*
+ * Parsed WPA or RSN IE of a scan result; cached for the duration of a single
+ * network selection round since the same IE is otherwise parsed again for
+ * each configured network.
+ */
+struct wpa_sel_ie {
+	int parsed; /* 0 = not yet parsed, 1 = parsed, -1 = parse failed */
+	struct wpa_ie_data data;
+};
+
+struct wpa_sel_bss {
+	struct wpa_sel_ie rsn;
+	struct wpa_sel_ie wpa;
+};
+
+/*
+ * Entry of the network selection index. The entries of a priority group are
+ * stored in an array in pnext order, so the array position gives the order
+ * in which the candidates are processed.
+ */
+struct wpa_sel_net {
+	struct wpa_ssid *ssid;
+	struct wpa_sel_net *next; /* next entry in the same index list */
+};
+
+/*
+ * Network selection index for the priority group being processed: enabled
+ * networks hashed by SSID and a separate list of the networks without an
+ * SSID (wildcard, BSSID-only, or WPS). Both lists are in pnext order.
+ */
+struct wpa_sel_ctx {
+	struct wpa_sel_net *hash[WPA_SEL_SSID_HASH_SIZE];
+	struct wpa_sel_net *wildcard;
+	struct wpa_sel_net *nets; /* entries for the largest priority group */
+	struct wpa_sel_bss *bss; /* per scan result; may be NULL */
+	int enabled_networks;
+};
+
+
+static unsigned int wpa_sel_ssid_hash(const u8 *ssid, size_t ssid_len)
+{
+	unsigned int hash = 0;
+	size_t i;
+
+	for (i = 0; i < ssid_len; i++)
+		hash = hash * 31 + ssid[i];
+	return hash % WPA_SEL_SSID_HASH_SIZE;
+}
+
+
+static unsigned int wpa_sel_group_size(struct wpa_ssid *group)
+{
+	struct wpa_ssid *ssid;
+	unsigned int count = 0;
+
+	for (ssid = group; ssid; ssid = ssid->pnext) {
+		if (!ssid->disabled)
+			count++;
+	}
+
+	return count;
+}
+
+
+static void wpa_sel_index_group(struct wpa_sel_ctx *ctx,
+				struct wpa_ssid *group)
+{
+	struct wpa_ssid *ssid;
+	struct wpa_sel_net *net, **tail[WPA_SEL_SSID_HASH_SIZE], **wtail;
+	unsigned int hash;
+
+	os_memset(ctx->hash, 0, sizeof(ctx->hash));
+	for (hash = 0; hash < WPA_SEL_SSID_HASH_SIZE; hash++)
+		tail[hash] = &ctx->hash[hash];
+	ctx->wildcard = NULL;
+	wtail = &ctx->wildcard;
+
+	net = ctx->nets;
+	for (ssid = group; ssid; ssid = ssid->pnext) {
+		if (ssid->disabled)
+			continue;
+		net->ssid = ssid;
+		net->next = NULL;
+		if (ssid->ssid_len == 0) {
+			*wtail = net;
+			wtail = &net->next;
+		} else {
+			hash = wpa_sel_ssid_hash(ssid->ssid, ssid->ssid_len);
+			*tail[hash] = net;
+			tail[hash] = &net->next;
+		}
+		net++;
+	}
+}
+
+
+/* Return the next candidate network in pnext order from the two lists */
+static struct wpa_ssid * wpa_sel_next(struct wpa_sel_net **h,
+				      struct wpa_sel_net **w)
+{
+	struct wpa_sel_net *net;
+
+	if (*h && (*w == NULL || *h < *w)) {
+		net = *h;
+		*h = net->next;
+	} else {
+		net = *w;
+		if (net == NULL)
+			return NULL;
+		*w = net->next;
+	}
+
+	return net->ssid;
+}
+
+
+static int wpa_sel_parse_ie(struct wpa_sel_ie *cache, const u8 *ie,
+			    struct wpa_ie_data *data)
+{
+	if (cache == NULL)
+		return wpa_parse_wpa_ie(ie, 2 + ie[1], data);
+
+	if (cache->parsed == 0)
+		cache->parsed = wpa_parse_wpa_ie(ie, 2 + ie[1], &cache->data) ?
+			-1 : 1;
+	if (cache->parsed < 0)
+		return -1;
+	os_memcpy(data, &cache->data, sizeof(*data));
+	return 0;
+}
+
+
 static int wpa_supplicant_ssid_bss_match(struct wpa_supplicant *wpa_s,
 					 struct wpa_ssid *ssid,
-					 struct wpa_scan_res *bss)
+					 struct wpa_scan_res *bss,
+					 struct wpa_sel_bss *sel)
 {
 	struct wpa_ie_data ie;
 	int proto_match = 0;
@@ -348,7 +484,7 @@ static int wpa_supplicant_ssid_bss_match(struct wpa_supplicant *wpa_s,
 	while ((ssid->proto & WPA_PROTO_RSN) && rsn_ie) {
 		proto_match++;
 
-		if (wpa_parse_wpa_ie(rsn_ie, 2 + rsn_ie[1], &ie)) {
+		if (wpa_sel_parse_ie(sel ? &sel->rsn : NULL, rsn_ie, &ie)) {
 			wpa_dbg(wpa_s, MSG_DEBUG, "   skip RSN IE - parse "
 				"failed");
 			break;
@@ -403,7 +539,7 @@ static int wpa_supplicant_ssid_bss_match(struct wpa_supplicant *wpa_s,
 	while ((ssid->proto & WPA_PROTO_WPA) && wpa_ie) {
 		proto_match++;
 
-		if (wpa_parse_wpa_ie(wpa_ie, 2 + wpa_ie[1], &ie)) {
+		if (wpa_sel_parse_ie(sel ? &sel->wpa : NULL, wpa_ie, &ie)) {
 			wpa_dbg(wpa_s, MSG_DEBUG, "   skip WPA IE - parse "
 				"failed");
 			break;
@@ -588,7 +724,7 @@ static int rate_match(struct wpa_supplicant *wpa_s, struct wpa_scan_res *bss)
 
 static struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 					    int i, struct wpa_scan_res *bss,
-					    struct wpa_ssid *group)
+					    struct wpa_sel_ctx *ctx)
 {
 	const u8 *ssid_;
 	u8 wpa_ie_len, rsn_ie_len, ssid_len;
@@ -596,6 +732,8 @@ static struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 	struct wpa_blacklist *e;
 	const u8 *ie;
 	struct wpa_ssid *ssid;
+	struct wpa_sel_net *hnext, *wnext;
+	struct wpa_sel_bss *sel = ctx->bss ? &ctx->bss[i] : NULL;
 
 	ie = wpa_scan_get_ie(bss, WLAN_EID_SSID);
 	ssid_ = ie ? ie + 2 : (u8 *) "";
@@ -616,7 +754,7 @@ static struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 	e = wpa_blacklist_get(wpa_s, bss->bssid);
 	if (e) {
 		int limit = 1;
-		if (wpa_supplicant_enabled_networks(wpa_s->conf) == 1) {
+		if (ctx->enabled_networks == 1) {
 			/*
 			 * When only a single network is enabled, we can
 			 * trigger blacklisting on the first failure. This
@@ -641,14 +779,15 @@ static struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 
 	wpa = wpa_ie_len > 0 || rsn_ie_len > 0;
 
-	for (ssid = group; ssid; ssid = ssid->pnext) {
+	/*
+	 * Only the enabled networks with a matching SSID hash and the ones
+	 * without a configured SSID can match this BSS.
+	 */
+	hnext = ctx->hash[wpa_sel_ssid_hash(ssid_, ssid_len)];
+	wnext = ctx->wildcard;
+	while ((ssid = wpa_sel_next(&hnext, &wnext)) != NULL) {
 		int check_ssid = wpa ? 1 : (ssid->ssid_len != 0);
 
-		if (ssid->disabled) {
-			wpa_dbg(wpa_s, MSG_DEBUG, "   skip - disabled");
-			continue;
-		}
-
 #ifdef CONFIG_WPS
 		if ((ssid->key_mgmt & WPA_KEY_MGMT_WPS) && e && e->count > 0) {
 			wpa_dbg(wpa_s, MSG_DEBUG, "   skip - blacklisted "
@@ -688,7 +827,7 @@ static struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 			continue;
 		}
 
-		if (!wpa_supplicant_ssid_bss_match(wpa_s, ssid, bss))
+		if (!wpa_supplicant_ssid_bss_match(wpa_s, ssid, bss, sel))
 			continue;
 
 		if (!wpa &&
@@ -745,19 +884,22 @@ static struct wpa_bss *
 wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 			  struct wpa_scan_results *scan_res,
 			  struct wpa_ssid *group,
-			  struct wpa_ssid **selected_ssid)
+			  struct wpa_ssid **selected_ssid,
+			  struct wpa_sel_ctx *ctx)
 {
 	size_t i;
 
 	wpa_dbg(wpa_s, MSG_DEBUG, "Selecting BSS from priority group %d",
 		group->priority);
 
+	wpa_sel_index_group(ctx, group);
+
 	for (i = 0; i < scan_res->num; i++) {
 		struct wpa_scan_res *bss = scan_res->res[i];
 		const u8 *ie, *ssid;
 		u8 ssid_len;
 
-		*selected_ssid = wpa_scan_res_match(wpa_s, i, bss, group);
+		*selected_ssid = wpa_scan_res_match(wpa_s, i, bss, ctx);
 		if (!*selected_ssid)
 			continue;
 
@@ -778,21 +920,40 @@ wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 static struct wpa_bss *
 wpa_supplicant_pick_network(struct wpa_supplicant *wpa_s,
 			    struct wpa_scan_results *scan_res,
-			    struct wpa_ssid **selected_ssid)
+			    struct wpa_ssid **selected_ssid,
+			    int clear_blacklist)
 {
 	struct wpa_bss *selected = NULL;
+	struct wpa_sel_ctx ctx;
+	unsigned int count, max_count = 0;
 	int prio;
 
+	os_memset(&ctx, 0, sizeof(ctx));
+	ctx.enabled_networks = wpa_supplicant_enabled_networks(wpa_s->conf);
+	for (prio = 0; prio < wpa_s->conf->num_prio; prio++) {
+		count = wpa_sel_group_size(wpa_s->conf->pssid[prio]);
+		if (count > max_count)
+			max_count = count;
+	}
+	if (max_count) {
+		ctx.nets = os_malloc(max_count * sizeof(struct wpa_sel_net));
+		if (ctx.nets == NULL)
+			return NULL;
+	}
+	/* Parsed WPA/RSN IEs are shared by all priority groups */
+	if (scan_res->num)
+		ctx.bss = os_zalloc(scan_res->num * sizeof(struct wpa_sel_bss));
+
 	while (selected == NULL) {
 		for (prio = 0; prio < wpa_s->conf->num_prio; prio++) {
 			selected = wpa_supplicant_select_bss(
 				wpa_s, scan_res, wpa_s->conf->pssid[prio],
-				selected_ssid);
+				selected_ssid, &ctx);
 			if (selected)
 				break;
 		}
 
-		if (selected == NULL && wpa_s->blacklist) {
+		if (selected == NULL && clear_blacklist && wpa_s->blacklist) {
 			wpa_dbg(wpa_s, MSG_DEBUG, "No APs found - clear "
 				"blacklist and try again");
 			wpa_blacklist_clear(wpa_s);
@@ -801,6 +962,9 @@ wpa_supplicant_pick_network(struct wpa_supplicant *wpa_s,
 			break;
 	}
 
+	os_free(ctx.bss);
+	os_free(ctx.nets);
+
 	return selected;
 }
 
@@ -870,6 +1034,117 @@ int wpa_supplicant_connect(struct wpa_supplicant *wpa_s,
 }
 
 
+static struct wpa_scan_results *
+wpa_supplicant_bss_to_scan_res(struct wpa_supplicant *wpa_s, int max_age)
+{
+	struct wpa_scan_results *res;
+	struct wpa_scan_res *r;
+	struct wpa_bss *bss;
+	struct os_time now;
+
+	res = os_zalloc(sizeof(*res));
+	if (res == NULL)
+		return NULL;
+	res->res = os_zalloc(wpa_s->num_bss * sizeof(struct wpa_scan_res *));
+	if (res->res == NULL) {
+		os_free(res);
+		return NULL;
+	}
+
+	os_get_time(&now);
+	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+		if (res->num >= wpa_s->num_bss)
+			break;
+		if (max_age >= 0 && bss->last_update.sec + max_age < now.sec)
+			continue;
+		r = os_malloc(sizeof(*r) + bss->ie_len + bss->beacon_ie_len);
+		if (r == NULL)
+			break;
+		os_memset(r, 0, sizeof(*r));
+		r->flags = bss->flags;
+		os_memcpy(r->bssid, bss->bssid, ETH_ALEN);
+		r->freq = bss->freq;
+		r->beacon_int = bss->beacon_int;
+		r->caps = bss->caps;
+		r->qual = bss->qual;
+		r->noise = bss->noise;
+		r->level = bss->level;
+		r->tsf = bss->tsf;
+		r->age = (now.sec - bss->last_update.sec) * 1000;
+		r->ie_len = bss->ie_len;
+		r->beacon_ie_len = bss->beacon_ie_len;
+		os_memcpy(r + 1, bss + 1, bss->ie_len + bss->beacon_ie_len);
+		r->ie_index = bss->ie_index;
+		res->res[res->num++] = r;
+	}
+
+	wpa_supplicant_sort_scan_results(wpa_s, res);
+
+	return res;
+}
+
+
+/**
+ * wpa_supplicant_fast_connect - Try to connect without waiting for a scan
+ * @wpa_s: Pointer to wpa_supplicant data
+ * Returns: 1 if association was started, 0 if a scan is needed
+ *
+ * This is called when a new scan is about to be started for connection. If
+ * the BSS table has a sufficiently recent entry for an enabled network
+ * (fast_connect_age), association is started immediately based on it. If
+ * only older entries match, the following scan is limited to the channel of
+ * the selected BSS. This is done only once per disconnection so that a full
+ * scan is used if the fast connection attempt fails.
+ */
+int wpa_supplicant_fast_connect(struct wpa_supplicant *wpa_s)
+{
+	struct wpa_scan_results *res;
+	struct wpa_bss *selected;
+	struct wpa_ssid *ssid = NULL;
+	int *freqs;
+
+	if (wpa_s->conf->fast_connect_age == 0 || wpa_s->fast_connect_done ||
+	    wpa_s->num_bss == 0 || wpas_wps_in_progress(wpa_s))
+		return 0;
+	wpa_s->fast_connect_done = 1;
+
+	res = wpa_supplicant_bss_to_scan_res(wpa_s,
+					     wpa_s->conf->fast_connect_age);
+	if (res == NULL)
+		return 0;
+	selected = wpa_supplicant_pick_network(wpa_s, res, &ssid, 0);
+	wpa_scan_results_free(res);
+	if (selected) {
+		wpa_dbg(wpa_s, MSG_DEBUG, "Fast connect to " MACSTR
+			" based on cached scan results",
+			MAC2STR(selected->bssid));
+		conn_timeline_event(wpa_s, CONN_TL_FAST_CONNECT, selected->id);
+		if (wpa_supplicant_connect(wpa_s, selected, ssid) < 0)
+			return 0;
+		return 1;
+	}
+
+	/* Try to find a known BSS to limit the scan to a single channel */
+	res = wpa_supplicant_bss_to_scan_res(wpa_s, -1);
+	if (res == NULL)
+		return 0;
+	selected = wpa_supplicant_pick_network(wpa_s, res, &ssid, 0);
+	wpa_scan_results_free(res);
+	if (selected == NULL || wpa_s->next_scan_freqs)
+		return 0;
+
+	freqs = os_zalloc(2 * sizeof(int));
+	if (freqs == NULL)
+		return 0;
+	freqs[0] = selected->freq;
+	wpa_dbg(wpa_s, MSG_DEBUG, "Fast connect: scan only %d MHz for "
+		MACSTR, freqs[0], MAC2STR(selected->bssid));
+	wpa_s->next_scan_freqs = freqs;
+
+	return 0;
+}
+
+
 static struct wpa_ssid *
 wpa_supplicant_pick_new_network(struct wpa_supplicant *wpa_s)
 {
@@ -1061,6 +1336,7 @@ static int _wpa_supplicant_event_scan_results(struct wpa_supplicant *wpa_s,
 	}
 
 	wpa_dbg(wpa_s, MSG_DEBUG, "New scan results available");
+	conn_timeline_event(wpa_s, CONN_TL_SCAN_RESULTS, scan_res->num);
 	wpa_msg_ctrl(wpa_s, MSG_INFO, WPA_EVENT_SCAN_RESULTS);
 	wpas_notify_scan_results(wpa_s);
 
@@ -1083,7 +1359,7 @@ static int _wpa_supplicant_event_scan_results(struct wpa_supplicant *wpa_s,
 		return 0;
 	}
 
-	selected = wpa_supplicant_pick_network(wpa_s, scan_res, &ssid);
+	selected = wpa_supplicant_pick_network(wpa_s, scan_res, &ssid, 1);
 
 	if (selected) {
 		int skip;
@@ -1534,6 +1810,7 @@ static void wpa_supplicant_event_disassoc(struct wpa_supplicant *wpa_s,
 
 	authenticating = wpa_s->wpa_state == WPA_AUTHENTICATING;
 	os_memcpy(prev_pending_bssid, wpa_s->pending_bssid, ETH_ALEN);
+	conn_timeline_event(wpa_s, CONN_TL_DISCONNECT, reason_code);
 
 	if (wpa_s->key_mgmt == WPA_KEY_MGMT_WPA_NONE) {
 		/*
@@ -67,6 +67,10 @@ static void usage(void)
 #ifdef CONFIG_DEBUG_SYSLOG
 	printf("  -s = log output to syslog instead of stdout\n");
 #endif /* CONFIG_DEBUG_SYSLOG */
+#ifdef CONFIG_DEBUG_RINGBUF
+	printf("  -r = keep debug messages in a memory ring buffer of "
+	       "<records> entries\n");
+#endif /* CONFIG_DEBUG_RINGBUF */
 	printf("  -t = include timestamp in debug messages\n"
 	       "  -h = show this help text\n"
 	       "  -L = show license (GPL and BSD)\n"
@@ -145,7 +149,7 @@ int main(int argc, char *argv[])
 	wpa_supplicant_fd_workaround();
 
 	for (;;) {
-		c = getopt(argc, argv, "b:Bc:C:D:de:f:g:hi:KLNo:O:p:P:qstuvW");
+		c = getopt(argc, argv, "b:Bc:C:D:de:f:g:hi:KLNo:O:p:P:qr:stuvW");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -215,6 +219,11 @@ int main(int argc, char *argv[])
 		case 'q':
 			params.wpa_debug_level++;
 			break;
+#ifdef CONFIG_DEBUG_RINGBUF
+		case 'r':
+			params.wpa_debug_ringbuf = atoi(optarg);
+			break;
+#endif /* CONFIG_DEBUG_RINGBUF */
 #ifdef CONFIG_DEBUG_SYSLOG
 		case 's':
 			params.wpa_debug_syslog++;
@@ -115,7 +115,9 @@ OBJS = \
 	$(OBJDIR)\scan_helpers.obj \
 	$(OBJDIR)\events.obj \
 	$(OBJDIR)\blacklist.obj \
+	$(OBJDIR)\conn_timeline.obj \
 	$(OBJDIR)\scan.obj \
+	$(OBJDIR)\bss_ie.obj \
 	$(OBJDIR)\wpas_glue.obj \
 	$(OBJDIR)\eap_register.obj \
 	$(OBJDIR)\config.obj \
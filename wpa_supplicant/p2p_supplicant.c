@@ -1041,6 +1041,35 @@ static int wpas_send_probe_resp(void *ctx, const struct wpabuf *buf)
 }
 
 
+static unsigned int wpas_p2p_srv_hash(u8 version, const u8 *data, size_t len)
+{
+	unsigned int hash = version;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		hash = hash * 31 + data[i];
+	return hash & (P2P_SRV_HASH_SIZE - 1);
+}
+
+
+static struct p2p_srv_bonjour **
+wpas_p2p_bonjour_bucket(struct wpa_global *global, const struct wpabuf *query)
+{
+	return &global->p2p_srv_bonjour_hash[
+		wpas_p2p_srv_hash(0, wpabuf_head(query), wpabuf_len(query))];
+}
+
+
+static struct p2p_srv_upnp **
+wpas_p2p_upnp_bucket(struct wpa_global *global, u8 version,
+		     const char *service)
+{
+	return &global->p2p_srv_upnp_hash[
+		wpas_p2p_srv_hash(version, (const u8 *) service,
+				  os_strlen(service))];
+}
+
+
 static struct p2p_srv_bonjour *
 wpas_p2p_service_get_bonjour(struct wpa_supplicant *wpa_s,
 			     const struct wpabuf *query)
@@ -1049,8 +1078,8 @@ wpas_p2p_service_get_bonjour(struct wpa_supplicant *wpa_s,
 	size_t len;
 
 	len = wpabuf_len(query);
-	dl_list_for_each(bsrv, &wpa_s->global->p2p_srv_bonjour,
-			 struct p2p_srv_bonjour, list) {
+	for (bsrv = *wpas_p2p_bonjour_bucket(wpa_s->global, query); bsrv;
+	     bsrv = bsrv->hnext) {
 		if (len == wpabuf_len(bsrv->query) &&
 		    os_memcmp(wpabuf_head(query), wpabuf_head(bsrv->query),
 			      len) == 0)
@@ -1066,8 +1095,8 @@ wpas_p2p_service_get_upnp(struct wpa_supplicant *wpa_s, u8 version,
 {
 	struct p2p_srv_upnp *usrv;
 
-	dl_list_for_each(usrv, &wpa_s->global->p2p_srv_upnp,
-			 struct p2p_srv_upnp, list) {
+	for (usrv = *wpas_p2p_upnp_bucket(wpa_s->global, version, service);
+	     usrv; usrv = usrv->hnext) {
 		if (version == usrv->version &&
 		    os_strcmp(service, usrv->service) == 0)
 			return usrv;
@@ -1076,6 +1105,63 @@ wpas_p2p_service_get_upnp(struct wpa_supplicant *wpa_s, u8 version,
 }
 
 
+static void wpas_sd_cache_flush(struct wpa_global *global)
+{
+	struct p2p_sd_cache_entry *e;
+	int i;
+
+	for (i = 0; i < P2P_SD_CACHE_SIZE; i++) {
+		e = &global->p2p_sd_cache[i];
+		wpabuf_free(e->query);
+		wpabuf_free(e->tlvs);
+		os_memset(e, 0, sizeof(*e));
+	}
+	global->p2p_sd_cache_next = 0;
+}
+
+
+static struct p2p_sd_cache_entry *
+wpas_sd_cache_get(struct wpa_global *global, u8 srv_proto, const u8 *query,
+		  size_t query_len)
+{
+	struct p2p_sd_cache_entry *e;
+	int i;
+
+	for (i = 0; i < P2P_SD_CACHE_SIZE; i++) {
+		e = &global->p2p_sd_cache[i];
+		if (e->tlvs && e->srv_proto == srv_proto &&
+		    wpabuf_len(e->query) == query_len &&
+		    os_memcmp(wpabuf_head(e->query), query, query_len) == 0)
+			return e;
+	}
+	return NULL;
+}
+
+
+static struct p2p_sd_cache_entry *
+wpas_sd_cache_add(struct wpa_global *global, u8 srv_proto, const u8 *query,
+		  size_t query_len, struct wpabuf *tlvs)
+{
+	struct p2p_sd_cache_entry *e;
+	struct wpabuf *q;
+
+	q = wpabuf_alloc_copy(query, query_len);
+	if (q == NULL)
+		return NULL;
+
+	/* Replace the entries in round-robin order */
+	e = &global->p2p_sd_cache[global->p2p_sd_cache_next];
+	global->p2p_sd_cache_next = (global->p2p_sd_cache_next + 1) %
+		P2P_SD_CACHE_SIZE;
+	wpabuf_free(e->query);
+	wpabuf_free(e->tlvs);
+	e->srv_proto = srv_proto;
+	e->query = q;
+	e->tlvs = tlvs;
+	return e;
+}
+
+
 static void wpas_sd_add_proto_not_avail(struct wpabuf *resp, u8 srv_proto,
 					u8 srv_trans_id)
 {
@@ -1306,6 +1392,99 @@ static void wpas_sd_req_upnp(struct wpa_supplicant *wpa_s,
 }
 
 
+static void wpas_sd_req_proto(struct wpa_supplicant *wpa_s,
+			      struct wpabuf *resp, u8 srv_proto,
+			      u8 srv_trans_id, const u8 *query,
+			      size_t query_len)
+{
+	switch (srv_proto) {
+	case P2P_SERV_ALL_SERVICES:
+		wpa_printf(MSG_DEBUG, "P2P: Service Discovery Request for all "
+			   "services");
+		if (dl_list_empty(&wpa_s->global->p2p_srv_upnp) &&
+		    dl_list_empty(&wpa_s->global->p2p_srv_bonjour)) {
+			wpa_printf(MSG_DEBUG, "P2P: No service discovery "
+				   "protocols available");
+			wpas_sd_add_proto_not_avail(resp,
+						    P2P_SERV_ALL_SERVICES,
+						    srv_trans_id);
+			break;
+		}
+		wpas_sd_all_bonjour(wpa_s, resp, srv_trans_id);
+		wpas_sd_all_upnp(wpa_s, resp, srv_trans_id);
+		break;
+	case P2P_SERV_BONJOUR:
+		wpas_sd_req_bonjour(wpa_s, resp, srv_trans_id,
+				    query, query_len);
+		break;
+	case P2P_SERV_UPNP:
+		wpas_sd_req_upnp(wpa_s, resp, srv_trans_id,
+				 query, query_len);
+		break;
+	default:
+		wpa_printf(MSG_DEBUG, "P2P: Unavailable service protocol %u",
+			   srv_proto);
+		wpas_sd_add_proto_not_avail(resp, srv_proto, srv_trans_id);
+		break;
+	}
+}
+
+
+/*
+ * Add the Service Response TLVs for a Service Request TLV into resp. The TLVs
+ * are cached by Service Protocol Type and Query Data until the local services
+ * change, so repeated queries from peers during discovery do not need to
+ * search the services and serialize the matching records again.
+ */
+static void wpas_sd_req_cached(struct wpa_supplicant *wpa_s,
+			       struct wpabuf *resp, u8 srv_proto,
+			       u8 srv_trans_id, const u8 *query,
+			       size_t query_len)
+{
+	struct p2p_sd_cache_entry *e;
+	struct wpabuf *tlvs;
+	u8 *pos, *end;
+
+	e = wpas_sd_cache_get(wpa_s->global, srv_proto, query, query_len);
+	if (e == NULL) {
+		tlvs = wpabuf_alloc(wpabuf_size(resp));
+		if (tlvs == NULL)
+			goto no_cache;
+		wpas_sd_req_proto(wpa_s, tlvs, srv_proto, srv_trans_id,
+				  query, query_len);
+		e = wpas_sd_cache_add(wpa_s->global, srv_proto, query,
+				      query_len, tlvs);
+		if (e == NULL) {
+			wpabuf_free(tlvs);
+			goto no_cache;
+		}
+	} else
+		wpa_printf(MSG_DEBUG, "P2P: Use cached response for Service "
+			   "Protocol Type %u", srv_proto);
+
+	if (wpabuf_len(e->tlvs) > wpabuf_tailroom(resp)) {
+		/*
+		 * Not enough room for the full response; build the TLVs that
+		 * fit directly into the remaining buffer.
+		 */
+		goto no_cache;
+	}
+
+	pos = wpabuf_put(resp, wpabuf_len(e->tlvs));
+	os_memcpy(pos, wpabuf_head(e->tlvs), wpabuf_len(e->tlvs));
+	end = pos + wpabuf_len(e->tlvs);
+	while (end - pos >= 4) {
+		pos[3] = srv_trans_id;
+		pos += 2 + WPA_GET_LE16(pos);
+	}
+	return;
+
+no_cache:
+	wpas_sd_req_proto(wpa_s, resp, srv_proto, srv_trans_id, query,
+			  query_len);
+}
+
+
 void wpas_sd_request(void *ctx, int freq, const u8 *sa, u8 dialog_token,
 		     u16 update_indic, const u8 *tlvs, size_t tlvs_len)
 {
@@ -1370,37 +1549,8 @@ void wpas_sd_request(void *ctx, int freq, const u8 *sa, u8 dialog_token,
 			goto done;
 		}
 
-		switch (srv_proto) {
-		case P2P_SERV_ALL_SERVICES:
-			wpa_printf(MSG_DEBUG, "P2P: Service Discovery Request "
-				   "for all services");
-			if (dl_list_empty(&wpa_s->global->p2p_srv_upnp) &&
-			    dl_list_empty(&wpa_s->global->p2p_srv_bonjour)) {
-				wpa_printf(MSG_DEBUG, "P2P: No service "
-					   "discovery protocols available");
-				wpas_sd_add_proto_not_avail(
-					resp, P2P_SERV_ALL_SERVICES,
-					srv_trans_id);
-				break;
-			}
-			wpas_sd_all_bonjour(wpa_s, resp, srv_trans_id);
-			wpas_sd_all_upnp(wpa_s, resp, srv_trans_id);
-			break;
-		case P2P_SERV_BONJOUR:
-			wpas_sd_req_bonjour(wpa_s, resp, srv_trans_id,
-					    pos, tlv_end - pos);
-			break;
-		case P2P_SERV_UPNP:
-			wpas_sd_req_upnp(wpa_s, resp, srv_trans_id,
-					 pos, tlv_end - pos);
-			break;
-		default:
-			wpa_printf(MSG_DEBUG, "P2P: Unavailable service "
-				   "protocol %u", srv_proto);
-			wpas_sd_add_proto_not_avail(resp, srv_proto,
-						    srv_trans_id);
-			break;
-		}
+		wpas_sd_req_cached(wpa_s, resp, srv_proto, srv_trans_id,
+				   pos, tlv_end - pos);
 
 		pos = tlv_end;
 	}
@@ -1539,6 +1689,7 @@ void wpas_p2p_sd_response(struct wpa_supplicant *wpa_s, int freq,
 
 void wpas_p2p_sd_service_update(struct wpa_supplicant *wpa_s)
 {
+	wpas_sd_cache_flush(wpa_s->global);
 	if (wpa_s->drv_flags & WPA_DRIVER_FLAGS_P2P_MGMT) {
 		wpa_drv_p2p_service_update(wpa_s);
 		return;
@@ -1548,8 +1699,18 @@ void wpas_p2p_sd_service_update(struct wpa_supplicant *wpa_s)
 }
 
 
-static void wpas_p2p_srv_bonjour_free(struct p2p_srv_bonjour *bsrv)
+static void wpas_p2p_srv_bonjour_free(struct wpa_global *global,
+				      struct p2p_srv_bonjour *bsrv)
 {
+	struct p2p_srv_bonjour **pos;
+
+	for (pos = wpas_p2p_bonjour_bucket(global, bsrv->query); *pos;
+	     pos = &(*pos)->hnext) {
+		if (*pos == bsrv) {
+			*pos = bsrv->hnext;
+			break;
+		}
+	}
 	dl_list_del(&bsrv->list);
 	wpabuf_free(bsrv->query);
 	wpabuf_free(bsrv->resp);
@@ -1557,8 +1718,18 @@ static void wpas_p2p_srv_bonjour_free(struct p2p_srv_bonjour *bsrv)
 }
 
 
-static void wpas_p2p_srv_upnp_free(struct p2p_srv_upnp *usrv)
+static void wpas_p2p_srv_upnp_free(struct wpa_global *global,
+				   struct p2p_srv_upnp *usrv)
 {
+	struct p2p_srv_upnp **pos;
+
+	for (pos = wpas_p2p_upnp_bucket(global, usrv->version, usrv->service);
+	     *pos; pos = &(*pos)->hnext) {
+		if (*pos == usrv) {
+			*pos = usrv->hnext;
+			break;
+		}
+	}
 	dl_list_del(&usrv->list);
 	os_free(usrv->service);
 	os_free(usrv);
@@ -1572,11 +1743,11 @@ void wpas_p2p_service_flush(struct wpa_supplicant *wpa_s)
 
 	dl_list_for_each_safe(bsrv, bn, &wpa_s->global->p2p_srv_bonjour,
 			      struct p2p_srv_bonjour, list)
-		wpas_p2p_srv_bonjour_free(bsrv);
+		wpas_p2p_srv_bonjour_free(wpa_s->global, bsrv);
 
 	dl_list_for_each_safe(usrv, un, &wpa_s->global->p2p_srv_upnp,
 			      struct p2p_srv_upnp, list)
-		wpas_p2p_srv_upnp_free(usrv);
+		wpas_p2p_srv_upnp_free(wpa_s->global, usrv);
 
 	wpas_p2p_sd_service_update(wpa_s);
 }
@@ -1585,13 +1756,14 @@ void wpas_p2p_service_flush(struct wpa_supplicant *wpa_s)
 int wpas_p2p_service_add_bonjour(struct wpa_supplicant *wpa_s,
 				 struct wpabuf *query, struct wpabuf *resp)
 {
-	struct p2p_srv_bonjour *bsrv;
+	struct p2p_srv_bonjour *bsrv, **bucket;
 
 	bsrv = wpas_p2p_service_get_bonjour(wpa_s, query);
 	if (bsrv) {
 		wpabuf_free(query);
 		wpabuf_free(bsrv->resp);
 		bsrv->resp = resp;
+		wpas_p2p_sd_service_update(wpa_s);
 		return 0;
 	}
 
@@ -1601,6 +1773,9 @@ int wpas_p2p_service_add_bonjour(struct wpa_supplicant *wpa_s,
 	bsrv->query = query;
 	bsrv->resp = resp;
 	dl_list_add(&wpa_s->global->p2p_srv_bonjour, &bsrv->list);
+	bucket = wpas_p2p_bonjour_bucket(wpa_s->global, query);
+	bsrv->hnext = *bucket;
+	*bucket = bsrv;
 
 	wpas_p2p_sd_service_update(wpa_s);
 	return 0;
@@ -1615,7 +1790,7 @@ int wpas_p2p_service_del_bonjour(struct wpa_supplicant *wpa_s,
 	bsrv = wpas_p2p_service_get_bonjour(wpa_s, query);
 	if (bsrv == NULL)
 		return -1;
-	wpas_p2p_srv_bonjour_free(bsrv);
+	wpas_p2p_srv_bonjour_free(wpa_s->global, bsrv);
 	wpas_p2p_sd_service_update(wpa_s);
 	return 0;
 }
@@ -1624,7 +1799,7 @@ int wpas_p2p_service_del_bonjour(struct wpa_supplicant *wpa_s,
 int wpas_p2p_service_add_upnp(struct wpa_supplicant *wpa_s, u8 version,
 			      const char *service)
 {
-	struct p2p_srv_upnp *usrv;
+	struct p2p_srv_upnp *usrv, **bucket;
 
 	if (wpas_p2p_service_get_upnp(wpa_s, version, service))
 		return 0; /* Already listed */
@@ -1638,6 +1813,9 @@ int wpas_p2p_service_add_upnp(struct wpa_supplicant *wpa_s, u8 version,
 		return -1;
 	}
 	dl_list_add(&wpa_s->global->p2p_srv_upnp, &usrv->list);
+	bucket = wpas_p2p_upnp_bucket(wpa_s->global, version, service);
+	usrv->hnext = *bucket;
+	*bucket = usrv;
 
 	wpas_p2p_sd_service_update(wpa_s);
 	return 0;
@@ -1652,7 +1830,7 @@ int wpas_p2p_service_del_upnp(struct wpa_supplicant *wpa_s, u8 version,
 	usrv = wpas_p2p_service_get_upnp(wpa_s, version, service);
 	if (usrv == NULL)
 		return -1;
-	wpas_p2p_srv_upnp_free(usrv);
+	wpas_p2p_srv_upnp_free(wpa_s->global, usrv);
 	wpas_p2p_sd_service_update(wpa_s);
 	return 0;
 }
@@ -2248,7 +2426,7 @@ int wpas_p2p_init(struct wpa_global *global, struct wpa_supplicant *wpa_s)
 	p2p.concurrent_operations = !!(wpa_s->drv_flags &
 				       WPA_DRIVER_FLAGS_P2P_CONCURRENT);
 
-	p2p.max_peers = 100;
+	p2p.max_peers = wpa_s->conf->p2p_max_peers;
 
 	if (wpa_s->conf->p2p_ssid_postfix) {
 		p2p.ssid_postfix_len =
@@ -2311,6 +2489,8 @@ void wpas_p2p_deinit_global(struct wpa_global *global)
 	struct wpa_supplicant *wpa_s, *tmp;
 	char *ifname;
 
+	wpas_sd_cache_flush(global);
+
 	if (global->p2p == NULL)
 		return;
 
@@ -3795,6 +3975,9 @@ void wpas_p2p_update_config(struct wpa_supplicant *wpa_s)
 	if (wpa_s->conf->changed_parameters & CFG_CHANGED_P2P_INTRA_BSS)
 		p2p_set_intra_bss_dist(p2p, wpa_s->conf->p2p_intra_bss);
 
+	if (wpa_s->conf->changed_parameters & CFG_CHANGED_P2P_MAX_PEERS)
+		p2p_set_max_peers(p2p, wpa_s->conf->p2p_max_peers);
+
 	if (wpa_s->conf->changed_parameters & CFG_CHANGED_P2P_LISTEN_CHANNEL) {
 		u8 reg_class, channel;
 		int ret;
@@ -518,6 +518,12 @@ static void wpa_supplicant_scan(void *eloop_ctx, void *timeout_ctx)
 		wpa_s->connect_without_scan = NULL;
 		wpa_supplicant_assoc_try(wpa_s, ssid);
 		return;
+	}
+
+	if (!scan_req && wpa_s->wpa_state == WPA_SCANNING &&
+	    wpa_supplicant_fast_connect(wpa_s)) {
+		/* Association started based on the BSS table */
+		return;
 	} else if (wpa_s->conf->ap_scan == 2) {
 		/*
 		 * User-initiated scan request in ap_scan == 2; scan with
@@ -880,46 +886,6 @@ static int wpa_scan_get_max_rate(const struct wpa_scan_res *res)
 }
 
 
-const u8 * wpa_scan_get_ie(const struct wpa_scan_res *res, u8 ie)
-{
-	const u8 *end, *pos;
-
-	pos = (const u8 *) (res + 1);
-	end = pos + res->ie_len;
-
-	while (pos + 1 < end) {
-		if (pos + 2 + pos[1] > end)
-			break;
-		if (pos[0] == ie)
-			return pos;
-		pos += 2 + pos[1];
-	}
-
-	return NULL;
-}
-
-
-const u8 * wpa_scan_get_vendor_ie(const struct wpa_scan_res *res,
-				  u32 vendor_type)
-{
-	const u8 *end, *pos;
-
-	pos = (const u8 *) (res + 1);
-	end = pos + res->ie_len;
-
-	while (pos + 1 < end) {
-		if (pos + 2 + pos[1] > end)
-			break;
-		if (pos[0] == WLAN_EID_VENDOR_SPECIFIC && pos[1] >= 4 &&
-		    vendor_type == WPA_GET_BE32(&pos[2]))
-			return pos;
-		pos += 2 + pos[1];
-	}
-
-	return NULL;
-}
-
-
 struct wpabuf * wpa_scan_get_vendor_ie_multi(const struct wpa_scan_res *res,
 					     u32 vendor_type)
 {
@@ -1138,6 +1104,29 @@ static void dump_scan_res(struct wpa_scan_results *scan_res)
 }
 
 
+/**
+ * wpa_supplicant_sort_scan_results - Sort scan results in preference order
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @scan_res: Scan results to sort
+ */
+void wpa_supplicant_sort_scan_results(struct wpa_supplicant *wpa_s,
+				      struct wpa_scan_results *scan_res)
+{
+	int (*compar)(const void *, const void *) = wpa_scan_result_compar;
+
+#ifdef CONFIG_WPS
+	if (wpas_wps_in_progress(wpa_s)) {
+		wpa_dbg(wpa_s, MSG_DEBUG, "WPS: Order scan results with WPS "
+			"provisioning rules");
+		compar = wpa_scan_result_wps_compar;
+	}
+#endif /* CONFIG_WPS */
+
+	qsort(scan_res->res, scan_res->num, sizeof(struct wpa_scan_res *),
+	      compar);
+}
+
+
 /**
  * wpa_supplicant_get_scan_results - Get scan results
  * @wpa_s: Pointer to wpa_supplicant data
@@ -1155,7 +1144,6 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 {
 	struct wpa_scan_results *scan_res;
 	size_t i;
-	int (*compar)(const void *, const void *) = wpa_scan_result_compar;
 
 	scan_res = wpa_drv_get_scan_results2(wpa_s);
 	if (scan_res == NULL) {
@@ -1163,16 +1151,18 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 		return NULL;
 	}
 
-#ifdef CONFIG_WPS
-	if (wpas_wps_in_progress(wpa_s)) {
-		wpa_dbg(wpa_s, MSG_DEBUG, "WPS: Order scan results with WPS "
-			"provisioning rules");
-		compar = wpa_scan_result_wps_compar;
+	/*
+	 * Index the commonly used IEs once here instead of walking the IE
+	 * buffer for each lookup during sorting, BSS table update, and network
+	 * selection.
+	 */
+	for (i = 0; i < scan_res->num; i++) {
+		struct wpa_scan_res *r = scan_res->res[i];
+		ieee802_11_ie_index_build(&r->ie_index, (const u8 *) (r + 1),
+					  r->ie_len);
 	}
-#endif /* CONFIG_WPS */
 
-	qsort(scan_res->res, scan_res->num, sizeof(struct wpa_scan_res *),
-	      compar);
+	wpa_supplicant_sort_scan_results(wpa_s, scan_res);
 	dump_scan_res(scan_res);
 
 	wpa_bss_update_start(wpa_s);
@@ -30,6 +30,7 @@
 #include "p2p_supplicant.h"
 #include "notify.h"
 #include "blacklist.h"
+#include "conn_timeline.h"
 #include "bss.h"
 #include "scan.h"
 #include "sme.h"
@@ -126,8 +127,10 @@ void sme_authenticate(struct wpa_supplicant *wpa_s,
 			(ssid->proto & WPA_PROTO_RSN);
 		if (pmksa_cache_set_current(wpa_s->wpa, NULL, bss->bssid,
 					    wpa_s->current_ssid,
-					    try_opportunistic) == 0)
+					    try_opportunistic) == 0) {
 			eapol_sm_notify_pmkid_attempt(wpa_s->eapol, 1);
+			conn_timeline_event(wpa_s, CONN_TL_PMKSA, 1);
+		}
 		wpa_s->sme.assoc_req_ie_len = sizeof(wpa_s->sme.assoc_req_ie);
 		if (wpa_supplicant_set_suites(wpa_s, bss, ssid,
 					      wpa_s->sme.assoc_req_ie,
@@ -316,6 +319,7 @@ void sme_event_auth(struct wpa_supplicant *wpa_s, union wpa_event_data *data)
 		" auth_type=%d status_code=%d",
 		MAC2STR(data->auth.peer), data->auth.auth_type,
 		data->auth.status_code);
+	conn_timeline_event(wpa_s, CONN_TL_AUTH_RESP, data->auth.status_code);
 	wpa_hexdump(MSG_MSGDUMP, "SME: Authentication response IEs",
 		    data->auth.ies, data->auth.ies_len);
 
@@ -471,6 +471,36 @@ static int wpa_cli_cmd_relog(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int wpa_cli_cmd_log_dump(struct wpa_ctrl *ctrl, int argc, char *argv[])
+{
+	char cmd[64];
+	int res;
+
+	if (argc < 1)
+		return wpa_ctrl_command(ctrl, "LOG-DUMP");
+	res = os_snprintf(cmd, sizeof(cmd), "LOG-DUMP %s", argv[0]);
+	if (res < 0 || (size_t) res >= sizeof(cmd) - 1) {
+		printf("Too long LOG-DUMP command.\n");
+		return -1;
+	}
+	return wpa_ctrl_command(ctrl, cmd);
+}
+
+
+static int wpa_cli_cmd_pool_stats(struct wpa_ctrl *ctrl, int argc,
+				  char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "POOL-STATS");
+}
+
+
+static int wpa_cli_cmd_driver_stats(struct wpa_ctrl *ctrl, int argc,
+				    char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "DRIVER-STATS");
+}
+
+
 static int wpa_cli_cmd_note(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	char cmd[256];
@@ -707,6 +737,31 @@ static int wpa_cli_cmd_bss_expire_count(struct wpa_ctrl *ctrl, int argc,
 }
 
 
+static int wpa_cli_cmd_bss_mem(struct wpa_ctrl *ctrl, int argc,
+			       char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "BSS_MEM");
+}
+
+
+static int wpa_cli_cmd_conn_timeline(struct wpa_ctrl *ctrl, int argc,
+				     char *argv[])
+{
+	char cmd[64];
+	int res;
+
+	if (argc == 0)
+		return wpa_ctrl_command(ctrl, "CONN-TIMELINE");
+
+	res = os_snprintf(cmd, sizeof(cmd), "CONN-TIMELINE %s", argv[0]);
+	if (res < 0 || (size_t) res >= sizeof(cmd) - 1) {
+		printf("Too long CONN-TIMELINE command.\n");
+		return -1;
+	}
+	return wpa_ctrl_command(ctrl, cmd);
+}
+
+
 static int wpa_cli_cmd_stkstart(struct wpa_ctrl *ctrl, int argc,
 				char *argv[])
 {
@@ -2685,6 +2740,15 @@ static struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "relog", wpa_cli_cmd_relog,
 	  cli_cmd_flag_none,
 	  "= re-open log-file (allow rolling logs)" },
+	{ "log_dump", wpa_cli_cmd_log_dump,
+	  cli_cmd_flag_none,
+	  "[skip] = show messages from the debug ring buffer" },
+	{ "pool_stats", wpa_cli_cmd_pool_stats,
+	  cli_cmd_flag_none,
+	  "= show memory pool statistics" },
+	{ "driver_stats", wpa_cli_cmd_driver_stats,
+	  cli_cmd_flag_none,
+	  "= show driver interface statistics" },
 	{ "note", wpa_cli_cmd_note,
 	  cli_cmd_flag_none,
 	  "<text> = add a note to wpa_supplicant debug log" },
@@ -2755,6 +2819,7 @@ static struct wpa_cli_cmd wpa_cli_commands[] = {
 	  cli_cmd_flag_none,
 	  "<BSSID> = add a BSSID to the blacklist\n"
 	  "blacklist clear = clear the blacklist\n"
+	  "blacklist verbose = display the blacklist with failure counts\n"
 	  "blacklist = display the blacklist" },
 	{ "log_level", wpa_cli_cmd_log_level,
 	  cli_cmd_flag_none,
@@ -2837,6 +2902,13 @@ static struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "bss_expire_count", wpa_cli_cmd_bss_expire_count,
 	  cli_cmd_flag_none,
 	  "<value> = set BSS expiration scan count parameter" },
+	{ "bss_mem", wpa_cli_cmd_bss_mem,
+	  cli_cmd_flag_none,
+	  "= get BSS table size and memory use" },
+	{ "conn_timeline", wpa_cli_cmd_conn_timeline,
+	  cli_cmd_flag_none,
+	  "= list timing of recent connection attempts\n"
+	  "conn_timeline <id> = show all events of a connection attempt" },
 	{ "stkstart", wpa_cli_cmd_stkstart,
 	  cli_cmd_flag_none,
 	  "<addr> = request STK negotiation with <addr>" },
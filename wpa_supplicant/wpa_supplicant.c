@@ -39,6 +39,7 @@
 #include "common/ieee802_11_defs.h"
 #include "p2p/p2p.h"
 #include "blacklist.h"
+#include "conn_timeline.h"
 #include "wpas_glue.h"
 #include "wps_supplicant.h"
 #include "ibss_rsn.h"
@@ -429,6 +430,7 @@ static void wpa_supplicant_cleanup(struct wpa_supplicant *wpa_s)
 	wpa_sm_deinit(wpa_s->wpa);
 	wpa_s->wpa = NULL;
 	wpa_blacklist_clear(wpa_s);
+	conn_timeline_deinit(wpa_s);
 
 	wpa_bss_deinit(wpa_s);
 
@@ -650,6 +652,10 @@ void wpa_supplicant_set_state(struct wpa_supplicant *wpa_s,
 #endif /* CONFIG_BGSCAN */
 
 	if (wpa_s->wpa_state != old_state) {
+		conn_timeline_state(wpa_s, old_state, state);
+		if (state == WPA_COMPLETED || state == WPA_INACTIVE ||
+		    state == WPA_INTERFACE_DISABLED)
+			wpa_s->fast_connect_done = 0;
 		wpas_notify_state_changed(wpa_s, wpa_s->wpa_state, old_state);
 
 		if (wpa_s->wpa_state == WPA_COMPLETED ||
@@ -1234,8 +1240,10 @@ void wpa_supplicant_associate(struct wpa_supplicant *wpa_s,
 			(ssid->proto & WPA_PROTO_RSN);
 		if (pmksa_cache_set_current(wpa_s->wpa, NULL, bss->bssid,
 					    wpa_s->current_ssid,
-					    try_opportunistic) == 0)
+					    try_opportunistic) == 0) {
 			eapol_sm_notify_pmkid_attempt(wpa_s->eapol, 1);
+			conn_timeline_event(wpa_s, CONN_TL_PMKSA, 1);
+		}
 		wpa_ie_len = sizeof(wpa_ie);
 		if (wpa_supplicant_set_suites(wpa_s, bss, ssid,
 					      wpa_ie, &wpa_ie_len)) {
@@ -2161,6 +2169,7 @@ static struct wpa_supplicant * wpa_supplicant_alloc(void)
 	wpa_s->new_connection = 1;
 	wpa_s->parent = wpa_s;
 	wpa_s->sched_scanning = 0;
+	conn_timeline_init(wpa_s);
 
 	return wpa_s;
 }
@@ -2640,6 +2649,11 @@ struct wpa_global * wpa_supplicant_init(struct wpa_params *params)
 		params->wpa_debug_show_keys;
 	wpa_debug_timestamp = global->params.wpa_debug_timestamp =
 		params->wpa_debug_timestamp;
+	if (params->wpa_debug_ringbuf &&
+	    wpa_debug_ringbuf_init(params->wpa_debug_ringbuf,
+				   wpa_debug_level < MSG_DEBUG ?
+				   wpa_debug_level : MSG_DEBUG) < 0)
+		wpa_printf(MSG_ERROR, "Failed to initialize debug ring buffer");
 
 	wpa_printf(MSG_DEBUG, "wpa_supplicant v" VERSION_STR);
 
@@ -2765,6 +2779,7 @@ void wpa_supplicant_deinit(struct wpa_global *global)
 	os_free(global);
 	wpa_debug_close_syslog();
 	wpa_debug_close_file();
+	wpa_debug_ringbuf_deinit();
 }
 
 
@@ -36,6 +36,7 @@ struct scan_info;
 struct wpa_bss;
 struct wpa_scan_results;
 struct hostapd_hw_modes;
+struct conn_timeline;
 
 /*
  * Forward declarations of private structures used within the ctrl_iface
@@ -165,6 +166,13 @@ struct wpa_params {
 	 */
 	int wpa_debug_syslog;
 
+	/**
+	 * wpa_debug_ringbuf - Number of debug messages to keep in memory
+	 *
+	 * This is 0 when the in-memory debug ring buffer is not used.
+	 */
+	int wpa_debug_ringbuf;
+
 	/**
 	 * override_driver - Optional driver parameter override
 	 *
@@ -194,16 +202,35 @@ struct wpa_params {
 
 struct p2p_srv_bonjour {
 	struct dl_list list;
+	struct p2p_srv_bonjour *hnext; /* in wpa_global::p2p_srv_bonjour_hash */
 	struct wpabuf *query;
 	struct wpabuf *resp;
 };
 
 struct p2p_srv_upnp {
 	struct dl_list list;
+	struct p2p_srv_upnp *hnext; /* in wpa_global::p2p_srv_upnp_hash */
 	u8 version;
 	char *service;
 };
 
+#define P2P_SRV_HASH_SIZE 32
+
+/**
+ * struct p2p_sd_cache_entry - Cached Service Response TLVs
+ * @srv_proto: Service Protocol Type of the request TLV
+ * @query: Query Data of the request TLV
+ * @tlvs: Service Response TLVs built for the request TLV; the Service
+ *	Transaction ID is updated for each response
+ */
+struct p2p_sd_cache_entry {
+	u8 srv_proto;
+	struct wpabuf *query;
+	struct wpabuf *tlvs;
+};
+
+#define P2P_SD_CACHE_SIZE 8
+
 /**
  * struct wpa_global - Internal, global data for all %wpa_supplicant interfaces
  *
@@ -223,6 +250,10 @@ struct wpa_global {
 	u8 p2p_dev_addr[ETH_ALEN];
 	struct dl_list p2p_srv_bonjour; /* struct p2p_srv_bonjour */
 	struct dl_list p2p_srv_upnp; /* struct p2p_srv_upnp */
+	struct p2p_srv_bonjour *p2p_srv_bonjour_hash[P2P_SRV_HASH_SIZE];
+	struct p2p_srv_upnp *p2p_srv_upnp_hash[P2P_SRV_HASH_SIZE];
+	struct p2p_sd_cache_entry p2p_sd_cache[P2P_SD_CACHE_SIZE];
+	unsigned int p2p_sd_cache_next;
 	int p2p_disabled;
 	int cross_connection;
 };
@@ -257,6 +288,7 @@ struct wpa_supplicant {
 #ifdef CONFIG_CTRL_IFACE_DBUS_NEW
 	char *dbus_new_path;
 	char *dbus_groupobj_path;
+	struct wpas_dbus_bss_delta *dbus_bss_delta;
 #endif /* CONFIG_CTRL_IFACE_DBUS_NEW */
 	char bridge_ifname[16];
 
@@ -304,6 +336,7 @@ struct wpa_supplicant {
 	struct dl_list bss; /* struct wpa_bss::list */
 	struct dl_list bss_id; /* struct wpa_bss::list_id */
 	size_t num_bss;
+	size_t bss_mem; /* octets used by BSS entries including IEs */
 	unsigned int bss_update_idx;
 	unsigned int bss_next_id;
 
@@ -331,6 +364,9 @@ struct wpa_supplicant {
 	int keys_cleared;
 
 	struct wpa_blacklist *blacklist;
+#define WPA_BLACKLIST_HASH_SIZE 64
+	struct wpa_blacklist *blacklist_hash[WPA_BLACKLIST_HASH_SIZE];
+	unsigned int num_blacklist;
 
 	int scan_req; /* manual scan request; this forces a scan even if there
 		       * are no enabled networks in the configuration */
@@ -338,6 +374,13 @@ struct wpa_supplicant {
 	int *next_scan_freqs;
 	int scan_interval; /* time in sec between scans to find suitable AP */
 
+	int fast_connect_done; /* tried once per connection attempt */
+
+	struct dl_list conn_tl; /* struct conn_timeline; oldest first */
+	unsigned int num_conn_tl;
+	unsigned int conn_tl_next_id;
+	struct conn_timeline *conn_tl_cur; /* attempt in progress */
+
 	unsigned int drv_flags;
 	int max_scan_ssids;
 	int max_sched_scan_ssids;
@@ -585,6 +628,7 @@ void wpa_supplicant_mark_disassoc(struct wpa_supplicant *wpa_s);
 int wpa_supplicant_connect(struct wpa_supplicant *wpa_s,
 			   struct wpa_bss *selected,
 			   struct wpa_ssid *ssid);
+int wpa_supplicant_fast_connect(struct wpa_supplicant *wpa_s);
 void wpa_supplicant_stop_countermeasures(void *eloop_ctx, void *sock_ctx);
 void wpa_supplicant_delayed_mic_error_report(void *eloop_ctx, void *sock_ctx);
 
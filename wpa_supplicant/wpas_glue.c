@@ -32,6 +32,7 @@
 #include "bss.h"
 #include "scan.h"
 #include "notify.h"
+#include "conn_timeline.h"
 
 
 #ifndef CONFIG_NO_CONFIG_BLOBS
@@ -231,6 +232,7 @@ static void wpa_supplicant_eapol_cb(struct eapol_sm *eapol, int success,
 
 	wpa_printf(MSG_DEBUG, "EAPOL authentication completed %ssuccessfully",
 		   success ? "" : "un");
+	conn_timeline_event(wpa_s, CONN_TL_EAP_DONE, success);
 
 	if (wpas_wps_eapol_cb(wpa_s) > 0)
 		return;